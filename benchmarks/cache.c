@@ -0,0 +1,265 @@
+/**
+ * @file
+ *
+ * @brief Cold-start benchmark for kdbOpen + kdbGet with and without the cache
+ *
+ * Mounts 10, 100 and 1000 backends below the test root `user:/tests/benchmark/cache` and
+ * measures a fresh kdbOpen followed by the first kdbGet. Each configuration is measured
+ * once with the default contract and once with the cache enabled via the contract key
+ * `system:/elektra/contract/mountglobal/cache`.
+ *
+ * The configuration files and the cache entries are kept in a temporary directory.
+ * The benchmark refuses to run if something is already mounted below the test root
+ * and restores the previous mountpoint configuration afterwards.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <benchmarks.h>
+#include <kdb.h>
+#include <kdbconfig.h>
+
+#define NUM_RUNS 7
+#define KEYS_PER_MOUNTPOINT 10
+
+#define CACHE_ROOT "user:/tests/benchmark/cache"
+#define MOUNTPOINTS_ROOT "system:/elektra/mountpoints"
+
+#define CSV_STR_FMT "%s;%d;%s;%d\n"
+
+static const int mountpointCounts[] = { 10, 100, 1000 };
+
+static char workDir[] = "/tmp/elektra-benchmark-cache-XXXXXX";
+
+static void addMountpointKey (KeySet * ks, const Key * root, const char * name, const char * value)
+{
+	Key * key = keyDup (root, KEY_CP_NAME);
+	keyAddName (key, name);
+	keySetString (key, value);
+	ksAppendKey (ks, key);
+}
+
+static void addMountpoint (KeySet * mountpoints, int index)
+{
+	char buffer[128];
+	snprintf (buffer, sizeof (buffer), CACHE_ROOT "/mp%d", index);
+
+	Key * root = keyNew (MOUNTPOINTS_ROOT, KEY_END);
+	keyAddBaseName (root, buffer);
+	ksAppendKey (mountpoints, keyDup (root, KEY_CP_NAME));
+
+	snprintf (buffer, sizeof (buffer), "%s/mp%d.ecf", workDir, index);
+
+	addMountpointKey (mountpoints, root, "plugins/backend", "");
+	addMountpointKey (mountpoints, root, "plugins/backend/name", "backend");
+	addMountpointKey (mountpoints, root, "plugins/resolver", "");
+	addMountpointKey (mountpoints, root, "plugins/resolver/name", KDB_RESOLVER);
+	addMountpointKey (mountpoints, root, "plugins/storage", "");
+	addMountpointKey (mountpoints, root, "plugins/storage/name", KDB_STORAGE);
+	addMountpointKey (mountpoints, root, "definition/path", buffer);
+	addMountpointKey (mountpoints, root, "definition/positions/get/resolver", "resolver");
+	addMountpointKey (mountpoints, root, "definition/positions/get/storage", "storage");
+	addMountpointKey (mountpoints, root, "definition/positions/set/resolver", "resolver");
+	addMountpointKey (mountpoints, root, "definition/positions/set/storage", "storage");
+	addMountpointKey (mountpoints, root, "definition/positions/set/commit", "resolver");
+	addMountpointKey (mountpoints, root, "definition/positions/set/rollback", "resolver");
+
+	keyDel (root);
+}
+
+/**
+ * @brief Checks whether @p mountpoints contains a mountpoint below CACHE_ROOT
+ */
+static int hasBenchmarkMountpoints (KeySet * mountpoints)
+{
+	Key * mountpointsRoot = keyNew (MOUNTPOINTS_ROOT, KEY_END);
+	int found = 0;
+	for (elektraCursor it = 0; it < ksGetSize (mountpoints) && !found; ++it)
+	{
+		Key * cur = ksAtCursor (mountpoints, it);
+		found = keyIsDirectlyBelow (mountpointsRoot, cur) == 1 && strncmp (keyBaseName (cur), CACHE_ROOT "/", sizeof (CACHE_ROOT)) == 0;
+	}
+	keyDel (mountpointsRoot);
+	return found;
+}
+
+/**
+ * @brief Replaces the mountpoint configuration with @p previous and @p count benchmark mountpoints
+ *
+ * @retval 0 on success
+ * @retval -1 on error
+ */
+static int setMountpoints (const KeySet * previous, int count)
+{
+	Key * parentKey = keyNew (MOUNTPOINTS_ROOT, KEY_END);
+	KDB * handle = kdbOpen (NULL, parentKey);
+	if (handle == NULL)
+	{
+		keyDel (parentKey);
+		return -1;
+	}
+
+	KeySet * mountpoints = ksNew (0, KS_END);
+	int ret = kdbGet (handle, mountpoints, parentKey);
+	if (ret != -1)
+	{
+		ksClear (mountpoints);
+		ksAppend (mountpoints, previous);
+		for (int i = 0; i < count; ++i)
+		{
+			addMountpoint (mountpoints, i);
+		}
+		ret = kdbSet (handle, mountpoints, parentKey);
+	}
+
+	ksDel (mountpoints);
+	kdbClose (handle, parentKey);
+	keyDel (parentKey);
+	return ret == -1 ? -1 : 0;
+}
+
+/**
+ * @brief Fetches the current mountpoint configuration
+ *
+ * @return the mountpoint configuration or NULL if it could not be read
+ *         or already contains mountpoints below CACHE_ROOT
+ */
+static KeySet * getMountpoints (void)
+{
+	Key * parentKey = keyNew (MOUNTPOINTS_ROOT, KEY_END);
+	KDB * handle = kdbOpen (NULL, parentKey);
+	if (handle == NULL)
+	{
+		keyDel (parentKey);
+		return NULL;
+	}
+
+	KeySet * mountpoints = ksNew (0, KS_END);
+	if (kdbGet (handle, mountpoints, parentKey) == -1 || hasBenchmarkMountpoints (mountpoints))
+	{
+		ksDel (mountpoints);
+		mountpoints = NULL;
+	}
+
+	kdbClose (handle, parentKey);
+	keyDel (parentKey);
+	return mountpoints;
+}
+
+/**
+ * @brief Writes KEYS_PER_MOUNTPOINT keys into each of the @p count mountpoints
+ */
+static int setData (int count)
+{
+	Key * parentKey = keyNew (CACHE_ROOT, KEY_END);
+	KDB * handle = kdbOpen (NULL, parentKey);
+	if (handle == NULL)
+	{
+		keyDel (parentKey);
+		return -1;
+	}
+
+	KeySet * data = ksNew (0, KS_END);
+	int ret = kdbGet (handle, data, parentKey);
+	if (ret != -1)
+	{
+		ksClear (data);
+		char name[128];
+		for (int i = 0; i < count; ++i)
+		{
+			for (int k = 0; k < KEYS_PER_MOUNTPOINT; ++k)
+			{
+				snprintf (name, sizeof (name), CACHE_ROOT "/mp%d/key%d", i, k);
+				ksAppendKey (data, keyNew (name, KEY_VALUE, "value", KEY_END));
+			}
+		}
+		ret = kdbSet (handle, data, parentKey);
+	}
+
+	ksDel (data);
+	kdbClose (handle, parentKey);
+	keyDel (parentKey);
+	return ret == -1 ? -1 : 0;
+}
+
+static void benchmarkColdStart (int count, const char * mode, const KeySet * contract)
+{
+	for (size_t i = 0; i < NUM_RUNS; ++i)
+	{
+		Key * parentKey = keyNew (CACHE_ROOT, KEY_END);
+		KeySet * returned = ksNew (0, KS_END);
+
+		timeInit ();
+		KDB * handle = kdbOpen (contract, parentKey);
+		kdbGet (handle, returned, parentKey);
+		int diff = timeGetDiffMicroseconds ();
+
+		// the first run with the cache enabled only fills the cache
+		if (i > 0 || contract == NULL)
+		{
+			fprintf (stdout, CSV_STR_FMT, mode, count, "kdbOpen+kdbGet", diff);
+		}
+
+		kdbClose (handle, parentKey);
+		ksDel (returned);
+		keyDel (parentKey);
+	}
+}
+
+static int removeWorkFile (const char * fpath, const struct stat * sb ELEKTRA_UNUSED, int tflag ELEKTRA_UNUSED,
+			   struct FTW * ftwbuf ELEKTRA_UNUSED)
+{
+	return remove (fpath);
+}
+
+int main (void)
+{
+	// keep configuration files and cache entries out of the directories of the user
+	if (mkdtemp (workDir) == NULL || setenv ("XDG_CACHE_HOME", workDir, 1) != 0)
+	{
+		fprintf (stderr, "could not create temporary directory\n");
+		return 1;
+	}
+
+	KeySet * previousMountpoints = getMountpoints ();
+	if (previousMountpoints == NULL)
+	{
+		fprintf (stderr, "could not read mountpoints or something is already mounted below %s\n", CACHE_ROOT);
+		nftw (workDir, removeWorkFile, 16, FTW_DEPTH | FTW_PHYS);
+		return 1;
+	}
+
+	KeySet * cacheContract = ksNew (1, keyNew ("system:/elektra/contract/mountglobal/cache", KEY_END), KS_END);
+
+	fprintf (stdout, "%s;%s;%s;%s\n", "mode", "mountpoints", "operation", "microseconds");
+	for (size_t i = 0; i < sizeof (mountpointCounts) / sizeof (mountpointCounts[0]); ++i)
+	{
+		int count = mountpointCounts[i];
+		if (setMountpoints (previousMountpoints, count) != 0 || setData (count) != 0)
+		{
+			fprintf (stderr, "could not set up %d mountpoints below %s\n", count, CACHE_ROOT);
+			break;
+		}
+
+		benchmarkColdStart (count, "nocache", NULL);
+		benchmarkColdStart (count, "cache", cacheContract);
+	}
+
+	int ret = setMountpoints (previousMountpoints, 0);
+	if (ret != 0)
+	{
+		fprintf (stderr, "could not restore the mountpoints, remove the mountpoints below %s manually\n", CACHE_ROOT);
+	}
+
+	nftw (workDir, removeWorkFile, 16, FTW_DEPTH | FTW_PHYS);
+	ksDel (previousMountpoints);
+	ksDel (cacheContract);
+	return ret == 0 ? 0 : 1;
+}
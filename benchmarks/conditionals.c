@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for the conditionals plugin
+ *
+ * Evaluates the conditions of NUM_KEYS keys, which share NUM_CONDITIONS
+ * condition strings, with the get method of the conditionals plugin.
+ * Every tenth key is assigned a value that is read by the other keys.
+ *
+ * The number of keys can be passed as argument.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <stdio.h>
+
+#include <benchmarks.h>
+
+#define NUM_KEYS 10000
+#define NUM_CONDITIONS 10
+#define NUM_RUNS 3
+
+#define CONDITIONALS_ROOT KEY_ROOT "/conditionals"
+
+static KeySet * createKeys (int keys)
+{
+	KeySet * ks = ksNew (keys, KS_END);
+	char name[128];
+	char condition[128];
+	for (int i = 0; i < keys; ++i)
+	{
+		int c = i % NUM_CONDITIONS;
+		snprintf (name, sizeof (name), CONDITIONALS_ROOT "/dir%d/key%d", i / NUM_CONDITIONS, c);
+		Key * key = keyNew (name, KEY_VALUE, "100", KEY_END);
+		if (c == 0)
+		{
+			keySetMeta (key, "assign/condition", "(./ == '100') ? ('50') : ('100')");
+		}
+		else
+		{
+			snprintf (condition, sizeof (condition), "((./ > '%d') && (../key0 == '50')) ? (./ < '200') : (@/missing == '%d')", c,
+				  c);
+			keySetMeta (key, "check/condition", condition);
+		}
+		ksAppendKey (ks, key);
+	}
+	return ks;
+}
+
+int main (int argc, char ** argv)
+{
+	int keys = argc > 1 ? atoi (argv[1]) : NUM_KEYS;
+
+	KeySet * modules = ksNew (0, KS_END);
+	elektraModulesInit (modules, 0);
+	Key * errorKey = keyNew ("/", KEY_END);
+	Plugin * plugin = elektraPluginOpen ("conditionals", modules, ksNew (0, KS_END), errorKey);
+	if (plugin == NULL)
+	{
+		printf ("Could not open plugin: conditionals\n");
+		return -1;
+	}
+
+	KeySet * ks = createKeys (keys);
+	Key * parentKey = keyNew (CONDITIONALS_ROOT, KEY_END);
+	int ret = 0;
+
+	timeInit ();
+	for (int i = 0; i < NUM_RUNS; ++i)
+	{
+		// reset the assigned keys
+		for (elektraCursor it = 0; it < ksGetSize (ks); it += NUM_CONDITIONS)
+		{
+			keySetString (ksAtCursor (ks, it), "100");
+		}
+		if (plugin->kdbGet (plugin, ks, parentKey) != 1) ret = -1;
+		timePrint ("evaluate conditions");
+	}
+
+	if (ret != 0) printf ("evaluation failed: %s\n", keyString (keyGetMeta (parentKey, "error/reason")));
+	printf ("%d keys\n", keys);
+
+	keyDel (parentKey);
+	ksDel (ks);
+	elektraPluginClose (plugin, errorKey);
+	elektraModulesClose (modules, 0);
+	ksDel (modules);
+	keyDel (errorKey);
+	return ret;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for the glob plugin
+ *
+ * Applies NUM_GLOBS glob expressions to NUM_DIRS * NUM_KEYS keys with the
+ * get method of the glob plugin. Most expressions match one directory,
+ * some use brackets and some are used without FNM_PATHNAME.
+ *
+ * The number of glob expressions and directories can be passed as arguments.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <stdio.h>
+
+#include <benchmarks.h>
+
+#define NUM_GLOBS 1000
+#define NUM_DIRS 1000
+#define NUM_KEYS 1000
+
+#define GLOB_ROOT KEY_ROOT "/glob"
+
+static KeySet * createConfig (int globs)
+{
+	KeySet * conf = ksNew (globs, KS_END);
+	char name[64];
+	char pattern[128];
+	for (int i = 0; i < globs; ++i)
+	{
+		snprintf (name, sizeof (name), "user:/glob/%06d", i);
+		switch (i % 10)
+		{
+		case 0:
+			snprintf (pattern, sizeof (pattern), GLOB_ROOT "/dir%d/key[0-4]*", i);
+			break;
+		case 1:
+			// without FNM_PATHNAME
+			snprintf (pattern, sizeof (pattern), GLOB_ROOT "/dir%d/*1", i);
+			strcat (name, "/flags");
+			ksAppendKey (conf, keyNew (name, KEY_VALUE, "", KEY_END));
+			name[strlen (name) - sizeof ("/flags") + 1] = '\0';
+			break;
+		default:
+			snprintf (pattern, sizeof (pattern), GLOB_ROOT "/dir%d/*", i);
+			break;
+		}
+		ksAppendKey (conf, keyNew (name, KEY_VALUE, pattern, KEY_META, "glob/benchmark", "", KEY_END));
+	}
+	return conf;
+}
+
+static KeySet * createKeys (int dirs)
+{
+	KeySet * ks = ksNew (dirs * NUM_KEYS, KS_END);
+	char name[128];
+	for (int i = 0; i < dirs; ++i)
+	{
+		for (int j = 0; j < NUM_KEYS; ++j)
+		{
+			snprintf (name, sizeof (name), GLOB_ROOT "/dir%d/key%d", i, j);
+			ksAppendKey (ks, keyNew (name, KEY_END));
+		}
+	}
+	return ks;
+}
+
+int main (int argc, char ** argv)
+{
+	int globs = argc > 1 ? atoi (argv[1]) : NUM_GLOBS;
+	int dirs = argc > 2 ? atoi (argv[2]) : NUM_DIRS;
+
+	KeySet * modules = ksNew (0, KS_END);
+	elektraModulesInit (modules, 0);
+	Key * errorKey = keyNew ("/", KEY_END);
+	Plugin * plugin = elektraPluginOpen ("glob", modules, createConfig (globs), errorKey);
+	if (plugin == NULL)
+	{
+		printf ("Could not open plugin: glob\n");
+		return -1;
+	}
+
+	timeInit ();
+	KeySet * ks = createKeys (dirs);
+	timePrint ("create keys");
+
+	Key * parentKey = keyNew (GLOB_ROOT, KEY_END);
+	plugin->kdbGet (plugin, ks, parentKey);
+	timePrint ("apply globs");
+
+	ssize_t matched = 0;
+	for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+	{
+		if (keyGetMeta (ksAtCursor (ks, it), "glob/benchmark")) ++matched;
+	}
+	printf ("%d globs, %zd keys, %zd matched\n", globs, ksGetSize (ks), matched);
+
+	keyDel (parentKey);
+	ksDel (ks);
+	elektraPluginClose (plugin, errorKey);
+	elektraModulesClose (modules, 0);
+	ksDel (modules);
+	keyDel (errorKey);
+	return 0;
+}
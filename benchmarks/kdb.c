@@ -63,5 +63,27 @@ int main (void)
 		keyDel (parentKey);
 	}
 
+	for (size_t i = 0; i < NUM_RUNS; ++i)
+	{
+		Key * parentKey = keyNew ("user:/benchmark", KEY_END);
+		KDB * handle = kdbOpen (NULL, parentKey);
+
+		// only count the keys, like a tool that prints them
+		ssize_t count = 0;
+		timeInit ();
+		KDBGetStream * stream = kdbGetStreamOpen (handle, parentKey);
+		KeySet * keys;
+		while (kdbGetStreamNext (stream, &keys) == 1)
+		{
+			count += ksGetSize (keys);
+		}
+		kdbGetStreamClose (stream);
+		fprintf (stdout, CSV_STR_FMT, "core", "kdbGetStream", timeGetDiffMicroseconds ());
+		fprintf (stderr, "streamed %zd keys\n", count);
+
+		kdbClose (handle, parentKey);
+		keyDel (parentKey);
+	}
+
 	benchmarkDel ();
 }
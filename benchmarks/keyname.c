@@ -0,0 +1,130 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for key name canonicalization and unescaping
+ *
+ * Sets names from several realistic name corpora the way keySetName() does
+ * and measures the operations per second for each implementation of the key
+ * name scanner. The `scalar` scanner corresponds to the byte-by-byte
+ * implementation.
+ *
+ * The library selects its scanner once when it is loaded, so this benchmark
+ * includes its own copy of keyname.c, where the scanner can be switched.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#define ELEKTRA_KEYNAME_SCANNER_OVERRIDE
+#include <keyname.c>
+
+#include <benchmarks.h>
+
+#define NUM_RUNS 5
+#define NAMES_PER_CORPUS 20000
+
+#define CSV_STR_FMT "%s;%s;%s;%.0f\n"
+
+static const char * scanners[] = { "scalar", "sse2", "avx2" };
+
+typedef struct
+{
+	const char * name;
+	const char * format;
+} Corpus;
+
+// every format gets two numbers
+static const Corpus corpora[] = {
+	{ "app", "user:/sw/org/application/#0/current/section%d/setting%d" },
+	{ "mountpoints", "system:/elektra/mountpoints/user:\\/sw\\/org\\/application%d/config/plugins/#%d/name" },
+	{ "arrays", "user:/sw/org/app/#0/current/servers/#%d/ports/#%d" },
+	{ "dots", "user:/sw/org/app/./current/../current/%%/section%d/very/long/key/name/with/many/parts/setting%d" },
+	{ "escapes", "user:/sw/org/app/with\\\\backslashes\\/and\\/slashes/section%d/value%d" },
+};
+
+static char ** createCorpus (const Corpus * corpus)
+{
+	char ** names = elektraMalloc (NAMES_PER_CORPUS * sizeof (char *));
+	char buffer[1024];
+	for (int i = 0; i < NAMES_PER_CORPUS; ++i)
+	{
+		snprintf (buffer, sizeof (buffer), corpus->format, i / 100, i % 100);
+		names[i] = elektraStrDup (buffer);
+	}
+	return names;
+}
+
+static void deleteCorpus (char ** names)
+{
+	for (int i = 0; i < NAMES_PER_CORPUS; ++i)
+	{
+		elektraFree (names[i]);
+	}
+	elektraFree (names);
+}
+
+static void benchmarkSetName (const char * scanner, const Corpus * corpus, char ** names)
+{
+	char * canonicalName = NULL;
+	size_t canonicalSize = 0;
+	char * unescapedName = elektraMalloc (1024);
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		timeInit ();
+		for (int i = 0; i < NAMES_PER_CORPUS; ++i)
+		{
+			// same steps as keySetName()
+			size_t unescapedSize = 0;
+			elektraKeyNameValidate (names[i], true);
+			elektraKeyNameCanonicalize (names[i], &canonicalName, &canonicalSize, 0, &unescapedSize);
+			elektraKeyNameUnescape (canonicalName, unescapedName);
+		}
+		int diff = timeGetDiffMicroseconds ();
+		fprintf (stdout, CSV_STR_FMT, scanner, corpus->name, "keySetName", NAMES_PER_CORPUS * 1000000.0 / (diff > 0 ? diff : 1));
+	}
+	elektraFree (canonicalName);
+	elektraFree (unescapedName);
+}
+
+static void benchmarkUnescape (const char * scanner, const Corpus * corpus, char ** names)
+{
+	// canonicalize once, then only unescape
+	KeySet * keys = ksNew (NAMES_PER_CORPUS, KS_END);
+	for (int i = 0; i < NAMES_PER_CORPUS; ++i)
+	{
+		ksAppendKey (keys, keyNew (names[i], KEY_END));
+	}
+
+	char * buffer = elektraMalloc (1024);
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		timeInit ();
+		for (elektraCursor it = 0; it < ksGetSize (keys); ++it)
+		{
+			elektraKeyNameUnescape (keyName (ksAtCursor (keys, it)), buffer);
+		}
+		int diff = timeGetDiffMicroseconds ();
+		fprintf (stdout, CSV_STR_FMT, scanner, corpus->name, "unescape", ksGetSize (keys) * 1000000.0 / (diff > 0 ? diff : 1));
+	}
+	elektraFree (buffer);
+	ksDel (keys);
+}
+
+int main (void)
+{
+	fprintf (stdout, "%s;%s;%s;%s\n", "scanner", "corpus", "operation", "ops per second");
+	for (size_t c = 0; c < sizeof (corpora) / sizeof (corpora[0]); ++c)
+	{
+		char ** names = createCorpus (&corpora[c]);
+		for (size_t s = 0; s < sizeof (scanners) / sizeof (scanners[0]); ++s)
+		{
+			if (!useScanner (scanners[s]))
+			{
+				fprintf (stderr, "scanner %s is not supported, skipping\n", scanners[s]);
+				continue;
+			}
+			benchmarkSetName (scanners[s], &corpora[c], names);
+			benchmarkUnescape (scanners[s], &corpora[c], names);
+		}
+		deleteCorpus (names);
+	}
+}
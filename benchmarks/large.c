@@ -1,13 +1,17 @@
 /**
  * @file
  *
- * @brief
+ * @brief Benchmark for a large KeySet, also reports its memory usage
  *
  * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
  */
 
 #include <benchmarks.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 KDB * kdb;
 Key * key;
 
@@ -72,6 +76,24 @@ void benchmarkClose (void)
 	kdbClose (kdb, key);
 }
 
+/**
+ * @return the number of bytes currently allocated on the heap, 0 if unknown
+ */
+static size_t heapUsage (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2 ();
+	return info.uordblks + info.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static void memoryPrint (const char * msg, size_t before, size_t after, ssize_t keys)
+{
+	if (after < before || keys <= 0) return;
+	fprintf (stdout, "%20s: %zu bytes for %zd keys, %zu bytes per key\n", msg, after - before, keys, (after - before) / keys);
+}
 
 int main (void)
 {
@@ -81,8 +103,16 @@ int main (void)
 	benchmarkCreate ();
 	timePrint ("Created empty keyset");
 
+	size_t heapBefore = heapUsage ();
 	benchmarkFillup ();
 	timePrint ("New large keyset");
+	memoryPrint ("Memory large keyset", heapBefore, heapUsage (), ksGetSize (large));
+
+	heapBefore = heapUsage ();
+	KeySet * copy = ksDeepDup (large);
+	timePrint ("Deep duplicated keyset");
+	memoryPrint ("Memory deep dup", heapBefore, heapUsage (), ksGetSize (copy));
+	ksDel (copy);
 
 	benchmarkOpen ();
 	keySetName (key, KEY_ROOT);
@@ -0,0 +1,108 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for merging big KeySets with ksAppend()
+ *
+ * Merges two KeySets, whose Keys are interleaved, disjoint or overlapping,
+ * once with ksAppend() and, for smaller sizes, once by calling
+ * ksAppendKey() for every Key, which was how ksAppend() used to work.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <benchmarks.h>
+
+#define NUM_RUNS 3
+
+/** ksAppendKey() per Key is quadratic, so it is only measured up to this size */
+#define MAX_SIZE_PER_KEY 100000
+
+#define CSV_STR_FMT "%s;%zu;%s;%d\n"
+
+static const size_t sizes[] = { 10000, 100000, 1000000 };
+
+typedef enum
+{
+	INTERLEAVED, ///< every second Key comes from the other KeySet
+	DISJOINT,    ///< all Keys of the second KeySet are behind the first one
+	OVERLAPPING, ///< both KeySets contain the same Keys
+	FEW,	     ///< only a hundred Keys get appended
+} Layout;
+
+static const char * layoutNames[] = { "interleaved", "disjoint", "overlapping", "few" };
+
+static KeySet * createKeySet (size_t size, Layout layout, bool second)
+{
+	if (layout == FEW && second) size = 100;
+
+	KeySet * ks = ksNew (size, KS_END);
+	char name[128];
+	for (size_t i = 0; i < size; ++i)
+	{
+		size_t index;
+		switch (layout)
+		{
+		case INTERLEAVED:
+		case FEW:
+			index = 2 * i + (second ? 1 : 0);
+			break;
+		case DISJOINT:
+			index = i + (second ? size : 0);
+			break;
+		case OVERLAPPING:
+		default:
+			index = i;
+			break;
+		}
+		snprintf (name, sizeof (name), "user:/benchmark/merge/section%zu/key%zu", index / 1000, index % 1000);
+		ksAppendKey (ks, keyNew (name, KEY_VALUE, "value", KEY_END));
+	}
+	return ks;
+}
+
+static void benchmarkMerge (size_t size, Layout layout, bool perKey)
+{
+	KeySet * first = createKeySet (size, layout, false);
+	KeySet * second = createKeySet (size, layout, true);
+
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		KeySet * ks = ksDup (first);
+
+		timeInit ();
+		if (perKey)
+		{
+			for (elektraCursor it = 0; it < ksGetSize (second); ++it)
+			{
+				ksAppendKey (ks, ksAtCursor (second, it));
+			}
+		}
+		else
+		{
+			ksAppend (ks, second);
+		}
+		int diff = timeGetDiffMicroseconds ();
+
+		fprintf (stdout, CSV_STR_FMT, layoutNames[layout], size, perKey ? "ksAppendKey" : "ksAppend", diff);
+		ksDel (ks);
+	}
+
+	ksDel (first);
+	ksDel (second);
+}
+
+int main (void)
+{
+	fprintf (stdout, "%s;%s;%s;%s\n", "layout", "keys", "operation", "microseconds");
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i)
+	{
+		for (Layout layout = INTERLEAVED; layout <= FEW; ++layout)
+		{
+			benchmarkMerge (sizes[i], layout, false);
+			if (sizes[i] <= MAX_SIZE_PER_KEY)
+			{
+				benchmarkMerge (sizes[i], layout, true);
+			}
+		}
+	}
+}
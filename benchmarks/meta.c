@@ -0,0 +1,120 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for reading and writing metadata
+ *
+ * Measures the nanoseconds per call of keyGetMeta() and keySetMeta() for Keys
+ * with a few metadata entries, like Keys with a specification have. The
+ * `keyNew` rows look up metadata with a search Key created by keyNew() and
+ * keyAddName(), which was how keyGetMeta() used to work.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <benchmarks.h>
+
+#define NUM_RUNS 7
+#define NUM_KEYS 1000
+#define NUM_ROUNDS 100
+
+#define CSV_STR_FMT "%s;%s;%.1f\n"
+
+static const char * metaNames[] = { "check/type", "default", "description", "opt", "opt/long", "type" };
+
+static KeySet * createKeySet (void)
+{
+	KeySet * ks = ksNew (NUM_KEYS, KS_END);
+	char name[128];
+	for (int i = 0; i < NUM_KEYS; ++i)
+	{
+		snprintf (name, sizeof (name), "spec:/sw/org/app/#0/current/section%d/key%d", i / 100, i % 100);
+		Key * key = keyNew (name, KEY_END);
+		for (size_t m = 0; m < sizeof (metaNames) / sizeof (metaNames[0]); ++m)
+		{
+			keySetMeta (key, metaNames[m], "value");
+		}
+		ksAppendKey (ks, key);
+	}
+	return ks;
+}
+
+static const Key * keyGetMetaByKeyNew (const Key * key, const char * metaName)
+{
+	Key * search = keyNew ("meta:/", KEY_END);
+	keyAddName (search, metaName);
+	const Key * ret = ksLookup (keyMeta ((Key *) key), search, 0);
+	keyDel (search);
+	return ret;
+}
+
+static void printResult (const char * function, const char * variant, int diff, size_t calls)
+{
+	fprintf (stdout, CSV_STR_FMT, function, variant, diff * 1000.0 / calls);
+}
+
+static void benchmarkGetMeta (KeySet * ks, const char * metaName, const char * variant)
+{
+	size_t found = 0;
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		timeInit ();
+		for (int round = 0; round < NUM_ROUNDS; ++round)
+		{
+			for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+			{
+				found += keyGetMeta (ksAtCursor (ks, it), metaName) != NULL;
+			}
+		}
+		printResult ("keyGetMeta", variant, timeGetDiffMicroseconds (), NUM_ROUNDS * ksGetSize (ks));
+
+		timeInit ();
+		for (int round = 0; round < NUM_ROUNDS; ++round)
+		{
+			for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+			{
+				found += keyGetMetaByKeyNew (ksAtCursor (ks, it), metaName) != NULL;
+			}
+		}
+		printResult ("keyNew", variant, timeGetDiffMicroseconds (), NUM_ROUNDS * ksGetSize (ks));
+	}
+	fprintf (stderr, "found %zu\n", found);
+}
+
+static void benchmarkSetMeta (KeySet * ks)
+{
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		timeInit ();
+		for (int round = 0; round < NUM_ROUNDS; ++round)
+		{
+			for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+			{
+				keySetMeta (ksAtCursor (ks, it), "type", round % 2 ? "long" : "string");
+			}
+		}
+		printResult ("keySetMeta", "replace", timeGetDiffMicroseconds (), NUM_ROUNDS * ksGetSize (ks));
+
+		timeInit ();
+		for (int round = 0; round < NUM_ROUNDS; ++round)
+		{
+			for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+			{
+				keySetMeta (ksAtCursor (ks, it), "missing", NULL);
+			}
+		}
+		printResult ("keySetMeta", "remove missing", timeGetDiffMicroseconds (), NUM_ROUNDS * ksGetSize (ks));
+	}
+}
+
+int main (void)
+{
+	KeySet * ks = createKeySet ();
+
+	fprintf (stdout, "%s;%s;%s\n", "function", "variant", "ns per call");
+	benchmarkGetMeta (ks, "type", "found");
+	benchmarkGetMeta (ks, "meta:/opt/long", "found prefixed");
+	benchmarkGetMeta (ks, "missing", "missing");
+	benchmarkSetMeta (ks);
+
+	ksDel (ks);
+}
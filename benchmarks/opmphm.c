@@ -33,6 +33,7 @@
 #include "../src/libs/elektra/opmphmpredictor.c"
 #include "../src/libs/elektra/rand.c"
 #include <sys/time.h>
+#include <unistd.h>
 
 int32_t elektraRandBenchmarkInitSeed;
 
@@ -1532,6 +1533,218 @@ static void benchmarkBinarySearchTime (char * name)
  * END =================================================== Binary search Time ========================================================== END
  */
 
+/**
+ * START ============================================== Load and Lookup Time ======================================================= START
+ *
+ * This benchmark measures the time the quickdump plugin needs to load a KeySet and the time of the first lookups afterwards.
+ * Every KeySet is stored once without and once with the OPMPHM (`/opmphm`) in the quickdump file.
+ * With the stored OPMPHM the first lookups do not need to build the OPMPHM or fall back to the binary search.
+ * Uses all KeySet shapes except 6, for one n (KeySet size) one KeySet is used.
+ * The keyset shape 6 is excluded, because previous evaluation had show that the results with that keyset shape
+ * where unusable, due to the unnatural long key names.
+ * Each measurement is repeated numberOfRepeats time and summarized with the median.
+ * The results are written out in the following format:
+ *
+ * n;load_binary;search_binary;load_opmphm;search_opmphm
+ *
+ * The number of needed seeds for this benchmarks is: (numberOfShapes - 1) * nCount * 2
+ */
+
+static Plugin * benchmarkLoadLookupOpenQuickdump (KeySet * modules, bool storeOpmphm)
+{
+	KeySet * conf = storeOpmphm ? ksNew (1, keyNew ("user:/opmphm", KEY_END), KS_END) : ksNew (0, KS_END);
+	Key * errorKey = keyNew ("/", KEY_END);
+	Plugin * plugin = elektraPluginOpen ("quickdump", modules, conf, errorKey);
+	keyDel (errorKey);
+	if (!plugin)
+	{
+		printExit ("open quickdump");
+	}
+	return plugin;
+}
+
+/**
+ * @brief Measures loading the file of parentKey and the first searches lookups in the loaded KeySet.
+ *
+ * @param ks the KeySet that was stored in the file, used for the lookups
+ * @param loadTime set to the median time of the load
+ * @param searchTime set to the median time of the lookups
+ */
+static void benchmarkLoadLookupTimeMeasure (Plugin * plugin, Key * parentKey, KeySet * ks, size_t searches, int32_t searchSeed,
+					    size_t * loadRepeats, size_t * searchRepeats, size_t numberOfRepeats, size_t * loadTime,
+					    size_t * searchTime)
+{
+	for (size_t repeatsI = 0; repeatsI < numberOfRepeats; ++repeatsI)
+	{
+		KeySet * returned = ksNew (0, KS_END);
+		struct timeval start;
+		struct timeval loaded;
+		struct timeval end;
+		int32_t actualSearchSeed = searchSeed;
+
+		// START MEASUREMENT
+		__asm__("");
+		gettimeofday (&start, 0);
+		__asm__("");
+
+		if (plugin->kdbGet (plugin, returned, parentKey) != ELEKTRA_PLUGIN_STATUS_SUCCESS)
+		{
+			printExit ("kdbGet");
+		}
+
+		__asm__("");
+		gettimeofday (&loaded, 0);
+		__asm__("");
+
+		for (size_t s = 1; s <= searches; ++s)
+		{
+			Key * search = ks->array[actualSearchSeed % ks->size];
+			Key * keyFound = ksLookup (returned, search, KDB_O_NOCASCADING);
+			if (!keyFound || strcmp (keyName (keyFound), keyName (search)))
+			{
+				printExit ("Sanity Check Failed: found wrong Key");
+			}
+			elektraRand (&actualSearchSeed);
+		}
+
+		__asm__("");
+		gettimeofday (&end, 0);
+		__asm__("");
+		// END MEASUREMENT
+
+		ksDel (returned);
+
+		loadRepeats[repeatsI] = (loaded.tv_sec - start.tv_sec) * 1000000 + (loaded.tv_usec - start.tv_usec);
+		searchRepeats[repeatsI] = (end.tv_sec - loaded.tv_sec) * 1000000 + (end.tv_usec - loaded.tv_usec);
+	}
+	// sort repeats and take median
+	qsort (loadRepeats, numberOfRepeats, sizeof (size_t), cmpInteger);
+	qsort (searchRepeats, numberOfRepeats, sizeof (size_t), cmpInteger);
+	*loadTime = loadRepeats[numberOfRepeats / 2];
+	*searchTime = searchRepeats[numberOfRepeats / 2];
+}
+
+static void benchmarkLoadLookupTime (char * name)
+{
+	const size_t startN = 1000;
+	const size_t stepN = 2000;
+	const size_t endN = 19000;
+	const size_t numberOfRepeats = 7;
+	const size_t searches = 1000;
+
+	// check config
+	if (startN >= endN || startN == 0)
+	{
+		printExit ("startN >= endN || startN == 0");
+	}
+	if (numberOfRepeats % 2 == 0)
+	{
+		printExit ("numberOfRepeats is even");
+	}
+
+	size_t * loadRepeats = elektraMalloc (numberOfRepeats * sizeof (size_t));
+	size_t * searchRepeats = elektraMalloc (numberOfRepeats * sizeof (size_t));
+	if (!loadRepeats || !searchRepeats)
+	{
+		printExit ("malloc");
+	}
+
+	char fileName[] = "/tmp/benchmark_opmphm_XXXXXX";
+	int fd = mkstemp (fileName);
+	if (fd == -1)
+	{
+		printExit ("mkstemp");
+	}
+	close (fd);
+
+	KeySet * modules = ksNew (0, KS_END);
+	elektraModulesInit (modules, 0);
+	Plugin * plugins[2] = { benchmarkLoadLookupOpenQuickdump (modules, false), benchmarkLoadLookupOpenQuickdump (modules, true) };
+	Key * parentKey = keyNew ("user:/benchmark", KEY_VALUE, fileName, KEY_END);
+
+	// get KeySet shapes
+	KeySetShape * keySetShapes = getKeySetShapes ();
+
+	printf ("Run Benchmark %s:\n", name);
+
+	// for all KeySet shapes except 6
+	for (size_t shapeI = 0; shapeI < numberOfShapes; ++shapeI)
+	{
+		if (shapeI == 6)
+		{
+			continue;
+		}
+		KeySetShape * usedKeySetShape = &keySetShapes[shapeI];
+
+		FILE * out = openOutFileWithRPartitePostfix ("benchmark_opmphm_load_lookup_time", shapeI);
+		if (!out)
+		{
+			printExit ("open out file");
+		}
+		fprintf (out, "n;load_binary;search_binary;load_opmphm;search_opmphm\n");
+
+		// for all Ns
+		for (size_t nI = startN; nI <= endN; nI += stepN)
+		{
+			printf ("now at: shape = %zu/%zu n = %zu/%zu\r", shapeI + 1, numberOfShapes, nI, endN);
+			fflush (stdout);
+
+			int32_t genSeed;
+			if (getRandomSeed (&genSeed) != &genSeed) printExit ("Seed Parsing Error or feed me more seeds");
+			int32_t searchSeed;
+			if (getRandomSeed (&searchSeed) != &searchSeed) printExit ("Seed Parsing Error or feed me more seeds");
+
+			// move the generated cascading Keys below the parent Key, only then the OPMPHM is stored
+			KeySet * generated = generateKeySet (nI, &genSeed, usedKeySetShape);
+			KeySet * ks = ksNew (nI, KS_END);
+			for (elektraCursor it = 0; it < ksGetSize (generated); ++it)
+			{
+				char * fullName = elektraFormat ("%s%s", keyName (parentKey), keyName (ksAtCursor (generated, it)));
+				ksAppendKey (ks, keyNew (fullName, KEY_END));
+				elektraFree (fullName);
+			}
+			ksDel (generated);
+
+			// set seed to return by elektraRandGetInitSeed () in the OPMPHM builds
+			elektraRandBenchmarkInitSeed = searchSeed;
+
+			fprintf (out, "%zu", nI);
+			for (size_t pluginI = 0; pluginI < 2; ++pluginI)
+			{
+				if (plugins[pluginI]->kdbSet (plugins[pluginI], ks, parentKey) != ELEKTRA_PLUGIN_STATUS_SUCCESS)
+				{
+					printExit ("kdbSet");
+				}
+				size_t loadTime;
+				size_t searchTime;
+				benchmarkLoadLookupTimeMeasure (plugins[pluginI], parentKey, ks, searches, searchSeed, loadRepeats, searchRepeats,
+								numberOfRepeats, &loadTime, &searchTime);
+				fprintf (out, ";%zu;%zu", loadTime, searchTime);
+			}
+			fprintf (out, "\n");
+
+			ksDel (ks);
+		}
+
+		fclose (out);
+	}
+	printf ("\n");
+
+	remove (fileName);
+	keyDel (parentKey);
+	elektraPluginClose (plugins[0], 0);
+	elektraPluginClose (plugins[1], 0);
+	elektraModulesClose (modules, 0);
+	ksDel (modules);
+	elektraFree (keySetShapes);
+	elektraFree (searchRepeats);
+	elektraFree (loadRepeats);
+}
+
+/**
+ * END ================================================= Load and Lookup Time ======================================================== END
+ */
+
 /**
  * START ================================================= hsearch Build Time ======================================================== START
  *
@@ -2114,7 +2327,7 @@ static void benchmarkPrintAllKeySetShapes (char * name)
 int main (int argc, char ** argv)
 {
 	// define all benchmarks
-	size_t benchmarksCount = 9;
+	size_t benchmarksCount = 10;
 #ifdef HAVE_HSEARCHR
 	// hsearchbuildtime
 	++benchmarksCount;
@@ -2170,6 +2383,11 @@ int main (int argc, char ** argv)
 	benchmarks[8].name = benchmarkNamePredictionTime;
 	benchmarks[8].benchmarkF = benchmarkPredictionTime;
 	benchmarks[8].numberOfSeedsNeeded = 3496500;
+	// loadlookuptime
+	char * benchmarkNameLoadLookupTime = "loadlookuptime";
+	benchmarks[9].name = benchmarkNameLoadLookupTime;
+	benchmarks[9].benchmarkF = benchmarkLoadLookupTime;
+	benchmarks[9].numberOfSeedsNeeded = 140;
 #ifdef HAVE_HSEARCHR
 	// hsearchbuildtime
 	char * benchmarkNameHsearchBuildTime = "hsearchbuildtime";
@@ -0,0 +1,112 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for the transports of the pluginprocess library
+ *
+ * Measures the round-trip time of a kdbSet call to a plugin in a child process,
+ * which returns the KeySet unchanged. The `pipe` transport serializes the KeySet
+ * with the dump plugin, the `shm` transport shares it in memory using the
+ * mmapstorage plugin.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <benchmarks.h>
+
+#include <kdbpluginprocess.h>
+
+#define NUM_RUNS 7
+
+#define CSV_STR_FMT "%s;%zd;%d\n"
+
+static const ssize_t sizes[] = { 1000, 100000 };
+
+static pluginprocess_transport_t transport;
+
+static int echoClose (Plugin * handle, Key * errorKey)
+{
+	ElektraPluginProcess * pp = elektraPluginGetData (handle);
+	if (pp && elektraPluginProcessIsParent (pp))
+	{
+		ElektraPluginProcessCloseResult result = elektraPluginProcessClose (pp, errorKey);
+		if (result.cleanedUp) elektraPluginSetData (handle, NULL);
+		return result.result;
+	}
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+static int echoSet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	ElektraPluginProcess * pp = elektraPluginGetData (handle);
+	if (elektraPluginProcessIsParent (pp)) return elektraPluginProcessSend (pp, ELEKTRA_PLUGINPROCESS_SET, returned, parentKey);
+
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+static int echoOpen (Plugin * handle, Key * errorKey)
+{
+	ElektraPluginProcess * pp = elektraPluginGetData (handle);
+	if (pp == NULL)
+	{
+		if ((pp = elektraPluginProcessInitTransport (errorKey, transport)) == NULL) return ELEKTRA_PLUGIN_STATUS_ERROR;
+		elektraPluginSetData (handle, pp);
+		if (!elektraPluginProcessIsParent (pp)) elektraPluginProcessStart (handle, pp);
+	}
+	if (elektraPluginProcessIsParent (pp)) return elektraPluginProcessOpen (pp, errorKey);
+
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+static KeySet * createKeySet (ssize_t size)
+{
+	KeySet * ks = ksNew (size, KS_END);
+	char name[128];
+	for (ssize_t i = 0; i < size; ++i)
+	{
+		snprintf (name, sizeof (name), "user:/benchmark/section%zd/key%zd", i / 100, i % 100);
+		ksAppendKey (ks, keyNew (name, KEY_VALUE, "value", KEY_META, "type", "string", KEY_END));
+	}
+	return ks;
+}
+
+static void benchmarkTransport (const char * name, ssize_t size)
+{
+	Plugin plugin = { .kdbOpen = echoOpen, .kdbClose = echoClose, .kdbSet = echoSet, .name = "echo", .refcounter = 1 };
+	Key * parentKey = keyNew ("user:/benchmark", KEY_END);
+
+	// the child process must not inherit buffered output
+	fflush (stdout);
+	if (plugin.kdbOpen (&plugin, parentKey) != ELEKTRA_PLUGIN_STATUS_SUCCESS)
+	{
+		fprintf (stderr, "could not start the plugin process\n");
+		keyDel (parentKey);
+		return;
+	}
+
+	KeySet * ks = createKeySet (size);
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		timeInit ();
+		if (plugin.kdbSet (&plugin, ks, parentKey) != ELEKTRA_PLUGIN_STATUS_SUCCESS || ksGetSize (ks) != size)
+		{
+			fprintf (stderr, "round trip failed\n");
+		}
+		fprintf (stdout, CSV_STR_FMT, name, size, timeGetDiffMicroseconds ());
+	}
+	ksDel (ks);
+
+	plugin.kdbClose (&plugin, parentKey);
+	keyDel (parentKey);
+}
+
+int main (void)
+{
+	fprintf (stdout, "%s;%s;%s\n", "transport", "keys", "microseconds");
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i)
+	{
+		transport = ELEKTRA_PLUGINPROCESS_TRANSPORT_PIPE;
+		benchmarkTransport ("pipe", sizes[i]);
+		transport = ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM;
+		benchmarkTransport ("shm", sizes[i]);
+	}
+}
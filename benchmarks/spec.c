@@ -0,0 +1,102 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for the spec plugin
+ *
+ * Calls the spec/copy hook of the spec plugin with NUM_SPECS spec keys and
+ * NUM_KEYS keys. Most spec keys match one key directly, some use wildcard
+ * (`_`) parts, some define arrays and some are missing and have defaults.
+ *
+ * The number of spec keys and keys can be passed as arguments.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <stdio.h>
+
+#include <benchmarks.h>
+
+#define NUM_SPECS 10000
+#define NUM_KEYS 100000
+#define KEYS_PER_DIR 100
+
+#define SPEC_ROOT "/benchmark/spec"
+
+typedef int (*SpecCopyFunction) (Plugin * handle, KeySet * returned, Key * parentKey, bool isKdbGet);
+
+static KeySet * createKeys (int specs, int keys)
+{
+	KeySet * ks = ksNew (specs + keys, KS_END);
+	char name[128];
+	int dirs = keys / KEYS_PER_DIR;
+	for (int i = 0; i < specs; ++i)
+	{
+		int dir = i % (dirs > 0 ? dirs : 1);
+		Key * spec;
+		switch (i % 10)
+		{
+		case 0:
+			snprintf (name, sizeof (name), "spec:" SPEC_ROOT "/dir%d/_", dir);
+			spec = keyNew (name, KEY_META, "type", "string", KEY_END);
+			break;
+		case 1:
+			snprintf (name, sizeof (name), "spec:" SPEC_ROOT "/array%d/#/value", i);
+			spec = keyNew (name, KEY_META, "type", "long", KEY_END);
+			ksAppendKey (ks, spec);
+			snprintf (name, sizeof (name), "spec:" SPEC_ROOT "/array%d", i);
+			spec = keyNew (name, KEY_META, "array", "#9", KEY_END);
+			break;
+		case 2:
+			snprintf (name, sizeof (name), "spec:" SPEC_ROOT "/missing%d", i);
+			spec = keyNew (name, KEY_META, "default", "1", KEY_END);
+			break;
+		default:
+			snprintf (name, sizeof (name), "spec:" SPEC_ROOT "/dir%d/key%d", dir, i / (dirs > 0 ? dirs : 1));
+			spec = keyNew (name, KEY_META, "description", "a key", KEY_END);
+			break;
+		}
+		ksAppendKey (ks, spec);
+	}
+
+	for (int i = 0; i < keys; ++i)
+	{
+		snprintf (name, sizeof (name), "user:" SPEC_ROOT "/dir%d/key%d", i / KEYS_PER_DIR, i % KEYS_PER_DIR);
+		ksAppendKey (ks, keyNew (name, KEY_VALUE, "value", KEY_END));
+	}
+	return ks;
+}
+
+int main (int argc, char ** argv)
+{
+	int specs = argc > 1 ? atoi (argv[1]) : NUM_SPECS;
+	int keys = argc > 2 ? atoi (argv[2]) : NUM_KEYS;
+
+	KeySet * modules = ksNew (0, KS_END);
+	elektraModulesInit (modules, 0);
+	Key * errorKey = keyNew ("/", KEY_END);
+	Plugin * plugin = elektraPluginOpen ("spec", modules, ksNew (0, KS_END), errorKey);
+	if (plugin == NULL)
+	{
+		printf ("Could not open plugin: spec\n");
+		return -1;
+	}
+	SpecCopyFunction specCopy = (SpecCopyFunction) elektraPluginGetFunction (plugin, "hook/spec/copy");
+
+	timeInit ();
+	KeySet * ks = createKeys (specs, keys);
+	timePrint ("create keys");
+
+	Key * parentKey = keyNew (SPEC_ROOT, KEY_END);
+	int ret = specCopy (plugin, ks, parentKey, true);
+	timePrint ("spec copy");
+
+	printf ("%d spec keys, %d keys, %zd keys after spec copy, result %d\n", specs, keys, ksGetSize (ks), ret);
+
+	keyDel (parentKey);
+	ksDel (ks);
+	elektraPluginClose (plugin, errorKey);
+	elektraModulesClose (modules, 0);
+	ksDel (modules);
+	keyDel (errorKey);
+	return 0;
+}
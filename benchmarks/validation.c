@@ -0,0 +1,102 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for the validation plugin
+ *
+ * Validates NUM_KEYS keys that share NUM_PATTERNS patterns, once without
+ * the pattern cache (via the exported validateKey) and several times with
+ * the kdbSet of an opened plugin, where the first run fills the cache.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <stdio.h>
+
+#include <benchmarks.h>
+
+#define NUM_KEYS 100000
+#define NUM_PATTERNS 50
+#define NUM_RUNS 3
+
+typedef int (*ValidateKeyFunction) (Key * key, Key * parentKey);
+
+static KeySet * createKeys (void)
+{
+	KeySet * ks = ksNew (NUM_KEYS, KS_END);
+	char name[64];
+	char value[64];
+	char pattern[64];
+	for (int i = 0; i < NUM_KEYS; ++i)
+	{
+		int p = i % NUM_PATTERNS;
+		snprintf (name, sizeof (name), KEY_ROOT "/validation/key%d", i);
+		snprintf (value, sizeof (value), "value%d-%d", p, i);
+		Key * key = keyNew (name, KEY_VALUE, value, KEY_END);
+
+		switch (p % 3)
+		{
+		case 0:
+			// plain string, matched anywhere
+			snprintf (pattern, sizeof (pattern), "value%d-", p);
+			keySetMeta (key, "check/validation", pattern);
+			break;
+		case 1:
+			snprintf (pattern, sizeof (pattern), "value%d-[0-9]+", p);
+			keySetMeta (key, "check/validation", pattern);
+			keySetMeta (key, "check/validation/match", "LINE");
+			break;
+		default:
+			snprintf (pattern, sizeof (pattern), "^(value|VALUE)%d-[0-9]*$", p);
+			keySetMeta (key, "check/validation", pattern);
+			keySetMeta (key, "check/validation/ignorecase", "");
+			break;
+		}
+		ksAppendKey (ks, key);
+	}
+	return ks;
+}
+
+int main (void)
+{
+	KeySet * modules = ksNew (0, KS_END);
+	elektraModulesInit (modules, 0);
+	Key * errorKey = keyNew ("/", KEY_END);
+	Plugin * plugin = elektraPluginOpen ("validation", modules, ksNew (0, KS_END), errorKey);
+	if (plugin == NULL)
+	{
+		printf ("Could not open plugin: validation\n");
+		return -1;
+	}
+	ValidateKeyFunction validateKey = (ValidateKeyFunction) elektraPluginGetFunction (plugin, "validateKey");
+
+	KeySet * ks = createKeys ();
+	Key * parentKey = keyNew (KEY_ROOT "/validation", KEY_END);
+	int ret = 0;
+
+	if (validateKey)
+	{
+		timeInit ();
+		for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+		{
+			if (!validateKey (ksAtCursor (ks, it), parentKey)) ret = -1;
+		}
+		timePrint ("uncached");
+	}
+
+	timeInit ();
+	for (int i = 0; i < NUM_RUNS; ++i)
+	{
+		if (plugin->kdbSet (plugin, ks, parentKey) != 1) ret = -1;
+		timePrint (i == 0 ? "cold cache" : "warm cache");
+	}
+
+	if (ret != 0) printf ("validation failed: %s\n", keyString (keyGetMeta (parentKey, "error/reason")));
+
+	keyDel (parentKey);
+	ksDel (ks);
+	elektraPluginClose (plugin, errorKey);
+	elektraModulesClose (modules, 0);
+	ksDel (modules);
+	keyDel (errorKey);
+	return ret;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * @brief Benchmark for lookups in a KeySet shared between threads
+ *
+ * Compares three ways to read a shared configuration from many threads:
+ *
+ * - dup: every request ksDup()s the configuration (under a lock, because
+ *   ksDup() and ksDel() change reference counters) and looks up in its copy
+ * - mutex: all threads look up in the same KeySet, every ksLookup() is locked
+ * - frozen: all threads look up in the same ksFreeze() snapshot without locks
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#include <kdbprivate.h>
+
+#include <kdbtimer.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace ckdb;
+
+const long long keys = 10000LL;
+const long long requests = 1000LL;	     // per thread
+const long long lookupsPerRequest = 100LL; // lookups done by each request
+
+const int benchmarkIterations = 11; // is a good number to not need mean values for median
+
+const int threadCounts[] = { 1, 2, 4, 8 };
+
+const std::string filename = "check.txt";
+std::ofstream dump (filename);
+
+std::mutex mutex;
+
+KeySet * createConfig ()
+{
+	KeySet * ks = ksNew (keys, KS_END);
+	for (long long i = 0; i < keys; ++i)
+	{
+		std::ostringstream os;
+		os << "user:/benchmark/freeze/section" << i / 100 << "/key" << i % 100;
+		ksAppendKey (ks, keyNew (os.str ().c_str (), KEY_VALUE, "value", KEY_META, "type", "string", KEY_END));
+	}
+	return ks;
+}
+
+std::vector<std::string> createNames (int thread)
+{
+	std::vector<std::string> names;
+	for (long long i = 0; i < lookupsPerRequest; ++i)
+	{
+		std::ostringstream os;
+		long long k = (i * 7919 + thread * 104729) % keys;
+		os << "user:/benchmark/freeze/section" << k / 100 << "/key" << k % 100;
+		names.push_back (os.str ());
+	}
+	return names;
+}
+
+__attribute__ ((noinline)) long long lookupDup (KeySet * ks, std::vector<std::string> const & names)
+{
+	long long found = 0;
+	for (long long r = 0; r < requests; ++r)
+	{
+		KeySet * copy;
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			copy = ksDup (ks);
+		}
+		for (auto const & name : names)
+		{
+			found += ksLookupByName (copy, name.c_str (), 0) != nullptr;
+		}
+		std::lock_guard<std::mutex> lock (mutex);
+		ksDel (copy);
+	}
+	return found;
+}
+
+__attribute__ ((noinline)) long long lookupMutex (KeySet * ks, std::vector<std::string> const & names)
+{
+	long long found = 0;
+	for (long long r = 0; r < requests; ++r)
+	{
+		for (auto const & name : names)
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			found += ksLookupByName (ks, name.c_str (), 0) != nullptr;
+		}
+	}
+	return found;
+}
+
+__attribute__ ((noinline)) long long lookupFrozen (KeySet * ks, std::vector<std::string> const & names)
+{
+	long long found = 0;
+	for (long long r = 0; r < requests; ++r)
+	{
+		for (auto const & name : names)
+		{
+			found += ksLookupByName (ks, name.c_str (), 0) != nullptr;
+		}
+	}
+	return found;
+}
+
+typedef long long (*lookup_t) (KeySet * ks, std::vector<std::string> const & names);
+
+void benchmark_threads (Timer & t, lookup_t lookup, KeySet * ks, int threadCount)
+{
+	std::vector<std::vector<std::string>> names;
+	for (int i = 0; i < threadCount; ++i)
+	{
+		names.push_back (createNames (i));
+	}
+
+	std::atomic<long long> found (0);
+	std::vector<std::thread> threads;
+
+	t.start ();
+	for (int i = 0; i < threadCount; ++i)
+	{
+		threads.push_back (std::thread ([&, i] { found += lookup (ks, names[i]); }));
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	t.stop ();
+
+	std::cout << t;
+	dump << t.name << found << std::endl;
+}
+
+int main (int argc, char ** argv)
+{
+	int iterations = benchmarkIterations;
+	if (argc > 1)
+	{
+		iterations = atoi (argv[1]);
+	}
+
+	KeySet * config = createConfig ();
+	KeySet * frozen = ksFreeze (config);
+
+	std::vector<std::unique_ptr<Timer>> timers;
+	for (int threadCount : threadCounts)
+	{
+		std::ostringstream os;
+		os << threadCount;
+		auto tDup = std::unique_ptr<Timer> (new Timer ("dup " + os.str () + " threads", Timer::median_cerr));
+		auto tMutex = std::unique_ptr<Timer> (new Timer ("mutex " + os.str () + " threads", Timer::median_cerr));
+		auto tFrozen = std::unique_ptr<Timer> (new Timer ("frozen " + os.str () + " threads", Timer::median_cerr));
+
+		for (int i = 0; i < iterations; ++i)
+		{
+			std::cout << i << std::endl;
+			benchmark_threads (*tDup, lookupDup, config, threadCount);
+			benchmark_threads (*tMutex, lookupMutex, config, threadCount);
+			benchmark_threads (*tFrozen, lookupFrozen, frozen, threadCount);
+		}
+
+		timers.push_back (std::move (tDup));
+		timers.push_back (std::move (tMutex));
+		timers.push_back (std::move (tFrozen));
+	}
+
+	ksDel (frozen);
+	ksDel (config);
+
+	// the timers print their medians when they are destroyed
+	std::cerr << "benchmark,median" << std::endl;
+}
@@ -3,6 +3,10 @@
  *
  * @brief benchmark for getenv
  *
+ * The threaded benchmarks measure the throughput of getenv() calls from
+ * several threads at once: `elektra getenv` uses the lock-free snapshot,
+ * `mutex getenv` serializes all calls like getenv() did before.
+ *
  * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
  *
  */
@@ -12,7 +16,12 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include <dlfcn.h>
 #include <string.h>
@@ -25,11 +34,13 @@ const long long nr_keys = 30;
 long long iterations = 1000000LL; // elitebenchmark
 // long long iterations = 100LL; // valgrind
 
-// not needed in benchmarks:
+// per thread in the threaded benchmarks:
 long long iterations1 = iterations / 100;
 
 const int benchmarkIterations = 11; // is a good number to not need mean values for median
 
+const int threadCounts[] = { 1, 2, 4, 8 };
+
 const std::string filename = "check.txt";
 
 const std::string csvfilename = "data.csv";
@@ -176,6 +187,45 @@ __attribute__ ((noinline)) void benchmark_kslookup ()
 	std::cout << t;
 }
 
+std::mutex getenvMutex;
+
+__attribute__ ((noinline)) void getenv_loop (bool lock)
+{
+	for (long long i = 0; i < iterations1; ++i)
+	{
+		if (lock)
+		{
+			std::lock_guard<std::mutex> guard (getenvMutex);
+			getenv ("HELLO");
+		}
+		else
+		{
+			getenv ("HELLO");
+		}
+		__asm__("");
+	}
+}
+
+__attribute__ ((noinline)) void benchmark_getenv_threads (Timer & t, int threadCount, bool lock)
+{
+	std::vector<std::thread> threads;
+
+	t.start ();
+	for (int i = 0; i < threadCount; ++i)
+	{
+		threads.push_back (std::thread (getenv_loop, lock));
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	t.stop ();
+	std::cout << t;
+	std::cout << t.name << ": " << threadCount * iterations1 * Timer::usec_factor / std::max (t.results.back (), 1LL)
+		  << " calls per second" << std::endl;
+	dump << t.name << std::endl;
+}
+
 void computer_info ()
 {
 	std::cout << std::endl;
@@ -220,6 +270,15 @@ int main (int argc, char ** argv)
 		iterations1 = iterations / 100;
 	}
 
+	std::vector<std::unique_ptr<Timer>> threadTimers;
+	for (int threadCount : threadCounts)
+	{
+		std::ostringstream os;
+		os << threadCount;
+		threadTimers.push_back (std::unique_ptr<Timer> (new Timer ("elektra getenv " + os.str () + " threads", Timer::median_cerr)));
+		threadTimers.push_back (std::unique_ptr<Timer> (new Timer ("mutex getenv " + os.str () + " threads", Timer::median_cerr)));
+	}
+
 	for (int i = 0; i < benchmarkIterations; ++i)
 	{
 		std::cout << i << std::endl;
@@ -231,6 +290,12 @@ int main (int argc, char ** argv)
 
 		benchmark_kslookup ();
 
+		for (size_t j = 0; j < sizeof (threadCounts) / sizeof (threadCounts[0]); ++j)
+		{
+			benchmark_getenv_threads (*threadTimers[2 * j], threadCounts[j], false);
+			benchmark_getenv_threads (*threadTimers[2 * j + 1], threadCounts[j], true);
+		}
+
 		// benchmark_hashmap();
 		// benchmark_hashmap_find();
 	}
@@ -51,6 +51,10 @@ void elektraLockMutex ();
 /**
  * @brief Unlock the internally used mutex
  *
+ * Changes of elektraConfig become visible to getenv() when the
+ * outermost lock is released. If nothing changed, getenv() continues
+ * to use the previous snapshot.
+ *
  * @see elektraLockMutex()
  */
 void elektraUnlockMutex ();
@@ -22,6 +22,7 @@
 
 #include <kdbcontext.hpp>
 
+#include <kdbfreeze.h>
 #include <kdbhelper.h>
 
 #include <dlfcn.h>
@@ -39,10 +40,16 @@
 #include <sys/auxv.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 /* BSDI has this functionality, but its not defined */
 #if !defined(RTLD_NEXT)
@@ -55,6 +62,9 @@ using namespace ckdb;
 #define LOG                                                                                                                                \
 	if (elektraLog) (*elektraLog)
 
+#define LOG_TO(log)                                                                                                                        \
+	if (log) (*log)
+
 #define ELEKTRA_GETENV_USE_LOCKS 1
 
 #if ELEKTRA_GETENV_USE_LOCKS
@@ -72,7 +82,6 @@ extern "C" {
 Key * elektraParentKey;
 KeySet * elektraConfig;
 KDB * elektraRepo;
-
 } // extern "C"
 
 namespace
@@ -139,10 +148,10 @@ union Fork
 	ffcn f;
 } ffork; // symbols for libc fork
 
-std::chrono::milliseconds elektraReloadTimeout;
-std::chrono::system_clock::time_point elektraReloadNext;
+std::atomic<std::chrono::milliseconds::rep> elektraReloadTimeout;
+std::atomic<std::chrono::system_clock::rep> elektraReloadNext;
 std::shared_ptr<ostream> elektraLog;
-bool elektraInGetEnv;
+thread_local bool elektraInGetEnv;
 KeySet * elektraDocu = ksNew (20,
 #include "readme_elektrify-getenv.c"
 			      KS_END);
@@ -154,25 +163,160 @@ int to_ (int c)
 }
 
 pthread_mutex_t elektraGetEnvMutex = ELEKTRA_MUTEX_INIT;
+int elektraLockDepth; // how often the current owner locked elektraGetEnvMutex
+
+typedef std::vector<std::pair<std::string, const Key *>> SnapshotEntries;
+
+/**
+ * @brief Immutable view of the configuration used by getenv()
+ *
+ * A new snapshot is published when the mutex gets unlocked after the
+ * configuration changed, so getenv() itself never needs to lock. The entries
+ * contain the result of elektraLookupWithContext() for every name below
+ * override/ and fallback/, which spares the key name canonicalization for the
+ * common variable names.
+ */
+struct Snapshot
+{
+	KeySet * config = nullptr; // frozen copy of elektraConfig, see ksFreeze()
+	GetEnvContext context;
+	std::shared_ptr<ostream> log;
+	SnapshotEntries overrides; // sorted by name
+	SnapshotEntries fallbacks; // sorted by name
+	std::unordered_map<const Key *, const char *> values; // interned values of config, see elektraValues
+
+	const char * value (const Key * key) const
+	{
+		auto it = values.find (key);
+		return it != values.end () ? it->second : nullptr;
+	}
+
+	~Snapshot ()
+	{
+		ksDel (config);
+	}
+};
+
+std::atomic<Snapshot *> elektraSnapshot;
+bool elektraSnapshotOutdated; // layers or options changed since the last publish
+// values returned by getenv() must outlive the snapshots, so they are kept until elektraClose()
+std::unordered_set<std::string> elektraValues;
+thread_local const Snapshot * elektraLookupSnapshot; // used by elektraContextEvaluation()
+
+/**
+ * Readers announce themselves in the counters of the current epoch, spread
+ * over several cache lines so that concurrent getenv() calls do not write
+ * to the same memory.
+ */
+const int elektraReaderShards = 64;
+
+struct alignas (64) ReaderShard
+{
+	std::atomic<long> readers[2];
+};
+
+ReaderShard elektraReaders[elektraReaderShards];
+std::atomic<unsigned> elektraReaderEpoch;
+std::atomic<unsigned> elektraNextShard;
+thread_local int elektraShard = -1;
+
+class ReadSection
+{
+public:
+	ReadSection ()
+	{
+		if (elektraShard < 0) elektraShard = elektraNextShard++ % elektraReaderShards;
+		m_counter = &elektraReaders[elektraShard].readers[elektraReaderEpoch.load () & 1];
+		m_counter->fetch_add (1);
+		m_snapshot = elektraSnapshot.load ();
+	}
+	~ReadSection ()
+	{
+		m_counter->fetch_sub (1);
+	}
+	const Snapshot * snapshot () const
+	{
+		return m_snapshot;
+	}
+
+private:
+	std::atomic<long> * m_counter;
+	const Snapshot * m_snapshot;
+};
+
+/**
+ * @brief Waits until no reader can use a snapshot replaced before
+ *
+ * Both epochs need to be drained: a reader might have read the epoch just
+ * before it changed and incremented the counter afterwards.
+ */
+void waitForReaders ()
+{
+	for (int i = 0; i < 2; ++i)
+	{
+		unsigned const epoch = elektraReaderEpoch.fetch_add (1) & 1;
+		for (auto & shard : elektraReaders)
+		{
+			while (shard.readers[epoch].load () > 0)
+			{
+				std::this_thread::yield ();
+			}
+		}
+	}
+}
+
+void resetReaders ()
+{
+	for (auto & shard : elektraReaders)
+	{
+		shard.readers[0] = 0;
+		shard.readers[1] = 0;
+	}
+}
 
 
 } // anonymous namespace
 
+void elektraPublishSnapshot ();
+bool elektraSnapshotChanged ();
 
 extern "C" void elektraLockMutex ()
 {
 #if ELEKTRA_GETENV_USE_LOCKS
 	pthread_mutex_lock (&elektraGetEnvMutex);
 #endif
+	++elektraLockDepth;
 }
 
-extern "C" void elektraUnlockMutex ()
+bool elektraTryLockMutex ()
 {
+#if ELEKTRA_GETENV_USE_LOCKS
+	if (pthread_mutex_trylock (&elektraGetEnvMutex) != 0) return false;
+#endif
+	++elektraLockDepth;
+	return true;
+}
+
+/**
+ * @brief Unlocks the mutex
+ *
+ * @param publish if the changes done while the mutex was locked should be
+ *        visible to getenv() (only done by the outermost unlock and only
+ *        if something changed)
+ */
+void elektraReleaseMutex (bool publish)
+{
+	if (--elektraLockDepth == 0 && publish && elektraSnapshotChanged ()) elektraPublishSnapshot ();
 #if ELEKTRA_GETENV_USE_LOCKS
 	pthread_mutex_unlock (&elektraGetEnvMutex);
 #endif
 }
 
+extern "C" void elektraUnlockMutex ()
+{
+	elektraReleaseMutex (true);
+}
+
 
 void printVersion ()
 {
@@ -402,14 +546,13 @@ void applyOptions ()
 		environ = nullptr;
 	}
 
-	elektraReloadTimeout = std::chrono::milliseconds::zero ();
+	elektraReloadTimeout = 0;
 	if (((k = ksLookupByName (elektraConfig, "/elektra/intercept/getenv/option/reload_timeout", 0))) && !keyIsBinary (k))
 	{
 		LOG << "activate reloading feature" << endl;
 
 		// we do not care about errors, 0 is an invalid number anyway
-		std::chrono::milliseconds::rep v = atoi (keyString (k));
-		elektraReloadTimeout = std::chrono::milliseconds (v);
+		elektraReloadTimeout = atoi (keyString (k));
 	}
 
 	if (((k = ksLookupByName (elektraConfig, "/elektra/intercept/getenv/option/help", 0))) && !keyIsBinary (k))
@@ -450,6 +593,7 @@ extern "C" void elektraOpen (int * argc, char ** argv)
 	kdbGet (elektraRepo, elektraConfig, elektraParentKey);
 	addLayers ();
 	applyOptions ();
+	elektraSnapshotOutdated = true;
 	elektraUnlockMutex ();
 }
 
@@ -514,6 +658,9 @@ extern "C" pid_t fork ()
 		// reinitialize mutex in new process
 		// fixes deadlock in akonadictl
 		elektraGetEnvMutex = ELEKTRA_MUTEX_INIT;
+		elektraLockDepth = 0;
+		// readers of other threads do not exist anymore
+		resetReaders ();
 	}
 	return ret;
 }
@@ -522,44 +669,206 @@ Key * elektraContextEvaluation (ELEKTRA_UNUSED KeySet * ks, ELEKTRA_UNUSED Key *
 {
 	if (found && !strncmp (keyName (found), "spec:/", 5) && option == KDB_O_CALLBACK)
 	{
+		const GetEnvContext & context = elektraLookupSnapshot ? elektraLookupSnapshot->context : elektraEnvContext;
+		ostream * log = elektraLookupSnapshot ? elektraLookupSnapshot->log.get () : elektraLog.get ();
 		const Key * meta = keyGetMeta (found, "context");
 		if (meta)
 		{
-			string contextName = elektraEnvContext.evaluate (keyString (meta));
-			LOG << ", in context: " << contextName;
+			string contextName = context.evaluate (keyString (meta));
+			LOG_TO (log) << ", in context: " << contextName;
 			// only consider context if key actually exists, otherwise continue searching
 			Key * ret = ksLookupByName (ks, contextName.c_str (), 0);
 			if (ret) return ret; // use context override!
 		}
 		else
 		{
-			LOG << ", NO context";
+			LOG_TO (log) << ", NO context";
 		}
 	}
 	return found;
 }
 
-Key * elektraLookupWithContext (std::string name)
+Key * elektraLookupWithContext (KeySet * ks, std::string const & name)
 {
 	Key * search = keyNew (name.c_str (), KEY_META, "callback", "", KEY_FUNC, elektraContextEvaluation, KEY_END);
-	Key * ret = ksLookup (elektraConfig, search, 0);
+	Key * ret = ksLookup (ks, search, 0);
 	keyDel (search);
 	return ret;
 }
 
-char * elektraGetEnvKey (std::string const & fullName, bool & finish)
+Key * elektraLookupWithContext (std::string name)
+{
+	return elektraLookupWithContext (elektraConfig, name);
+}
+
+const std::string elektraOverridePrefix = "/elektra/intercept/getenv/override/";
+const std::string elektraFallbackPrefix = "/elektra/intercept/getenv/fallback/";
+
+void addSnapshotEntries (Snapshot * snapshot, SnapshotEntries & entries, std::string const & prefix)
+{
+	std::vector<std::string> names;
+	for (elektraCursor it = 0; it < ksGetSize (snapshot->config); ++it)
+	{
+		const char * name = strchr (keyName (ksAtCursor (snapshot->config, it)), '/');
+		if (name && !strncmp (name, prefix.c_str (), prefix.size ()))
+		{
+			names.push_back (name + prefix.size ());
+		}
+	}
+	std::sort (names.begin (), names.end ());
+	names.erase (std::unique (names.begin (), names.end ()), names.end ());
+
+	for (auto const & name : names)
+	{
+		const Key * found = elektraLookupWithContext (snapshot->config, prefix + name);
+		if (found) entries.push_back (std::make_pair (name, found));
+	}
+}
+
+/**
+ * @brief Creates a snapshot of the current configuration
+ *
+ * Must be called with the mutex locked.
+ *
+ * @return the new snapshot
+ * @retval nullptr if Elektra is closed or on memory errors
+ */
+Snapshot * elektraCreateSnapshot ()
+{
+	if (!elektraRepo) return nullptr;
+
+	Snapshot * snapshot = new Snapshot;
+	snapshot->config = ksFreeze (elektraConfig);
+	if (!snapshot->config)
+	{
+		delete snapshot;
+		return nullptr;
+	}
+	snapshot->context = elektraEnvContext;
+	snapshot->log = elektraLog;
+
+	for (elektraCursor it = 0; it < ksGetSize (snapshot->config); ++it)
+	{
+		const Key * key = ksAtCursor (snapshot->config, it);
+		if (keyIsBinary (key)) continue;
+		snapshot->values[key] = elektraValues.insert (keyString (key)).first->c_str ();
+	}
+
+	elektraLookupSnapshot = snapshot;
+	addSnapshotEntries (snapshot, snapshot->overrides, elektraOverridePrefix);
+	addSnapshotEntries (snapshot, snapshot->fallbacks, elektraFallbackPrefix);
+	elektraLookupSnapshot = nullptr;
+	return snapshot;
+}
+
+/**
+ * @brief Checks if getenv() would see something else than the current snapshot
+ *
+ * Must be called with the mutex locked. Comparing elektraConfig with the
+ * snapshot is much cheaper than creating a new snapshot.
+ */
+bool elektraSnapshotChanged ()
+{
+	const Snapshot * current = elektraSnapshot.load ();
+	if (!elektraRepo) return current != nullptr;
+	if (!current || elektraSnapshotOutdated) return true;
+	return ksFrozenMatches (current->config, elektraConfig) != 1;
+}
+
+/**
+ * @brief Replaces the snapshot used by getenv()
+ *
+ * Must be called with the mutex locked. The replaced snapshot gets freed as
+ * soon as no reader uses it anymore. Values returned by getenv() are interned
+ * in elektraValues, so they stay valid until Elektra gets closed.
+ */
+void elektraPublishSnapshot ()
+{
+	Snapshot * snapshot = elektraCreateSnapshot ();
+	elektraSnapshotOutdated = elektraRepo && !snapshot; // retry on memory errors
+	Snapshot * old = elektraSnapshot.exchange (snapshot);
+	if (!old) return;
+
+	waitForReaders ();
+	delete old;
+	if (!elektraRepo) elektraValues.clear ();
+}
+
+/**
+ * @brief Reloads the configuration if reload_timeout is over
+ *
+ * Only one thread reloads, all others continue to use the current snapshot
+ * in the meantime.
+ */
+void elektraReloadIfDue ()
+{
+	// is reload feature enabled at all?
+	std::chrono::milliseconds const timeout (elektraReloadTimeout.load ());
+	if (timeout <= std::chrono::milliseconds::zero ()) return;
+
+	// are we now ready to reload?
+	std::chrono::system_clock::time_point const now = std::chrono::system_clock::now ();
+	if (now.time_since_epoch ().count () < elektraReloadNext.load ()) return;
+
+	if (!elektraTryLockMutex ()) return;
+	if (!elektraRepo || now.time_since_epoch ().count () < elektraReloadNext.load ())
+	{
+		// another thread reloaded in the meantime
+		elektraReleaseMutex (false);
+		return;
+	}
+	elektraReloadNext = (now + timeout).time_since_epoch ().count ();
+
+	int ret = kdbGet (elektraRepo, elektraConfig, elektraParentKey);
+
+	// was there a change?
+	if (ret == 1)
+	{
+		elektraEnvContext.clearAllLayer ();
+		addLayers ();
+		applyOptions ();
+		elektraSnapshotOutdated = true;
+	}
+	elektraReleaseMutex (ret == 1);
+}
+
+bool isPlainName (const char * name)
+{
+	if (!*name) return false;
+	for (; *name; ++name)
+	{
+		char const c = *name;
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) return false;
+	}
+	return true;
+}
+
+char * elektraGetEnvKey (const Snapshot * snapshot, SnapshotEntries const & entries, std::string const & prefix, const char * name,
+			 bool & finish)
 {
-	Key * key = elektraLookupWithContext (fullName);
+	ostream * log = snapshot->log.get ();
+	const Key * key = nullptr;
+	if (isPlainName (name))
+	{
+		// such names are already canonical, so the entries are complete
+		auto it = std::lower_bound (entries.begin (), entries.end (), name,
+					    [] (SnapshotEntries::value_type const & entry, const char * n) { return entry.first.compare (n) < 0; });
+		if (it != entries.end () && it->first == name) key = it->second;
+	}
+	else
+	{
+		key = elektraLookupWithContext (snapshot->config, prefix + name);
+	}
+
 	if (key)
 	{
-		LOG << " found " << fullName << ": " << keyString (key) << endl;
+		LOG_TO (log) << " found " << prefix << name << ": " << keyString (key) << endl;
 		finish = true;
-		if (keyIsBinary (key)) return nullptr;
-		return const_cast<char *> (keyString (key));
+		return const_cast<char *> (snapshot->value (key));
 	}
 
 	finish = false;
-	LOG << " tried " << fullName << ",";
+	LOG_TO (log) << " tried " << prefix << name << ",";
 	return nullptr;
 }
 
@@ -567,6 +876,8 @@ char * elektraGetEnvKey (std::string const & fullName, bool & finish)
 /**
  * @brief Uses Elektra to get from environment.
  *
+ * Does not lock, values found in Elektra stay valid until elektraClose().
+ *
  * @param name to be looked up in the environment.
  *
  * @return the value found for that key
@@ -575,61 +886,39 @@ char * elektraGetEnvKey (std::string const & fullName, bool & finish)
  */
 char * elektraGetEnv (const char * cname, gfcn origGetenv)
 {
-	LOG << "elektraGetEnv(" << cname << ")";
-	if (!elektraRepo)
+	elektraReloadIfDue ();
+
+	ReadSection section;
+	const Snapshot * snapshot = section.snapshot ();
+	if (!snapshot)
 	{ // no open Repo (needed for bootstrapping, if inside kdbOpen() getenv is used)
-		char * ret = (*origGetenv) (cname);
-		if (!ret)
-		{
-			LOG << " orig getenv returned null pointer" << endl;
-		}
-		else
-			LOG << " orig getenv returned (" << strlen (ret) << ") <" << ret << ">" << endl;
-		return ret;
+		return (*origGetenv) (cname);
 	}
 
-	// is reload feature enabled at all?
-	if (elektraReloadTimeout > std::chrono::milliseconds::zero ())
-	{
-		std::chrono::system_clock::time_point const now = std::chrono::system_clock::now ();
-
-		// are we now ready to reload?
-		if (now >= elektraReloadNext)
-		{
-			int ret = kdbGet (elektraRepo, elektraConfig, elektraParentKey);
-
-			// was there a change?
-			if (ret == 1)
-			{
-				elektraEnvContext.clearAllLayer ();
-				addLayers ();
-				applyOptions ();
-			}
-		}
-
-		elektraReloadNext = now + elektraReloadTimeout;
-	}
+	ostream * log = snapshot->log.get ();
+	LOG_TO (log) << "elektraGetEnv(" << cname << ")";
+	elektraLookupSnapshot = snapshot;
 
-	std::string name = cname;
 	bool finish = false;
 	char * ret = nullptr;
-	ret = elektraGetEnvKey ("/elektra/intercept/getenv/override/" + name, finish);
-	if (finish) return ret;
-
-	ret = (*origGetenv) (name.c_str ());
-	if (ret)
+	ret = elektraGetEnvKey (snapshot, snapshot->overrides, elektraOverridePrefix, cname, finish);
+	if (!finish)
 	{
-		LOG << " environ returned (" << strlen (ret) << ") <" << ret << ">" << endl;
-		return ret;
+		ret = (*origGetenv) (cname);
+		if (ret)
+		{
+			LOG_TO (log) << " environ returned (" << strlen (ret) << ") <" << ret << ">" << endl;
+		}
+		else
+		{
+			LOG_TO (log) << " tried environ,";
+			ret = elektraGetEnvKey (snapshot, snapshot->fallbacks, elektraFallbackPrefix, cname, finish);
+			if (!finish) LOG_TO (log) << " nothing found" << endl;
+		}
 	}
-	else
-		LOG << " tried environ,";
-
-	ret = elektraGetEnvKey ("/elektra/intercept/getenv/fallback/" + name, finish);
-	if (finish) return ret;
 
-	LOG << " nothing found" << endl;
-	return nullptr;
+	elektraLookupSnapshot = nullptr;
+	return ret;
 }
 
 /*
@@ -682,35 +971,27 @@ char * elektraBootstrapSecureGetEnv (const char * name)
 
 extern "C" char * getenv (const char * name) // throw ()
 {
-	elektraLockMutex ();
 	if (!sym.f || elektraInGetEnv)
 	{
-		char * ret = elektraBootstrapGetEnv (name);
-		elektraUnlockMutex ();
-		return ret;
+		return elektraBootstrapGetEnv (name);
 	}
 
 	elektraInGetEnv = true;
 	char * ret = elektraGetEnv (name, sym.f);
 	elektraInGetEnv = false;
-	elektraUnlockMutex ();
 	return ret;
 }
 
 extern "C" char * secure_getenv (const char * name) // throw ()
 {
-	elektraLockMutex ();
 	if (!ssym.f || elektraInGetEnv)
 	{
-		char * ret = elektraBootstrapSecureGetEnv (name);
-		elektraUnlockMutex ();
-		return ret;
+		return elektraBootstrapSecureGetEnv (name);
 	}
 
 	elektraInGetEnv = true;
 	char * ret = elektraGetEnv (name, ssym.f);
 	elektraInGetEnv = false;
-	elektraUnlockMutex ();
 	return ret;
 }
 } // namespace ckdb
@@ -10,6 +10,10 @@
 #include <gtest/gtest.h>
 #include <kdbgetenv.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 TEST (GetEnv, NonExist)
 {
 	EXPECT_EQ (getenv ("du4Maiwi/does-not-exist"), static_cast<char *> (nullptr));
@@ -19,7 +23,9 @@ TEST (GetEnv, ExistOverride)
 {
 	using namespace ckdb;
 	elektraOpen (nullptr, nullptr);
+	elektraLockMutex ();
 	ksAppendKey (elektraConfig, keyNew ("user:/elektra/intercept/getenv/override/does-exist", KEY_VALUE, "hello", KEY_END));
+	elektraUnlockMutex ();
 	ASSERT_NE (getenv ("does-exist"), static_cast<char *> (nullptr));
 	EXPECT_EQ (getenv ("does-exist"), std::string ("hello"));
 	elektraClose ();
@@ -49,7 +55,9 @@ TEST (GetEnv, ExistFallback)
 {
 	using namespace ckdb;
 	elektraOpen (nullptr, nullptr);
+	elektraLockMutex ();
 	ksAppendKey (elektraConfig, keyNew ("user:/elektra/intercept/getenv/fallback/does-exist", KEY_VALUE, "hello", KEY_END));
+	elektraUnlockMutex ();
 	ASSERT_NE (getenv ("does-exist"), static_cast<char *> (nullptr));
 	EXPECT_EQ (getenv ("does-exist"), std::string ("hello"));
 	elektraClose ();
@@ -59,7 +67,9 @@ TEST (GetEnv, ExistFallbackFallback)
 {
 	using namespace ckdb;
 	elektraOpen (nullptr, nullptr);
+	elektraLockMutex ();
 	ksAppendKey (elektraConfig, keyNew ("user:/env/fallback/does-exist-fb", KEY_VALUE, "hello", KEY_END));
+	elektraUnlockMutex ();
 	ASSERT_NE (getenv ("does-exist-fb"), static_cast<char *> (nullptr));
 	EXPECT_EQ (getenv ("does-exist-fb"), std::string ("hello"));
 	elektraClose ();
@@ -72,7 +82,9 @@ TEST (GetEnv, OpenClose)
 	elektraOpen (nullptr, nullptr);
 	// EXPECT_NE(elektraConfig, oldElektraConfig); // even its a new object, it might point to same address
 	EXPECT_EQ (getenv ("du4Maiwi/does-not-exist"), static_cast<char *> (nullptr));
+	elektraLockMutex ();
 	ksAppendKey (elektraConfig, keyNew ("user:/elektra/intercept/getenv/override/does-exist", KEY_VALUE, "hello", KEY_END));
+	elektraUnlockMutex ();
 
 	ASSERT_NE (getenv ("does-exist"), static_cast<char *> (nullptr));
 	EXPECT_EQ (getenv ("does-exist"), std::string ("hello"));
@@ -87,7 +99,9 @@ TEST (GetEnv, OpenCloseFallback)
 	elektraOpen (nullptr, nullptr);
 	// EXPECT_NE(elektraConfig, oldElektraConfig); // even its a new object, it might point to same address
 	EXPECT_EQ (getenv ("du4Maiwi/does-not-exist-fb"), static_cast<char *> (nullptr));
+	elektraLockMutex ();
 	ksAppendKey (elektraConfig, keyNew ("user:/env/override/does-exist-fb", KEY_VALUE, "hello", KEY_END));
+	elektraUnlockMutex ();
 
 	ASSERT_NE (getenv ("does-exist-fb"), static_cast<char *> (nullptr));
 	EXPECT_EQ (getenv ("does-exist-fb"), std::string ("hello"));
@@ -95,6 +109,69 @@ TEST (GetEnv, OpenCloseFallback)
 	elektraClose ();
 }
 
+TEST (GetEnv, ConcurrentChange)
+{
+	using namespace ckdb;
+	elektraOpen (nullptr, nullptr);
+	elektraLockMutex ();
+	ksAppendKey (elektraConfig, keyNew ("user:/elektra/intercept/getenv/override/does-change", KEY_VALUE, "old", KEY_END));
+	elektraUnlockMutex ();
+
+	std::atomic<bool> done (false);
+	std::atomic<int> wrong (0);
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i)
+	{
+		readers.push_back (std::thread ([&] {
+			while (!done)
+			{
+				const char * value = getenv ("does-change");
+				if (!value || (std::string (value) != "old" && std::string (value) != "new")) ++wrong;
+			}
+		}));
+	}
+
+	for (int i = 0; i < 100; ++i)
+	{
+		elektraLockMutex ();
+		ksAppendKey (elektraConfig, keyNew ("user:/elektra/intercept/getenv/override/does-change", KEY_VALUE,
+						    i % 2 ? "old" : "new", KEY_END));
+		elektraUnlockMutex ();
+	}
+	done = true;
+	for (auto & reader : readers)
+	{
+		reader.join ();
+	}
+
+	EXPECT_EQ (wrong, 0);
+	EXPECT_EQ (getenv ("does-change"), std::string ("old"));
+	elektraClose ();
+}
+
+TEST (GetEnv, UnchangedSnapshot)
+{
+	using namespace ckdb;
+	elektraOpen (nullptr, nullptr);
+	elektraLockMutex ();
+	ksAppendKey (elektraConfig, keyNew ("user:/elektra/intercept/getenv/override/does-exist", KEY_VALUE, "hello", KEY_END));
+	elektraUnlockMutex ();
+	const char * value = getenv ("does-exist");
+	ASSERT_NE (value, static_cast<char *> (nullptr));
+
+	// nothing changed, so the snapshot is kept
+	elektraLockMutex ();
+	elektraUnlockMutex ();
+	EXPECT_EQ (getenv ("does-exist"), value);
+
+	elektraLockMutex ();
+	keySetString (ksLookupByName (elektraConfig, "user:/elektra/intercept/getenv/override/does-exist", 0), "changed");
+	elektraUnlockMutex ();
+	EXPECT_EQ (getenv ("does-exist"), std::string ("changed"));
+	EXPECT_EQ (value, std::string ("hello")); // still valid until elektraClose()
+	elektraClose ();
+}
+
 void elektraPrintConfig ()
 {
 	using namespace ckdb;
@@ -71,4 +71,6 @@ void elektraIoTestSuite (ElektraIoTestSuiteCreateBinding createBinding, ElektraI
 	elektraIoTestSuiteFd (createBinding, start, stop);
 
 	elektraIoTestSuiteMix (createBinding, start, stop);
+
+	elektraIoTestSuiteKdb (createBinding, start, stop);
 }
@@ -24,4 +24,6 @@ void elektraIoTestSuiteFd (ElektraIoTestSuiteCreateBinding createBinding, Elektr
 
 void elektraIoTestSuiteMix (ElektraIoTestSuiteCreateBinding createBinding, ElektraIoTestSuiteStart start, ElektraIoTestSuiteStop stop);
 
+void elektraIoTestSuiteKdb (ElektraIoTestSuiteCreateBinding createBinding, ElektraIoTestSuiteStart start, ElektraIoTestSuiteStop stop);
+
 #endif
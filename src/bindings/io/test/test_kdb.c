@@ -0,0 +1,130 @@
+/**
+ * @file
+ *
+ * @brief Tests for asynchronous kdbGet() and kdbSet() using I/O bindings
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kdb.h>
+#include <kdbhelper.h>
+#include <tests.h>
+
+#include "test.h"
+#include <kdbio.h>
+#include <kdbiotest.h>
+
+#define KDB_CONTROL_INTERVAL 5000
+
+#define KDB_TEST_PARENT "system:/elektra/version"
+
+static ElektraIoTestSuiteStop testStop;
+
+static int testCallbackCalled;
+static int testCallbackResult;
+static ElektraIoKdbOperation * testCallbackOperation;
+
+static void testKdbCallback (ElektraIoKdbOperation * kdbOp, int result)
+{
+	testCallbackCalled++;
+	testCallbackResult = result;
+	testCallbackOperation = kdbOp;
+
+	succeed_if (elektraIoKdbGetData (kdbOp) == &testCallbackCalled, "callback data was not passed");
+	succeed_if (elektraIoKdbGetKeySet (kdbOp) != NULL, "keyset was not passed");
+	succeed_if (elektraIoKdbGetParentKey (kdbOp) != NULL, "parent key was not passed");
+
+	testStop ();
+}
+
+static void testKdbControl (ElektraIoTimerOperation * timerOp ELEKTRA_UNUSED)
+{
+	yield_error ("timeout; test failed");
+	testStop ();
+}
+
+static void testKdbBasics (ElektraIoTestSuiteCreateBinding createBinding)
+{
+	Key * parentKey = keyNew (KDB_TEST_PARENT, KEY_END);
+	KeySet * ks = ksNew (0, KS_END);
+	ElektraIoInterface * binding = createBinding ();
+
+	succeed_if (elektraIoKdbGet (NULL, (KDB *) 1, ks, parentKey, testKdbCallback, NULL) == NULL, "should not accept missing binding");
+	succeed_if (elektraIoKdbGet (binding, NULL, ks, parentKey, testKdbCallback, NULL) == NULL, "should not accept missing handle");
+	succeed_if (elektraIoKdbSet (binding, (KDB *) 1, NULL, parentKey, testKdbCallback, NULL) == NULL, "should not accept missing keyset");
+	succeed_if (elektraIoKdbSet (binding, (KDB *) 1, ks, NULL, testKdbCallback, NULL) == NULL, "should not accept missing parent key");
+	succeed_if (elektraIoKdbSet (binding, (KDB *) 1, ks, parentKey, NULL, NULL) == NULL, "should not accept missing callback");
+
+	elektraIoBindingCleanup (binding);
+	ksDel (ks);
+	keyDel (parentKey);
+}
+
+static void testKdbShouldGetAndSet (ElektraIoTestSuiteCreateBinding createBinding, ElektraIoTestSuiteStart start,
+				    ElektraIoTestSuiteStop stop)
+{
+	Key * parentKey = keyNew (KDB_TEST_PARENT, KEY_END);
+	KDB * kdb = kdbOpen (NULL, parentKey);
+	exit_if_fail (kdb != NULL, "kdbOpen failed");
+	KeySet * ks = ksNew (0, KS_END);
+
+	ElektraIoTimerOperation * timerOp = elektraIoNewTimerOperation (KDB_CONTROL_INTERVAL, 1, testKdbControl, NULL);
+
+	ElektraIoInterface * binding = createBinding ();
+	elektraIoBindingAddTimer (binding, timerOp);
+
+	testStop = stop;
+	testCallbackCalled = 0;
+	testCallbackResult = -1;
+
+	ElektraIoKdbOperation * kdbOp = elektraIoKdbGet (binding, kdb, ks, parentKey, testKdbCallback, &testCallbackCalled);
+	succeed_if (kdbOp != NULL, "could not start asynchronous kdbGet");
+
+	start ();
+
+	succeed_if (testCallbackCalled == 1, "callback of kdbGet was not called exactly once");
+	succeed_if (testCallbackOperation == kdbOp, "callback was called with wrong operation");
+	succeed_if (testCallbackResult >= 0, "asynchronous kdbGet failed");
+	succeed_if (ksLookupByName (ks, KDB_TEST_PARENT "/constants/KDB_VERSION", 0) != NULL, "kdbGet did not return version keys");
+
+	testCallbackCalled = 0;
+	testCallbackResult = -1;
+
+	kdbOp = elektraIoKdbSet (binding, kdb, ks, parentKey, testKdbCallback, &testCallbackCalled);
+	succeed_if (kdbOp != NULL, "could not start asynchronous kdbSet");
+
+	start ();
+
+	succeed_if (testCallbackCalled == 1, "callback of kdbSet was not called exactly once");
+	succeed_if (testCallbackResult == 0, "asynchronous kdbSet of unchanged keyset should do nothing");
+
+	elektraIoBindingRemoveTimer (timerOp);
+	elektraIoBindingCleanup (binding);
+	elektraFree (timerOp);
+
+	ksDel (ks);
+	kdbClose (kdb, parentKey);
+	keyDel (parentKey);
+}
+
+/**
+ * Test asynchronous kdbGet() and kdbSet() of the I/O binding returned by createBinding.
+ * Requires the following operations: Fd, Timer
+ *
+ * @param createBinding binding creation function
+ * @param start         starts I/O operations
+ * @param stop          stops I/O operations
+ */
+void elektraIoTestSuiteKdb (ElektraIoTestSuiteCreateBinding createBinding, ElektraIoTestSuiteStart start, ElektraIoTestSuiteStop stop)
+{
+	printf ("test kdb\n");
+
+	testKdbBasics (createBinding);
+
+	testKdbShouldGetAndSet (createBinding, start, stop);
+}
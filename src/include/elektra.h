@@ -18,6 +18,7 @@
 // region Helpers for Code Generation
 #define ELEKTRA_GET(typeName) ELEKTRA_CONCAT (elektraGet, typeName)
 #define ELEKTRA_GET_ARRAY_ELEMENT(typeName) ELEKTRA_CONCAT (ELEKTRA_CONCAT (elektraGet, typeName), ArrayElement)
+#define ELEKTRA_GET_BY_ID(typeName) ELEKTRA_CONCAT (ELEKTRA_CONCAT (elektraGet, typeName), ById)
 #define ELEKTRA_SET(typeName) ELEKTRA_CONCAT (elektraSet, typeName)
 #define ELEKTRA_SET_ARRAY_ELEMENT(typeName) ELEKTRA_CONCAT (ELEKTRA_CONCAT (elektraSet, typeName), ArrayElement)
 
@@ -234,6 +235,45 @@ void elektraSetLongDoubleArrayElement (Elektra * elektra, const char * keyname,
 
 // endregion Array-Setters
 
+// region Key index
+/**************************************
+ *
+ * Key index
+ *
+ **************************************/
+
+/**
+ * Describes a key for elektraBuildKeyIndex().
+ */
+typedef struct _ElektraIndexedKey
+{
+	const char * name; ///< The relative name of the key.
+	const char * type; ///< The expected type metadata value.
+} ElektraIndexedKey;
+
+void elektraBuildKeyIndex (Elektra * elektra, const ElektraIndexedKey * keys, size_t size);
+
+const char * elektraGetStringById (Elektra * elektra, size_t id);
+kdb_boolean_t elektraGetBooleanById (Elektra * elektra, size_t id);
+kdb_char_t elektraGetCharById (Elektra * elektra, size_t id);
+kdb_octet_t elektraGetOctetById (Elektra * elektra, size_t id);
+kdb_short_t elektraGetShortById (Elektra * elektra, size_t id);
+kdb_unsigned_short_t elektraGetUnsignedShortById (Elektra * elektra, size_t id);
+kdb_long_t elektraGetLongById (Elektra * elektra, size_t id);
+kdb_unsigned_long_t elektraGetUnsignedLongById (Elektra * elektra, size_t id);
+kdb_long_long_t elektraGetLongLongById (Elektra * elektra, size_t id);
+kdb_unsigned_long_long_t elektraGetUnsignedLongLongById (Elektra * elektra, size_t id);
+kdb_float_t elektraGetFloatById (Elektra * elektra, size_t id);
+kdb_double_t elektraGetDoubleById (Elektra * elektra, size_t id);
+
+#ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
+
+kdb_long_double_t elektraGetLongDoubleById (Elektra * elektra, size_t id);
+
+#endif
+
+// endregion Key index
+
 // region Type information
 /**************************************
  *
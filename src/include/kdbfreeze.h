@@ -0,0 +1,32 @@
+/**
+ * @file
+ *
+ * @brief Private declarations for read-only KeySet snapshots.
+ *
+ * Unlike kdbprivate.h, this header does not pull in the high-level API, so
+ * code that declares functions with the same names (e.g. kdbgetenv.h) can use it.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef KDBFREEZE_H
+#define KDBFREEZE_H
+
+#include <kdb.h>
+
+#ifdef __cplusplus
+namespace ckdb
+{
+extern "C" {
+#endif
+
+KeySet * ksFreeze (const KeySet * source);
+int ksIsFrozen (const KeySet * ks);
+int ksFrozenMatches (const KeySet * frozen, const KeySet * source);
+
+#ifdef __cplusplus
+}
+}
+#endif
+
+#endif // KDBFREEZE_H
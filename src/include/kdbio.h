@@ -30,6 +30,9 @@ typedef struct _ElektraIoTimerOperation ElektraIoTimerOperation;
 /** idle operation handle */
 typedef struct _ElektraIoIdleOperation ElektraIoIdleOperation;
 
+/** asynchronous kdbGet() or kdbSet() operation handle */
+typedef struct _ElektraIoKdbOperation ElektraIoKdbOperation;
+
 /**
  * Callback for file descriptor watch operations.
  *
@@ -59,6 +62,17 @@ typedef void (*ElektraIoIdleCallback) (ElektraIoIdleOperation * idleOp);
  */
 typedef void (*ElektraIoTimerCallback) (ElektraIoTimerOperation * timerOp);
 
+/**
+ * Callback for asynchronous kdbGet() and kdbSet() operations.
+ *
+ * Called by the I/O binding after the operation completed.
+ * The operation handle is freed after the callback returned.
+ *
+ * @param  kdbOp   operation handle
+ * @param  result  return value of kdbGet() or kdbSet()
+ */
+typedef void (*ElektraIoKdbCallback) (ElektraIoKdbOperation * kdbOp, int result);
+
 /**
  * Available flags for file descriptors operation bitmask
  */
@@ -618,6 +632,75 @@ int elektraIoContract (KeySet * contract, ElektraIoInterface * ioBinding);
  */
 ElektraIoInterface * elektraIoGetBinding (KDB * kdb);
 
+/**
+ * Start kdbGet() without blocking the I/O binding.
+ *
+ * kdbGet() runs in a separate thread, including the file system accesses of
+ * resolvers and storage plugins. Once it completed, @p callback is called
+ * by the I/O binding, like the callbacks of other operations.
+ *
+ * Until then @p kdb, @p returned and @p parentKey belong to the operation
+ * and must not be used or freed. The operation cannot be cancelled, the
+ * I/O binding has to run until @p callback was called.
+ *
+ * Plugins run in the separate thread, too. If @p kdb uses the notification
+ * API, registered variables are updated and notification callbacks are
+ * called in this thread, before @p callback. They must not touch state of
+ * the event loop thread without synchronization.
+ *
+ * @param  binding    I/O binding handle
+ * @param  kdb        KDB instance, see kdbGet()
+ * @param  returned   KeySet for the configuration, see kdbGet()
+ * @param  parentKey  parent key, receives errors and warnings, see kdbGet()
+ * @param  callback   called with the result of kdbGet()
+ * @param  data       custom private data
+ * @return            operation handle
+ * @retval NULL       on NULL pointers or if the operation could not be started
+ */
+ElektraIoKdbOperation * elektraIoKdbGet (ElektraIoInterface * binding, KDB * kdb, KeySet * returned, Key * parentKey,
+					 ElektraIoKdbCallback callback, void * data);
+
+/**
+ * Start kdbSet() without blocking the I/O binding.
+ *
+ * Works like elektraIoKdbGet(), but calls kdbSet().
+ *
+ * @param  binding    I/O binding handle
+ * @param  kdb        KDB instance, see kdbSet()
+ * @param  returned   KeySet with the configuration to write, see kdbSet()
+ * @param  parentKey  parent key, receives errors and warnings, see kdbSet()
+ * @param  callback   called with the result of kdbSet()
+ * @param  data       custom private data
+ * @return            operation handle
+ * @retval NULL       on NULL pointers or if the operation could not be started
+ */
+ElektraIoKdbOperation * elektraIoKdbSet (ElektraIoInterface * binding, KDB * kdb, KeySet * returned, Key * parentKey,
+					 ElektraIoKdbCallback callback, void * data);
+
+/**
+ * Get KeySet of asynchronous kdbGet() or kdbSet() operation.
+ *
+ * @param  kdbOp  operation handle
+ * @return        KeySet or NULL on error
+ */
+KeySet * elektraIoKdbGetKeySet (ElektraIoKdbOperation * kdbOp);
+
+/**
+ * Get parent key of asynchronous kdbGet() or kdbSet() operation.
+ *
+ * @param  kdbOp  operation handle
+ * @return        parent key or NULL on error
+ */
+Key * elektraIoKdbGetParentKey (ElektraIoKdbOperation * kdbOp);
+
+/**
+ * Get private data from asynchronous kdbGet() or kdbSet() operation.
+ *
+ * @param  kdbOp  operation handle
+ * @return        pointer to data or NULL on error
+ */
+void * elektraIoKdbGetData (ElektraIoKdbOperation * kdbOp);
+
 #ifdef __cplusplus
 }
 }
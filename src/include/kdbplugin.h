@@ -135,6 +135,7 @@ void * elektraPluginGetData (Plugin * plugin);
 KeySet * elektraPluginGetGlobalKeySet (Plugin * plugin);
 ElektraKdbPhase elektraPluginGetPhase (Plugin * plugin);
 Plugin * elektraPluginFromMountpoint (Plugin * plugin, const char * ref);
+int elektraPluginGetChangeLog (Plugin * plugin, KeySet * returned, KeySet * added, KeySet * changed, KeySet * removed);
 
 #define PLUGINVERSION "1"
 
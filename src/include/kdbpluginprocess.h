@@ -31,6 +31,17 @@ ELEKTRA_PLUGINPROCESS_END=0			/*!< End of arguments */
 	// clang-format on
 } pluginprocess_t;
 
+/**
+ * Switches to denote how the payload keysets are transferred between the processes.
+ */
+typedef enum
+{
+	// clang-format off
+ELEKTRA_PLUGINPROCESS_TRANSPORT_PIPE=1,	/*!< Serialize the payload with the dump plugin and send it through pipes */
+ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM=2,	/*!< Share the payload in memory using the mmapstorage plugin, falls back to pipes */
+	// clang-format on
+} pluginprocess_transport_t;
+
 typedef struct _ElektraPluginProcess ElektraPluginProcess;
 
 typedef struct ElektraPluginProcessCloseResult
@@ -39,6 +50,7 @@ typedef struct ElektraPluginProcessCloseResult
 } ElektraPluginProcessCloseResult;
 
 ElektraPluginProcess * elektraPluginProcessInit (Key *);
+ElektraPluginProcess * elektraPluginProcessInitTransport (Key *, pluginprocess_transport_t);
 void elektraPluginProcessStart (Plugin *, ElektraPluginProcess *);
 
 int elektraPluginProcessOpen (ElektraPluginProcess *, Key *);
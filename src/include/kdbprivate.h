@@ -13,14 +13,15 @@
 #include <elektra/error.h>
 #include <kdb.h>
 #include <kdbextension.h>
+#include <kdbfreeze.h>
 #include <kdbhelper.h>
 #include <kdbio.h>
 #include <kdbmacros.h>
 #include <kdbnotificationinternal.h>
 #include <kdbplugin.h>
+#include <kdbopmphm.h>
 #include <kdbtypes.h>
 #ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
-#include <kdbopmphm.h>
 #include <kdbopmphmpredictor.h>
 #endif
 
@@ -31,6 +32,15 @@
 	it says how much can actually be stored.*/
 #define KEYSET_SIZE 16
 
+/** Values up to this size (in bytes, including the NULL terminator) are
+	stored in the same allocation as the Key struct, see _Key.inlineSize */
+#define KEY_INLINE_VALUE_SIZE 64
+
+/** The biggest possible size of the canonical form of a key name of size
+	@p nameSize (including the NULL terminator) written at @p offset,
+	see elektraKeyNameCanonicalizeInto() */
+#define ELEKTRA_KEY_NAME_CANONICAL_SIZE_MAX(offset, nameSize) ((offset) + 2 * (nameSize) + 1)
+
 /** Trie optimization */
 #define APPROXIMATE_NR_OF_BACKENDS 16
 
@@ -55,6 +65,9 @@
 /** All keys below this are used for cache metadata in the global keyset */
 #define KDB_CACHE_PREFIX "system:/elektra/cache"
 
+/** Size of the buffer for the name of a warning and its fields, see elektraAddWarningName() */
+#define ELEKTRA_WARNING_NAME_SIZE 64
+
 
 #ifdef __cplusplus
 namespace ckdb
@@ -81,6 +94,9 @@ typedef int (*kdbHookSpecRemovePtr) (Plugin * handle, KeySet * returned, Key * p
 typedef int (*kdbHookSendNotificationGetPtr) (Plugin * handle, KeySet * returned, Key * parentKey);
 typedef int (*kdbHookSendNotificationSetPtr) (Plugin * handle, KeySet * returned, Key * parentKey);
 
+typedef int (*kdbHookCacheGetPtr) (Plugin * handle, KeySet * returned, Key * parentKey);
+typedef int (*kdbHookCacheSetPtr) (Plugin * handle, KeySet * returned, Key * parentKey);
+
 typedef Plugin * (*OpenMapper) (const char *, const char *, KeySet *);
 typedef int (*CloseMapper) (Plugin *);
 
@@ -134,15 +150,21 @@ typedef enum {
 			 This flag is set for Keys inside a mapped region.
 			 It prevents erroneous free() calls on these keys. */
 	KEY_FLAG_MMAP_KEY = 1 << 5,	/*!<
-			 Key name lies inside a mmap region.
+			 Key name lies inside a mmap region (or an arena, see KEY_FLAG_ARENA,
+			 or the allocation of the Key struct, see _Key.inlineSize).
 			 This flag is set once a Key name has been moved to a mapped region,
 			 and is removed if the name moves out of the mapped region.
 			 It prevents erroneous free() calls on these keys. */
-	KEY_FLAG_MMAP_DATA = 1 << 6	/*!<
-			 Key value lies inside a mmap region.
+	KEY_FLAG_MMAP_DATA = 1 << 6,	/*!<
+			 Key value lies inside a mmap region (or an arena, see KEY_FLAG_ARENA,
+			 or the allocation of the Key struct, see _Key.inlineSize).
 			 This flag is set once a Key value has been moved to a mapped region,
 			 and is removed if the value moves out of the mapped region.
 			 It prevents erroneous free() calls on these keys. */
+	KEY_FLAG_ARENA = 1 << 7	/*!<
+			 Key struct lies inside the arena of a KeySet.
+			 This flag is set for Keys created with ksArenaKeyNew().
+			 keyDel() releases the arena instead of freeing the Key. */
 } keyflag_t;
 
 
@@ -175,6 +197,20 @@ typedef enum {
 		 This flag is set for KeySets where the array is in a mapped region,
 		 and is removed if the array is moved out from the mapped region.
 		 It prevents erroneous free() calls on these arrays. */
+	,KS_FLAG_FROZEN = 1 << 4	/*!<
+		 KeySet is a read-only snapshot created by ksFreeze().
+		 All operations that would modify the KeySet, its Keys
+		 or its internal cursor fail.
+		 Lookups do not change any state. */
+	,KS_FLAG_SHARED_META = 1 << 5	/*!<
+		 KeySet is the metadata of several Keys.
+		 @ref _KeySet.shares holds the number of these Keys.
+		 A Key must detach the KeySet with elektraKeyDetachMeta()
+		 before it modifies its metadata. */
+	,KS_FLAG_EXPOSED_META = 1 << 6	/*!<
+		 KeySet is the metadata of a Key and was returned by keyMeta().
+		 The application may still modify it through that pointer,
+		 so it is never shared with other Keys. */
 } ksflag_t;
 
 
@@ -251,9 +287,22 @@ struct _Key
 	uint16_t refs;
 
 	/**
-	 * Reserved for future use
+	 * Size of the buffer for small values directly behind the Key struct.
+	 *
+	 * keyNew() and keyDup() allocate the Key struct, this buffer, the name and
+	 * the unescaped name in a single allocation. While the value fits into this
+	 * buffer, it is stored there (with KEY_FLAG_MMAP_DATA set, because it must
+	 * not be freed). 0 if there is no such buffer.
+	 */
+	uint16_t inlineSize;
+
+	/**
+	 * The value converted to a C type, NULL if there is none.
+	 *
+	 * Every change of the value frees it.
+	 * @see elektraKeySetTypedValue(), elektraKeyGetTypedValue()
 	 */
-	uint16_t reserved;
+	struct _ElektraTypedValue * typedValue;
 };
 
 
@@ -277,6 +326,8 @@ struct _KeySet
 	size_t size;  /**< Number of keys contained in the KeySet */
 	size_t alloc; /**< Allocated size of array */
 
+	size_t pending; /**< Number of Keys added by ksBuilderAdd() behind the sorted Keys, see ksBuilderFinish() */
+
 	struct _Key * cursor; /**< Internal cursor */
 	size_t current;		  /**< Current position of cursor */
 
@@ -287,7 +338,13 @@ struct _KeySet
 
 	uint16_t refs; /**< Reference counter */
 
-	uint16_t reserved; /**< Reserved for future use */
+	uint16_t shares; /**< Number of Keys using this KeySet as metadata, if KS_FLAG_SHARED_META is set */
+
+	/**
+	 * The arena of Keys created with ksArenaKeyNew(), NULL if the KeySet
+	 * was not created with ksNewArena().
+	 */
+	struct _ElektraArena * arena;
 
 #ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
 	/**
@@ -345,6 +402,12 @@ struct _KDB
 
 	KeySet * backends;
 
+	struct _BackendsIndex * backendsIndex; /*!< The mountpoint index for @ref _KDB.backends, built at the end of kdbOpen().
+			NULL during bootstrap, see backendsIndexNew(). */
+
+	size_t getWorkers; /*!< The number of threads used for the resolver and storage phases of kdbGet().
+			0 runs all backends sequentially, see `system:/elektra/contract/parallel` in kdbOpen(). */
+
 	struct
 	{
 		struct
@@ -361,6 +424,13 @@ struct _KDB
 		} spec;
 
 		struct _SendNotificationHook * sendNotification;
+
+		struct
+		{
+			struct _Plugin * plugin;
+			kdbHookCacheGetPtr get;
+			kdbHookCacheSetPtr set;
+		} cache;
 	} hooks;
 };
 
@@ -430,6 +500,10 @@ typedef struct _BackendData
 	bool initialized; /*!< whether or not the init function of this backend has been called */
 	bool keyNeedsSync; /*!< whether or not any key in this backend needs a sync (keyNeedSync())
 	 More precisely this is set by backendsDivide() to indicate whether it encountered a key that needs sync */
+	struct _KeySet * storedKeys; /*!< the keys the storage phase last read (kdbGet()) or wrote (kdbSet()) for this backend,
+	 NULL if unknown (e.g. loaded from the cache). The change log of elektraPluginGetChangeLog() is relative to these keys. */
+	bool needsReload; /*!< whether or not the next kdbGet() has to read this backend, even if its resolver reports no update.
+	 Set by kdbGetStreamOpen(), because the stream does not keep the keys it reads in @ref _BackendData.keys */
 } BackendData;
 
 // clang-format on
@@ -441,11 +515,20 @@ typedef struct _BackendData
  **************************************/
 
 /* Backends handling */
-Key * backendsFindParent (KeySet * backends, const Key * key);
-KeySet * backendsForParentKey (KeySet * backends, Key * parentKey);
+typedef struct _BackendsIndex BackendsIndex;
+BackendsIndex * backendsIndexNew (KeySet * backends);
+void backendsIndexDel (BackendsIndex * index);
+Key * backendsFindParent (KeySet * backends, const BackendsIndex * index, const Key * key);
+KeySet * backendsForParentKey (KeySet * backends, const BackendsIndex * index, Key * parentKey);
 bool backendsDivide (KeySet * backends, const KeySet * ks);
 void backendsMerge (KeySet * backends, KeySet * ks);
 
+/* Streaming kdbGet */
+typedef struct _KDBGetStream KDBGetStream;
+KDBGetStream * kdbGetStreamOpen (KDB * handle, Key * parentKey);
+int kdbGetStreamNext (KDBGetStream * stream, KeySet ** keys);
+void kdbGetStreamClose (KDBGetStream * stream);
+
 /* Mountpoint parsing */
 // visible for testing
 KeySet * elektraMountpointsParse (KeySet * elektraKs, KeySet * modules, KeySet * global, Key * errorKey);
@@ -460,13 +543,31 @@ int initHooks (KDB * kdb, const KeySet * config, KeySet * modules, const KeySet
 void freeHooks (KDB * kdb, Key * errorKey);
 Plugin * elektraFindInternalNotificationPlugin (KDB * kdb);
 
+/* Errors handling */
+char * elektraAddWarningName (Key * key, char * buffer);
+
 
 /*Private helper for key*/
 ssize_t keySetRaw (Key * key, const void * newBinary, size_t dataSize);
 void keyInit (Key * key);
+Key * elektraKeyNewCanonical (const char * name, size_t nameSize, const char * uname, size_t unameSize, size_t valueSize);
 int keyClearSync (Key * key);
 int keyReplacePrefix (Key * key, const Key * oldPrefix, const Key * newPrefix);
 
+/*Private helper for cached typed values*/
+typedef struct _ElektraTypedValue ElektraTypedValue;
+
+int elektraKeySetTypedValue (Key * key, const char * type, const void * value, size_t size);
+int elektraKeyGetTypedValue (const Key * key, const char * type, void * value, size_t size);
+ElektraTypedValue * elektraTypedValueDup (const ElektraTypedValue * typedValue);
+void elektraKeyClearTypedValue (Key * key);
+
+/*Private helper for copy-on-write metadata*/
+KeySet * elektraMetaShare (KeySet * meta);
+void elektraMetaRelease (KeySet * meta);
+int elektraKeyDetachMeta (Key * key);
+const KeySet * elektraKeyGetMetaKeySet (const Key * key);
+
 /*Private helper for keyset*/
 int ksInit (KeySet * ks);
 int ksClose (KeySet * ks);
@@ -479,6 +580,23 @@ Key * elektraKsPopAtCursor (KeySet * ks, elektraCursor pos);
 
 KeySet * ksRenameKeys (KeySet * config, const char * name);
 
+/*Private helper for arena keysets*/
+typedef struct _ElektraArena ElektraArena;
+
+KeySet * ksNewArena (size_t alloc);
+Key * ksArenaKeyNew (KeySet * ks, const char * name, const void * value, size_t valueSize);
+void elektraArenaRelease (ElektraArena * arena);
+void elektraArenaReleaseKey (Key * key);
+void elektraArenaDetachKey (const KeySet * ks, Key * key);
+
+/*Private helper for bulk loading keysets*/
+ssize_t ksBuilderAdd (KeySet * ks, Key * key);
+ssize_t ksBuilderFinish (KeySet * ks);
+
+/*Private helper for storing the OPMPHM of keysets*/
+const Opmphm * elektraKsGetOpmphm (KeySet * ks);
+int elektraKsSetOpmphm (KeySet * ks, Opmphm * opmphm);
+
 ssize_t ksRename (KeySet * ks, const Key * root, const Key * newRoot);
 
 elektraCursor ksFindHierarchy (const KeySet * ks, const Key * root, elektraCursor * end);
@@ -503,6 +621,7 @@ elektraNamespace elektraReadNamespace (const char * namespaceStr, size_t len);
 
 bool elektraKeyNameValidate (const char * name, bool isComplete);
 void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_t * canonicalSizePtr, size_t offset, size_t * usizePtr);
+size_t elektraKeyNameCanonicalizeInto (const char * name, char * canonicalName, size_t offset, size_t * usizePtr);
 void elektraKeyNameUnescape (const char * name, char * unescapedName);
 size_t elektraKeyNameEscapePart (const char * part, char ** escapedPart);
 
@@ -526,6 +645,37 @@ int elektraIsArrayPart (const char * namePart);
 extern "C" {
 #endif
 
+/**
+ * A value of the key index, see elektraBuildKeyIndex().
+ */
+typedef struct _ElektraIndexedValue
+{
+	const char * name;
+	const char * type;
+	/**
+	 * NULL, if the key is missing, has the wrong type or could not be converted.
+	 * The getters fall back to the lookup by name then, which reports the error.
+	 */
+	const Key * key;
+	union {
+		const char * stringValue;
+		kdb_boolean_t booleanValue;
+		kdb_char_t charValue;
+		kdb_octet_t octetValue;
+		kdb_short_t shortValue;
+		kdb_unsigned_short_t unsignedShortValue;
+		kdb_long_t longValue;
+		kdb_unsigned_long_t unsignedLongValue;
+		kdb_long_long_t longLongValue;
+		kdb_unsigned_long_long_t unsignedLongLongValue;
+		kdb_float_t floatValue;
+		kdb_double_t doubleValue;
+#ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
+		kdb_long_double_t longDoubleValue;
+#endif
+	} value;
+} ElektraIndexedValue;
+
 struct _Elektra
 {
 	KDB * kdb;
@@ -536,6 +686,9 @@ struct _Elektra
 	ElektraErrorHandler fatalErrorHandler;
 	char * resolvedReference;
 	size_t parentKeyLength;
+	ElektraIndexedValue * index;
+	size_t indexSize;
+	kdb_boolean_t indexValid; ///< cleared when the config changes
 };
 
 struct _ElektraError
@@ -25,6 +25,8 @@
  *                                    (e.g. ELEKTRA_TYPE_NEGATIVE_PRE_CHECK).
  * @param  PRE_CHECK_FAIL_BLOCK       optional, defaults to logging a warning in the key. The code to be executed (before returning 0), if
  *                                    PRE_CHECK_CONVERSION evaluates to false.
+ * @param  CACHED_KDB_TYPE            optional. The name of the type (e.g. "long"), under which a value cached with
+ *                                    elektraKeySetTypedValue() is returned instead of converting the string again.
  * @param  DISABLE_UNDEF_PARAMETERS   define to disable undefining of parameters after the macro. Use if parameters
  *                                    are used within another supermacro.
  * @param  CODE_ONLY           optional, defaults to 0. Set to 1 to only generate the function body. This is useful, if you want to create a
@@ -121,6 +123,12 @@
  */
 TYPE_CONVERSION_SIGNATURE (TYPE, TYPE_NAME, NAME_MACRO)
 {
+#endif
+#ifdef CACHED_KDB_TYPE
+	if (elektraKeyGetTypedValue (KEY_PARAM_NAME, CACHED_KDB_TYPE, VARIABLE_PARAM_NAME, sizeof (TYPE)) == 1)
+	{
+		return 1;
+	}
 #endif
 	char * end ELEKTRA_UNUSED;
 	const char * string = keyValue (KEY_PARAM_NAME);
@@ -161,6 +169,7 @@ TYPE_CONVERSION_SIGNATURE (TYPE, TYPE_NAME, NAME_MACRO)
 #undef PRE_CHECK_CONVERSION
 #undef PRE_CHECK_FAIL_BLOCK
 #undef CHECK_FAIL_BLOCK
+#undef CACHED_KDB_TYPE
 #undef CODE_ONLY
 #undef KEY_PARAM_NAME
 #undef VARIABLE_PARAM_NAME
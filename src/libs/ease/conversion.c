@@ -8,6 +8,7 @@
 
 #include "kdbease.h"
 #include "kdbhelper.h"
+#include "kdbprivate.h"
 #include <ctype.h>
 #include <errno.h>
 #include <stdint.h>
@@ -69,6 +70,7 @@ int elektraKeyToBoolean (const Key * key ELEKTRA_UNUSED, kdb_boolean_t * variabl
 #define TYPE_NAME Boolean
 #define TYPE kdb_boolean_t
 #define KDB_TYPE KDB_TYPE_BOOLEAN
+#define CACHED_KDB_TYPE "boolean"
 #define PRE_CHECK_CONVERSION ((string[0] == '0' || string[0] == '1') && string[1] == '\0')
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_FAIL_BLOCK
@@ -100,6 +102,7 @@ int elektraKeyToChar (const Key * key ELEKTRA_UNUSED, kdb_char_t * variable ELEK
 #define TYPE_NAME Char
 #define TYPE kdb_char_t
 #define KDB_TYPE KDB_TYPE_CHAR
+#define CACHED_KDB_TYPE "char"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_FAIL_BLOCK
 #define TO_VALUE (string[0])
@@ -130,6 +133,7 @@ int elektraKeyToOctet (const Key * key ELEKTRA_UNUSED, kdb_octet_t * variable EL
 #define TYPE_NAME Octet
 #define TYPE kdb_octet_t
 #define KDB_TYPE KDB_TYPE_OCTET
+#define CACHED_KDB_TYPE "octet"
 #define PRE_CHECK_BLOCK ELEKTRA_TYPE_NEGATIVE_PRE_CHECK_BLOCK
 #define PRE_CHECK_CONVERSION (ELEKTRA_TYPE_NEGATIVE_PRE_CHECK)
 #define PRE_CHECK_FAIL_BLOCK
@@ -164,6 +168,7 @@ int elektraKeyToShort (const Key * key ELEKTRA_UNUSED, kdb_short_t * variable EL
 #define TYPE_NAME Short
 #define TYPE kdb_short_t
 #define KDB_TYPE KDB_TYPE_SHORT
+#define CACHED_KDB_TYPE "short"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_CONVERSION ELEKTRA_TYPE_CHECK_CONVERSION_RANGE (value <= INT16_MAX && value >= INT16_MIN)
 #define CHECK_FAIL_BLOCK
@@ -196,6 +201,7 @@ int elektraKeyToUnsignedShort (const Key * key ELEKTRA_UNUSED, kdb_unsigned_shor
 #define TYPE_NAME UnsignedShort
 #define TYPE kdb_unsigned_short_t
 #define KDB_TYPE KDB_TYPE_UNSIGNED_SHORT
+#define CACHED_KDB_TYPE "unsigned_short"
 #define PRE_CHECK_BLOCK ELEKTRA_TYPE_NEGATIVE_PRE_CHECK_BLOCK
 #define PRE_CHECK_CONVERSION (ELEKTRA_TYPE_NEGATIVE_PRE_CHECK)
 #define PRE_CHECK_FAIL_BLOCK
@@ -230,6 +236,7 @@ int elektraKeyToLong (const Key * key ELEKTRA_UNUSED, kdb_long_t * variable ELEK
 #define TYPE_NAME Long
 #define TYPE kdb_long_t
 #define KDB_TYPE KDB_TYPE_LONG
+#define CACHED_KDB_TYPE "long"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_CONVERSION ELEKTRA_TYPE_CHECK_CONVERSION_RANGE (value <= INT32_MAX && value >= INT32_MIN)
 #define CHECK_FAIL_BLOCK
@@ -262,6 +269,7 @@ int elektraKeyToUnsignedLong (const Key * key ELEKTRA_UNUSED, kdb_unsigned_long_
 #define TYPE_NAME UnsignedLong
 #define TYPE kdb_unsigned_long_t
 #define KDB_TYPE KDB_TYPE_UNSIGNED_LONG
+#define CACHED_KDB_TYPE "unsigned_long"
 #define PRE_CHECK_BLOCK ELEKTRA_TYPE_NEGATIVE_PRE_CHECK_BLOCK
 #define PRE_CHECK_CONVERSION (ELEKTRA_TYPE_NEGATIVE_PRE_CHECK)
 #define PRE_CHECK_FAIL_BLOCK
@@ -296,6 +304,7 @@ int elektraKeyToLongLong (const Key * key ELEKTRA_UNUSED, kdb_long_long_t * vari
 #define TYPE_NAME LongLong
 #define TYPE kdb_long_long_t
 #define KDB_TYPE KDB_TYPE_LONG_LONG
+#define CACHED_KDB_TYPE "long_long"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_CONVERSION ELEKTRA_TYPE_CHECK_CONVERSION_RANGE (value <= INT64_MAX && value >= INT64_MIN)
 #define CHECK_FAIL_BLOCK
@@ -328,6 +337,7 @@ int elektraKeyToUnsignedLongLong (const Key * key ELEKTRA_UNUSED, kdb_unsigned_l
 #define TYPE_NAME UnsignedLongLong
 #define TYPE kdb_unsigned_long_long_t
 #define KDB_TYPE KDB_TYPE_UNSIGNED_LONG_LONG
+#define CACHED_KDB_TYPE "unsigned_long_long"
 #define PRE_CHECK_BLOCK ELEKTRA_TYPE_NEGATIVE_PRE_CHECK_BLOCK
 #define PRE_CHECK_CONVERSION (ELEKTRA_TYPE_NEGATIVE_PRE_CHECK)
 #define PRE_CHECK_FAIL_BLOCK
@@ -362,6 +372,7 @@ int elektraKeyToFloat (const Key * key ELEKTRA_UNUSED, kdb_float_t * variable EL
 #define TYPE_NAME Float
 #define TYPE kdb_float_t
 #define KDB_TYPE KDB_TYPE_FLOAT
+#define CACHED_KDB_TYPE "float"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_CONVERSION ELEKTRA_TYPE_CHECK_CONVERSION
 #define CHECK_FAIL_BLOCK
@@ -393,6 +404,7 @@ int elektraKeyToDouble (const Key * key ELEKTRA_UNUSED, kdb_double_t * variable
 #define TYPE_NAME Double
 #define TYPE kdb_double_t
 #define KDB_TYPE KDB_TYPE_DOUBLE
+#define CACHED_KDB_TYPE "double"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_CONVERSION ELEKTRA_TYPE_CHECK_CONVERSION
 #define CHECK_FAIL_BLOCK
@@ -426,6 +438,7 @@ int elektraKeyToLongDouble (const Key * key ELEKTRA_UNUSED, kdb_long_double_t *
 #define TYPE_NAME LongDouble
 #define TYPE kdb_long_double_t
 #define KDB_TYPE KDB_TYPE_LONG_DOUBLE
+#define CACHED_KDB_TYPE "long_double"
 #define PRE_CHECK_FAIL_BLOCK
 #define CHECK_CONVERSION ELEKTRA_TYPE_CHECK_CONVERSION
 #define CHECK_FAIL_BLOCK
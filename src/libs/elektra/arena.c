@@ -0,0 +1,340 @@
+/**
+ * @file
+ *
+ * @brief Arena backed KeySets
+ *
+ * Keys created with ksArenaKeyNew() are bump-allocated together with their
+ * name and value in the arena of the KeySet. Instead of freeing every Key on
+ * its own, the whole arena is released at once by ksDel().
+ *
+ * Keys that outlive the KeySet keep the arena alive, the arena is only freed
+ * when the KeySet and all of its Keys have been deleted.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifdef HAVE_KDBCONFIG_H
+#include "kdbconfig.h"
+#endif
+
+#include <stddef.h>
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include "kdb.h"
+#include "kdbprivate.h"
+#include <kdbassert.h>
+
+/** the size of the first block, if ksNewArena() got no hint */
+#define ELEKTRA_ARENA_MIN_BLOCK_SIZE 4096
+/** blocks do not grow beyond this size, bigger allocations get their own block */
+#define ELEKTRA_ARENA_MAX_BLOCK_SIZE (1024 * 1024)
+/** rough estimate of the size of the names and value of a Key, used to size the first block */
+#define ELEKTRA_ARENA_KEY_DATA_ESTIMATE 64
+
+typedef union
+{
+	void * p;
+	size_t s;
+	kdb_long_long_t l;
+	double d;
+} ElektraArenaAlign;
+
+#define ELEKTRA_ARENA_ALIGNMENT sizeof (ElektraArenaAlign)
+
+typedef struct _ElektraArenaBlock
+{
+	struct _ElektraArenaBlock * next;
+	ElektraArenaAlign data[];
+} ElektraArenaBlock;
+
+struct _ElektraArena
+{
+	ElektraArenaBlock * blocks; /*!< all blocks, the current one first */
+	char * next;		    /*!< next free byte in the current block */
+	char * end;		    /*!< end of the current block */
+	size_t blockSize;	    /*!< size of the current block */
+
+	size_t refs; /*!< the KeySet plus all Keys that were not deleted yet */
+
+	char * nameBuffer; /*!< scratch buffer for canonicalizing names */
+	size_t nameBufferSize;
+};
+
+/**
+ * Header in front of every Key allocated in an arena,
+ * needed to find the arena again in keyDel().
+ */
+typedef struct
+{
+	ElektraArena * arena;
+	Key key;
+} ElektraArenaKey;
+
+static ElektraArenaKey * arenaKeyOf (const Key * key)
+{
+	return (ElektraArenaKey *) ((char *) key - offsetof (ElektraArenaKey, key));
+}
+
+static bool arenaAddBlock (ElektraArena * arena, size_t minSize)
+{
+	size_t size = arena->blockSize;
+	if (arena->blocks != NULL && size < ELEKTRA_ARENA_MAX_BLOCK_SIZE)
+	{
+		size *= 2;
+	}
+	if (size < minSize)
+	{
+		size = minSize;
+	}
+
+	ElektraArenaBlock * block = elektraMalloc (sizeof (ElektraArenaBlock) + size);
+	if (block == NULL)
+	{
+		return false;
+	}
+
+	block->next = arena->blocks;
+	arena->blocks = block;
+	arena->next = (char *) block->data;
+	arena->end = arena->next + size;
+	arena->blockSize = size;
+	return true;
+}
+
+/**
+ * @brief Bump-allocates @p size bytes in @p arena
+ *
+ * @param alignment must be 1 or ELEKTRA_ARENA_ALIGNMENT
+ *
+ * @return the new memory, it must not be freed
+ * @retval NULL on memory errors
+ */
+static void * arenaAlloc (ElektraArena * arena, size_t size, size_t alignment)
+{
+	size_t padding = (alignment - ((uintptr_t) arena->next % alignment)) % alignment;
+	if (arena->next == NULL || (size_t) (arena->end - arena->next) < padding + size)
+	{
+		if (!arenaAddBlock (arena, size))
+		{
+			return NULL;
+		}
+		padding = 0;
+	}
+
+	void * result = arena->next + padding;
+	arena->next += padding + size;
+	return result;
+}
+
+static ElektraArena * arenaNew (size_t alloc)
+{
+	ElektraArena * arena = elektraCalloc (sizeof (ElektraArena));
+	if (arena == NULL)
+	{
+		return NULL;
+	}
+
+	size_t blockSize = alloc * (sizeof (ElektraArenaKey) + ELEKTRA_ARENA_KEY_DATA_ESTIMATE);
+	if (blockSize < ELEKTRA_ARENA_MIN_BLOCK_SIZE)
+	{
+		blockSize = ELEKTRA_ARENA_MIN_BLOCK_SIZE;
+	}
+	if (blockSize > ELEKTRA_ARENA_MAX_BLOCK_SIZE)
+	{
+		blockSize = ELEKTRA_ARENA_MAX_BLOCK_SIZE;
+	}
+	arena->blockSize = blockSize;
+	arena->refs = 1;
+	return arena;
+}
+
+/**
+ * @internal
+ *
+ * @brief Drops one reference to @p arena and frees it, once no KeySet and no Key uses it anymore
+ *
+ * @param arena the arena to release, may be NULL
+ */
+void elektraArenaRelease (ElektraArena * arena)
+{
+	if (arena == NULL || --arena->refs > 0)
+	{
+		return;
+	}
+
+	ElektraArenaBlock * block = arena->blocks;
+	while (block != NULL)
+	{
+		ElektraArenaBlock * next = block->next;
+		elektraFree (block);
+		block = next;
+	}
+	elektraFree (arena->nameBuffer);
+	elektraFree (arena);
+}
+
+/**
+ * @internal
+ *
+ * @brief Releases the arena of @p key, called by keyDel() instead of freeing the Key
+ *
+ * @pre @p key has KEY_FLAG_ARENA set and was otherwise already cleaned up by keyDel()
+ */
+void elektraArenaReleaseKey (Key * key)
+{
+	ELEKTRA_ASSERT (test_bit (key->flags, KEY_FLAG_ARENA), "key is not in an arena");
+	elektraArenaRelease (arenaKeyOf (key)->arena);
+}
+
+/**
+ * @internal
+ *
+ * @brief Copy-on-write detachment of Keys leaving their arena KeySet
+ *
+ * If @p key was created in an arena, which is not the arena of @p ks, its name and
+ * value are copied out of the arena. Afterwards the Key behaves like any Key created
+ * with keyNew(), only the Key struct itself stays in the arena and keeps it alive.
+ *
+ * Called by ksAppendKey() for every Key with KEY_FLAG_ARENA.
+ *
+ * @param ks the KeySet the Key gets appended to
+ * @param key the Key to detach
+ */
+void elektraArenaDetachKey (const KeySet * ks, Key * key)
+{
+	if (!test_bit (key->flags, KEY_FLAG_ARENA) || arenaKeyOf (key)->arena == ks->arena)
+	{
+		return;
+	}
+
+	if (test_bit (key->flags, KEY_FLAG_MMAP_KEY))
+	{
+		key->key = elektraMemDup (key->key, key->keySize);
+		key->ukey = elektraMemDup (key->ukey, key->keyUSize);
+		clear_bit (key->flags, (keyflag_t) KEY_FLAG_MMAP_KEY);
+	}
+
+	if (test_bit (key->flags, KEY_FLAG_MMAP_DATA))
+	{
+		key->data.v = elektraMemDup (key->data.v, key->dataSize);
+		clear_bit (key->flags, (keyflag_t) KEY_FLAG_MMAP_DATA);
+	}
+}
+
+/**
+ * @brief Creates a new KeySet with an arena for its Keys
+ *
+ * The returned KeySet works like any KeySet created with ksNew().
+ * Additionally, Keys can be created directly in its arena with ksArenaKeyNew().
+ * Such Keys (including their name and value) are bump-allocated and ksDel()
+ * releases them all at once, instead of freeing every Key on its own.
+ *
+ * If a Key of the arena is appended to another KeySet, its name and value
+ * get copied out of the arena (see elektraArenaDetachKey()).
+ * Changing the name or value of a Key of the arena also moves them out of the arena.
+ * The memory of the arena is freed once the KeySet and all Keys created in
+ * the arena have been deleted.
+ *
+ * Use arena KeySets for many Keys with the same lifetime, e.g. a KeySet
+ * a storage plugin fills in a single kdbGet().
+ *
+ * @param alloc gives a hint for how many Keys will be created in the arena
+ *
+ * @return a new KeySet with an arena, free it with ksDel()
+ * @retval NULL on memory errors
+ *
+ * @see ksArenaKeyNew() for creating Keys in the arena
+ */
+KeySet * ksNewArena (size_t alloc)
+{
+	KeySet * ks = ksNew (alloc, KS_END);
+	if (ks == NULL)
+	{
+		return NULL;
+	}
+
+	ks->arena = arenaNew (alloc);
+	if (ks->arena == NULL)
+	{
+		ksDel (ks);
+		return NULL;
+	}
+
+	return ks;
+}
+
+/**
+ * @brief Creates a new Key in the arena of @p ks and appends it to @p ks
+ *
+ * Name and value are stored in the arena as well.
+ * The value is set like with keySetRaw(), i.e. string values must include
+ * the terminating null byte and binary Keys additionally need the
+ * metadata `binary`.
+ *
+ * If @p ks was not created by ksNewArena(), a regular Key is created instead.
+ *
+ * @param ks the KeySet to create the Key in
+ * @param name a valid name for the Key (see keySetName())
+ * @param value the value of the Key, may be NULL
+ * @param valueSize the size of @p value in bytes
+ *
+ * @return the new Key, it is owned by @p ks, like after ksAppendKey()
+ * @retval NULL if @p ks or @p name is NULL, @p name is invalid or on memory errors
+ */
+Key * ksArenaKeyNew (KeySet * ks, const char * name, const void * value, size_t valueSize)
+{
+	if (ks == NULL || name == NULL) return NULL;
+
+	if (ks->arena == NULL)
+	{
+		Key * key = keyNew (name, KEY_END);
+		if (key == NULL) return NULL;
+		keySetRaw (key, value, valueSize);
+		return ksAppendKey (ks, key) < 0 ? NULL : key;
+	}
+
+	if (strlen (name) == 0 || !elektraKeyNameValidate (name, true)) return NULL;
+
+	ElektraArena * arena = ks->arena;
+	ElektraArenaKey * arenaKey = arenaAlloc (arena, sizeof (ElektraArenaKey), ELEKTRA_ARENA_ALIGNMENT);
+	if (arenaKey == NULL) return NULL;
+
+	Key * key = &arenaKey->key;
+	keyInit (key);
+	arenaKey->arena = arena;
+
+	size_t keySize = arena->nameBufferSize;
+	size_t keyUSize = 0;
+	elektraKeyNameCanonicalize (name, &arena->nameBuffer, &keySize, 0, &keyUSize);
+	arena->nameBufferSize = keySize;
+
+	key->key = arenaAlloc (arena, keySize, 1);
+	key->ukey = arenaAlloc (arena, keyUSize, 1);
+	if (key->key == NULL || key->ukey == NULL) return NULL;
+	memcpy (key->key, arena->nameBuffer, keySize);
+	key->keySize = keySize;
+	elektraKeyNameUnescape (key->key, key->ukey);
+	key->keyUSize = keyUSize;
+
+	if (value != NULL && valueSize > 0)
+	{
+		key->data.v = arenaAlloc (arena, valueSize, 1);
+		if (key->data.v == NULL) return NULL;
+		memcpy (key->data.v, value, valueSize);
+		key->dataSize = valueSize;
+		set_bit (key->flags, KEY_FLAG_MMAP_DATA);
+	}
+
+	set_bit (key->flags, KEY_FLAG_SYNC | KEY_FLAG_ARENA | KEY_FLAG_MMAP_KEY);
+	++arena->refs;
+
+	if (ksAppendKey (ks, key) < 0)
+	{
+		// ksAppendKey() already released the key
+		return NULL;
+	}
+	return key;
+}
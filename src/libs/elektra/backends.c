@@ -9,36 +9,238 @@
 #include <kdb.h>
 #include <kdbprivate.h>
 #include <stdlib.h>
+#include <string.h>
 
-Key * backendsFindParent (KeySet * backends, const Key * key)
+/**
+ * A node of the mountpoint index, one for each part of an unescaped mountpoint name.
+ *
+ * The children are sorted by their part, so they can be searched with a binary search.
+ */
+typedef struct _BackendsIndexNode
+{
+	const char * part; /*!< points into the unescaped name of a mountpoint Key, the Key must outlive the index */
+	Key * backendKey;  /*!< the mountpoint Key of this node, NULL if there is no mountpoint here */
+	struct _BackendsIndexNode * children;
+	size_t childCount;
+	size_t childAlloc;
+} BackendsIndexNode;
+
+/**
+ * Trie over the parts of the unescaped names of all mountpoints.
+ *
+ * Resolving the mountpoint of a Key is a longest-prefix match along the parts of its
+ * unescaped name: O(m*log(c)) for m parts and c mountpoints below a single part.
+ * Nothing is allocated and the name of the Key is never copied.
+ */
+struct _BackendsIndex
+{
+	BackendsIndexNode roots[KEY_NS_DEFAULT + 1]; // indexed by namespace, KEY_NS_DEFAULT is the last one
+	Key * defaultBackendKey;
+};
+
+static BackendsIndexNode * findChild (const BackendsIndexNode * node, const char * part, size_t * insertPos)
+{
+	size_t left = 0;
+	size_t right = node->childCount;
+	while (left < right)
+	{
+		size_t middle = left + (right - left) / 2;
+		int cmp = strcmp (part, node->children[middle].part);
+		if (cmp == 0)
+		{
+			return &node->children[middle];
+		}
+		if (cmp < 0)
+		{
+			right = middle;
+		}
+		else
+		{
+			left = middle + 1;
+		}
+	}
+	if (insertPos != NULL) *insertPos = left;
+	return NULL;
+}
+
+static BackendsIndexNode * addChild (BackendsIndexNode * node, const char * part)
+{
+	size_t insertPos;
+	BackendsIndexNode * child = findChild (node, part, &insertPos);
+	if (child != NULL)
+	{
+		return child;
+	}
+
+	if (node->childCount == node->childAlloc)
+	{
+		size_t alloc = node->childAlloc == 0 ? 4 : 2 * node->childAlloc;
+		if (elektraRealloc ((void **) &node->children, alloc * sizeof (BackendsIndexNode)) == -1)
+		{
+			return NULL;
+		}
+		node->childAlloc = alloc;
+	}
+
+	memmove (&node->children[insertPos + 1], &node->children[insertPos], (node->childCount - insertPos) * sizeof (BackendsIndexNode));
+	++node->childCount;
+
+	child = &node->children[insertPos];
+	memset (child, 0, sizeof (BackendsIndexNode));
+	child->part = part;
+	return child;
+}
+
+static void deleteChildren (BackendsIndexNode * node)
+{
+	for (size_t i = 0; i < node->childCount; ++i)
+	{
+		deleteChildren (&node->children[i]);
+	}
+	elektraFree (node->children);
+}
+
+/**
+ * Builds the mountpoint index for @p backends.
+ *
+ * The index refers to the Keys in @p backends, it must be deleted with
+ * backendsIndexDel() before they are removed from @p backends.
+ *
+ * @param backends the backends KeySet of a KDB instance
+ *
+ * @return a new index, free it with backendsIndexDel()
+ * @retval NULL on memory errors
+ */
+BackendsIndex * backendsIndexNew (KeySet * backends)
+{
+	BackendsIndex * index = elektraCalloc (sizeof (BackendsIndex));
+	if (index == NULL) return NULL;
+
+	for (elektraCursor i = 0; i < ksGetSize (backends); ++i)
+	{
+		Key * backendKey = ksAtCursor (backends, i);
+		const char * name = (const char *) keyUnescapedName (backendKey);
+		size_t size = keyGetUnescapedNameSize (backendKey);
+
+		BackendsIndexNode * node = &index->roots[(unsigned char) name[0]];
+		// the root of a namespace (size 3) has no parts
+		for (size_t pos = 2; size > 3 && pos < size; pos += strlen (name + pos) + 1)
+		{
+			node = addChild (node, name + pos);
+			if (node == NULL)
+			{
+				backendsIndexDel (index);
+				return NULL;
+			}
+		}
+		node->backendKey = backendKey;
+	}
+
+	index->defaultBackendKey = index->roots[KEY_NS_DEFAULT].backendKey;
+	return index;
+}
+
+/**
+ * Frees an index created by backendsIndexNew()
+ *
+ * @param index the index to free, may be NULL
+ */
+void backendsIndexDel (BackendsIndex * index)
 {
+	if (index == NULL) return;
+
+	for (elektraNamespace ns = KEY_NS_NONE; ns <= KEY_NS_DEFAULT; ++ns)
+	{
+		deleteChildren (&index->roots[ns]);
+	}
+	elektraFree (index);
+}
+
+static Key * indexFindParent (const BackendsIndex * index, const Key * key)
+{
+	const char * name = (const char *) keyUnescapedName (key);
+	size_t size = keyGetUnescapedNameSize (key);
+
+	const BackendsIndexNode * node = &index->roots[(unsigned char) name[0]];
+	Key * parent = node->backendKey;
+	for (size_t pos = 2; size > 3 && pos < size; pos += strlen (name + pos) + 1)
+	{
+		node = findChild (node, name + pos, NULL);
+		if (node == NULL) break;
+		if (node->backendKey != NULL) parent = node->backendKey;
+	}
+
+	return parent != NULL ? parent : index->defaultBackendKey;
+}
+
+/**
+ * Looks up the root Key of namespace @p ns in @p backends, without allocating a search Key.
+ */
+static Key * lookupRoot (KeySet * backends, elektraNamespace ns)
+{
+	char name[] = { ns, '\0', '\0' };
+	Key search;
+	keyInit (&search);
+	search.ukey = name;
+	search.keyUSize = sizeof (name);
+
+	ssize_t found = ksSearch (backends, &search);
+	return found < 0 ? NULL : ksAtCursor (backends, found);
+}
+
+/**
+ * Finds the backend responsible for @p key.
+ *
+ * This is the backend with the longest mountpoint that is the same as or above @p key.
+ * If there is none, the backend for `default:/` is returned.
+ *
+ * @param backends the backends to search, may be a subset of the backends of a KDB instance
+ * @param index the index of @p backends created by backendsIndexNew(),
+ *              or NULL to search @p backends directly (e.g. for subsets)
+ * @param key the Key to find the backend for
+ *
+ * @return the mountpoint Key of the backend
+ * @retval NULL if there is no backend for @p key and no `default:/` backend
+ */
+Key * backendsFindParent (KeySet * backends, const BackendsIndex * index, const Key * key)
+{
+	if (index != NULL)
+	{
+		return indexFindParent (index, key);
+	}
+
 	/* Note on runtime:
-	   m = number of parts in key, n = size of backends, k = length of name of key
+	   m = number of parts in key, n = size of backends
 
-	   This function has a runtime of O(m) if backends uses the hashmap, and O(m*log(n)) otherwise.
-	   The old trie solution had a runtime of O(k).
-	   We expect k > m*log(n) in most cases.
+	   Without the index this has a runtime of O(m*log(n)). It searches with a Key on the stack,
+	   which shares the unescaped name of key and is cut back one part at a time.
 	*/
-
-	Key * lookup = keyDup (key, KEY_CP_NAME);
-	while (keyGetUnescapedNameSize (lookup) > 3)
+	Key search;
+	keyInit (&search);
+	search.ukey = key->ukey;
+	search.keyUSize = key->keyUSize;
+	while (search.keyUSize > 3)
 	{
-		Key * parent = ksLookup (backends, lookup, 0);
-		if (parent != NULL)
+		ssize_t found = ksSearch (backends, &search);
+		if (found >= 0)
+		{
+			return ksAtCursor (backends, found);
+		}
+
+		size_t end = search.keyUSize - 2;
+		while (end > 1 && search.ukey[end] != '\0')
 		{
-			keyDel (lookup);
-			return parent;
+			--end;
 		}
-		keySetBaseName (lookup, NULL);
+		search.keyUSize = end + 1;
 	}
 
 	// lookup root key or fallback to default:/
-	Key * parent = ksLookup (backends, lookup, 0);
-	keyDel (lookup);
-	return parent != NULL ? parent : ksLookupByName (backends, "default:/", 0);
+	Key * parent = lookupRoot (backends, keyGetNamespace (key));
+	return parent != NULL ? parent : lookupRoot (backends, KEY_NS_DEFAULT);
 }
 
-KeySet * backendsForParentKey (KeySet * backends, Key * parentKey)
+KeySet * backendsForParentKey (KeySet * backends, const BackendsIndex * index, Key * parentKey)
 {
 	KeySet * selected = ksBelow (backends, parentKey);
 	if (keyGetNamespace (parentKey) == KEY_NS_CASCADING)
@@ -54,7 +256,7 @@ KeySet * backendsForParentKey (KeySet * backends, Key * parentKey)
 			case KEY_NS_SPEC:
 			case KEY_NS_DEFAULT:
 				keySetNamespace (parentKey, ns);
-				ksAppendKey (selected, backendsFindParent (backends, parentKey));
+				ksAppendKey (selected, backendsFindParent (backends, index, parentKey));
 				break;
 			case KEY_NS_META:
 			case KEY_NS_NONE:
@@ -66,15 +268,15 @@ KeySet * backendsForParentKey (KeySet * backends, Key * parentKey)
 	}
 	else
 	{
-		ksAppendKey (selected, backendsFindParent (backends, parentKey));
+		ksAppendKey (selected, backendsFindParent (backends, index, parentKey));
 	}
-	ksAppendKey (selected, ksLookupByName (backends, "default:/", 0));
+	ksAppendKey (selected, index != NULL ? index->defaultBackendKey : lookupRoot (backends, KEY_NS_DEFAULT));
 	return selected;
 }
 
-static elektraCursor backendsDivideInternal (KeySet * backends, elektraCursor * curBackend, const KeySet * ks, elektraCursor cur)
+static elektraCursor backendsDivideInternal (KeySet * backends, Key * defaultBackendKey, elektraCursor * curBackend, const KeySet * ks,
+					     elektraCursor cur)
 {
-	Key * defaultBackendKey = ksLookupByName (backends, "default:/", 0);
 	if (defaultBackendKey == NULL && *curBackend < 0)
 	{
 		// happens during bootstrap
@@ -104,7 +306,7 @@ static elektraCursor backendsDivideInternal (KeySet * backends, elektraCursor *
 		else if (nextBackendKey != NULL && keyCmp (k, nextBackendKey) >= 0)
 		{
 			++*curBackend;
-			cur = backendsDivideInternal (backends, curBackend, ks, cur);
+			cur = backendsDivideInternal (backends, defaultBackendKey, curBackend, ks, cur);
 			continue;
 		}
 		else if (*curBackend < 0 || keyIsBelowOrSame (backendKey, k) == 1)
@@ -141,7 +343,7 @@ bool backendsDivide (KeySet * backends, const KeySet * ks)
 
 
 	elektraCursor curBackend = -1;
-	elektraCursor ret = backendsDivideInternal (backends, &curBackend, ks, 0);
+	elektraCursor ret = backendsDivideInternal (backends, lookupRoot (backends, KEY_NS_DEFAULT), &curBackend, ks, 0);
 	return ret == ksGetSize (ks);
 }
 
@@ -7,6 +7,7 @@
  */
 
 #include <kdberrors.h>
+#include <kdbprivate.h>
 
 #include <string.h>
 
@@ -33,15 +34,20 @@ using namespace ckdb;
 #define ELEKTRA_ERROR_CODE_VALIDATION_SEMANTIC "C03200"
 #define ELEKTRA_ERROR_CODE_VALIDATION_SEMANTIC_NAME "Validation Semantic"
 
-static void addWarning (Key * key, const char * code, const char * name, const char * file, const char * line, const char * module,
-			const char * reasonFmt, va_list va)
+/**
+ * Adds a new, empty warning to the metadata of @p key.
+ *
+ * Only the next 100 warnings are kept, older warnings are overwritten.
+ *
+ * @param key the key the warning is added to
+ * @param buffer receives the name of the new warning, e.g. `warnings/#0`,
+ *               must have room for at least #ELEKTRA_WARNING_NAME_SIZE characters
+ *
+ * @return a pointer to the end of the name in @p buffer, to append the names of the fields of the warning
+ */
+char * elektraAddWarningName (Key * key, char * buffer)
 {
-	if (key == NULL)
-	{
-		return;
-	}
-
-	char buffer[64] = "warnings/#0\0\0\0";
+	strcpy (buffer, "warnings/#0");
 	const Key * meta = keyGetMeta (key, "warnings");
 	const char * old = meta == NULL ? NULL : keyString (meta);
 	char * end = &buffer[11];
@@ -62,8 +68,22 @@ static void addWarning (Key * key, const char * code, const char * name, const c
 			buffer[12] = '0' + (i % 10);
 			end = &buffer[13];
 		}
+		*end = '\0';
 	}
 	keySetMeta (key, "warnings", &buffer[9]);
+	return end;
+}
+
+static void addWarning (Key * key, const char * code, const char * name, const char * file, const char * line, const char * module,
+			const char * reasonFmt, va_list va)
+{
+	if (key == NULL)
+	{
+		return;
+	}
+
+	char buffer[ELEKTRA_WARNING_NAME_SIZE];
+	char * end = elektraAddWarningName (key, buffer);
 
 	keySetMeta (key, buffer, "number description  module file line mountpoint configfile reason");
 	strcpy (end, "/number");
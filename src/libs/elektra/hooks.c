@@ -50,6 +50,14 @@ void freeHooks (KDB * kdb, Key * errorKey)
 
 		kdb->hooks.sendNotification = NULL;
 	}
+
+	if (kdb->hooks.cache.plugin != NULL)
+	{
+		elektraPluginClose (kdb->hooks.cache.plugin, errorKey);
+		kdb->hooks.cache.plugin = NULL;
+		kdb->hooks.cache.get = NULL;
+		kdb->hooks.cache.set = NULL;
+	}
 }
 
 static size_t getFunction (Plugin * plugin, const char * functionName, Key * errorKey)
@@ -103,6 +111,30 @@ static int initHooksSpec (KDB * kdb, Plugin * plugin, Key * errorKey)
 	return 0;
 }
 
+static int initHooksCache (KDB * kdb, Plugin * plugin, Key * errorKey)
+{
+	if (!plugin)
+	{
+		return -1;
+	}
+
+	kdb->hooks.cache.plugin = plugin;
+
+	kdb->hooks.cache.get = (kdbHookCacheGetPtr) getFunction (plugin, "hook/cache/get", errorKey);
+	kdb->hooks.cache.set = (kdbHookCacheSetPtr) getFunction (plugin, "hook/cache/set", errorKey);
+
+	if (kdb->hooks.cache.get == NULL || kdb->hooks.cache.set == NULL)
+	{
+		elektraPluginClose (plugin, errorKey);
+		kdb->hooks.cache.plugin = NULL;
+		kdb->hooks.cache.get = NULL;
+		kdb->hooks.cache.set = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
 static KeySet * getSendNotificationHooksEnforcedByContract (const KeySet * contract)
 {
 	KeySet * returned = ksNew (0, KS_END);
@@ -298,6 +330,37 @@ static bool isGoptsEnabledByContract (const KeySet * contract)
 	return isEnabled;
 }
 
+/**
+ * The cache is used, if either `system:/elektra/cache/enabled` is set to `1` (see `kdb cache enable`),
+ * or the contract contains `system:/elektra/contract/mountglobal/cache`.
+ * Setting `system:/elektra/cache/enabled` to `0` (see `kdb cache disable`) always disables the cache.
+ */
+static bool isCacheEnabled (const KeySet * config, const KeySet * contract)
+{
+	KeySet * dupConfig = ksDup (config);
+	Key * enabledKey = ksLookupByName (dupConfig, KDB_CACHE_PREFIX "/enabled", 0);
+	const char * enabled = enabledKey == NULL ? NULL : keyString (enabledKey);
+
+	bool isEnabled;
+	if (enabled != NULL && strcmp (enabled, "0") == 0)
+	{
+		isEnabled = false;
+	}
+	else if (enabled != NULL && strcmp (enabled, "1") == 0)
+	{
+		isEnabled = true;
+	}
+	else
+	{
+		KeySet * dupContract = ksDup (contract);
+		isEnabled = ksLookupByName (dupContract, "system:/elektra/contract/mountglobal/cache", 0) != NULL;
+		ksDel (dupContract);
+	}
+
+	ksDel (dupConfig);
+	return isEnabled;
+}
+
 static bool isSpecEnabledByConfig (const KeySet * config ELEKTRA_UNUSED)
 {
 	// TODO: check for system:/elektra/hook/spec/enabled or system:/elektra/hook/spec/disabled or something else ... TBD
@@ -370,6 +433,13 @@ int initHooks (KDB * kdb, const KeySet * config, KeySet * modules, const KeySet
 		goto error;
 	}
 
+	// the cache is only an optimization, so failing to load it is not an error
+	if (isCacheEnabled (config, contract) &&
+	    initHooksCache (kdb, loadPlugin ("cache", kdb->global, modules, contract, errorKey), errorKey) != 0)
+	{
+		ELEKTRA_ADD_INSTALLATION_WARNING (errorKey, "The cache is enabled, but the cache hook could not be initialized");
+	}
+
 	if (!existingError)
 	{
 		// remove dummy error again
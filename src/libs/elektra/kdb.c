@@ -16,6 +16,7 @@
 #endif
 
 #include <kdbassert.h>
+#include <inttypes.h>
 
 #ifdef HAVE_LOCALE_H
 #include <locale.h>
@@ -45,6 +46,14 @@
 #include <errno.h>
 #endif
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 #include <kdbinternal.h>
 
 
@@ -169,6 +178,7 @@ static bool closeBackends (KeySet * backends, Key * errorKey)
 		ksDel (backendData->plugins);
 		ksDel (backendData->keys);
 		ksDel (backendData->definition);
+		ksDel (backendData->storedKeys);
 	}
 
 	ksDel (backends);
@@ -220,6 +230,72 @@ static void clearErrorAndWarnings (Key * key)
 	keyDel (cutRoot);
 }
 
+/**
+ * Copies the metadata @p srcRoot and everything below it from @p src to @p destRoot of @p dest
+ */
+static void copyMetaHierarchy (Key * dest, const char * destRoot, Key * src, const char * srcRoot)
+{
+	Key * root = keyNew (srcRoot, KEY_END);
+	size_t rootSize = strlen (keyName (root));
+
+	KeySet * meta = keyMeta (src);
+	elektraCursor end;
+	for (elektraCursor it = ksFindHierarchy (meta, root, &end); it < end; it++)
+	{
+		Key * cur = ksAtCursor (meta, it);
+		char * name = elektraFormat ("%s%s", destRoot, keyName (cur) + rootSize);
+		keySetMeta (dest, name, keyString (cur));
+		elektraFree (name);
+	}
+
+	keyDel (root);
+}
+
+/**
+ * Adds the metadata @p srcRoot of @p src as new warning to @p dest, see elektraAddWarningName()
+ */
+static void addWarningFrom (Key * dest, Key * src, const char * srcRoot)
+{
+	char buffer[ELEKTRA_WARNING_NAME_SIZE];
+	elektraAddWarningName (dest, buffer);
+	copyMetaHierarchy (dest, buffer, src, srcRoot);
+}
+
+/**
+ * Adds the error and all warnings of @p src to @p dest, as if they had been added to @p dest directly.
+ *
+ * If @p dest already has an error, the error of @p src becomes a warning.
+ */
+static void mergeErrorsAndWarnings (Key * dest, Key * src)
+{
+	Key * warningsRoot = keyNew ("meta:/warnings", KEY_END);
+	KeySet * warnings = ksBelow (keyMeta (src), warningsRoot);
+	for (elektraCursor i = 0; i < ksGetSize (warnings); i++)
+	{
+		Key * cur = ksAtCursor (warnings, i);
+		if (keyIsDirectlyBelow (warningsRoot, cur) == 1)
+		{
+			addWarningFrom (dest, src, keyName (cur));
+		}
+	}
+	ksDel (warnings);
+	keyDel (warningsRoot);
+
+	if (keyGetMeta (src, "meta:/error") == NULL)
+	{
+		return;
+	}
+
+	if (keyGetMeta (dest, "meta:/error") == NULL)
+	{
+		copyMetaHierarchy (dest, "meta:/error", src, "meta:/error");
+	}
+	else
+	{
+		addWarningFrom (dest, src, "meta:/error");
+	}
+}
+
 /**
  * Handles the system:/elektra/contract/globalkeyset part of kdbOpen() contracts
  *
@@ -244,17 +320,67 @@ static void ensureContractGlobalKs (KDB * handle, KeySet * contract)
 }
 
 
+/**
+ * Handles the system:/elektra/contract/parallel part of kdbOpen() contracts
+ *
+ * @see kdbOpen()
+ */
+static bool ensureContractParallel (KDB * handle, KeySet * contract, Key * errorKey)
+{
+	Key * parallelKey = ksLookupByName (contract, "system:/elektra/contract/parallel", 0);
+	if (parallelKey == NULL)
+	{
+		return true;
+	}
+
+	const char * value = keyString (parallelKey);
+	char * end;
+	errno = 0;
+	long long workers = strlen (value) == 0 ? 0 : strtoll (value, &end, 10);
+	if (errno != 0 || workers < 0 || (strlen (value) > 0 && *end != '\0'))
+	{
+		ELEKTRA_SET_INTERFACE_ERRORF (errorKey,
+					      "The value '%s' of 'system:/elektra/contract/parallel' is invalid. Use a positive number of "
+					      "threads or an empty value for one thread per processor.",
+					      value);
+		return false;
+	}
+
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+	if (workers == 0)
+	{
+		workers = sysconf (_SC_NPROCESSORS_ONLN);
+	}
+#endif
+
+#ifdef HAVE_PTHREAD
+	handle->getWorkers = workers > 1 ? (size_t) workers : 0;
+#else
+	(void) workers;
+	ELEKTRA_ADD_INSTALLATION_WARNING (errorKey, "Elektra was built without threads, kdbGet() will not run in parallel");
+	handle->getWorkers = 0;
+#endif
+
+	return true;
+}
+
 /**
  * Handles the @p contract argument of kdbOpen().
  *
  * @see kdbOpen()
  */
-static bool ensureContract (KDB * handle, const KeySet * contract)
+static bool ensureContract (KDB * handle, const KeySet * contract, Key * errorKey)
 {
 	// FIXME [new_backend]: tests needed
 	// deep dupContract, so modifications to the keys in contract after kdbOpen() cannot modify the contract
 	KeySet * dupContract = ksDeepDup (contract);
 
+	if (!ensureContractParallel (handle, dupContract, errorKey))
+	{
+		ksDel (dupContract);
+		return false;
+	}
+
 	ensureContractGlobalKs (handle, dupContract);
 
 	ksDel (dupContract);
@@ -312,6 +438,8 @@ static void addMountpoint (KeySet * backends, Key * mountpoint, Plugin * backend
 		.getSize = 0,
 		.initialized = false,
 		.keyNeedsSync = false,
+		.storedKeys = NULL,
+		.needsReload = false,
 	};
 	keySetBinary (mountpoint, &backendData, sizeof (backendData));
 	ksAppendKey (backends, mountpoint);
@@ -529,10 +657,41 @@ static bool addDupMountpoint (KeySet * mountpoints, Key * mountpoint, KeySet * p
 		return false;
 	}
 	Plugin * backendPlugin = *(Plugin **) keyValue (ksLookupByName (dupPlugins, "system:/backend", 0));
-	addMountpoint (mountpoints, keyDup (mountpoint, KEY_CP_NAME), backendPlugin, dupPlugins, ksDup (definition));
+	addMountpoint (mountpoints, keyDup (mountpoint, KEY_CP_NAME | KEY_CP_META), backendPlugin, dupPlugins, ksDup (definition));
 	return true;
 }
 
+/**
+ * Hashes the configuration of a mountpoint, i.e. the names and values of all keys below (and including) @p root.
+ *
+ * The cache hook stores the hash with every cache entry, so that entries written
+ * with a different configuration of the mountpoint are not used.
+ *
+ * @param elektraKs the KeySet containing the mountpoint configuration
+ * @param root the key `system:/elektra/mountpoints/<mp>`
+ * @param hash receives the hash as hex string
+ */
+static void hashMountpointConfig (KeySet * elektraKs, Key * root, char hash[9])
+{
+	// FNV-1a
+	uint32_t value = 2166136261u;
+	elektraCursor end;
+	for (elektraCursor it = ksFindHierarchy (elektraKs, root, &end); it < end; it++)
+	{
+		const Key * cur = ksAtCursor (elektraKs, it);
+		const unsigned char * parts[] = { (const unsigned char *) keyName (cur), keyValue (cur) };
+		size_t sizes[] = { keyGetNameSize (cur), keyGetValueSize (cur) };
+		for (size_t part = 0; part < 2; part++)
+		{
+			for (size_t i = 0; parts[part] != NULL && i < sizes[part]; i++)
+			{
+				value = (value ^ parts[part][i]) * 16777619u;
+			}
+		}
+	}
+	snprintf (hash, 9, "%08" PRIx32, value);
+}
+
 static bool parseAndAddMountpoint (KeySet * mountpoints, KeySet * modules, KeySet * elektraKs, KeySet * global, Key * root, Key * errorKey)
 {
 	// check that the base name is a key name
@@ -561,6 +720,10 @@ static bool parseAndAddMountpoint (KeySet * mountpoints, KeySet * modules, KeySe
 	keyDel (elektraRoot);
 	elektraRoot = NULL;
 
+	char configHash[9];
+	hashMountpointConfig (elektraKs, root, configHash);
+	keySetMeta (mountpoint, "meta:/internal/kdbconfighash", configHash);
+
 
 	// load mountpoint level config
 	Key * lookupHelper = keyDup (root, KEY_CP_NAME);
@@ -968,7 +1131,7 @@ KDB * kdbOpen (const KeySet * contract, Key * errorKey)
 		goto error;
 	}
 
-	if (contract != NULL && !ensureContract (handle, contract))
+	if (contract != NULL && !ensureContract (handle, contract, errorKey))
 	{
 		ksDel (elektraKs);
 		goto error;
@@ -999,6 +1162,9 @@ KDB * kdbOpen (const KeySet * contract, Key * errorKey)
 		goto error;
 	}
 
+	// Step 8: index mountpoints, without the index (e.g. on memory errors) the backends are searched directly
+	handle->backendsIndex = backendsIndexNew (handle->backends);
+
 	keyCopy (errorKey, initialParent, KEY_CP_NAME | KEY_CP_VALUE);
 	keyDel (initialParent);
 	errno = errnosave;
@@ -1056,6 +1222,9 @@ int kdbClose (KDB * handle, Key * errorKey)
 	Key * initialParent = keyDup (errorKey, KEY_CP_ALL);
 	int errnosave = errno;
 
+	backendsIndexDel (handle->backendsIndex);
+	handle->backendsIndex = NULL;
+
 	if (handle->backends)
 	{
 
@@ -1088,199 +1257,6 @@ int kdbClose (KDB * handle, Key * errorKey)
 	return 0;
 }
 
-#if 2 == 0
-// TODO [new_backend]: re-implement cache
-static int elektraCacheCheckParent (KeySet * global, Key * cacheParent, Key * initialParent)
-{
-	const char * cacheName = keyGetNamespace (cacheParent) == KEY_NS_DEFAULT ? "" : keyName (cacheParent);
-
-	// first check if parentkey matches
-	Key * lastParentName = ksLookupByName (global, KDB_CACHE_PREFIX "/lastParentName", KDB_O_NONE);
-	ELEKTRA_LOG_DEBUG ("LAST PARENT name: %s", keyString (lastParentName));
-	ELEKTRA_LOG_DEBUG ("KDBG PARENT name: %s", cacheName);
-	if (!lastParentName || elektraStrCmp (keyString (lastParentName), cacheName)) return -1;
-
-	const char * cacheValue = keyGetNamespace (cacheParent) == KEY_NS_DEFAULT ? "default" : keyString (cacheParent);
-
-	Key * lastParentValue = ksLookupByName (global, KDB_CACHE_PREFIX "/lastParentValue", KDB_O_NONE);
-	ELEKTRA_LOG_DEBUG ("LAST PARENT value: %s", keyString (lastParentValue));
-	ELEKTRA_LOG_DEBUG ("KDBG PARENT value: %s", cacheValue);
-	if (!lastParentValue || elektraStrCmp (keyString (lastParentValue), cacheValue)) return -1;
-
-	Key * lastInitalParentName = ksLookupByName (global, KDB_CACHE_PREFIX "/lastInitialParentName", KDB_O_NONE);
-	Key * lastInitialParent = keyNew (keyString (lastInitalParentName), KEY_END);
-	ELEKTRA_LOG_DEBUG ("LAST initial PARENT name: %s", keyName (lastInitialParent));
-	ELEKTRA_LOG_DEBUG ("CURR initial PARENT name: %s", keyName (initialParent));
-
-	if (!keyIsBelowOrSame (lastInitialParent, initialParent))
-	{
-		ELEKTRA_LOG_DEBUG ("CACHE initial PARENT: key is not below or same");
-		keyDel (lastInitialParent);
-		return -1;
-	}
-
-	keyDel (lastInitialParent);
-	return 0;
-}
-
-static void elektraCacheCutMeta (KDB * handle)
-{
-	Key * parentKey = keyNew (KDB_CACHE_PREFIX, KEY_END);
-	ksDel (ksCut (handle->global, parentKey));
-	keyDel (parentKey);
-}
-
-KeySet * elektraCutProc (KeySet * ks)
-{
-	Key * parentKey = keyNew ("proc:/", KEY_END);
-	KeySet * ret = ksCut (ks, parentKey);
-	keyDel (parentKey);
-	return ret;
-}
-
-static void elektraRestoreProc (KeySet * ks, KeySet * proc)
-{
-	ksAppend (ks, proc);
-	ksDel (proc);
-}
-
-static void elektraCacheLoad (KDB * handle, KeySet * cache, Key * parentKey, Key * initialParent ELEKTRA_UNUSED, Key * cacheParent)
-{
-	// prune old cache info
-	elektraCacheCutMeta (handle);
-
-	if (elektraGlobalGet (handle, cache, cacheParent, PREGETCACHE, MAXONCE) != ELEKTRA_PLUGIN_STATUS_SUCCESS)
-	{
-		ELEKTRA_LOG_DEBUG ("CACHE MISS: could not fetch cache");
-		elektraCacheCutMeta (handle);
-		return;
-	}
-
-	keySetName (parentKey, keyName (initialParent));
-	if (!(elektraStrCmp (keyName (initialParent), keyName (parentKey)) == 0))
-	{
-		ELEKTRA_LOG_WARNING ("parentKey name (%s) differs from initial (%s)", keyName (parentKey), keyName (initialParent));
-	}
-	ELEKTRA_ASSERT (elektraStrCmp (keyName (initialParent), keyName (parentKey)) == 0, "parentKey name (%s) differs from initial (%s)",
-			keyName (parentKey), keyName (initialParent));
-	if (elektraCacheCheckParent (handle->global, cacheParent, parentKey) != 0)
-	{
-		// parentKey in cache does not match, needs rebuild
-		ELEKTRA_LOG_DEBUG ("CACHE WRONG PARENTKEY");
-		elektraCacheCutMeta (handle);
-		return;
-	}
-}
-
-#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
-/**
- * @brief Deletes the OPMPHM.
- *
- * Clears and frees all memory in Opmphm.
- *
- * @param opmphm the OPMPHM
- */
-static void cacheOpmphmDel (Opmphm * opmphm)
-{
-	ELEKTRA_NOT_NULL (opmphm);
-	if (opmphm && opmphm->size && !test_bit (opmphm->flags, OPMPHM_FLAG_MMAP_GRAPH))
-	{
-		elektraFree (opmphm->graph);
-	}
-	if (opmphm->rUniPar && !test_bit (opmphm->flags, OPMPHM_FLAG_MMAP_HASHFUNCTIONSEEDS))
-	{
-		elektraFree (opmphm->hashFunctionSeeds);
-	}
-	if (!test_bit (opmphm->flags, OPMPHM_FLAG_MMAP_STRUCT)) elektraFree (opmphm);
-}
-
-/**
- * @brief Deletes the OpmphmPredictor.
- *
- * Clears and frees all memory in OpmphmPredictor.
- *
- * @param op the OpmphmPredictor
- */
-static void cacheOpmphmPredictorDel (OpmphmPredictor * op)
-{
-	ELEKTRA_NOT_NULL (op);
-	if (!test_bit (op->flags, OPMPHM_PREDICTOR_FLAG_MMAP_PATTERNTABLE)) elektraFree (op->patternTable);
-	if (!test_bit (op->flags, OPMPHM_PREDICTOR_FLAG_MMAP_STRUCT)) elektraFree (op);
-}
-#endif
-
-static int elektraCacheLoadSplit (KDB * handle, Split * split, KeySet * ks, KeySet ** cache, Key ** cacheParent, Key * parentKey,
-				  Key * initialParent, int debugGlobalPositions)
-{
-	ELEKTRA_LOG_DEBUG ("CACHE parentKey: %s, %s", keyName (*cacheParent), keyString (*cacheParent));
-
-	if (splitCacheCheckState (split, handle->global) == -1)
-	{
-		ELEKTRA_LOG_DEBUG ("FAIL, have to discard cache because split state / SIZE FAIL, or file mismatch");
-		elektraCacheCutMeta (handle);
-		return -1;
-	}
-
-	ELEKTRA_LOG_DEBUG ("CACHE HIT");
-	if (splitCacheLoadState (split, handle->global) != 0) return -1;
-
-	if (debugGlobalPositions)
-	{
-		keySetName (parentKey, keyName (initialParent));
-		elektraGlobalGet (handle, *cache, parentKey, PREGETSTORAGE, INIT);
-		elektraGlobalGet (handle, *cache, parentKey, PREGETSTORAGE, MAXONCE);
-		elektraGlobalGet (handle, *cache, parentKey, PREGETSTORAGE, DEINIT);
-	}
-
-	keySetName (parentKey, keyName (initialParent));
-	// TODO: there are no error checks here, see kdbGet
-	elektraGlobalGet (handle, *cache, parentKey, PROCGETSTORAGE, INIT);
-	elektraGlobalGet (handle, *cache, parentKey, PROCGETSTORAGE, MAXONCE);
-	elektraGlobalGet (handle, *cache, parentKey, PROCGETSTORAGE, DEINIT);
-
-	// replace ks with cached keyset
-	ksRewind (*cache);
-	if (ks->size == 0)
-	{
-		ELEKTRA_LOG_DEBUG ("replacing keyset with cached keyset");
-#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
-		if (ks->opmphm) cacheOpmphmDel (ks->opmphm);
-		if (ks->opmphmPredictor) cacheOpmphmPredictorDel (ks->opmphmPredictor);
-#endif
-		ksClose (ks);
-		ks->array = (*cache)->array;
-		ks->size = (*cache)->size;
-		ks->alloc = (*cache)->alloc;
-		ks->flags = (*cache)->flags;
-#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
-		ks->opmphm = (*cache)->opmphm;
-		ks->opmphmPredictor = (*cache)->opmphmPredictor;
-#endif
-		elektraFree (*cache);
-		*cache = 0;
-	}
-	else
-	{
-		ELEKTRA_LOG_DEBUG ("appending cached keyset (ks was not empty)");
-		ksAppend (ks, *cache);
-		ksDel (*cache);
-		*cache = 0;
-	}
-	keyDel (*cacheParent);
-	*cacheParent = 0;
-
-	if (debugGlobalPositions)
-	{
-		keySetName (parentKey, keyName (initialParent));
-		elektraGlobalGet (handle, ks, parentKey, POSTGETSTORAGE, INIT);
-		elektraGlobalGet (handle, ks, parentKey, POSTGETSTORAGE, MAXONCE);
-		elektraGlobalGet (handle, ks, parentKey, POSTGETSTORAGE, DEINIT);
-	}
-
-	return 0;
-}
-#endif
-
 static const char * phaseName (ElektraKdbPhase phase)
 {
 	switch (phase)
@@ -1399,96 +1375,425 @@ static bool initBackends (KeySet * backends, Key * parentKey)
 	return success;
 }
 
-static bool resolveBackendsForGet (KeySet * backends, Key * parentKey)
+/**
+ * A single call of the kdbGet function of a backend plugin that may run on a worker thread.
+ *
+ * The job has its own parent key and its own copy of the global keyset (see dupGlobalForJob()),
+ * so that backends running concurrently do not share the global keys, their metadata or any
+ * reference counters. Afterwards, the results are merged with finishGetPhaseJob().
+ */
+typedef struct
+{
+	Key * backendKey;
+	BackendData * backendData;
+	Key * parentKey;
+	KeySet * global;
+	KeySet * sharedGlobal;
+	KeySet * initialGlobal;
+	int ret;
+} GetPhaseJob;
+
+/**
+ * Sets the global keyset of the backend plugin and of all plugins of the backend
+ */
+static void setBackendGlobal (BackendData * backendData, KeySet * global)
 {
-	bool success = true;
-	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	backendData->backend->global = global;
+	for (elektraCursor i = 0; i < ksGetSize (backendData->plugins); i++)
 	{
-		Key * backendKey = ksAtCursor (backends, i);
-		keySetMeta (backendKey, "meta:/internal/kdbmountpoint", NULL);
-		keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", NULL);
-
-		if (keyGetNamespace (backendKey) == KEY_NS_PROC)
-		{
-			// proc:/ backends only run in poststorage
-			// TODO [new_backend]: allow proc:/ backends for more than poststorage
-			keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", "1");
-			continue;
-		}
+		Plugin * plugin = *(Plugin **) keyValue (ksAtCursor (backendData->plugins, i));
+		plugin->global = global;
+	}
+}
 
-		BackendData * backendData = (BackendData *) keyValue (backendKey);
+/**
+ * Copies the global keyset for a GetPhaseJob.
+ *
+ * Unlike ksDeepDup(), the copied keys neither share their metadata KeySet (see keyCopyAllMeta())
+ * nor their metadata keys with the keys of @p global. Otherwise, jobs running concurrently
+ * would change the same (non-atomic) reference counters.
+ *
+ * @param global the shared global keyset, only read
+ *
+ * @return a copy of @p global that only the job uses
+ */
+static KeySet * dupGlobalForJob (const KeySet * global)
+{
+	KeySet * copy = ksNew (ksGetSize (global), KS_END);
+	for (elektraCursor i = 0; i < ksGetSize (global); i++)
+	{
+		const Key * cur = ksAtCursor (global, i);
+		Key * dup = keyDup (cur, KEY_CP_NAME | KEY_CP_VALUE);
 
-		// check if get function exists
-		kdbGetPtr getFn = backendData->backend->kdbGet;
-		if (getFn == NULL)
+		const KeySet * meta = elektraKeyGetMetaKeySet (cur);
+		for (elektraCursor j = 0; j < ksGetSize (meta); j++)
 		{
-			ELEKTRA_ADD_INTERFACE_WARNINGF (
-				parentKey, "The mountpoint '%s' defined a plugin ('%s') without a kdbGet function as a backend.",
-				keyName (backendKey), backendData->backend->name);
-			success = false;
-			continue;
+			ksAppendKey (keyMeta (dup), keyDup (ksAtCursor (meta, j), KEY_CP_ALL));
 		}
+		ksAppendKey (copy, dup);
+	}
+	return copy;
+}
 
-		// set up parentKey and global keyset for plugin
-		keyCopy (parentKey, backendKey, KEY_CP_NAME);
-		keySetString (parentKey, "");
-		setBackendPhase (backendData, ELEKTRA_KDB_GET_PHASE_RESOLVER);
-		ksAppendKey (backendData->backend->global,
-			     keyNew ("system:/elektra/kdb/backend/plugins", KEY_BINARY, KEY_SIZE, sizeof (backendData->plugins), KEY_VALUE,
-				     &backendData->plugins, KEY_END));
-		set_bit (parentKey->flags, KEY_FLAG_RO_NAME);
-
-		int ret = getFn (backendData->backend, backendData->keys, parentKey);
-
-		// restore parentKey
-		clear_bit (parentKey->flags, KEY_FLAG_RO_NAME);
+static void initGetPhaseJob (GetPhaseJob * job, Key * backendKey, ElektraKdbPhase phase, const char * value)
+{
+	job->backendKey = backendKey;
+	job->backendData = (BackendData *) keyValue (backendKey);
+	job->parentKey = keyNew (keyName (backendKey), KEY_VALUE, value, KEY_END);
+	job->sharedGlobal = job->backendData->backend->global;
+	job->initialGlobal = ksDup (job->sharedGlobal);
+	job->global = dupGlobalForJob (job->sharedGlobal);
+	job->ret = ELEKTRA_PLUGIN_STATUS_ERROR;
+
+	setBackendGlobal (job->backendData, job->global);
+	setBackendPhase (job->backendData, phase);
+	ksAppendKey (job->global, keyNew ("system:/elektra/kdb/backend/plugins", KEY_BINARY, KEY_SIZE, sizeof (job->backendData->plugins),
+					  KEY_VALUE, &job->backendData->plugins, KEY_END));
+	set_bit (job->parentKey->flags, KEY_FLAG_RO_NAME);
+}
 
-		// check return code
-		switch (ret)
-		{
-		case ELEKTRA_PLUGIN_STATUS_SUCCESS:
-			// Store returned mountpoint ID and mark for update
-			keySetMeta (backendKey, "meta:/internal/kdbmountpoint", keyString (parentKey));
-			keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", "1");
-			break;
-		case ELEKTRA_PLUGIN_STATUS_NO_UPDATE:
-			// no update needed
-			keySetMeta (backendKey, "meta:/internal/kdbmountpoint", keyString (parentKey));
-			break;
-		case ELEKTRA_PLUGIN_STATUS_ERROR:
-			// handle error
-			ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
-							"Calling the kdbGet function for the backend plugin ('%s') of the mountpoint '%s' "
-							"has failed during the %s phase.",
-							backendData->backend->name, keyName (backendKey),
-							phaseName (ELEKTRA_KDB_GET_PHASE_RESOLVER));
-			success = false;
-			continue;
-		default:
-			// unknown result -> treat as error
-			ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
-							"The kdbGet function for the backend plugin ('%s') of the mountpoint '%s' returned "
-							"an unknown result code '%d' during the %s phase. Treating the call as failed.",
-							backendData->backend->name, keyName (backendKey), ret,
-							phaseName (ELEKTRA_KDB_GET_PHASE_RESOLVER));
-			success = false;
-			continue;
-		}
+/**
+ * Checks whether @p a and @p b have the same value and the same metadata
+ */
+static bool keyValueAndMetaEqual (const Key * a, const Key * b)
+{
+	if (keyGetValueSize (a) != keyGetValueSize (b) || memcmp (keyValue (a), keyValue (b), keyGetValueSize (a)) != 0)
+	{
+		return false;
 	}
 
-	if (!success)
+	const KeySet * metaA = elektraKeyGetMetaKeySet (a);
+	const KeySet * metaB = elektraKeyGetMetaKeySet (b);
+	ssize_t size = metaA == NULL ? 0 : ksGetSize (metaA);
+	if (size != (metaB == NULL ? 0 : ksGetSize (metaB)))
 	{
-		ELEKTRA_SET_INTERFACE_ERRORF (parentKey, "The %s phase of kdbGet() has failed. See warnings for details.",
-					      phaseName (ELEKTRA_KDB_GET_PHASE_RESOLVER));
+		return false;
 	}
 
-	return success;
+	for (elektraCursor i = 0; i < size; i++)
+	{
+		const Key * metaKeyA = ksAtCursor (metaA, i);
+		const Key * metaKeyB = ksAtCursor (metaB, i);
+		if (strcmp (keyName (metaKeyA), keyName (metaKeyB)) != 0 || strcmp (keyString (metaKeyA), keyString (metaKeyB)) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Restores the shared global keyset of the backend and merges the changes @p job made to
+ * its global keyset and parent key into the shared global keyset and @p parentKey.
+ *
+ * The changes are determined relative to the global keyset at the start of the job.
+ * Keys the job added or changed (value or metadata) are copied into the shared global keyset,
+ * keys the job removed are removed from it. Keys the job did not touch keep the
+ * state an earlier job may have merged.
+ *
+ * Must be called for the jobs in the order of the backends, so that the warnings
+ * have the same order as in a sequential kdbGet().
+ */
+static void finishGetPhaseJob (GetPhaseJob * job, Key * parentKey)
+{
+	clear_bit (job->parentKey->flags, KEY_FLAG_RO_NAME);
+	setBackendGlobal (job->backendData, job->sharedGlobal);
+
+	for (elektraCursor i = 0; i < ksGetSize (job->initialGlobal); i++)
+	{
+		Key * initial = ksAtCursor (job->initialGlobal, i);
+		if (ksLookup (job->global, initial, 0) == NULL)
+		{
+			keyDel (ksLookup (job->sharedGlobal, initial, KDB_O_POP));
+		}
+	}
+
+	for (elektraCursor i = 0; i < ksGetSize (job->global); i++)
+	{
+		Key * cur = ksAtCursor (job->global, i);
+		Key * initial = ksLookup (job->initialGlobal, cur, 0);
+		if (initial == NULL || !keyValueAndMetaEqual (initial, cur))
+		{
+			ksAppendKey (job->sharedGlobal, cur);
+		}
+	}
+	ksDel (job->global);
+	job->global = NULL;
+	ksDel (job->initialGlobal);
+	job->initialGlobal = NULL;
+
+	mergeErrorsAndWarnings (parentKey, job->parentKey);
+}
+
+#ifdef HAVE_PTHREAD
+typedef struct
+{
+	GetPhaseJob * jobs;
+	size_t size;
+	size_t next;
+	pthread_mutex_t mutex;
+} GetPhaseQueue;
+
+static void * getPhaseWorker (void * data)
+{
+	GetPhaseQueue * queue = data;
+	for (;;)
+	{
+		pthread_mutex_lock (&queue->mutex);
+		size_t i = queue->next++;
+		pthread_mutex_unlock (&queue->mutex);
+
+		if (i >= queue->size)
+		{
+			return NULL;
+		}
+
+		GetPhaseJob * job = &queue->jobs[i];
+		job->ret = job->backendData->backend->kdbGet (job->backendData->backend, job->backendData->keys, job->parentKey);
+	}
+}
+#endif
+
+/**
+ * Runs the kdbGet function of the backend plugins of all @p jobs on up to @p workers threads.
+ * The calling thread is one of the workers.
+ */
+static void runGetPhaseJobs (GetPhaseJob * jobs, size_t size, size_t workers)
+{
+#ifdef HAVE_PTHREAD
+	if (size == 0)
+	{
+		return;
+	}
+
+	GetPhaseQueue queue = { .jobs = jobs, .size = size, .next = 0 };
+	pthread_mutex_init (&queue.mutex, NULL);
+
+	size_t threadCount = (workers < size ? workers : size) - 1;
+	pthread_t * threads = threadCount > 0 ? elektraMalloc (threadCount * sizeof (pthread_t)) : NULL;
+	size_t started = 0;
+	// if a thread cannot be allocated or created, the remaining workers run its jobs
+	while (threads != NULL && started < threadCount && pthread_create (&threads[started], NULL, getPhaseWorker, &queue) == 0)
+	{
+		++started;
+	}
+
+	getPhaseWorker (&queue);
+
+	for (size_t i = 0; i < started; i++)
+	{
+		pthread_join (threads[i], NULL);
+	}
+
+	elektraFree (threads);
+	pthread_mutex_destroy (&queue.mutex);
+#else
+	(void) workers;
+	for (size_t i = 0; i < size; i++)
+	{
+		jobs[i].ret = jobs[i].backendData->backend->kdbGet (jobs[i].backendData->backend, jobs[i].backendData->keys, jobs[i].parentKey);
+	}
+#endif
+}
+
+/**
+ * Checks the return value of the kdbGet function of a backend plugin in the resolver phase.
+ *
+ * @param backendKey the backend
+ * @param resultKey the parent key that was passed to the backend plugin
+ * @param parentKey receives the warnings
+ * @param ret the return value of the backend plugin
+ *
+ * @retval true if the call was successful
+ * @retval false otherwise
+ */
+static bool checkResolverResult (Key * backendKey, const Key * resultKey, Key * parentKey, int ret)
+{
+	const BackendData * backendData = keyValue (backendKey);
+	switch (ret)
+	{
+	case ELEKTRA_PLUGIN_STATUS_SUCCESS:
+		// Store returned mountpoint ID and cache handle and mark for update
+		keySetMeta (backendKey, "meta:/internal/kdbmountpoint", keyString (resultKey));
+		keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", "1");
+		if (keyGetMeta (resultKey, "meta:/internal/kdb/cachehandle") != NULL)
+		{
+			keySetMeta (backendKey, "meta:/internal/kdbcachehandle",
+				    keyString (keyGetMeta (resultKey, "meta:/internal/kdb/cachehandle")));
+		}
+		return true;
+	case ELEKTRA_PLUGIN_STATUS_NO_UPDATE:
+		// no update needed, unless a stream dropped the keys
+		keySetMeta (backendKey, "meta:/internal/kdbmountpoint", keyString (resultKey));
+		if (backendData->needsReload) keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", "1");
+		return true;
+	case ELEKTRA_PLUGIN_STATUS_ERROR:
+		// handle error
+		ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
+						"Calling the kdbGet function for the backend plugin ('%s') of the mountpoint '%s' "
+						"has failed during the %s phase.",
+						backendData->backend->name, keyName (backendKey), phaseName (ELEKTRA_KDB_GET_PHASE_RESOLVER));
+		return false;
+	default:
+		// unknown result -> treat as error
+		ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
+						"The kdbGet function for the backend plugin ('%s') of the mountpoint '%s' returned "
+						"an unknown result code '%d' during the %s phase. Treating the call as failed.",
+						backendData->backend->name, keyName (backendKey), ret,
+						phaseName (ELEKTRA_KDB_GET_PHASE_RESOLVER));
+		return false;
+	}
+}
+
+/**
+ * Runs the resolver phase on all @p backends.
+ *
+ * @param backends the backends
+ * @param parentKey used for the resolver phase and errors
+ * @param workers the number of threads to use, with 0 or 1 the backends run sequentially
+ *
+ * @retval true if the resolver phase was successful for all backends
+ * @retval false otherwise
+ */
+static bool resolveBackendsForGet (KeySet * backends, Key * parentKey, size_t workers)
+{
+	bool success = true;
+	// if the jobs cannot be allocated, the backends run sequentially
+	GetPhaseJob * jobs = workers > 1 && ksGetSize (backends) > 0 ? elektraMalloc (ksGetSize (backends) * sizeof (GetPhaseJob)) : NULL;
+	size_t jobCount = 0;
+
+	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	{
+		Key * backendKey = ksAtCursor (backends, i);
+		keySetMeta (backendKey, "meta:/internal/kdbmountpoint", NULL);
+		keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", NULL);
+		keySetMeta (backendKey, "meta:/internal/kdbcachehandle", NULL);
+
+		if (keyGetNamespace (backendKey) == KEY_NS_PROC)
+		{
+			// proc:/ backends only run in poststorage
+			// TODO [new_backend]: allow proc:/ backends for more than poststorage
+			keySetMeta (backendKey, "meta:/internal/kdbneedsupdate", "1");
+			continue;
+		}
+
+		BackendData * backendData = (BackendData *) keyValue (backendKey);
+
+		// check if get function exists
+		kdbGetPtr getFn = backendData->backend->kdbGet;
+		if (getFn == NULL)
+		{
+			ELEKTRA_ADD_INTERFACE_WARNINGF (
+				parentKey, "The mountpoint '%s' defined a plugin ('%s') without a kdbGet function as a backend.",
+				keyName (backendKey), backendData->backend->name);
+			success = false;
+			continue;
+		}
+
+		if (jobs != NULL)
+		{
+			initGetPhaseJob (&jobs[jobCount++], backendKey, ELEKTRA_KDB_GET_PHASE_RESOLVER, "");
+			continue;
+		}
+
+		// set up parentKey and global keyset for plugin
+		keyCopy (parentKey, backendKey, KEY_CP_NAME);
+		keySetString (parentKey, "");
+		keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+		setBackendPhase (backendData, ELEKTRA_KDB_GET_PHASE_RESOLVER);
+		ksAppendKey (backendData->backend->global,
+			     keyNew ("system:/elektra/kdb/backend/plugins", KEY_BINARY, KEY_SIZE, sizeof (backendData->plugins), KEY_VALUE,
+				     &backendData->plugins, KEY_END));
+		set_bit (parentKey->flags, KEY_FLAG_RO_NAME);
+
+		int ret = getFn (backendData->backend, backendData->keys, parentKey);
+
+		// restore parentKey
+		clear_bit (parentKey->flags, KEY_FLAG_RO_NAME);
+
+		success = checkResolverResult (backendKey, parentKey, parentKey, ret) && success;
+	}
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+
+	if (jobs != NULL)
+	{
+		runGetPhaseJobs (jobs, jobCount, workers);
+		for (size_t i = 0; i < jobCount; i++)
+		{
+			finishGetPhaseJob (&jobs[i], parentKey);
+			success = checkResolverResult (jobs[i].backendKey, jobs[i].parentKey, parentKey, jobs[i].ret) && success;
+			keyDel (jobs[i].parentKey);
+		}
+		elektraFree (jobs);
+	}
+
+	if (!success)
+	{
+		ELEKTRA_SET_INTERFACE_ERRORF (parentKey, "The %s phase of kdbGet() has failed. See warnings for details.",
+					      phaseName (ELEKTRA_KDB_GET_PHASE_RESOLVER));
+	}
+
+	return success;
 }
 
 static const uint16_t ELEKTRA_KDB_GET_PHASE_POST_STORAGE_SPEC = 1 << 8 | ELEKTRA_KDB_GET_PHASE_POST_STORAGE;
 static const uint16_t ELETKRA_KDB_GET_PHASE_POST_STORAGE_NONSPEC = ELEKTRA_KDB_GET_PHASE_POST_STORAGE;
 
-static bool runGetPhase (KeySet * backends, Key * parentKey, uint16_t phase)
+/**
+ * Checks the return value of the kdbGet function of a backend plugin in any phase after the resolver phase.
+ *
+ * @param backendKey the backend
+ * @param resultKey the parent key that was passed to the backend plugin
+ * @param parentKey receives the warnings
+ * @param ret the return value of the backend plugin
+ * @param phase the phase
+ *
+ * @retval true if the call was successful
+ * @retval false otherwise
+ */
+static bool checkGetPhaseResult (Key * backendKey, const Key * resultKey, Key * parentKey, int ret, ElektraKdbPhase phase)
+{
+	const BackendData * backendData = keyValue (backendKey);
+	switch (ret)
+	{
+	case ELEKTRA_PLUGIN_STATUS_SUCCESS:
+	case ELEKTRA_PLUGIN_STATUS_NO_UPDATE:
+		// success
+
+		// START fcrypt workaround
+		keySetMeta (backendKey, "meta:/internal/kdbmountpoint", keyString (resultKey));
+		// END fcrypt workaround
+		return true;
+	case ELEKTRA_PLUGIN_STATUS_ERROR:
+		// handle error
+		ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
+						"Calling the kdbGet function for the backend plugin ('%s') of the mountpoint '%s' "
+						"has failed during the %s phase.",
+						backendData->backend->name, keyName (backendKey), phaseName (phase));
+		return false;
+	default:
+		// unknown result -> treat as error
+		ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
+						"The kdbGet function for the backend plugin ('%s') of the mountpoint '%s' returned "
+						"an unknown result code '%d' during the %s phase. Treating the call as failed.",
+						backendData->backend->name, keyName (backendKey), ret, phaseName (phase));
+		return false;
+	}
+}
+
+/**
+ * Runs a phase of kdbGet() after the resolver phase on all @p backends.
+ *
+ * @param backends the backends
+ * @param parentKey used for the phase and errors
+ * @param phase the phase, the poststorage phase is either ELEKTRA_KDB_GET_PHASE_POST_STORAGE_SPEC
+ *              or ELETKRA_KDB_GET_PHASE_POST_STORAGE_NONSPEC
+ * @param workers the number of threads to use, with 0 or 1 the backends run sequentially
+ *
+ * @retval true if the phase was successful for all backends
+ * @retval false otherwise
+ */
+static bool runGetPhase (KeySet * backends, Key * parentKey, uint16_t phase, size_t workers)
 {
 	bool speconly = false;
 	bool skipspec = false;
@@ -1500,6 +1805,10 @@ static bool runGetPhase (KeySet * backends, Key * parentKey, uint16_t phase)
 	}
 
 	bool success = true;
+	// if the jobs cannot be allocated, the backends run sequentially
+	GetPhaseJob * jobs = workers > 1 && ksGetSize (backends) > 0 ? elektraMalloc (ksGetSize (backends) * sizeof (GetPhaseJob)) : NULL;
+	size_t jobCount = 0;
+
 	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
 	{
 		Key * backendKey = ksAtCursor (backends, i);
@@ -1533,6 +1842,13 @@ static bool runGetPhase (KeySet * backends, Key * parentKey, uint16_t phase)
 			continue;
 		}
 
+		if (jobs != NULL)
+		{
+			initGetPhaseJob (&jobs[jobCount++], backendKey, phase,
+					 keyString (keyGetMeta (backendKey, "meta:/internal/kdbmountpoint")));
+			continue;
+		}
+
 		// set up parentKey and global keyset for plugin
 		keyCopy (parentKey, backendKey, KEY_CP_NAME);
 		keyCopy (parentKey, keyGetMeta (backendKey, "meta:/internal/kdbmountpoint"), KEY_CP_STRING);
@@ -1553,45 +1869,245 @@ static bool runGetPhase (KeySet * backends, Key * parentKey, uint16_t phase)
 		// restore parentKey
 		clear_bit (parentKey->flags, KEY_FLAG_RO_NAME | KEY_FLAG_RO_VALUE);
 
-		// check return code
-		switch (ret)
+		success = checkGetPhaseResult (backendKey, parentKey, parentKey, ret, phase) && success;
+	}
+
+	if (jobs != NULL)
+	{
+		runGetPhaseJobs (jobs, jobCount, workers);
+		for (size_t i = 0; i < jobCount; i++)
 		{
-		case ELEKTRA_PLUGIN_STATUS_SUCCESS:
-		case ELEKTRA_PLUGIN_STATUS_NO_UPDATE:
-			// success
+			finishGetPhaseJob (&jobs[i], parentKey);
+			success = checkGetPhaseResult (jobs[i].backendKey, jobs[i].parentKey, parentKey, jobs[i].ret, phase) && success;
+			keyDel (jobs[i].parentKey);
+		}
+		elektraFree (jobs);
+	}
 
-			// START fcrypt workaround
-			keySetMeta (backendKey, "meta:/internal/kdbmountpoint", keyString (parentKey));
-			// END fcrypt workaround
-			break;
-		case ELEKTRA_PLUGIN_STATUS_ERROR:
-			// handle error
-			ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
-							"Calling the kdbGet function for the backend plugin ('%s') of the mountpoint '%s' "
-							"has failed during the %s phase.",
-							backendData->backend->name, keyName (backendKey), phaseName (phase));
+	if (!success)
+	{
+		ELEKTRA_SET_INTERFACE_ERRORF (parentKey, "The %s phase of kdbGet() has failed. See warnings for details.",
+					      phaseName (phase));
+	}
+
+	return success;
+}
+
+
+/**
+ * Creates the parentKey for the cache hook.
+ *
+ * Its name is the mountpoint of @p backendKey and its value the storage identifier
+ * returned by the resolver phase. `meta:/internal/kdb/confighash` contains the hash of
+ * the mountpoint configuration, if the mountpoint is configured in `system:/elektra/mountpoints`.
+ *
+ * @param backendKey the backend
+ *
+ * @return a new key, which has to be deleted with keyDel()
+ */
+static Key * newCacheParent (const Key * backendKey)
+{
+	Key * cacheParent =
+		keyNew (keyName (backendKey), KEY_VALUE, keyString (keyGetMeta (backendKey, "meta:/internal/kdbmountpoint")), KEY_END);
+	const Key * configHash = keyGetMeta (backendKey, "meta:/internal/kdbconfighash");
+	if (configHash != NULL)
+	{
+		keySetMeta (cacheParent, "meta:/internal/kdb/confighash", keyString (configHash));
+	}
+	return cacheParent;
+}
+
+/**
+ * Loads the cache entry of a single backend and runs the cachecheck phase for it.
+ *
+ * @param handle the KDB instance with the cache hook
+ * @param backendKey the backend
+ * @param parentKey used for the cachecheck phase and errors
+ * @param cachedKeys set to the cached keys of the backend, if the cache entry is valid
+ *
+ * @retval true if there was no error, even if the cache entry is invalid
+ * @retval false if the cachecheck phase failed
+ */
+static bool loadBackendFromCache (KDB * handle, Key * backendKey, Key * parentKey, KeySet ** cachedKeys)
+{
+	BackendData * backendData = (BackendData *) keyValue (backendKey);
+	*cachedKeys = NULL;
+
+	// Step 7: get cache entry
+	Key * cacheParent = newCacheParent (backendKey);
+	KeySet * cached = ksNew (0, KS_END);
+	if (handle->hooks.cache.get (handle->hooks.cache.plugin, cached, cacheParent) != ELEKTRA_PLUGIN_STATUS_SUCCESS)
+	{
+		keyDel (cacheParent);
+		ksDel (cached);
+		return true;
+	}
+
+	// Step 8: run cachecheck phase
+	keyCopy (parentKey, backendKey, KEY_CP_NAME);
+	keyCopy (parentKey, keyGetMeta (backendKey, "meta:/internal/kdbmountpoint"), KEY_CP_STRING);
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", keyString (keyGetMeta (cacheParent, "meta:/internal/kdb/cachehandle")));
+	setBackendPhase (backendData, ELEKTRA_KDB_GET_PHASE_CACHECHECK);
+	ksAppendKey (backendData->backend->global,
+		     keyNew ("system:/elektra/kdb/backend/plugins", KEY_BINARY, KEY_SIZE, sizeof (backendData->plugins), KEY_VALUE,
+			     &backendData->plugins, KEY_END));
+	set_bit (parentKey->flags, KEY_FLAG_RO_NAME | KEY_FLAG_RO_VALUE);
+
+	// the backend plugin may modify ks, but we discard it afterwards
+	KeySet * checkKs = ksNew (0, KS_END);
+	int ret = backendData->backend->kdbGet (backendData->backend, checkKs, parentKey);
+	ksDel (checkKs);
+
+	// restore parentKey
+	clear_bit (parentKey->flags, KEY_FLAG_RO_NAME | KEY_FLAG_RO_VALUE);
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+	keyDel (cacheParent);
+
+	switch (ret)
+	{
+	case ELEKTRA_PLUGIN_STATUS_CACHE_HIT:
+		ELEKTRA_LOG_DEBUG ("CACHE HIT: %s", keyName (backendKey));
+		*cachedKeys = cached;
+		return true;
+	case ELEKTRA_PLUGIN_STATUS_SUCCESS:
+	case ELEKTRA_PLUGIN_STATUS_NO_UPDATE:
+		ELEKTRA_LOG_DEBUG ("CACHE MISS: %s", keyName (backendKey));
+		ksDel (cached);
+		return true;
+	case ELEKTRA_PLUGIN_STATUS_ERROR:
+		ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
+						"Calling the kdbGet function for the backend plugin ('%s') of the mountpoint '%s' "
+						"has failed during the %s phase.",
+						backendData->backend->name, keyName (backendKey),
+						phaseName (ELEKTRA_KDB_GET_PHASE_CACHECHECK));
+		ksDel (cached);
+		return false;
+	default:
+		ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
+						"The kdbGet function for the backend plugin ('%s') of the mountpoint '%s' returned "
+						"an unknown result code '%d' during the %s phase. Treating the call as failed.",
+						backendData->backend->name, keyName (backendKey), ret,
+						phaseName (ELEKTRA_KDB_GET_PHASE_CACHECHECK));
+		ksDel (cached);
+		return false;
+	}
+}
+
+/**
+ * Loads all backends in @p backends that have a valid cache entry from the cache (steps 7-9 of kdbGet()).
+ *
+ * The cache contains the keys of a backend at the end of the poststorage phase.
+ * Backends loaded from the cache therefore skip the prestorage, storage and poststorage phases.
+ * The poststorage results depend on the specification, so if any `spec:/` backend must be
+ * read from storage, nothing is loaded from the cache.
+ *
+ * @param handle the KDB instance with the cache hook
+ * @param backends the backends that need an update
+ * @param parentKey used for the cachecheck phase and errors
+ *
+ * @return a new KeySet containing the backends that were not loaded from the cache
+ * @retval NULL if the cachecheck phase failed
+ */
+static KeySet * loadBackendsFromCache (KDB * handle, KeySet * backends, Key * parentKey)
+{
+	KeySet * uncached = ksNew (ksGetSize (backends), KS_END);
+	KeySet * cached = ksNew (ksGetSize (backends), KS_END);
+	bool specUncached = false;
+	bool success = true;
+
+	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	{
+		Key * backendKey = ksAtCursor (backends, i);
+		KeySet * cachedKeys = NULL;
+
+		// proc:/ backends are never cached
+		if (keyGetNamespace (backendKey) != KEY_NS_PROC && keyGetMeta (backendKey, "meta:/internal/kdbcachehandle") != NULL &&
+		    !loadBackendFromCache (handle, backendKey, parentKey, &cachedKeys))
+		{
 			success = false;
 			continue;
-		default:
-			// unknown result -> treat as error
-			ELEKTRA_ADD_INTERFACE_WARNINGF (parentKey,
-							"The kdbGet function for the backend plugin ('%s') of the mountpoint '%s' returned "
-							"an unknown result code '%d' during the %s phase. Treating the call as failed.",
-							backendData->backend->name, keyName (backendKey), ret, phaseName (phase));
-			success = false;
+		}
+
+		if (cachedKeys == NULL)
+		{
+			specUncached = specUncached || keyGetNamespace (backendKey) == KEY_NS_SPEC;
+			ksAppendKey (uncached, backendKey);
 			continue;
 		}
+
+		Key * cacheKey = keyDup (backendKey, KEY_CP_NAME);
+		keySetBinary (cacheKey, &cachedKeys, sizeof (cachedKeys));
+		ksAppendKey (cached, cacheKey);
 	}
 
+	// Step 9: retrieve cache data
+	for (elektraCursor i = 0; i < ksGetSize (cached); i++)
+	{
+		Key * cacheKey = ksAtCursor (cached, i);
+		KeySet * cachedKeys = *(KeySet **) keyValue (cacheKey);
+		Key * backendKey = ksLookup (backends, cacheKey, 0);
+
+		if (specUncached)
+		{
+			ksAppendKey (uncached, backendKey);
+		}
+		else
+		{
+			const BackendData * backendData = keyValue (backendKey);
+			ksClear (backendData->keys);
+			ksAppend (backendData->keys, cachedKeys);
+		}
+
+		ksDel (cachedKeys);
+	}
+	ksDel (cached);
+
 	if (!success)
 	{
 		ELEKTRA_SET_INTERFACE_ERRORF (parentKey, "The %s phase of kdbGet() has failed. See warnings for details.",
-					      phaseName (phase));
+					      phaseName (ELEKTRA_KDB_GET_PHASE_CACHECHECK));
+		ksDel (uncached);
+		return NULL;
 	}
 
-	return success;
+	return uncached;
 }
 
+/**
+ * Stores the keys of all backends in @p backends in the cache (step 19 of kdbGet()).
+ *
+ * Only backends for which the resolver phase returned a cache handle are stored.
+ * Failing to update the cache only results in a warning.
+ *
+ * @param handle the KDB instance with the cache hook
+ * @param backends the backends that were read from storage
+ * @param parentKey used for warnings
+ */
+static void storeBackendsInCache (KDB * handle, KeySet * backends, Key * parentKey)
+{
+	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	{
+		Key * backendKey = ksAtCursor (backends, i);
+		const Key * cacheHandle = keyGetMeta (backendKey, "meta:/internal/kdbcachehandle");
+
+		// proc:/ backends are never cached
+		if (keyGetNamespace (backendKey) == KEY_NS_PROC || cacheHandle == NULL)
+		{
+			continue;
+		}
+
+		const BackendData * backendData = keyValue (backendKey);
+		Key * cacheParent = newCacheParent (backendKey);
+		keySetMeta (cacheParent, "meta:/internal/kdb/cachehandle", keyString (cacheHandle));
+
+		if (handle->hooks.cache.set (handle->hooks.cache.plugin, backendData->keys, cacheParent) == ELEKTRA_PLUGIN_STATUS_ERROR)
+		{
+			ELEKTRA_ADD_RESOURCE_WARNINGF (parentKey, "Could not update the cache for the mountpoint '%s'", keyName (backendKey));
+		}
+
+		keyDel (cacheParent);
+	}
+}
 
 /**
  * Retrieve Keys from the Key database in an atomic and universal way.
@@ -1753,13 +2269,19 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 		return -1;
 	}
 
+	if (test_bit (ks->flags, KS_FLAG_FROZEN))
+	{
+		ELEKTRA_SET_INTERFACE_ERROR (parentKey, "frozen KeySet passed, use ksDeepDup() to get a KeySet that can be changed");
+		return -1;
+	}
+
 	int errnosave = errno;
 	Key * initialParent = keyDup (parentKey, KEY_CP_ALL);
 
 	ELEKTRA_LOG ("now in new kdbGet (%s)", keyName (parentKey));
 
 	// Step 1: find backends for parentKey
-	KeySet * backends = backendsForParentKey (handle->backends, parentKey);
+	KeySet * backends = backendsForParentKey (handle->backends, handle->backendsIndex, parentKey);
 
 	bool goptsActive = handle->hooks.gopts.plugin != NULL;
 	if (goptsActive)
@@ -1770,6 +2292,7 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 		ksAppendKey (backends, ksLookupByName (handle->backends, "proc:/", 0));
 	}
 	KeySet * allBackends = ksDup (backends);
+	KeySet * storageBackends = NULL;
 
 	// Step 2: run open operation where needed (happens within step 3)
 	// Step 3: run init phase where needed
@@ -1784,7 +2307,7 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 	clear_bit (parentKey->flags, KEY_FLAG_RO_NAME | KEY_FLAG_RO_VALUE);
 
 	// Step 4: run resolver phase
-	if (!resolveBackendsForGet (backends, parentKey))
+	if (!resolveBackendsForGet (backends, parentKey, handle->getWorkers))
 	{
 		goto error;
 	}
@@ -1809,7 +2332,7 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 		keyCopy (parentKey, initialParent, KEY_CP_NAME | KEY_CP_VALUE);
 		keyDel (initialParent);
 
-		keyCopy (parentKey, keyGetMeta (backendsFindParent (allBackends, parentKey), "meta:/internal/kdbmountpoint"),
+		keyCopy (parentKey, keyGetMeta (backendsFindParent (allBackends, NULL, parentKey), "meta:/internal/kdbmountpoint"),
 			 KEY_CP_STRING);
 
 		ksDel (backends);
@@ -1819,42 +2342,63 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 	}
 
 	// check if cache is enabled, Steps 7-9 only run with cache
-	// TODO [new_backend]: implement cache
-	bool cacheEnabled = false;
-	if (cacheEnabled)
+	if (handle->hooks.cache.plugin != NULL)
 	{
-		// Step 7: get cache entry IDs
-		// TODO [new_backend]: implement cache
-
-		// Step 8: run cachecheck phase
-		// TODO [new_backend]: implement cache
-
-		// Step 9: retrieve cache data
-		// TODO [new_backend]: implement cache
+		// Steps 7-9: load backends with valid cache entries from cache
+		storageBackends = loadBackendsFromCache (handle, backends, parentKey);
+		if (storageBackends == NULL)
+		{
+			goto error;
+		}
+	}
+	else
+	{
+		storageBackends = ksDup (backends);
 	}
 
 	// Step 10a: run prestorage phase
-	if (!runGetPhase (backends, parentKey, ELEKTRA_KDB_GET_PHASE_PRE_STORAGE))
+	if (!runGetPhase (storageBackends, parentKey, ELEKTRA_KDB_GET_PHASE_PRE_STORAGE, 0))
 	{
 		goto error;
 	}
 
 	// Step 10b: discard data that plugins may have produced
-	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	for (elektraCursor i = 0; i < ksGetSize (storageBackends); i++)
 	{
-		const BackendData * backendData = keyValue (ksAtCursor (backends, i));
+		const BackendData * backendData = keyValue (ksAtCursor (storageBackends, i));
 		ksClear (backendData->keys);
 	}
 
 	// Step 10c: run storage phase
-	if (!runGetPhase (backends, parentKey, ELEKTRA_KDB_GET_PHASE_STORAGE))
+	if (!runGetPhase (storageBackends, parentKey, ELEKTRA_KDB_GET_PHASE_STORAGE, handle->getWorkers))
 	{
 		goto error;
 	}
 
+	// Step 10d: remember what was read, kdbSet() gives storage plugins the changes relative to it
+	// up-to-date backends were removed in step 5, they keep the keys of the last kdbGet() or kdbSet() as their base
+	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	{
+		Key * backendKey = ksAtCursor (backends, i);
+		BackendData * backendData = (BackendData *) keyValue (backendKey);
+		ksDel (backendData->storedKeys);
+		backendData->needsReload = false;
+
+		if (ksLookup (storageBackends, backendKey, 0) != NULL)
+		{
+			backendData->storedKeys = ksDup (backendData->keys);
+		}
+		else
+		{
+			// backends loaded from the cache contain the keys after the poststorage phase and their storage
+			// plugins did not read the changed file, so the next kdbSet() has to write everything
+			backendData->storedKeys = NULL;
+		}
+	}
+
 	// Step 11: run poststorage phase for spec:/
 	Key * specRoot = keyNew ("spec:/", KEY_END);
-	if (!runGetPhase (backends, parentKey, ELEKTRA_KDB_GET_PHASE_POST_STORAGE_SPEC))
+	if (!runGetPhase (storageBackends, parentKey, ELEKTRA_KDB_GET_PHASE_POST_STORAGE_SPEC, 0))
 	{
 		keyDel (specRoot);
 		goto error;
@@ -1916,7 +2460,7 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 	}
 
 	// Step 16: run poststorage phase for non-spec:/
-	if (!runGetPhase (backends, parentKey, ELETKRA_KDB_GET_PHASE_POST_STORAGE_NONSPEC))
+	if (!runGetPhase (storageBackends, parentKey, ELETKRA_KDB_GET_PHASE_POST_STORAGE_NONSPEC, 0))
 	{
 		ksDel (dataKs);
 		goto error;
@@ -1940,7 +2484,10 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 	keyDel (defaultCutpoint);
 
 	// Step 19: update cache
-	// TODO [new_backend]: implement cache
+	if (handle->hooks.cache.plugin != NULL)
+	{
+		storeBackendsInCache (handle, storageBackends, parentKey);
+	}
 
 	keyCopy (parentKey, initialParent, KEY_CP_NAME | KEY_CP_VALUE);
 	keyDel (initialParent);
@@ -1952,12 +2499,13 @@ int kdbGet (KDB * handle, KeySet * ks, Key * parentKey)
 	}
 	else
 	{
-		keyCopy (parentKey, keyGetMeta (backendsFindParent (allBackends, parentKey), "meta:/internal/kdbmountpoint"),
+		keyCopy (parentKey, keyGetMeta (backendsFindParent (allBackends, NULL, parentKey), "meta:/internal/kdbmountpoint"),
 			 KEY_CP_STRING);
 	}
 
 	ksDel (backends);
 	ksDel (allBackends);
+	ksDel (storageBackends);
 	ksDel (dataKs);
 
 	errno = errnosave;
@@ -1969,15 +2517,244 @@ error:
 	keyCopy (parentKey, initialParent, KEY_CP_NAME);
 	keyDel (initialParent);
 
-	keyCopy (parentKey, keyGetMeta (backendsFindParent (allBackends, parentKey), "meta:/internal/kdbmountpoint"), KEY_CP_STRING);
+	keyCopy (parentKey, keyGetMeta (backendsFindParent (allBackends, NULL, parentKey), "meta:/internal/kdbmountpoint"), KEY_CP_STRING);
 
 	ksDel (backends);
 	ksDel (allBackends);
+	ksDel (storageBackends);
 
 	errno = errnosave;
 	return -1;
 }
 
+/**
+ * @internal
+ *
+ * State of a streaming kdbGet(), see kdbGetStreamOpen().
+ */
+struct _KDBGetStream
+{
+	Key * parentKey;     /*!< the parentKey passed to kdbGetStreamOpen(), receives errors and warnings */
+	Key * initialParent; /*!< a copy of parentKey, the phases change the name of parentKey */
+	KeySet * backends;   /*!< the backends that will be read */
+	elektraCursor next;  /*!< the index of the next backend in backends */
+	KeySet * current;    /*!< the keys returned by the last call to kdbGetStreamNext() */
+};
+
+/**
+ * @brief Starts reading the Keys below @p parentKey one backend at a time.
+ *
+ * This is an alternative to kdbGet() for callers that only read the Keys once,
+ * e.g. to export or list them. Instead of merging the Keys of all backends into
+ * one KeySet, kdbGetStreamNext() returns the Keys of one backend after the other.
+ * Only the Keys of the current backend are kept in memory.
+ *
+ * kdbGetStreamOpen() runs the init and resolver phases for all backends. The
+ * storage phases of a backend only run when kdbGetStreamNext() reaches it.
+ * Backends that are up to date according to their resolver (e.g. because their
+ * file does not exist) are not read again, instead the Keys they got from the
+ * last kdbGet() with @p handle are returned, if there are any.
+ *
+ * Unlike kdbGet() the stream neither uses the cache, nor runs the gopts, spec or
+ * notification hooks, so the returned Keys are exactly the Keys stored in the
+ * backends (after their poststorage phase). `default:/` Keys are not returned.
+ *
+ * Reading through a stream changes the state of the backends of @p handle: the
+ * next kdbGet() with @p handle reads the backends that needed an update again,
+ * even if they did not change since. Use a separate handle, if you want to call
+ * kdbSet() with a KeySet from kdbGet().
+ *
+ * @param handle contains internal information of @link kdbOpen() opened @endlink key database
+ * @param parentKey Keys below @p parentKey will be read. It is also used to add warnings
+ *                  and set error information and must not be deleted before kdbGetStreamClose().
+ *
+ * @return a new stream, which has to be closed with kdbGetStreamClose()
+ * @retval NULL on failure, the error is set in @p parentKey
+ *
+ * @see kdbGetStreamNext() to read the Keys
+ */
+KDBGetStream * kdbGetStreamOpen (KDB * handle, Key * parentKey)
+{
+	if (parentKey == NULL)
+	{
+		ELEKTRA_LOG ("parentKey == NULL");
+		return NULL;
+	}
+
+	if (test_bit (parentKey->flags, KEY_FLAG_RO_META))
+	{
+		ELEKTRA_LOG ("parentKey KEY_FLAG_RO_META");
+		return NULL;
+	}
+
+	clearErrorAndWarnings (parentKey);
+
+	if (test_bit (parentKey->flags, KEY_FLAG_RO_NAME | KEY_FLAG_RO_VALUE))
+	{
+		ELEKTRA_SET_INTERFACE_ERROR (parentKey, "parentKey with read-only name or value passed");
+		return NULL;
+	}
+
+	if (keyGetNamespace (parentKey) == KEY_NS_META)
+	{
+		ELEKTRA_SET_INTERFACE_ERRORF (parentKey, "parentKey with meta:/ name passed ('%s')", keyName (parentKey));
+		return NULL;
+	}
+
+	if (handle == NULL)
+	{
+		ELEKTRA_SET_INTERFACE_ERROR (parentKey, "NULL pointer passed for handle");
+		return NULL;
+	}
+
+	int errnosave = errno;
+	Key * initialParent = keyDup (parentKey, KEY_CP_ALL);
+	KeySet * backends = backendsForParentKey (handle->backends, handle->backendsIndex, parentKey);
+
+	bool success = initBackends (backends, parentKey);
+	clear_bit (parentKey->flags, KEY_FLAG_RO_NAME | KEY_FLAG_RO_VALUE);
+	success = success && resolveBackendsForGet (backends, parentKey, handle->getWorkers);
+
+	keyCopy (parentKey, initialParent, KEY_CP_NAME | KEY_CP_VALUE);
+	errno = errnosave;
+
+	if (!success)
+	{
+		keyDel (initialParent);
+		ksDel (backends);
+		return NULL;
+	}
+
+	// the resolvers consider these backends up to date now, but their keys are dropped while streaming
+	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	{
+		Key * backendKey = ksAtCursor (backends, i);
+		if (keyGetMeta (backendKey, "meta:/internal/kdbneedsupdate") != NULL)
+		{
+			((BackendData *) keyValue (backendKey))->needsReload = true;
+		}
+	}
+
+	KDBGetStream * stream = elektraCalloc (sizeof (KDBGetStream));
+	stream->parentKey = parentKey;
+	stream->initialParent = initialParent;
+	stream->backends = backends;
+	return stream;
+}
+
+/**
+ * @brief Reads the Keys of the next backend of @p stream.
+ *
+ * The Keys in @p keys are sorted and belong to a single backend. The backends
+ * are returned in the order of their mountpoints, so the Keys of a backend
+ * mounted below another backend are returned separately after the Keys of the
+ * outer backend. Thus the Keys are only sorted per call, callers that need the
+ * global order of kdbGet() have to append them to a KeySet. On success the value
+ * of the parentKey is set to the mountpoint identifier (e.g. the file name) of the backend.
+ *
+ * @p keys is owned by the stream and only valid until the next call to
+ * kdbGetStreamNext() or kdbGetStreamClose(). Use ksDup() to keep (some of) the Keys.
+ *
+ * If reading a backend fails, the stream can still be continued with the next backend.
+ *
+ * @param stream the stream from kdbGetStreamOpen()
+ * @param keys set to the Keys of the next backend, or NULL if there are none left
+ *
+ * @retval 1 if the Keys of the next backend are in @p keys
+ * @retval 0 if all backends were read
+ * @retval -1 on failure, the error is set in the parentKey
+ */
+int kdbGetStreamNext (KDBGetStream * stream, KeySet ** keys)
+{
+	if (stream == NULL || keys == NULL)
+	{
+		return -1;
+	}
+	*keys = NULL;
+
+	// only keep the keys of one backend in memory
+	if (stream->current != NULL)
+	{
+		ksClear (stream->current);
+		stream->current = NULL;
+	}
+
+	Key * parentKey = stream->parentKey;
+	while (stream->next < ksGetSize (stream->backends))
+	{
+		Key * backendKey = ksAtCursor (stream->backends, stream->next++);
+		if (keyGetNamespace (backendKey) == KEY_NS_DEFAULT)
+		{
+			continue;
+		}
+
+		BackendData * backendData = (BackendData *) keyValue (backendKey);
+		if (keyGetMeta (backendKey, "meta:/internal/kdbneedsupdate") == NULL)
+		{
+			// up to date, the keys still belong to the handle and are not cleared
+			if (ksGetSize (backendData->keys) == 0) continue;
+			keyCopy (parentKey, keyGetMeta (backendKey, "meta:/internal/kdbmountpoint"), KEY_CP_STRING);
+			*keys = backendData->keys;
+			return 1;
+		}
+
+		KeySet * single = ksNew (1, backendKey, KS_END);
+		int errnosave = errno;
+
+		bool success = runGetPhase (single, parentKey, ELEKTRA_KDB_GET_PHASE_PRE_STORAGE, 0);
+		if (success)
+		{
+			ksClear (backendData->keys);
+			success = runGetPhase (single, parentKey, ELEKTRA_KDB_GET_PHASE_STORAGE, 0) &&
+				  runGetPhase (single, parentKey, ELEKTRA_KDB_GET_PHASE_POST_STORAGE_SPEC, 0) &&
+				  runGetPhase (single, parentKey, ELETKRA_KDB_GET_PHASE_POST_STORAGE_NONSPEC, 0);
+		}
+		ksDel (single);
+
+		// the keys will be cleared, kdbSet() must not use them for its change log
+		ksDel (backendData->storedKeys);
+		backendData->storedKeys = NULL;
+
+		keyCopy (parentKey, stream->initialParent, KEY_CP_NAME | KEY_CP_VALUE);
+		errno = errnosave;
+
+		if (!success)
+		{
+			ksClear (backendData->keys);
+			return -1;
+		}
+
+		clearAllSync (backendData->keys);
+		keyCopy (parentKey, keyGetMeta (backendKey, "meta:/internal/kdbmountpoint"), KEY_CP_STRING);
+		stream->current = backendData->keys;
+		*keys = stream->current;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Closes a stream from kdbGetStreamOpen().
+ *
+ * @param stream the stream, may be NULL
+ */
+void kdbGetStreamClose (KDBGetStream * stream)
+{
+	if (stream == NULL)
+	{
+		return;
+	}
+
+	if (stream->current != NULL)
+	{
+		ksClear (stream->current);
+	}
+	keyDel (stream->initialParent);
+	ksDel (stream->backends);
+	elektraFree (stream);
+}
+
 static bool resolveBackendsForSet (KeySet * backends, Key * parentKey)
 {
 	bool success = true;
@@ -2124,7 +2901,15 @@ static bool runSetPhase (KeySet * backends, Key * parentKey, ElektraKdbPhase pha
 		switch (function)
 		{
 		case KDB_SET_FN_SET:
+			if (phase == ELEKTRA_KDB_SET_PHASE_STORAGE)
+			{
+				// only available during the storage phase of kdbSet(), see elektraPluginGetChangeLog()
+				ksAppendKey (backendData->backend->global,
+					     keyNew ("system:/elektra/kdb/backend/storedkeys", KEY_BINARY, KEY_SIZE,
+						     sizeof (backendData->storedKeys), KEY_VALUE, &backendData->storedKeys, KEY_END));
+			}
 			ret = backendData->backend->kdbSet (backendData->backend, backendData->keys, parentKey);
+			keyDel (ksLookupByName (backendData->backend->global, "system:/elektra/kdb/backend/storedkeys", KDB_O_POP));
 			break;
 		case KDB_SET_FN_COMMIT:
 			ret = backendData->backend->kdbCommit (backendData->backend, backendData->keys, parentKey);
@@ -2337,13 +3122,19 @@ int kdbSet (KDB * handle, KeySet * ks, Key * parentKey)
 		return -1;
 	}
 
+	if (test_bit (ks->flags, KS_FLAG_FROZEN))
+	{
+		ELEKTRA_SET_INTERFACE_ERROR (parentKey, "frozen KeySet passed, use ksDeepDup() to get a KeySet that can be changed");
+		return -1;
+	}
+
 	ELEKTRA_LOG ("now in new kdbSet (%s) %p %zd", keyName (parentKey), (void *) handle, ksGetSize (ks));
 
 	int errnosave = errno;
 	Key * initialParent = keyDup (parentKey, KEY_CP_ALL);
 
 	// Step 1: find backends for parentKey
-	KeySet * backends = backendsForParentKey (handle->backends, parentKey);
+	KeySet * backends = backendsForParentKey (handle->backends, handle->backendsIndex, parentKey);
 
 	// Step 2: check that backends are initialized
 	bool backendsInit = true;
@@ -2500,6 +3291,14 @@ int kdbSet (KDB * handle, KeySet * ks, Key * parentKey)
 	// Step 12c: run postcommit phase
 	runSetPhase (backends, parentKey, ELEKTRA_KDB_SET_PHASE_POST_COMMIT, true, KDB_SET_FN_COMMIT);
 
+	// Step 12d: remember what was written for the change log of the next kdbSet()
+	for (elektraCursor i = 0; i < ksGetSize (backends); i++)
+	{
+		BackendData * backendData = (BackendData *) keyValue (ksAtCursor (backends, i));
+		ksDel (backendData->storedKeys);
+		backendData->storedKeys = ksDup (backendData->keys);
+	}
+
 	SendNotificationHook * sendNotificationHook = handle->hooks.sendNotification;
 	while (sendNotificationHook != NULL)
 	{
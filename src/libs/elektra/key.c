@@ -72,6 +72,145 @@
  * ordering or different Models of your configuration.
  */
 
+/** Names whose canonical form fits into this buffer are canonicalized on the stack in keyNew() */
+#define KEY_NAME_STACK_BUFFER_SIZE 256
+
+/**
+ * @internal
+ *
+ * @return the size of the buffer for a value of @p valueSize bytes behind
+ *         the Key struct, 0 if the value is too big to be stored there
+ */
+static uint16_t inlineValueSize (size_t valueSize)
+{
+	if (valueSize > KEY_INLINE_VALUE_SIZE) return 0;
+	// round up, so that the buffer can be reused for values that grow a little
+	return (valueSize + 7) & ~((size_t) 7);
+}
+
+/**
+ * @internal
+ *
+ * Allocates a Key, a buffer for small values and the (unescaped) name in a single allocation.
+ *
+ * @param name the canonical name
+ * @param nameSize the size of @p name
+ * @param uname the unescaped name, or NULL to compute it from @p name
+ * @param unameSize the size of the unescaped name
+ * @param valueSize the size of the value that will be set, determines the size of the value buffer
+ *
+ * @return the new Key with KEY_FLAG_MMAP_KEY set, because the name must not be freed
+ * @retval NULL on memory allocation problems
+ */
+static Key * keyNewInline (const char * name, size_t nameSize, const char * uname, size_t unameSize, size_t valueSize)
+{
+	uint16_t inlineSize = inlineValueSize (valueSize);
+	Key * key = elektraMalloc (sizeof (Key) + inlineSize + nameSize + unameSize);
+	if (!key) return NULL;
+
+	keyInit (key);
+	key->inlineSize = inlineSize;
+
+	key->key = (char *) key + sizeof (Key) + inlineSize;
+	memcpy (key->key, name, nameSize);
+	key->keySize = nameSize;
+
+	key->ukey = key->key + nameSize;
+	if (uname != NULL)
+	{
+		memcpy (key->ukey, uname, unameSize);
+	}
+	else
+	{
+		elektraKeyNameUnescape (key->key, key->ukey);
+	}
+	key->keyUSize = unameSize;
+
+	key->flags = KEY_FLAG_MMAP_KEY;
+	return key;
+}
+
+/**
+ * @internal
+ *
+ * Creates a Key from an already canonical (and unescaped) name, without validating it again.
+ *
+ * Used for Keys with names that were already canonicalized, e.g. by keySetMeta().
+ *
+ * @param name the canonical name
+ * @param nameSize the size of @p name
+ * @param uname the unescaped name, or NULL to compute it from @p name
+ * @param unameSize the size of the unescaped name
+ * @param valueSize the size of the value that will be set
+ *
+ * @return the new Key
+ * @retval NULL on memory allocation problems
+ */
+Key * elektraKeyNewCanonical (const char * name, size_t nameSize, const char * uname, size_t unameSize, size_t valueSize)
+{
+	Key * key = keyNewInline (name, nameSize, uname, unameSize, valueSize);
+	if (!key) return NULL;
+
+	set_bit (key->flags, KEY_FLAG_SYNC);
+	return key;
+}
+
+/**
+ * @internal
+ *
+ * Finds the size of the value keyVNew() will set, for sizing the value buffer of the Key.
+ *
+ * @param va the arguments of keyVNew(), they are not consumed
+ */
+static size_t keyVNewValueSize (va_list va)
+{
+	va_list copy;
+	va_copy (copy, va);
+
+	size_t size = 0;
+	size_t valueSize = 0;
+	int binary = 0;
+	elektraKeyFlags action;
+	while ((action = va_arg (copy, elektraKeyFlags)))
+	{
+		switch (action)
+		{
+		case KEY_SIZE:
+			valueSize = va_arg (copy, size_t);
+			break;
+		case KEY_VALUE: {
+			const char * value = va_arg (copy, const char *);
+			if (value == NULL)
+				size = 0;
+			else if (binary && valueSize)
+				size = valueSize;
+			else
+				size = elektraStrLen (value);
+			break;
+		}
+		case KEY_FUNC:
+			va_arg (copy, void (*) (void));
+			size = sizeof (void (*) (void));
+			break;
+		case KEY_META:
+			va_arg (copy, char *);
+			va_arg (copy, char *);
+			break;
+		case KEY_FLAGS:
+			binary |= va_arg (copy, int) & KEY_BINARY;
+			break;
+		case KEY_BINARY:
+			binary = 1;
+			break;
+		default:
+			break;
+		}
+	}
+
+	va_end (copy);
+	return size;
+}
+
 /**
  * A practical way to fully create a Key object in one step.
  *
@@ -125,6 +264,9 @@
  * @pre Variable arguments are a valid combination
  * @post returns a new, fully initialized Key object with the valid Key name and all data given by variable arguments
  *
+ * The Key, its name and values of up to #KEY_INLINE_VALUE_SIZE bytes are stored in a single allocation.
+ * Renaming the Key moves the name into its own buffer, values that fit keep using the buffer of the Key.
+ *
  * @param name a valid name to the key (see keySetName())
  *
  * @return a pointer to a new allocated and initialized Key object.
@@ -157,7 +299,26 @@ Key * keyVNew (const char * name, va_list va)
 {
 	if (!name) return NULL;
 
-	Key * key = elektraCalloc (sizeof (Key));
+	if (strlen (name) == 0 || !elektraKeyNameValidate (name, true))
+	{
+		ELEKTRA_LOG_WARNING ("Invalid name: %s", name);
+		return NULL;
+	}
+
+	// canonicalize on the stack, so that the name can be stored together with the Key
+	char stackBuffer[KEY_NAME_STACK_BUFFER_SIZE];
+	size_t maxSize = ELEKTRA_KEY_NAME_CANONICAL_SIZE_MAX (0, strlen (name) + 1);
+	char * canonicalName = maxSize <= sizeof (stackBuffer) ? stackBuffer : elektraMalloc (maxSize);
+	if (!canonicalName) return NULL;
+
+	size_t usize = 0;
+	size_t size = elektraKeyNameCanonicalizeInto (name, canonicalName, 0, &usize);
+
+	Key * key = keyNewInline (canonicalName, size, NULL, usize, keyVNewValueSize (va));
+	if (canonicalName != stackBuffer) elektraFree (canonicalName);
+	if (!key) return NULL;
+
+	set_bit (key->flags, KEY_FLAG_SYNC);
 
 	elektraKeyFlags action = 0;
 	size_t value_size = 0;
@@ -213,15 +374,53 @@ Key * keyVNew (const char * name, va_list va)
 		}
 	}
 
-	if (keySetName (key, name) < 0)
+	keyLock (key, flags);
+	return key;
+}
+
+/**
+ * Duplicate a Key.
+ *
+ * Equivalent to `keyCopy (keyNew ("/", KEY_END), source, flags)`,
+ * but the new Key is allocated together with its name and small values
+ * (see keyNew()).
+ *
+ * @param source the Key to duplicate
+ * @param flags specifies which parts of the key should be copied, see keyCopy()
+ *
+ * @return a new Key, which must be freed with keyDel()
+ * @retval NULL on memory allocation problems or invalid @p flags (see keyCopy())
+ *
+ * @since 1.0.0
+ * @ingroup key
+ * @see keyCopy() for copying into an existing Key
+ */
+Key * keyDup (const Key * source, elektraCopyFlags flags)
+{
+	size_t valueSize = 0;
+	if (source != NULL && (test_bit (flags, KEY_CP_VALUE) || test_bit (flags, KEY_CP_STRING)))
+	{
+		valueSize = source->dataSize;
+	}
+
+	Key * dest;
+	if (source != NULL && test_bit (flags, KEY_CP_NAME) && source->key != NULL)
 	{
-		ELEKTRA_LOG_WARNING ("Invalid name: %s", name);
-		elektraFree (key);
+		dest = keyNewInline (source->key, source->keySize, source->ukey, source->keyUSize, valueSize);
+	}
+	else
+	{
+		dest = keyNewInline ("/", 2, NULL, 3, valueSize);
+	}
+	if (!dest) return NULL;
+
+	if (keyCopy (dest, source, flags & ~KEY_CP_NAME) == NULL)
+	{
+		keyDel (dest);
 		return NULL;
 	}
 
-	keyLock (key, flags);
-	return key;
+	return dest;
 }
 
 /**
@@ -332,6 +531,7 @@ Key * keyCopy (Key * dest, const Key * source, elektraCopyFlags flags)
 		}
 		if (test_bit (flags, KEY_CP_META))
 		{
+			if (elektraKeyDetachMeta (dest) == -1) return NULL;
 			ksClear (dest->meta);
 		}
 		return dest;
@@ -372,12 +572,15 @@ Key * keyCopy (Key * dest, const Key * source, elektraCopyFlags flags)
 		clear_bit (dest->flags, KEY_FLAG_MMAP_KEY);
 	}
 
+	bool inlineValue = false;
 	if (test_bit (flags, KEY_CP_STRING))
 	{
 		if (source->data.v != NULL)
 		{
-			dest->data.v = elektraMemDup (source->data.v, source->dataSize);
-			if (!dest->data.v) goto memerror;
+			// values that fit into the buffer behind dest are copied there, once nothing can fail anymore
+			inlineValue = source->dataSize <= dest->inlineSize;
+			dest->data.v = inlineValue ? NULL : elektraMemDup (source->data.v, source->dataSize);
+			if (!inlineValue && !dest->data.v) goto memerror;
 			dest->dataSize = source->dataSize;
 
 			if (!test_bit (flags, KEY_CP_META) && keyIsBinary (source))
@@ -397,8 +600,9 @@ Key * keyCopy (Key * dest, const Key * source, elektraCopyFlags flags)
 	{
 		if (source->data.v != NULL)
 		{
-			dest->data.v = elektraMemDup (source->data.v, source->dataSize);
-			if (!dest->data.v) goto memerror;
+			inlineValue = source->dataSize <= dest->inlineSize;
+			dest->data.v = inlineValue ? NULL : elektraMemDup (source->data.v, source->dataSize);
+			if (!inlineValue && !dest->data.v) goto memerror;
 			dest->dataSize = source->dataSize;
 
 			if (!test_bit (flags, KEY_CP_META) && keyIsBinary (source))
@@ -418,7 +622,8 @@ Key * keyCopy (Key * dest, const Key * source, elektraCopyFlags flags)
 	{
 		if (source->meta != NULL)
 		{
-			dest->meta = ksDup (source->meta);
+			// shared copy-on-write, unless source is part of a frozen KeySet
+			dest->meta = elektraMetaShare (source->meta);
 			if (!dest->meta) goto memerror;
 		}
 		else
@@ -442,14 +647,28 @@ Key * keyCopy (Key * dest, const Key * source, elektraCopyFlags flags)
 		elektraFree (orig.data.c);
 	}
 
-	if (test_bit (flags, KEY_CP_META)) ksDel (orig.meta);
+	if (test_bit (flags, KEY_CP_META)) elektraMetaRelease (orig.meta);
+
+	if (test_bit (flags, KEY_CP_VALUE) || test_bit (flags, KEY_CP_STRING))
+	{
+		// the cached typed value belongs to the value, a failed copy only means it has to be converted again
+		elektraKeyClearTypedValue (dest);
+		dest->typedValue = elektraTypedValueDup (source->typedValue);
+	}
+
+	if (inlineValue)
+	{
+		dest->data.v = (char *) dest + sizeof (Key);
+		memcpy (dest->data.v, source->data.v, source->dataSize);
+		set_bit (dest->flags, KEY_FLAG_MMAP_DATA);
+	}
 
 	return dest;
 
 memerror:
 	elektraFree (dest->key);
 	elektraFree (dest->data.v);
-	ksDel (dest->meta);
+	if (dest->meta != orig.meta) elektraMetaRelease (dest->meta);
 
 	*dest = orig;
 	return NULL;
@@ -460,6 +679,7 @@ static void keyClearNameValue (Key * key)
 	if (key->key && !test_bit (key->flags, KEY_FLAG_MMAP_KEY)) elektraFree (key->key);
 	if (key->ukey && !test_bit (key->flags, KEY_FLAG_MMAP_KEY)) elektraFree (key->ukey);
 	if (key->data.v && !test_bit (key->flags, KEY_FLAG_MMAP_DATA)) elektraFree (key->data.v);
+	elektraKeyClearTypedValue (key);
 }
 
 
@@ -500,12 +720,17 @@ int keyDel (Key * key)
 	}
 
 	int keyInMmap = test_bit (key->flags, KEY_FLAG_MMAP_STRUCT);
+	int keyInArena = test_bit (key->flags, KEY_FLAG_ARENA);
 
 	keyClearNameValue (key);
 
-	ksDel (key->meta);
+	elektraMetaRelease (key->meta);
 
-	if (!keyInMmap)
+	if (keyInArena)
+	{
+		elektraArenaReleaseKey (key);
+	}
+	else if (!keyInMmap)
 	{
 		elektraFree (key);
 	}
@@ -558,13 +783,17 @@ int keyClear (Key * key)
 	ref = key->refs;
 
 	int keyStructInMmap = test_bit (key->flags, KEY_FLAG_MMAP_STRUCT);
+	int keyStructInArena = test_bit (key->flags, KEY_FLAG_ARENA);
+	uint16_t inlineSize = key->inlineSize;
 
 	keyClearNameValue (key);
 
-	ksDel (key->meta);
+	elektraMetaRelease (key->meta);
 
 	keyInit (key);
 	if (keyStructInMmap) key->flags |= KEY_FLAG_MMAP_STRUCT;
+	if (keyStructInArena) key->flags |= KEY_FLAG_ARENA;
+	key->inlineSize = inlineSize;
 
 	keySetName (key, "/");
 
@@ -123,6 +123,117 @@
 #include <errno.h>
 #endif
 
+/**
+ * @internal
+ *
+ * @brief Shares the metadata KeySet @p meta with one more Key
+ *
+ * Metadata KeySets are shared copy-on-write: A KeySet with KS_FLAG_SHARED_META
+ * is the metadata of `shares` Keys. Before one of these Keys changes its metadata,
+ * elektraKeyDetachMeta() gives it its own copy. The public reference counter
+ * (see ksIncRef()) is not used for this.
+ *
+ * KeySets that cannot be shared are copied instead: the metadata of frozen
+ * KeySets (see ksFreeze()) is deeply copied, KeySets returned by keyMeta()
+ * and KeySets someone else holds a reference to (see ksIncRef()) are copied
+ * with ksDup().
+ *
+ * @param meta the metadata KeySet of a Key
+ *
+ * @return the KeySet to use as metadata of the other Key, release it with elektraMetaRelease()
+ * @retval NULL on memory errors
+ */
+KeySet * elektraMetaShare (KeySet * meta)
+{
+	if (test_bit (meta->flags, KS_FLAG_FROZEN)) return ksDeepDup (meta);
+	if (test_bit (meta->flags, KS_FLAG_EXPOSED_META) || meta->refs > 0) return ksDup (meta);
+
+	if (!test_bit (meta->flags, KS_FLAG_SHARED_META))
+	{
+		set_bit (meta->flags, KS_FLAG_SHARED_META);
+		meta->shares = 1;
+	}
+
+	if (meta->shares == UINT16_MAX) return ksDup (meta);
+	++meta->shares;
+	return meta;
+}
+
+/**
+ * @internal
+ *
+ * @brief Releases the metadata KeySet @p meta of a Key
+ *
+ * Shared KeySets are only deleted, once no Key uses them anymore.
+ *
+ * @param meta the metadata KeySet, may be NULL
+ */
+void elektraMetaRelease (KeySet * meta)
+{
+	if (meta == NULL) return;
+
+	if (test_bit (meta->flags, KS_FLAG_SHARED_META))
+	{
+		if (--meta->shares > 0) return;
+		clear_bit (meta->flags, (ksflag_t) KS_FLAG_SHARED_META);
+	}
+	ksDel (meta);
+}
+
+/**
+ * @internal
+ *
+ * @brief Gives @p key its own metadata KeySet, if it shares it with other Keys
+ *
+ * Must be called before the metadata KeySet of @p key is modified.
+ * The Keys in the metadata KeySet are still shared, they are read-only anyway.
+ *
+ * @param key the Key that wants to modify its metadata
+ *
+ * @retval 0 on success
+ * @retval -1 on memory errors
+ */
+int elektraKeyDetachMeta (Key * key)
+{
+	KeySet * meta = key->meta;
+	if (meta == NULL || !test_bit (meta->flags, KS_FLAG_SHARED_META)) return 0;
+
+	if (meta->shares == 1)
+	{
+		// the other Keys are gone already
+		clear_bit (meta->flags, (ksflag_t) KS_FLAG_SHARED_META);
+		meta->shares = 0;
+		return 0;
+	}
+
+	KeySet * copy = ksDup (meta);
+	if (copy == NULL) return -1;
+
+	--meta->shares;
+	key->meta = copy;
+	return 0;
+}
+
+/**
+ * @internal
+ *
+ * @brief Returns the metadata KeySet of @p key for reading
+ *
+ * Unlike keyMeta(), this does not give @p key its own copy of metadata it shares
+ * with other Keys. Use it for iterating over the metadata without changing it,
+ * e.g. in storage plugins.
+ *
+ * @param key the Key to get the metadata from
+ *
+ * @return the metadata KeySet, it must not be modified
+ * @retval NULL if @p key is NULL or has no metadata
+ */
+const KeySet * elektraKeyGetMetaKeySet (const Key * key)
+{
+	if (key == NULL) return NULL;
+	return key->meta;
+}
+
 /**
  * Get the next metadata entry of a Key
  *
@@ -235,13 +346,21 @@ int keyCopyMeta (Key * dest, const Key * source, const char * metaName)
 
 	ret = (Key *) keyGetMeta (source, metaName);
 
+	if (ret && test_bit (source->meta->flags, KS_FLAG_FROZEN))
+	{
+		// do not share metadata of frozen KeySets, see ksFreeze()
+		ret = keyDup (ret, KEY_CP_ALL);
+		if (!ret) return -1;
+	}
+
 	if (!ret)
 	{
 		/*Make sure that dest also does not have metaName*/
-		if (dest->meta)
+		Key * target = (Key *) keyGetMeta (dest, metaName);
+		if (target)
 		{
 			Key * r;
-			Key * target = (Key *) keyGetMeta (dest, metaName);
+			if (elektraKeyDetachMeta (dest) == -1) return -1;
 			r = ksLookup (dest->meta, target, KDB_O_POP);
 			if (r)
 			{
@@ -256,6 +375,16 @@ int keyCopyMeta (Key * dest, const Key * source, const char * metaName)
 	if (dest->meta)
 	{
 		Key * r;
+		if (keyGetMeta (dest, metaName) == ret)
+		{
+			// nothing to do, e.g. if both Keys share their metadata anyway
+			return 1;
+		}
+		if (elektraKeyDetachMeta (dest) == -1)
+		{
+			if (test_bit (source->meta->flags, KS_FLAG_FROZEN)) keyDel (ret); // only deletes duplicated metadata
+			return -1;
+		}
 		r = ksLookup (dest->meta, ret, KDB_O_POP);
 		if (r && r != ret)
 		{
@@ -269,6 +398,7 @@ int keyCopyMeta (Key * dest, const Key * source, const char * metaName)
 		dest->meta = ksNew (0, KS_END);
 		if (!dest->meta)
 		{
+			keyDel (ret); // only deletes duplicated metadata
 			return -1;
 		}
 	}
@@ -306,6 +436,10 @@ int keyCopyMeta (Key * dest, const Key * source, const char * metaName)
  *
  * @snippet keyMeta.c Shared Meta All
  *
+ * If @p dest has no metadata yet, keyCopyAllMeta() does not even copy the
+ * metadata KeySet: both Keys share it copy-on-write until one of them
+ * changes its metadata.
+ *
  * @pre @p dest's metadata is not read-only
  * @post for every metaName present in source: keyGetMeta(source, metaName) == keyGetMeta(dest, metaName)
  *
@@ -329,21 +463,148 @@ int keyCopyAllMeta (Key * dest, const Key * source)
 
 	if (ksGetSize (source->meta) > 0)
 	{
+		if (dest->meta == source->meta) return 1;
+
+		if (dest->meta == NULL)
+		{
+			// dest gets exactly the metadata of source, so both can use the same KeySet
+			dest->meta = elektraMetaShare (source->meta);
+			return dest->meta ? 1 : -1;
+		}
+
+		if (elektraKeyDetachMeta (dest) == -1) return -1;
+
+		// do not share metadata of frozen KeySets, see ksFreeze()
+		bool frozen = test_bit (source->meta->flags, KS_FLAG_FROZEN);
+		KeySet * meta = frozen ? ksDeepDup (source->meta) : source->meta;
+		if (!meta) return -1;
+
 		/*Make sure that dest also does not have metaName*/
 		if (dest->meta)
 		{
-			ksAppend (dest->meta, source->meta);
+			ksAppend (dest->meta, meta);
 		}
 		else
 		{
-			dest->meta = ksDup (source->meta);
+			dest->meta = ksDup (meta);
 		}
+
+		if (frozen) ksDel (meta);
 		return 1;
 	}
 
 	return 0;
 }
 
+/** size of the stack buffer for the names of metadata Keys, longer names are allocated */
+#define META_NAME_STACK_BUFFER_SIZE 256
+
+/**
+ * @internal
+ *
+ * @brief Checks whether @p name consists only of parts with letters, digits, `_` and `-`,
+ * separated by single slashes. Such names are already canonical and contain no escapes.
+ *
+ * @return the length of @p name, or 0 if it is not such a name
+ */
+static size_t metaNameSimpleLength (const char * name)
+{
+	const char * cur = name;
+	bool partStart = true;
+	for (; *cur != '\0'; ++cur)
+	{
+		char c = *cur;
+		if (c == '/')
+		{
+			if (partStart) return 0;
+			partStart = true;
+		}
+		else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (!partStart && (c == '_' || c == '-')))
+		{
+			partStart = false;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return partStart ? 0 : (size_t) (cur - name);
+}
+
+/**
+ * @internal
+ *
+ * @brief Sets up @p search as a Key with the name `meta:/<metaName>` for searching in metadata
+ *
+ * Only the (unescaped) name is set, so @p search must only be passed to ksSearch() or
+ * elektraKeyNewCanonical(). The names are stored in @p buffer, if it is big enough,
+ * otherwise they are allocated.
+ *
+ * @param search the Key to set up
+ * @param metaName the name of the metadata, with or without `meta:/` prefix
+ * @param buffer the buffer for the names
+ * @param bufferSize the size of @p buffer
+ *
+ * @return the memory holding the names, free it with elektraFree() if it is not @p buffer
+ * @retval NULL if @p metaName is invalid or on memory errors
+ */
+static char * metaSearchKeyInit (Key * search, const char * metaName, char * buffer, size_t bufferSize)
+{
+	const size_t prefixSize = sizeof ("meta:/") - 1;
+	bool prefixed = strncmp (metaName, "meta:/", prefixSize) == 0;
+
+	// fast path for usual names, which need no canonicalization
+	const char * part = prefixed ? metaName + prefixSize : metaName;
+	size_t partLength = metaNameSimpleLength (part);
+	if (partLength > 0 && prefixSize + 2 * partLength + 4 <= bufferSize)
+	{
+		keyInit (search);
+		search->key = buffer;
+		memcpy (search->key, "meta:/", prefixSize);
+		memcpy (search->key + prefixSize, part, partLength + 1);
+		search->keySize = prefixSize + partLength + 1;
+
+		search->ukey = search->key + search->keySize;
+		search->ukey[0] = KEY_NS_META;
+		search->ukey[1] = '\0';
+		for (size_t i = 0; i <= partLength; ++i)
+		{
+			search->ukey[i + 2] = part[i] == '/' ? '\0' : part[i];
+		}
+		search->keyUSize = partLength + 3;
+		return buffer;
+	}
+
+	size_t nameSize = strlen (metaName) + 1;
+	size_t fullSize = prefixed ? 0 : prefixSize + nameSize;
+	size_t maxSize = ELEKTRA_KEY_NAME_CANONICAL_SIZE_MAX (0, prefixed ? nameSize : fullSize);
+	size_t size = fullSize + 2 * maxSize;
+
+	char * names = size <= bufferSize ? buffer : elektraMalloc (size);
+	if (!names) return NULL;
+
+	const char * name = metaName;
+	if (!prefixed)
+	{
+		memcpy (names, "meta:/", prefixSize);
+		memcpy (names + prefixSize, metaName, nameSize);
+		name = names;
+	}
+
+	if (!elektraKeyNameValidate (name, true))
+	{
+		if (names != buffer) elektraFree (names);
+		return NULL;
+	}
+
+	keyInit (search);
+	search->key = names + fullSize;
+	search->keySize = elektraKeyNameCanonicalizeInto (name, search->key, 0, &search->keyUSize);
+	search->ukey = search->key + maxSize;
+	elektraKeyNameUnescape (search->key, search->ukey);
+	return names;
+}
+
 /**
  * Returns the Key for a metadata entry with name @p metaName.
  *
@@ -378,28 +639,20 @@ char keyType[] = keyValue(metaData)
  **/
 const Key * keyGetMeta (const Key * key, const char * metaName)
 {
-	Key * ret;
-	Key * search;
-
 	if (!key) return 0;
 	if (!metaName) return 0;
 	if (!key->meta) return 0;
 
-	if (strncmp (metaName, "meta:/", sizeof ("meta:/") - 1) == 0)
-	{
-		search = keyNew (metaName, KEY_END);
-	}
-	else
-	{
-		search = keyNew ("meta:/", KEY_END);
-		keyAddName (search, metaName);
-	}
-
-	ret = ksLookup (key->meta, search, 0);
+	// search with a Key on the stack, nothing is allocated for usual metadata names
+	char buffer[META_NAME_STACK_BUFFER_SIZE];
+	Key search;
+	char * names = metaSearchKeyInit (&search, metaName, buffer, sizeof (buffer));
+	if (!names) return 0;
 
-	keyDel (search);
+	ssize_t found = ksSearch (key->meta, &search);
 
-	return ret;
+	if (names != buffer) elektraFree (names);
+	return found < 0 ? 0 : key->meta->array[found];
 }
 
 
@@ -441,8 +694,6 @@ const Key * keyGetMeta (const Key * key, const char * metaName)
  **/
 ssize_t keySetMeta (Key * key, const char * metaName, const char * newMetaString)
 {
-	Key * toSet;
-	char * metaStringDup;
 	ssize_t metaNameSize;
 	ssize_t metaStringSize = 0;
 
@@ -456,53 +707,36 @@ ssize_t keySetMeta (Key * key, const char * metaName, const char * newMetaString
 	// optimization: we have nothing and want to remove something:
 	if (!key->meta && !newMetaString) return 0;
 
-	if (strncmp (metaName, "meta:/", sizeof ("meta:/") - 1) == 0)
-	{
-		toSet = keyNew (metaName, KEY_END);
-	}
-	else
-	{
-		toSet = keyNew ("meta:/", KEY_END);
-		keyAddName (toSet, metaName);
-	}
-	if (!toSet) return -1;
+	char buffer[META_NAME_STACK_BUFFER_SIZE];
+	Key search;
+	char * names = metaSearchKeyInit (&search, metaName, buffer, sizeof (buffer));
+	if (!names) return -1;
 
-	/*Lets have a look if the key is already inserted.*/
-	if (key->meta)
+	if (newMetaString == NULL)
 	{
-		Key * ret;
-		ret = ksLookup (key->meta, toSet, KDB_O_POP);
-		if (ret)
+		/*The request is to remove the meta string.
+		  So simply drop it, if it is there.*/
+		ssize_t found = key->meta ? ksSearch (key->meta, &search) : -1;
+		if (names != buffer) elektraFree (names);
+		if (found >= 0)
 		{
-			/*It was already there, so lets drop that one*/
-			keyDel (ret);
+			// the position is the same in the copy
+			if (elektraKeyDetachMeta (key) == -1) return -1;
+			keyDel (elektraKsPopAtCursor (key->meta, found));
 			key->flags |= KEY_FLAG_SYNC;
 		}
+		return 0;
 	}
 
-	if (newMetaString != NULL)
-	{
-		/*Add the meta information to the key*/
-		metaStringDup = elektraMemDup (newMetaString, metaStringSize);
-		if (metaStringDup == NULL)
-		{
-			// TODO: actually we might already have changed
-			// the key
-			keyDel (toSet);
-			return -1;
-		}
+	// the name is already canonical, the value is stored together with the Key
+	Key * toSet = elektraKeyNewCanonical (search.key, search.keySize, search.ukey, search.keyUSize, metaStringSize);
+	if (names != buffer) elektraFree (names);
+	if (!toSet) return -1;
 
-		if (toSet->data.v && !test_bit (toSet->flags, KEY_FLAG_MMAP_DATA)) elektraFree (toSet->data.v);
-		clear_bit (toSet->flags, (keyflag_t) KEY_FLAG_MMAP_DATA);
-		toSet->data.c = metaStringDup;
-		toSet->dataSize = metaStringSize;
-	}
-	else
+	if (keySetRaw (toSet, newMetaString, metaStringSize) == -1)
 	{
-		/*The request is to remove the meta string.
-		  So simply drop it.*/
 		keyDel (toSet);
-		return 0;
+		return -1;
 	}
 
 	if (!key->meta)
@@ -515,12 +749,18 @@ ssize_t keySetMeta (Key * key, const char * metaName, const char * newMetaString
 			return -1;
 		}
 	}
+	else if (elektraKeyDetachMeta (key) == -1)
+	{
+		keyDel (toSet);
+		return -1;
+	}
 
 	set_bit (toSet->flags, KEY_FLAG_RO_NAME);
 	set_bit (toSet->flags, KEY_FLAG_RO_VALUE);
 	set_bit (toSet->flags, KEY_FLAG_RO_META);
 
-	ksAppendKey (key->meta, toSet);
+	// replaces the metadata Key with the same name, if there is one
+	if (ksAppendKey (key->meta, toSet) == -1) return -1;
 	key->flags |= KEY_FLAG_SYNC;
 	return metaStringSize;
 }
@@ -543,6 +783,10 @@ ssize_t keySetMeta (Key * key, const char * metaName, const char * newMetaString
  * @note You are not allowed to modify the name of KeySet's Keys or delete them.
  * @note You must not delete the returned KeySet.
  * @note Adding a key with metadata to the KeySet is an error.
+ * @note If @p key shares its metadata with other Keys (see keyCopyAllMeta()),
+ *       it gets its own copy of the metadata KeySet first. The returned
+ *       KeySet is never shared with other Keys afterwards, e.g. keyDup()
+ *       copies it, so modifying it only changes the metadata of @p key.
  *
  * @post for the returned KeySet ks: keyGetMeta(key, metaName) ==
  * ksLookupByName(ks, metaName)
@@ -553,6 +797,7 @@ ssize_t keySetMeta (Key * key, const char * metaName, const char * newMetaString
  * @return the KeySet holding the metadata
  * @retval 0 if the Key is 0
  * @retval 0 if the Key has no metadata
+ * @retval 0 on memory errors
  *
  * @since 1.0.0
  * @ingroup keymeta
@@ -563,6 +808,9 @@ KeySet * keyMeta (Key * key)
 {
 	if (!key) return 0;
 	if (!key->meta) key->meta = ksNew (0, KS_END);
+	// the caller may modify the KeySet, now and after later copies of the Key
+	if (elektraKeyDetachMeta (key) == -1) return 0;
+	if (!test_bit (key->meta->flags, KS_FLAG_FROZEN)) set_bit (key->meta->flags, KS_FLAG_EXPOSED_META);
 
 	return key->meta;
 }
@@ -165,6 +165,156 @@
 #include "kdbhelper.h"
 #include "kdbinternal.h"
 
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define ELEKTRA_KEYNAME_SSE2
+#include <emmintrin.h>
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 5)
+#define ELEKTRA_KEYNAME_AVX2
+#include <immintrin.h>
+#endif
+// the vectorized scanners read whole aligned blocks, which may extend past the end of a name
+#define ELEKTRA_KEYNAME_NO_SANITIZE __attribute__ ((no_sanitize_address))
+#endif
+
+/**
+ * @internal
+ *
+ * Finds the first character in @p name that needs special handling during
+ * canonicalization or unescaping, i.e. a backslash, a slash or the terminator.
+ *
+ * @param name the (part of a) key name to scan
+ *
+ * @returns pointer to the first `\\`, `/` or `\0` in @p name
+ */
+typedef const char * (*KeyNameScanner) (const char * name);
+
+static const char * scanSpecialScalar (const char * name)
+{
+	while (*name != '\0' && *name != '/' && *name != '\\')
+	{
+		++name;
+	}
+	return name;
+}
+
+#ifdef ELEKTRA_KEYNAME_SSE2
+ELEKTRA_KEYNAME_NO_SANITIZE static const char * scanSpecialSse2 (const char * name)
+{
+	const __m128i terminator = _mm_setzero_si128 ();
+	const __m128i slash = _mm_set1_epi8 ('/');
+	const __m128i backslash = _mm_set1_epi8 ('\\');
+
+	// aligned loads never cross a page boundary, so reading past the terminator is safe
+	size_t misalignment = (uintptr_t) name % sizeof (__m128i);
+	const char * block = name - misalignment;
+	for (;;)
+	{
+		__m128i chunk = _mm_load_si128 ((const __m128i *) block);
+		__m128i special = _mm_or_si128 (_mm_cmpeq_epi8 (chunk, terminator),
+						_mm_or_si128 (_mm_cmpeq_epi8 (chunk, slash), _mm_cmpeq_epi8 (chunk, backslash)));
+		unsigned int mask = (unsigned int) _mm_movemask_epi8 (special) >> misalignment;
+		if (mask != 0)
+		{
+			return block + misalignment + __builtin_ctz (mask);
+		}
+		block += sizeof (__m128i);
+		misalignment = 0;
+	}
+}
+#endif
+
+#ifdef ELEKTRA_KEYNAME_AVX2
+__attribute__ ((target ("avx2"))) ELEKTRA_KEYNAME_NO_SANITIZE static const char * scanSpecialAvx2 (const char * name)
+{
+	const __m256i terminator = _mm256_setzero_si256 ();
+	const __m256i slash = _mm256_set1_epi8 ('/');
+	const __m256i backslash = _mm256_set1_epi8 ('\\');
+
+	size_t misalignment = (uintptr_t) name % sizeof (__m256i);
+	const char * block = name - misalignment;
+	for (;;)
+	{
+		__m256i chunk = _mm256_load_si256 ((const __m256i *) block);
+		__m256i special = _mm256_or_si256 (_mm256_cmpeq_epi8 (chunk, terminator),
+						   _mm256_or_si256 (_mm256_cmpeq_epi8 (chunk, slash), _mm256_cmpeq_epi8 (chunk, backslash)));
+		uint32_t mask = (uint32_t) _mm256_movemask_epi8 (special) >> misalignment;
+		if (mask != 0)
+		{
+			return block + misalignment + __builtin_ctz (mask);
+		}
+		block += sizeof (__m256i);
+		misalignment = 0;
+	}
+}
+#endif
+
+/** the scanner used by the key name functions, see selectScanner() */
+static KeyNameScanner scanSpecial = scanSpecialScalar;
+
+#if defined(ELEKTRA_KEYNAME_SSE2) || defined(ELEKTRA_KEYNAME_AVX2)
+/**
+ * @internal
+ *
+ * Selects the fastest scanner supported by the CPU.
+ *
+ * Runs once when the library is loaded, i.e. before any thread can use
+ * key names, so scanSpecial is never written afterwards.
+ */
+__attribute__ ((constructor)) static void selectScanner (void)
+{
+#ifdef ELEKTRA_KEYNAME_AVX2
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2"))
+	{
+		scanSpecial = scanSpecialAvx2;
+		return;
+	}
+#endif
+#ifdef ELEKTRA_KEYNAME_SSE2
+	scanSpecial = scanSpecialSse2;
+#endif
+}
+#endif
+
+#ifdef ELEKTRA_KEYNAME_SCANNER_OVERRIDE
+/**
+ * @internal
+ *
+ * Selects the scanner used by the copy of this file included by a test
+ * or benchmark. Not part of the library.
+ *
+ * @param scanner one of `"scalar"`, `"sse2"` or `"avx2"`
+ *
+ * @retval true if @p scanner is now used
+ * @retval false if @p scanner is unknown or not supported by this build or CPU
+ */
+static bool useScanner (const char * scanner)
+{
+	if (strcmp (scanner, "scalar") == 0)
+	{
+		scanSpecial = scanSpecialScalar;
+		return true;
+	}
+#ifdef ELEKTRA_KEYNAME_SSE2
+	if (strcmp (scanner, "sse2") == 0)
+	{
+		scanSpecial = scanSpecialSse2;
+		return true;
+	}
+#endif
+#ifdef ELEKTRA_KEYNAME_AVX2
+	if (strcmp (scanner, "avx2") == 0)
+	{
+		__builtin_cpu_init ();
+		if (!__builtin_cpu_supports ("avx2")) return false;
+		scanSpecial = scanSpecialAvx2;
+		return true;
+	}
+#endif
+	return false;
+}
+#endif
+
 /**
  * Helper method: returns a pointer to the start of the last part of the given key name
  *
@@ -838,40 +988,33 @@ bool elektraKeyNameValidate (const char * name, bool isComplete)
 }
 
 /**
- * Takes a valid (non-)canonical key name and produces its canonical form.
+ * Takes a valid (non-)canonical key name and writes its canonical form into a buffer
+ * that is big enough for any result.
  * As a side-effect it can also calculate the size of the corresponding unescaped key name.
  *
+ * Unlike elektraKeyNameCanonicalize() this function never allocates memory,
+ * e.g. the canonical name can be written directly into a stack buffer.
+ *
  * @param name          The key name that is processed
- * @param canonicalName Output buffer for the canonical name
- * @param canonicalSizePtr Pointer to size of @p canonicalName
+ * @param canonicalName Output buffer for the canonical name, at least
+ *                      `ELEKTRA_KEY_NAME_CANONICAL_SIZE_MAX (offset, strlen (name) + 1)` bytes big
  * @param offset        Offset into @p canonicalName
  * @param usizePtr      Output variable for the size of the unescaped name
  *
  * @pre @p name MUST be a valid (non-)canonical key name. If it is not, the result is undefined
- * @pre @p canonicalName MUST be a valid first argument for elektraRealloc() when cast to void**
- * @pre @p canonicalSizePtr >= @p offset
- * @pre @p offset MUST be 0 or `*canonicalName + offset` MUST point to the zero-termintor of a valid canonical key name that starts at
- * `*canonicalName`
+ * @pre @p offset MUST be 0 or `canonicalName + offset` MUST point to the zero-termintor of a valid canonical key name that starts at
+ * `canonicalName`
  * @pre if @p offset is 0 then `*usizePtr` MUST 0, otherwise `*usizePtr` MUST be the correct unescaped size of the existing canonical name
- * in `*canonicalName`
+ * in `canonicalName`
  *
- * @see elektraKeyNameValidate
+ * @return the size of the canonical name, including the zero-terminator
+ *
+ * @see elektraKeyNameCanonicalize
  *
  * @ingroup keyname
  */
-void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_t * canonicalSizePtr, size_t offset, size_t * usizePtr)
+size_t elektraKeyNameCanonicalizeInto (const char * name, char * canonicalName, size_t offset, size_t * usizePtr)
 {
-	size_t nameLen = strlen (name) + 1;
-
-	// ensure output is at least as big as input
-	// output buffer will be enlarged when needed
-	// at the end we shrink to the correct size
-	if (offset + nameLen + 1 > *canonicalSizePtr)
-	{
-		*canonicalSizePtr = offset + nameLen;
-		elektraRealloc ((void **) canonicalName, *canonicalSizePtr);
-	}
-
 	char * outPtr;
 	size_t usize;
 
@@ -881,7 +1024,7 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 	{
 		// namespace byte
 		usize = 1;
-		outPtr = *canonicalName;
+		outPtr = canonicalName;
 
 		if (*name != '/')
 		{
@@ -896,7 +1039,7 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 			name = colon + 1;
 		}
 
-		rootOffset = outPtr - *canonicalName;
+		rootOffset = outPtr - canonicalName;
 
 		// handle root slash
 		*outPtr++ = '/';
@@ -905,7 +1048,7 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 	else
 	{
 		usize = *usizePtr;
-		outPtr = *canonicalName + offset - 2;
+		outPtr = canonicalName + offset - 2;
 
 		if (usize == 3)
 		{
@@ -921,13 +1064,13 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 		}
 
 		// find root slash
-		if (**canonicalName == '/')
+		if (*canonicalName == '/')
 		{
 			rootOffset = 0;
 		}
 		else
 		{
-			rootOffset = strchr (*canonicalName, ':') - *canonicalName + 1;
+			rootOffset = strchr (canonicalName, ':') - canonicalName + 1;
 		}
 	}
 
@@ -981,7 +1124,7 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 					*outPtr = '\0';
 
 					// 2. find start of previous part
-					char * newOutPtr = findStartOfLastPart (*canonicalName, outPtr - *canonicalName);
+					char * newOutPtr = findStartOfLastPart (canonicalName, outPtr - canonicalName);
 
 					// 3. calculate unescaped length of part, including separator
 					size_t ulen = outPtr - newOutPtr - 1;
@@ -1054,14 +1197,6 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 			if (len > 0 && check1 && check2 && (len < 19 || (len == 19 && strncmp (name + 1, "9223372036854775807", 19) <= 0)))
 			{
 				// non-canonical array part -> add underscores
-
-				// but first update buffer
-				size_t pos = outPtr - *canonicalName;
-
-				*canonicalSizePtr += offset + len - 1;
-				elektraRealloc ((void **) canonicalName, *canonicalSizePtr);
-				outPtr = *canonicalName + pos;
-
 				*outPtr = '#';
 				memset (outPtr + 1, '_', len - 1);
 				memcpy (outPtr + len, name + 1, len);
@@ -1085,8 +1220,17 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 		//        usize -- previous parts + separator
 		//     -> find end of part
 		const char * end = name;
-		while (*end != '\0')
+		for (;;)
 		{
+			// skip over runs of regular characters at once
+			const char * special = scanSpecial (end);
+			usize += special - end;
+			end = special;
+			if (*end != '\\')
+			{
+				break;
+			}
+
 			size_t backslashes = 0;
 			while (*end == '\\')
 			{
@@ -1123,7 +1267,7 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 	}
 
 	// terminate
-	if (outPtr > *canonicalName + rootOffset + 1)
+	if (outPtr > canonicalName + rootOffset + 1)
 	{
 		// not a root key -> need to replace trailing slash
 		--outPtr;
@@ -1135,15 +1279,51 @@ void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_
 	}
 	*outPtr = '\0';
 
-	// output size and shrink buffer
-	*canonicalSizePtr = outPtr - *canonicalName + 1;
-	elektraRealloc ((void **) canonicalName, *canonicalSizePtr);
-
 	// output unescape size if requested
 	if (usizePtr != NULL)
 	{
 		*usizePtr = usize;
 	}
+
+	return outPtr - canonicalName + 1;
+}
+
+
+/**
+ * Takes a valid (non-)canonical key name and produces its canonical form.
+ * As a side-effect it can also calculate the size of the corresponding unescaped key name.
+ *
+ * @param name          The key name that is processed
+ * @param canonicalName Output buffer for the canonical name
+ * @param canonicalSizePtr Pointer to size of @p canonicalName
+ * @param offset        Offset into @p canonicalName
+ * @param usizePtr      Output variable for the size of the unescaped name
+ *
+ * @pre @p name MUST be a valid (non-)canonical key name. If it is not, the result is undefined
+ * @pre @p canonicalName MUST be a valid first argument for elektraRealloc() when cast to void**
+ * @pre @p canonicalSizePtr >= @p offset
+ * @pre @p offset MUST be 0 or `*canonicalName + offset` MUST point to the zero-termintor of a valid canonical key name that starts at
+ * `*canonicalName`
+ * @pre if @p offset is 0 then `*usizePtr` MUST 0, otherwise `*usizePtr` MUST be the correct unescaped size of the existing canonical name
+ * in `*canonicalName`
+ *
+ * @see elektraKeyNameValidate
+ * @see elektraKeyNameCanonicalizeInto
+ *
+ * @ingroup keyname
+ */
+void elektraKeyNameCanonicalize (const char * name, char ** canonicalName, size_t * canonicalSizePtr, size_t offset, size_t * usizePtr)
+{
+	// ensure output is big enough for any result, at the end we shrink to the correct size
+	size_t maxSize = ELEKTRA_KEY_NAME_CANONICAL_SIZE_MAX (offset, strlen (name) + 1);
+	if (maxSize > *canonicalSizePtr)
+	{
+		*canonicalSizePtr = maxSize;
+		elektraRealloc ((void **) canonicalName, *canonicalSizePtr);
+	}
+
+	*canonicalSizePtr = elektraKeyNameCanonicalizeInto (name, *canonicalName, offset, usizePtr);
+	elektraRealloc ((void **) canonicalName, *canonicalSizePtr);
 }
 
 /**
@@ -1178,6 +1358,12 @@ void elektraKeyNameUnescape (const char * canonicalName, char * unescapedName)
 
 	while (*canonicalName != '\0')
 	{
+		// copy runs of regular characters at once
+		const char * special = scanSpecial (canonicalName);
+		memcpy (outPtr, canonicalName, special - canonicalName);
+		outPtr += special - canonicalName;
+		canonicalName = special;
+
 		switch (*canonicalName)
 		{
 		case '\\':
@@ -1201,9 +1387,7 @@ void elektraKeyNameUnescape (const char * canonicalName, char * unescapedName)
 			}
 			break;
 		default:
-			// nothing special, just output
-			*outPtr++ = *canonicalName;
-			++canonicalName;
+			// terminator, loop ends
 			break;
 		}
 	}
@@ -1800,6 +1984,20 @@ ssize_t keySetNamespace (Key * key, elektraNamespace ns)
 
 	size_t newNamespaceLen = strlen (newNamespace);
 
+	if (test_bit (key->flags, KEY_FLAG_MMAP_KEY))
+	{
+		// key was in mmap region, clear flag and copy to malloced buffer
+		char * tmp = elektraMalloc (key->keySize);
+		memcpy (tmp, key->key, key->keySize);
+		key->key = tmp;
+
+		tmp = elektraMalloc (key->keyUSize);
+		memcpy (tmp, key->ukey, key->keyUSize);
+		key->ukey = tmp;
+
+		clear_bit (key->flags, (keyflag_t) KEY_FLAG_MMAP_KEY);
+	}
+
 	if (newNamespaceLen > oldNamespaceLen)
 	{
 		// buffer growing -> realloc first
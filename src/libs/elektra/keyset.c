@@ -393,7 +393,7 @@ int f (KeySet *ks)
  *
  * @retval 1 on success
  * @retval 0 if @p dest was cleared successfully (@p source is NULL)
- * @retval -1 when @p dest is a NULL pointer
+ * @retval -1 when @p dest is a NULL pointer or frozen (see ksFreeze())
  *
  * @since 1.0.0
  * @see ksNew() for creating a new KeySet
@@ -404,6 +404,7 @@ int f (KeySet *ks)
 int ksCopy (KeySet * dest, const KeySet * source)
 {
 	if (!dest) return -1;
+	if (test_bit (dest->flags, KS_FLAG_FROZEN)) return -1;
 	ksClear (dest);
 	if (!source) return 0;
 
@@ -449,6 +450,9 @@ int ksDel (KeySet * ks)
 
 	ksClose (ks);
 
+	// the keys of the arena were released by ksClose(), now the arena can be freed
+	elektraArenaRelease (ks->arena);
+
 #ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
 	if (ks->opmphm)
 	{
@@ -486,6 +490,7 @@ int ksDel (KeySet * ks)
 int ksClear (KeySet * ks)
 {
 	if (ks == NULL) return -1;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
 	ksClose (ks);
 	// ks->array empty now
 
@@ -633,6 +638,56 @@ static int keyCompareByName (const void * p1, const void * p2)
 	return k1Shorter ? -1 : 1;
 }
 
+/**
+ * @brief Compare by unescaped name, skipping a known common prefix
+ *
+ * @internal
+ *
+ * Same order as keyCompareByName(), but the comparison starts at byte
+ * @p common and returns where the names start to differ. This allows
+ * binary searches to skip the prefix the searched Key shares with the
+ * bounds of the search range.
+ *
+ * @param k1 the first Key
+ * @param k2 the second Key
+ * @param common in: the number of bytes the unescaped names are known to share,
+ *               out: the length of the common prefix of the unescaped names
+ *
+ * @retval <0 if k1 < k2
+ * @retval 0 if k1 == k2
+ * @retval >0 if k1 > k2
+ */
+static int keyCompareByNameFrom (const Key * k1, const Key * k2, size_t * common)
+{
+	size_t size = k1->keyUSize < k2->keyUSize ? k1->keyUSize : k2->keyUSize;
+	size_t i = *common;
+
+	// compare word by word first, most names share long prefixes
+	while (i + sizeof (uint64_t) <= size)
+	{
+		uint64_t w1, w2;
+		memcpy (&w1, k1->ukey + i, sizeof (uint64_t));
+		memcpy (&w2, k2->ukey + i, sizeof (uint64_t));
+		if (w1 != w2) break;
+		i += sizeof (uint64_t);
+	}
+	while (i < size && k1->ukey[i] == k2->ukey[i])
+	{
+		++i;
+	}
+	*common = i;
+
+	if (i < size)
+	{
+		return (unsigned char) k1->ukey[i] < (unsigned char) k2->ukey[i] ? -1 : 1;
+	}
+	if (k1->keyUSize == k2->keyUSize)
+	{
+		return 0;
+	}
+	return k1->keyUSize < k2->keyUSize ? -1 : 1;
+}
+
 /**
  * Compare the name of two Keys.
  *
@@ -766,7 +821,12 @@ static ssize_t ksSearchInternal (const KeySet * ks, const Key * toAppend)
 		return -1;
 	}
 
-	cmpresult = keyCompareByName (&toAppend, &ks->array[right]);
+	// All Keys between left and right share at least min(commonLeft, commonRight)
+	// bytes of their unescaped name with toAppend, so comparisons can skip them.
+	size_t commonLeft = 0;
+	size_t commonRight = 0;
+
+	cmpresult = keyCompareByNameFrom (toAppend, ks->array[right], &commonRight);
 	if (cmpresult > 0)
 	{
 		return -((ssize_t) ks->size) - 1;
@@ -781,10 +841,12 @@ static ssize_t ksSearchInternal (const KeySet * ks, const Key * toAppend)
 			break;
 		}
 		middle = left + ((right - left) / 2);
-		cmpresult = keyCompareByName (&toAppend, &ks->array[middle]);
+		size_t common = commonLeft < commonRight ? commonLeft : commonRight;
+		cmpresult = keyCompareByNameFrom (toAppend, ks->array[middle], &common);
 		if (cmpresult > 0)
 		{
 			insertpos = left = middle + 1;
+			commonLeft = common;
 		}
 		else if (cmpresult == 0)
 		{
@@ -795,6 +857,7 @@ static ssize_t ksSearchInternal (const KeySet * ks, const Key * toAppend)
 		{
 			insertpos = middle;
 			right = middle - 1;
+			commonRight = common;
 		}
 	}
 
@@ -879,8 +942,8 @@ ssize_t ksSearch (const KeySet * ks, const Key * key)
  *
  * @return the size of the KeySet after appending
  * @retval -1 on NULL pointers
- * @retval -1 if appending failed (only on memory problems). The Key will be
- * deleted then.
+ * @retval -1 if appending failed (on memory problems or if @p ks is frozen,
+ * see ksFreeze()). The Key will be deleted then.
  *
  * @since 1.0.0
  * @see ksAppend() for appending a KeySet to another KeySet
@@ -892,7 +955,7 @@ ssize_t ksAppendKey (KeySet * ks, Key * toAppend)
 
 	if (!ks) return -1;
 	if (!toAppend) return -1;
-	if (!toAppend->key)
+	if (!toAppend->key || test_bit (ks->flags, KS_FLAG_FROZEN))
 	{
 		// needed for ksAppendKey(ks, keyNew(0))
 		keyDel (toAppend);
@@ -901,6 +964,11 @@ ssize_t ksAppendKey (KeySet * ks, Key * toAppend)
 
 	keyLock (toAppend, KEY_LOCK_NAME);
 
+	if (test_bit (toAppend->flags, KEY_FLAG_ARENA))
+	{
+		elektraArenaDetachKey (ks, toAppend);
+	}
+
 	result = ksSearchInternal (ks, toAppend);
 
 	if (result >= 0)
@@ -975,6 +1043,178 @@ ssize_t ksAppendKey (KeySet * ks, Key * toAppend)
 }
 
 
+/**
+ * @internal
+ *
+ * Galloping search for @p key in the first @p end Keys of @p ks, going backwards from @p end.
+ *
+ * Needs O(log d) comparisons, where d is the distance between @p end and the
+ * result. Merging two sorted KeySets with it is linear, while appending only
+ * a few Keys to a big KeySet needs only a few comparisons per Key.
+ *
+ * @pre all Keys from @p end on are bigger than @p key
+ *
+ * @param ks the keyset to search in
+ * @param end only Keys before this position are searched
+ * @param key the key to search
+ * @param found set to whether @p key is part of @p ks
+ *
+ * @return the position of @p key in @p ks, or where it would have to be inserted
+ */
+static size_t ksGallopBackInternal (const KeySet * ks, size_t end, const Key * key, bool * found)
+{
+	// find a range [left, right] that contains the position
+	size_t right = end;
+	size_t bound = 1;
+	while (bound <= right && keyCompareByName (&ks->array[right - bound], &key) >= 0)
+	{
+		right -= bound;
+		bound *= 2;
+	}
+	size_t left = bound <= right ? right - bound + 1 : 0;
+
+	// binary search for the first Key that is not smaller than key
+	while (left < right)
+	{
+		size_t middle = left + (right - left) / 2;
+		if (keyCompareByName (&ks->array[middle], &key) < 0)
+		{
+			left = middle + 1;
+		}
+		else
+		{
+			right = middle;
+		}
+	}
+
+	*found = left < end && keyCompareByName (&ks->array[left], &key) == 0;
+	return left;
+}
+
+/**
+ * @internal
+ *
+ * Merges the sorted array @p keys into the sorted KeySet @p ks in a single pass.
+ *
+ * Keys in @p keys replace Keys with the same name in @p ks.
+ * The Keys are merged in place from the back, so the array of @p ks
+ * only grows if needed instead of being copied.
+ *
+ * @param ks the KeySet to merge into
+ * @param keys sorted Keys without duplicates, may point behind the Keys of @p ks
+ * @param count the number of Keys in @p keys
+ * @param referenced whether the reference counter of the Keys in @p keys
+ *        was already incremented for @p ks
+ *
+ * @return the size of @p ks after merging
+ * @retval -1 on memory errors, @p ks is unchanged then
+ */
+static ssize_t ksMergeInternal (KeySet * ks, Key ** keys, size_t count, bool referenced)
+{
+	// count the Keys that replace a Key of ks, to know the size after merging;
+	// the searches are the same as while merging, so even an unsorted ks cannot make us write out of bounds
+	size_t replaced = 0;
+	for (size_t i = count, end = ks->size; i > 0; --i)
+	{
+		bool found;
+		end = ksGallopBackInternal (ks, end, keys[i - 1], &found);
+		if (found) ++replaced;
+	}
+	size_t size = ks->size + count - replaced;
+
+	size_t toAlloc = ks->array == NULL ? KEYSET_SIZE : ks->alloc;
+	for (; size >= toAlloc; toAlloc *= 2)
+		;
+
+	// Keys behind the Keys of ks would be overwritten while merging
+	Key ** pending = NULL;
+	if (ks->array != NULL && keys == ks->array + ks->size)
+	{
+		pending = elektraMalloc (sizeof (struct _Key *) * count);
+		if (!pending) return -1;
+		memcpy (pending, keys, count * sizeof (struct _Key *));
+		keys = pending;
+	}
+
+	if (ks->array == NULL || test_bit (ks->flags, KS_FLAG_MMAP_ARRAY))
+	{
+		// an mmap array cannot grow, so it is moved out of the mapping
+		Key ** array = elektraMalloc (sizeof (struct _Key *) * toAlloc);
+		if (!array)
+		{
+			elektraFree (pending);
+			return -1;
+		}
+		if (ks->size > 0) memcpy (array, ks->array, ks->size * sizeof (struct _Key *));
+		ks->array = array;
+		clear_bit (ks->flags, (keyflag_t) KS_FLAG_MMAP_ARRAY);
+	}
+	else if (toAlloc != ks->alloc && elektraRealloc ((void **) &ks->array, sizeof (struct _Key *) * toAlloc) == -1)
+	{
+		elektraFree (pending);
+		return -1;
+	}
+	ks->alloc = toAlloc;
+
+	// both arrays are sorted, so we merge them from the back, where the array has room
+	size_t to = size;
+	size_t end = ks->size;
+	size_t cursor = 0;
+	for (size_t i = count; i > 0; --i)
+	{
+		Key * key = keys[i - 1];
+
+		bool found;
+		size_t left = ksGallopBackInternal (ks, end, key, &found);
+
+		// move all Keys of ks behind key at once
+		size_t behind = left + (found ? 1 : 0);
+		if (end > behind)
+		{
+			memmove (ks->array + to - (end - behind), ks->array + behind, (end - behind) * sizeof (struct _Key *));
+			to -= end - behind;
+		}
+		end = left;
+
+		if (found)
+		{
+			if (ks->array[left] != key)
+			{
+				/* Pop the key in ks and use the other one instead */
+				keyDecRef (ks->array[left]);
+				keyDel (ks->array[left]);
+				if (!referenced) keyIncRef (key);
+			}
+			else if (referenced)
+			{
+				/* the same Key was referenced twice */
+				keyDecRef (key);
+			}
+		}
+		else if (!referenced)
+		{
+			keyIncRef (key);
+		}
+
+		ks->array[--to] = key;
+		if (i == count) cursor = to;
+	}
+	ks->array[size] = NULL;
+	elektraFree (pending);
+
+	// replaced Keys keep their position, only new Keys invalidate the OPMPHM
+	if (size != ks->size)
+	{
+		elektraOpmphmInvalidate (ks);
+	}
+	ks->size = size;
+
+	ksSetCursor (ks, cursor);
+
+	return ks->size;
+}
+
+
 /**
  * Append all Keys in @p toAppend to the end of the KeySet @p ks.
  *
@@ -983,6 +1223,9 @@ ssize_t ksAppendKey (KeySet * ks, Key * toAppend)
  * If a Key is both in @p toAppend and @p ks, the Key in @p ks will be
  * overwritten.
  *
+ * Both KeySets are merged in a single pass, so appending a big KeySet
+ * is much faster than calling ksAppendKey() for each of its Keys.
+ *
  * @copydetails doxygenFlatCopy
  *
  * @post Sorted KeySet ks with all Keys it had before and additionally
@@ -999,29 +1242,281 @@ ssize_t ksAppendKey (KeySet * ks, Key * toAppend)
  */
 ssize_t ksAppend (KeySet * ks, const KeySet * toAppend)
 {
-	size_t toAlloc = 0;
-
 	if (!ks) return -1;
 	if (!toAppend) return -1;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
 
 	if (toAppend->size == 0) return ks->size;
 	if (toAppend->array == NULL) return ks->size;
+	if (ks == toAppend) return ks->size;
 
-	if (ks->array == NULL)
-		toAlloc = KEYSET_SIZE;
-	else
-		toAlloc = ks->alloc;
+	for (size_t i = 0; i < toAppend->size; ++i)
+	{
+		Key * key = toAppend->array[i];
+		keyLock (key, KEY_LOCK_NAME);
+		if (test_bit (key->flags, KEY_FLAG_ARENA))
+		{
+			elektraArenaDetachKey (ks, key);
+		}
+	}
+
+	return ksMergeInternal (ks, toAppend->array, toAppend->size, false);
+}
+
+/**
+ * @internal
+ *
+ * Makes sure the array of @p ks has room for one more pending Key
+ * and the terminating NULL.
+ *
+ * @retval 0 on success
+ * @retval -1 on memory errors
+ */
+static int ksBuilderGrow (KeySet * ks)
+{
+	size_t used = ks->size + ks->pending + 1;
+	if (ks->array != NULL && used < ks->alloc && !test_bit (ks->flags, KS_FLAG_MMAP_ARRAY))
+	{
+		return 0;
+	}
 
-	/* Do only one resize in advance */
-	for (; ks->size + toAppend->size >= toAlloc; toAlloc *= 2)
+	size_t alloc = ks->alloc < KEYSET_SIZE ? KEYSET_SIZE : ks->alloc;
+	for (; used >= alloc; alloc *= 2)
 		;
-	ksResize (ks, toAlloc - 1);
 
-	/* TODO: here is lots of room for optimizations */
-	for (size_t i = 0; i < toAppend->size; ++i)
+	if (ks->array == NULL || test_bit (ks->flags, KS_FLAG_MMAP_ARRAY))
 	{
-		ksAppendKey (ks, toAppend->array[i]);
+		Key ** array = elektraMalloc (sizeof (struct _Key *) * alloc);
+		if (!array) return -1;
+		if (ks->array != NULL)
+		{
+			memcpy (array, ks->array, used * sizeof (struct _Key *));
+		}
+		else
+		{
+			array[0] = NULL;
+		}
+		ks->array = array;
+		clear_bit (ks->flags, (keyflag_t) KS_FLAG_MMAP_ARRAY);
+	}
+	else if (elektraRealloc ((void **) &ks->array, sizeof (struct _Key *) * alloc) == -1)
+	{
+		return -1;
 	}
+
+	ks->alloc = alloc;
+	return 0;
+}
+
+/**
+ * @brief Adds a Key to a KeySet that is bulk loaded
+ *
+ * In contrast to ksAppendKey(), the Key is not sorted into @p ks right away.
+ * Instead it is only put behind the Keys of @p ks. All Keys added this way are
+ * sorted and merged into @p ks at once by ksBuilderFinish(). As long as the Keys
+ * are added in sorted order, they are appended directly and ksBuilderFinish()
+ * has nothing to do.
+ *
+ * Storage plugins should use this function for reading their files, because
+ * the Keys in a file are often (but not always) already sorted.
+ *
+ * If Keys with the same name are added, the one added last wins,
+ * like with repeated calls of ksAppendKey().
+ *
+ * @pre Until ksBuilderFinish() is called, @p ks must only be passed to
+ *      ksBuilderAdd(), ksBuilderFinish() and ksDel().
+ *
+ * @param ks the KeySet to add @p key to
+ * @param key the Key to add, @p ks takes ownership like with ksAppendKey()
+ *
+ * @return the number of Keys in @p ks, including the Keys not sorted yet
+ * @retval -1 on NULL pointers
+ * @retval -1 on memory errors, @p key is deleted then
+ *
+ * @see ksBuilderFinish() for sorting the added Keys into @p ks
+ */
+ssize_t ksBuilderAdd (KeySet * ks, Key * key)
+{
+	if (!ks) return -1;
+	if (!key) return -1;
+	if (!key->key || test_bit (ks->flags, KS_FLAG_FROZEN))
+	{
+		keyDel (key);
+		return -1;
+	}
+
+	keyLock (key, KEY_LOCK_NAME);
+
+	if (test_bit (key->flags, KEY_FLAG_ARENA))
+	{
+		elektraArenaDetachKey (ks, key);
+	}
+
+	if (ks->pending == 0)
+	{
+		// as long as the Keys arrive in order, they are directly appended
+		Key * last = ks->size > 0 ? ks->array[ks->size - 1] : NULL;
+		int cmp = last != NULL ? keyCompareByName (&last, &key) : -1;
+		if (cmp == 0)
+		{
+			if (last != key)
+			{
+				keyDecRef (last);
+				keyDel (last);
+				keyIncRef (key);
+				ks->array[ks->size - 1] = key;
+			}
+			return ks->size;
+		}
+
+		if (cmp < 0)
+		{
+			if (ksBuilderGrow (ks) == -1)
+			{
+				keyDel (key);
+				return -1;
+			}
+			keyIncRef (key);
+			ks->array[ks->size++] = key;
+			ks->array[ks->size] = NULL;
+			elektraOpmphmInvalidate (ks);
+			return ks->size;
+		}
+	}
+
+	if (ksBuilderGrow (ks) == -1)
+	{
+		keyDel (key);
+		return -1;
+	}
+	keyIncRef (key);
+	ks->array[ks->size + ks->pending++] = key;
+	return ks->size + ks->pending;
+}
+
+/**
+ * @internal
+ *
+ * Stable bottom-up merge sort of @p count Keys in @p keys.
+ *
+ * @param buffer temporary space for @p count Keys
+ */
+static void ksBuilderSort (Key ** keys, Key ** buffer, size_t count)
+{
+	Key ** from = keys;
+	Key ** to = buffer;
+	for (size_t width = 1; width < count; width *= 2)
+	{
+		for (size_t left = 0; left < count; left += 2 * width)
+		{
+			size_t middle = left + width < count ? left + width : count;
+			size_t right = middle + width < count ? middle + width : count;
+			size_t i = left;
+			size_t j = middle;
+			size_t k = left;
+			while (i < middle && j < right)
+			{
+				// take the left Key on ties, so that the sort is stable
+				to[k++] = keyCompareByName (&from[j], &from[i]) < 0 ? from[j++] : from[i++];
+			}
+			while (i < middle)
+			{
+				to[k++] = from[i++];
+			}
+			while (j < right)
+			{
+				to[k++] = from[j++];
+			}
+		}
+		Key ** tmp = from;
+		from = to;
+		to = tmp;
+	}
+
+	if (from != keys)
+	{
+		memcpy (keys, from, count * sizeof (struct _Key *));
+	}
+}
+
+/**
+ * @brief Sorts all Keys added with ksBuilderAdd() into the KeySet
+ *
+ * The added Keys are sorted once and merged with the Keys
+ * that were already part of @p ks in a single pass.
+ * If they were added in sorted order, nothing needs to be done.
+ *
+ * Afterwards, @p ks can be used like any other KeySet again.
+ * Calling this function without any pending Keys does nothing.
+ *
+ * @param ks the KeySet to finish
+ *
+ * @return the size of @p ks after finishing
+ * @retval -1 on NULL pointers
+ * @retval -1 on memory errors, the pending Keys stay in @p ks then
+ *
+ * @see ksBuilderAdd() for adding Keys
+ */
+ssize_t ksBuilderFinish (KeySet * ks)
+{
+	if (!ks) return -1;
+	if (ks->pending == 0) return ks->size;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
+
+	Key ** keys = ks->array + ks->size;
+	size_t count = ks->pending;
+
+	bool sorted = true;
+	for (size_t i = 1; i < count && sorted; ++i)
+	{
+		sorted = keyCompareByName (&keys[i - 1], &keys[i]) <= 0;
+	}
+
+	if (!sorted)
+	{
+		Key ** buffer = elektraMalloc (count * sizeof (struct _Key *));
+		if (!buffer) return -1;
+		ksBuilderSort (keys, buffer, count);
+		elektraFree (buffer);
+	}
+
+	// remove duplicates, the Key added last wins
+	size_t unique = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (unique > 0 && keyCompareByName (&keys[unique - 1], &keys[i]) == 0)
+		{
+			keyDecRef (keys[unique - 1]);
+			if (keys[unique - 1] != keys[i])
+			{
+				keyDel (keys[unique - 1]);
+			}
+			keys[unique - 1] = keys[i];
+		}
+		else
+		{
+			keys[unique++] = keys[i];
+		}
+	}
+
+	ks->pending = 0;
+
+	if (ks->size == 0 || keyCompareByName (&ks->array[ks->size - 1], &keys[0]) < 0)
+	{
+		// all added Keys belong behind the existing ones
+		ks->size += unique;
+		ks->array[ks->size] = NULL;
+		elektraOpmphmInvalidate (ks);
+		ksRewind (ks);
+		return ks->size;
+	}
+
+	if (ksMergeInternal (ks, keys, unique, true) == -1)
+	{
+		ks->pending = unique;
+		return -1;
+	}
+	ksRewind (ks);
 	return ks->size;
 }
 
@@ -1097,6 +1592,7 @@ static size_t ksRenameInternal (KeySet * ks, size_t start, size_t end, const Key
 ssize_t ksRename (KeySet * ks, const Key * root, const Key * newRoot)
 {
 	if (ks == NULL || root == NULL || newRoot == NULL) return -1;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
 	if (keyGetNamespace (root) == KEY_NS_CASCADING || keyGetNamespace (newRoot) == KEY_NS_CASCADING) return -1;
 
 	// search the root
@@ -1468,6 +1964,7 @@ KeySet * ksCut (KeySet * ks, const Key * cutpoint)
 
 	if (!ks) return 0;
 	if (!cutpoint) return 0;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return 0;
 
 	if (!ks->array) return ksNew (0, KS_END);
 
@@ -1572,7 +2069,7 @@ ksDel (ks2);
  * @param ks KeySet to pop a Key from
  *
  * @return the last Key of @p ks
- * @retval NULL if @p ks is empty or a NULL pointer
+ * @retval NULL if @p ks is empty, frozen (see ksFreeze()) or a NULL pointer
  *
  * @since 1.0.0
  * @see ksLookup() to pop Keys by name
@@ -1583,6 +2080,7 @@ Key * ksPop (KeySet * ks)
 	Key * ret = 0;
 
 	if (!ks) return 0;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return 0;
 
 	ks->flags |= KS_FLAG_SYNC;
 
@@ -1629,6 +2127,8 @@ while ((key = ksNext (ks))!=0) {}
 int ksRewind (KeySet * ks)
 {
 	if (!ks) return -1;
+	// the cursor of frozen KeySets never moves away from the beginning
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return 0;
 
 	ks->cursor = 0;
 	ks->current = 0;
@@ -1657,7 +2157,7 @@ int ksRewind (KeySet * ks)
  *
  * @return the new current Key
  * @retval 0 when the end of the KeySet has been reached
- * @retval 0 on NULL pointer
+ * @retval 0 on NULL pointer or if @p ks is frozen (see ksFreeze())
  *
  * @since 1.0.0
  * @see ksRewind() for resetting the internal cursor of the KeySet
@@ -1667,6 +2167,7 @@ int ksRewind (KeySet * ks)
 Key * ksNext (KeySet * ks)
 {
 	if (!ks) return 0;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return 0;
 
 	if (ks->size == 0) return 0;
 	if (ks->current >= ks->size)
@@ -1850,7 +2351,7 @@ ksCurrent(ks); // in same position as before
  *
  * @retval 0 when the KeySet has been ksRewind()ed
  * @retval 1 otherwise
- * @retval -1 on NULL pointer
+ * @retval -1 on NULL pointer or if @p ks is frozen (see ksFreeze())
  *
  * @since 1.0.0
  * @see ksGetCursor() for getting the cursor at the current position
@@ -1860,6 +2361,7 @@ ksCurrent(ks); // in same position as before
 int ksSetCursor (KeySet * ks, elektraCursor cursor)
 {
 	if (!ks) return -1;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
 
 	if ((elektraCursor) -1 == cursor)
 	{
@@ -2001,7 +2503,7 @@ static Key * elektraLookupBySpecDefault (KeySet * ks, Key * specKey)
 	if (ret) return ret; // return previous added default key
 
 	m = keyGetMeta (specKey, "default");
-	if (!m) return ret;
+	if (!m || test_bit (ks->flags, KS_FLAG_FROZEN)) return ret;
 	ret = keyNew (keyName (specKey), KEY_VALUE, keyString (m), KEY_END);
 	ksAppendKey (ks, ret);
 
@@ -2171,14 +2673,11 @@ static Key * elektraLookupBinarySearch (KeySet * ks, Key const * key, elektraLoo
 {
 	elektraCursor cursor = 0;
 	cursor = ksGetCursor (ks);
-	Key ** found;
-	size_t jump = 0;
-	/*If there is a known offset in the beginning jump could be set*/
-	found = (Key **) bsearch (&key, ks->array + jump, ks->size - jump, sizeof (Key *), keyCompareByName);
+	ssize_t found = ksSearchInternal (ks, key);
 
-	if (found)
+	if (found >= 0)
 	{
-		cursor = found - ks->array;
+		cursor = found;
 		if (options & KDB_O_POP)
 		{
 			return elektraKsPopAtCursor (ks, cursor);
@@ -2186,7 +2685,7 @@ static Key * elektraLookupBinarySearch (KeySet * ks, Key const * key, elektraLoo
 		else
 		{
 			ksSetCursor (ks, cursor);
-			return (*found);
+			return ks->array[cursor];
 		}
 	}
 	else
@@ -2330,6 +2829,211 @@ static Key * elektraLookupOpmphmSearch (KeySet * ks, Key const * key, elektraLoo
 
 #endif
 
+/**
+ * @internal
+ *
+ * @brief Returns the OPMPHM of @p ks and builds it, if needed
+ *
+ * Used by storage plugins that store the OPMPHM together with the Keys,
+ * see elektraKsSetOpmphm().
+ *
+ * @param ks the KeySet
+ *
+ * @return the OPMPHM of @p ks, it is only valid until @p ks changes
+ * @retval NULL if the OPMPHM could not be built or optimizations are disabled
+ */
+const Opmphm * elektraKsGetOpmphm (KeySet * ks ELEKTRA_UNUSED)
+{
+#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
+	if (!ks || ks->size == 0) return NULL;
+	if (!opmphmIsBuild (ks->opmphm) && elektraLookupBuildOpmphm (ks) != 0) return NULL;
+	return ks->opmphm;
+#else
+	return NULL;
+#endif
+}
+
+/**
+ * @internal
+ *
+ * @brief Sets an already built OPMPHM for @p ks
+ *
+ * The next ksLookup() uses @p opmphm right away, instead of
+ * building the OPMPHM or doing a binary search.
+ *
+ * @pre @p opmphm was built for a KeySet with exactly the same Key names as @p ks,
+ *      e.g. it was returned by elektraKsGetOpmphm() and restored from a file
+ *
+ * @param ks the KeySet
+ * @param opmphm the OPMPHM, allocated with elektraMalloc(), @p ks takes ownership on success
+ *
+ * @retval 0 on success
+ * @retval -1 on NULL pointers, if @p opmphm is not built or optimizations are disabled
+ */
+int elektraKsSetOpmphm (KeySet * ks ELEKTRA_UNUSED, Opmphm * opmphm ELEKTRA_UNUSED)
+{
+#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
+	if (!ks || !opmphm || !opmphmIsBuild (opmphm) || ks->size == 0 || ks->size > KDB_OPMPHM_MAX_N) return -1;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
+	if (ks->opmphm) opmphmDel (ks->opmphm);
+	ks->opmphm = opmphm;
+	// the OPMPHM matches the Keys, nothing changed since it was built
+	clear_bit (ks->flags, (keyflag_t) KS_FLAG_NAME_CHANGE);
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * @internal
+ *
+ * @brief Duplicates @p source as a frozen KeySet
+ *
+ * @param source the KeySet to freeze
+ * @param index whether the OPMPHM should be built
+ *
+ * @return the frozen KeySet
+ * @retval NULL on memory errors
+ */
+static KeySet * ksFreezeInternal (const KeySet * source, bool index ELEKTRA_UNUSED)
+{
+	KeySet * frozen = ksNew (source->size, KS_END);
+	if (!frozen) return NULL;
+
+	for (size_t i = 0; i < source->size; ++i)
+	{
+		Key * k = source->array[i];
+		Key * d = keyDup (k, KEY_CP_NAME | KEY_CP_VALUE);
+		if (!d)
+		{
+			ksDel (frozen);
+			return NULL;
+		}
+
+		// the metadata is not shared, otherwise keyDup() of a frozen Key would change reference counters
+		ksDel (d->meta);
+		d->meta = NULL;
+		if (k->meta && k->meta->size > 0)
+		{
+			d->meta = ksFreezeInternal (k->meta, false);
+			if (!d->meta)
+			{
+				keyDel (d);
+				ksDel (frozen);
+				return NULL;
+			}
+		}
+
+		if (!test_bit (k->flags, KEY_FLAG_SYNC))
+		{
+			keyClearSync (d);
+		}
+		keyLock (d, KEY_LOCK_NAME | KEY_LOCK_VALUE | KEY_LOCK_META);
+
+		if (ksAppendKey (frozen, d) == -1)
+		{
+			ksDel (frozen);
+			return NULL;
+		}
+	}
+
+#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
+	// lookups must not build the OPMPHM lazily, if building fails they use binary search
+	if (index && frozen->size > 0)
+	{
+		elektraLookupBuildOpmphm (frozen);
+	}
+	clear_bit (frozen->flags, (keyflag_t) KS_FLAG_NAME_CHANGE);
+#endif
+
+	ksRewind (frozen);
+	set_bit (frozen->flags, KS_FLAG_FROZEN);
+	return frozen;
+}
+
+/**
+ * @brief Creates a read-only snapshot of @p source
+ *
+ * The returned KeySet contains copies of all Keys of @p source, including
+ * their metadata. Afterwards neither the KeySet nor its Keys can be changed:
+ * all operations that would change them fail, e.g. ksAppendKey(), ksCut(),
+ * ksPop(), keySetString() or keySetMeta(). The same applies to the internal
+ * cursor, use ksAtCursor() to iterate.
+ *
+ * Reading from a frozen KeySet never changes any state, so ksLookup(),
+ * ksLookupByName(), ksAtCursor(), ksGetSize(), keyGetMeta(), keyDup() and
+ * all other functions that only read Keys can be called from any number of
+ * threads at the same time, without locks. The hash index used by ksLookup()
+ * is built right away.
+ *
+ * Functions that change reference counters are not thread-safe, e.g.
+ * ksDup() or appending Keys of a frozen KeySet to other KeySets.
+ * Use keyDup() or ksDeepDup() to copy Keys out of a frozen KeySet in threads.
+ *
+ * @param source the KeySet to take a snapshot of, it is not changed
+ *
+ * @return a new frozen KeySet, free it with ksDel() once no thread uses it anymore
+ * @retval NULL on NULL pointers or memory errors
+ *
+ * @see ksIsFrozen() to check whether a KeySet is frozen
+ */
+KeySet * ksFreeze (const KeySet * source)
+{
+	if (!source) return NULL;
+	return ksFreezeInternal (source, true);
+}
+
+/**
+ * @brief Checks whether @p ks was created by ksFreeze()
+ *
+ * @param ks the KeySet to check
+ *
+ * @retval 1 if @p ks is frozen
+ * @retval 0 if @p ks can be changed
+ * @retval -1 on NULL pointers
+ */
+int ksIsFrozen (const KeySet * ks)
+{
+	if (!ks) return -1;
+	return test_bit (ks->flags, KS_FLAG_FROZEN) ? 1 : 0;
+}
+
+static bool ksContentMatches (const KeySet * frozen, const KeySet * source, bool withMeta)
+{
+	size_t size = frozen ? frozen->size : 0;
+	if (size != (source ? source->size : 0)) return false;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		const Key * f = frozen->array[i];
+		const Key * s = source->array[i];
+		if (f->keyUSize != s->keyUSize || memcmp (f->ukey, s->ukey, f->keyUSize) != 0) return false;
+		if (f->dataSize != s->dataSize || (f->dataSize > 0 && memcmp (f->data.v, s->data.v, f->dataSize) != 0)) return false;
+		if (withMeta && !ksContentMatches (f->meta, s->meta, false)) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Checks whether @p frozen still is a snapshot of @p source
+ *
+ * Compares the names, values and metadata of all Keys, which is much
+ * cheaper than creating a new snapshot with ksFreeze().
+ *
+ * @param frozen a KeySet returned by ksFreeze()
+ * @param source the KeySet that may have changed since ksFreeze()
+ *
+ * @retval 1 if both contain the same Keys
+ * @retval 0 if @p source was changed
+ * @retval -1 on NULL pointers
+ */
+int ksFrozenMatches (const KeySet * frozen, const KeySet * source)
+{
+	if (!frozen || !source) return -1;
+	return ksContentMatches (frozen, source, true) ? 1 : 0;
+}
+
 /**
  * @brief Process Callback + maps to correct binary/hashmap search
  *
@@ -2348,7 +3052,7 @@ static Key * elektraLookupSearch (KeySet * ks, Key * key, elektraLookupFlags opt
 	Key * found = 0;
 
 #ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
-	if (!ks->opmphmPredictor && ks->size > opmphmPredictorActionLimit)
+	if (!ks->opmphmPredictor && ks->size > opmphmPredictorActionLimit && !test_bit (ks->flags, KS_FLAG_FROZEN))
 	{
 		// lazy loading of predictor when over action limit
 		ks->opmphmPredictor = opmphmPredictorNew ();
@@ -2392,6 +3096,11 @@ static Key * elektraLookupSearch (KeySet * ks, Key * key, elektraLookupFlags opt
 				}
 			}
 		}
+		else if (opmphmIsBuild (ks->opmphm))
+		{
+			// the OPMPHM was set with elektraKsSetOpmphm() or built on request
+			set_bit (options, KDB_O_OPMPHM);
+		}
 		else
 		{
 			// when predictor is not here use binary search as backup
@@ -2402,7 +3111,8 @@ static Key * elektraLookupSearch (KeySet * ks, Key * key, elektraLookupFlags opt
 	// the actual lookup
 	if ((options & (KDB_O_BINSEARCH | KDB_O_OPMPHM)) == KDB_O_OPMPHM)
 	{
-		if (opmphmIsBuild (ks->opmphm) || !elektraLookupBuildOpmphm (ks))
+		// the OPMPHM of frozen KeySets is built by ksFreeze() or not at all
+		if (opmphmIsBuild (ks->opmphm) || (!test_bit (ks->flags, KS_FLAG_FROZEN) && !elektraLookupBuildOpmphm (ks)))
 		{
 			found = elektraLookupOpmphmSearch (ks, key, options);
 		}
@@ -2452,6 +3162,7 @@ static Key * elektraLookupSearch (KeySet * ks, Key * key, elektraLookupFlags opt
 
 static Key * elektraLookupCreateKey (KeySet * ks, Key * key, ELEKTRA_UNUSED elektraLookupFlags options)
 {
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return 0;
 	Key * ret = keyDup (key, KEY_CP_ALL);
 	ksAppendKey (ks, ret);
 	return ret;
@@ -2528,6 +3239,12 @@ static Key * elektraLookupCreateKey (KeySet * ks, Key * key, ELEKTRA_UNUSED elek
  * [OPMPHM](https://master.libelektra.org/doc/dev/data-structures.md#order-preserving-minimal-perfect-hash-map-aka-opmphm). The hybrid
  * search can be overruled by passing ::KDB_O_OPMPHM or ::KDB_O_BINSEARCH in the options to ksLookup().
  *
+ * @par Frozen KeySets
+ * Lookups in KeySets created by ksFreeze() do not change the KeySet, so they can be
+ * done from any number of threads at the same time. ::KDB_O_POP and ::KDB_O_CREATE
+ * fail for frozen KeySets and no Keys for the `default` metadata of spec:/ Keys
+ * are created.
+ *
  *
  * @param ks the KeySet that should be searched
  * @param key the Key object you are looking for
@@ -2659,6 +3376,7 @@ Key * ksLookupByName (KeySet * ks, const char * name, elektraLookupFlags options
 int ksResize (KeySet * ks, size_t alloc)
 {
 	if (!ks) return -1;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return -1;
 
 	alloc++; /* for ending null byte */
 	if (alloc == ks->alloc) return 1;
@@ -2743,9 +3461,12 @@ int ksInit (KeySet * ks)
 
 	ks->size = 0;
 	ks->alloc = 0;
+	ks->pending = 0;
 	ks->flags = 0;
 	ks->refs = 0;
+	ks->shares = 0;
 	ks->cursor = 0;
+	ks->arena = NULL;
 
 	ksRewind (ks);
 
@@ -2782,7 +3503,8 @@ int ksClose (KeySet * ks)
 
 	if (ks->array)
 	{
-		for (size_t i = 0; i < ks->size; i++)
+		// also release Keys of a build that was never finished
+		for (size_t i = 0; i < ks->size + ks->pending; i++)
 		{
 			keyDecRef (ks->array[i]);
 			keyDel (ks->array[i]);
@@ -2797,6 +3519,7 @@ int ksClose (KeySet * ks)
 	ks->array = NULL;
 	ks->alloc = 0;
 	ks->size = 0;
+	ks->pending = 0;
 	ksRewind (ks);
 
 	elektraOpmphmInvalidate (ks);
@@ -551,6 +551,8 @@ ssize_t keySetRaw (Key * key, const void * newBinary, size_t dataSize)
 	if (!key) return -1;
 	if (key->flags & KEY_FLAG_RO_VALUE) return -1;
 
+	elektraKeyClearTypedValue (key);
+
 	if (!dataSize || !newBinary)
 	{
 		if (key->data.v)
@@ -565,6 +567,18 @@ ssize_t keySetRaw (Key * key, const void * newBinary, size_t dataSize)
 		return 1;
 	}
 
+	if (dataSize <= key->inlineSize)
+	{
+		// the value fits into the buffer behind the Key struct
+		char * inlineValue = (char *) key + sizeof (Key);
+		memmove (inlineValue, newBinary, dataSize);
+		if (key->data.v && !test_bit (key->flags, KEY_FLAG_MMAP_DATA)) elektraFree (key->data.v);
+		key->data.v = inlineValue;
+		key->dataSize = dataSize;
+		set_bit (key->flags, KEY_FLAG_MMAP_DATA | KEY_FLAG_SYNC);
+		return keyGetValueSize (key);
+	}
+
 	key->dataSize = dataSize;
 	if (key->data.v)
 	{
@@ -603,3 +617,117 @@ ssize_t keySetRaw (Key * key, const void * newBinary, size_t dataSize)
 	set_bit (key->flags, KEY_FLAG_SYNC);
 	return keyGetValueSize (key);
 }
+
+
+/**
+ * @internal
+ *
+ * A value of a Key converted to a C type.
+ *
+ * The name of the type is stored directly behind the struct.
+ */
+struct _ElektraTypedValue
+{
+	size_t size;			  /**< Size of the converted value in bytes */
+	char value[sizeof (long double)]; /**< The converted value, big enough for every kdb_*_t type */
+};
+
+/**
+ * @internal
+ *
+ * @return the name of the type stored behind @p typedValue
+ */
+static char * typedValueType (const ElektraTypedValue * typedValue)
+{
+	return (char *) typedValue + sizeof (ElektraTypedValue);
+}
+
+/**
+ * @internal
+ *
+ * Caches the value of @p key converted to a C type.
+ *
+ * Plugins that already converted the value, e.g. to validate it, store the
+ * result here, so that conversion functions do not have to parse the string
+ * again (see elektraKeyGetTypedValue()). The cache is dropped whenever the
+ * value of @p key changes.
+ *
+ * The caller must ensure that @p value is exactly what converting the current
+ * value of @p key to @p type returns.
+ *
+ * @param key the Key whose value was converted
+ * @param type the name of the type, e.g. "long", it is copied
+ * @param value pointer to the converted value
+ * @param size the size of @p value, at most `sizeof (long double)`
+ *
+ * @retval 1 if the value was cached
+ * @retval 0 if it is too big, the value of @p key is read-only or on memory errors
+ * @retval -1 on NULL pointers
+ */
+int elektraKeySetTypedValue (Key * key, const char * type, const void * value, size_t size)
+{
+	if (!key || !type || !value) return -1;
+	if (test_bit (key->flags, KEY_FLAG_RO_VALUE)) return 0;
+	if (size > sizeof (((ElektraTypedValue *) NULL)->value)) return 0;
+
+	size_t typeSize = strlen (type) + 1;
+	ElektraTypedValue * typedValue = elektraMalloc (sizeof (ElektraTypedValue) + typeSize);
+	if (!typedValue) return 0;
+
+	typedValue->size = size;
+	memcpy (typedValue->value, value, size);
+	memcpy (typedValueType (typedValue), type, typeSize);
+
+	elektraKeyClearTypedValue (key);
+	key->typedValue = typedValue;
+	return 1;
+}
+
+/**
+ * @internal
+ *
+ * Reads a value cached with elektraKeySetTypedValue().
+ *
+ * @param key the Key to read from
+ * @param type the name of the type that was requested
+ * @param value where the cached value will be copied to, unchanged if there is none
+ * @param size the size of @p value
+ *
+ * @retval 1 if a value of @p type and @p size was copied to @p value
+ * @retval 0 if there is no such cached value
+ * @retval -1 on NULL pointers
+ */
+int elektraKeyGetTypedValue (const Key * key, const char * type, void * value, size_t size)
+{
+	if (!key || !type || !value) return -1;
+
+	const ElektraTypedValue * typedValue = key->typedValue;
+	if (!typedValue || typedValue->size != size || strcmp (typedValueType (typedValue), type) != 0) return 0;
+
+	memcpy (value, typedValue->value, size);
+	return 1;
+}
+
+/**
+ * @internal
+ *
+ * @return a copy of @p typedValue
+ * @retval NULL if @p typedValue is NULL or on memory errors
+ */
+ElektraTypedValue * elektraTypedValueDup (const ElektraTypedValue * typedValue)
+{
+	if (!typedValue) return NULL;
+	return elektraMemDup (typedValue, sizeof (ElektraTypedValue) + strlen (typedValueType (typedValue)) + 1);
+}
+
+/**
+ * @internal
+ *
+ * Drops the cached typed value of @p key, if there is one.
+ */
+void elektraKeyClearTypedValue (Key * key)
+{
+	if (key->typedValue == NULL) return;
+	elektraFree (key->typedValue);
+	key->typedValue = NULL;
+}
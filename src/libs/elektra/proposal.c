@@ -23,6 +23,7 @@
 Key * elektraKsPopAtCursor (KeySet * ks, elektraCursor pos)
 {
 	if (!ks) return 0;
+	if (test_bit (ks->flags, KS_FLAG_FROZEN)) return 0;
 	if (pos < 0) return 0;
 	if (pos > SSIZE_MAX) return 0;
 
@@ -502,6 +502,11 @@ void elektraClose (Elektra * elektra)
 		ksDel (elektra->defaults);
 	}
 
+	if (elektra->index != NULL)
+	{
+		elektraFree (elektra->index);
+	}
+
 	elektraFree (elektra);
 }
 
@@ -543,6 +548,7 @@ void elektraSetArrayLookupKey (Elektra * elektra, const char * name, kdb_long_lo
 void elektraSaveKey (Elektra * elektra, Key * key, ElektraError ** error)
 {
 	int ret = 0;
+	elektra->indexValid = 0;
 	do
 	{
 		ksAppendKey (elektra->config, key);
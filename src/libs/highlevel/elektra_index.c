@@ -0,0 +1,337 @@
+/**
+ * @file
+ *
+ * @brief Elektra High Level API.
+ *
+ * @copyright BSD License (see doc/LICENSE.md or http://www.libelektra.org)
+ */
+
+#include "elektra.h"
+#include "elektra/conversion.h"
+#include "kdbhelper.h"
+#include "kdbprivate.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ELEKTRA_INDEX_CONVERT(KEY_TO_VALUE, KDB_TYPE, FIELD, entry)                                                                        \
+	if (strcmp (entry->type, KDB_TYPE) == 0)                                                                                           \
+	{                                                                                                                                  \
+		return KEY_TO_VALUE (entry->key, &entry->value.FIELD);                                                                     \
+	}
+
+static int convertIndexedValue (ElektraIndexedValue * entry)
+{
+	ELEKTRA_INDEX_CONVERT (elektraKeyToString, KDB_TYPE_STRING, stringValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToBoolean, KDB_TYPE_BOOLEAN, booleanValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToChar, KDB_TYPE_CHAR, charValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToOctet, KDB_TYPE_OCTET, octetValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToShort, KDB_TYPE_SHORT, shortValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToUnsignedShort, KDB_TYPE_UNSIGNED_SHORT, unsignedShortValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToLong, KDB_TYPE_LONG, longValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToUnsignedLong, KDB_TYPE_UNSIGNED_LONG, unsignedLongValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToLongLong, KDB_TYPE_LONG_LONG, longLongValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToUnsignedLongLong, KDB_TYPE_UNSIGNED_LONG_LONG, unsignedLongLongValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToFloat, KDB_TYPE_FLOAT, floatValue, entry);
+	ELEKTRA_INDEX_CONVERT (elektraKeyToDouble, KDB_TYPE_DOUBLE, doubleValue, entry);
+#ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
+	ELEKTRA_INDEX_CONVERT (elektraKeyToLongDouble, KDB_TYPE_LONG_DOUBLE, longDoubleValue, entry);
+#endif
+	return 0;
+}
+
+/**
+ * Looks up and converts all keys of the index again.
+ *
+ * @param elektra The Elektra instance to use.
+ */
+static void updateKeyIndex (Elektra * elektra)
+{
+	for (size_t id = 0; id < elektra->indexSize; ++id)
+	{
+		ElektraIndexedValue * entry = &elektra->index[id];
+
+		elektraSetLookupKey (elektra, entry->name);
+		entry->key = ksLookup (elektra->config, elektra->lookupKey, 0);
+		if (entry->key == NULL)
+		{
+			continue;
+		}
+
+		const Key * typeMeta = keyGetMeta (entry->key, "type");
+		if (typeMeta == NULL || strcmp (keyString (typeMeta), entry->type) != 0 || !convertIndexedValue (entry))
+		{
+			entry->key = NULL;
+		}
+	}
+	elektra->indexValid = 1;
+}
+
+static const ElektraIndexedValue * findIndexedValue (Elektra * elektra, size_t id)
+{
+	if (id >= elektra->indexSize)
+	{
+		char name[64];
+		snprintf (name, sizeof (name), "(key id %zu)", id);
+		elektraFatalError (elektra, elektraErrorKeyNotFound (name));
+		return NULL;
+	}
+
+	if (!elektra->indexValid)
+	{
+		updateKeyIndex (elektra);
+	}
+	return &elektra->index[id];
+}
+
+/**
+ * \addtogroup highlevel High-level API
+ * @{
+ */
+
+/**
+ * Helper function for code generation.
+ *
+ * Builds an index of already converted values for the given keys. Afterwards
+ * the value of `keys[id]` can be read with the elektraGet*ById() function of
+ * its type, which does not look up or convert anything. After the config was
+ * changed by an elektraSet*() function, the index is rebuilt on the next access.
+ *
+ * Keys that are missing, have the wrong type or cannot be converted are read with
+ * the corresponding elektraGet*() function instead, which reports the error.
+ *
+ * @param elektra The Elektra instance to use.
+ * @param keys    The keys to index, the array must stay valid until elektraClose() is called on @p elektra.
+ * @param size    The number of elements in @p keys.
+ */
+void elektraBuildKeyIndex (Elektra * elektra, const ElektraIndexedKey * keys, size_t size)
+{
+	if (elektra->index != NULL)
+	{
+		elektraFree (elektra->index);
+	}
+
+	elektra->index = size == 0 ? NULL : elektraCalloc (size * sizeof (ElektraIndexedValue));
+	elektra->indexSize = elektra->index == NULL ? 0 : size;
+	for (size_t id = 0; id < elektra->indexSize; ++id)
+	{
+		elektra->index[id].name = keys[id].name;
+		elektra->index[id].type = keys[id].type;
+	}
+	updateKeyIndex (elektra);
+}
+
+#define ELEKTRA_GET_VALUE_BY_ID(GET_BY_NAME, FIELD, elektra, id, result)                                                                   \
+	const ElektraIndexedValue * entry = findIndexedValue (elektra, id);                                                                \
+	if (entry == NULL)                                                                                                                 \
+	{                                                                                                                                  \
+		result = 0;                                                                                                                \
+	}                                                                                                                                  \
+	else if (entry->key == NULL)                                                                                                       \
+	{                                                                                                                                  \
+		result = GET_BY_NAME (elektra, entry->name);                                                                               \
+	}                                                                                                                                  \
+	else                                                                                                                               \
+	{                                                                                                                                  \
+		result = entry->value.FIELD;                                                                                               \
+	}
+
+/**
+ * Gets a string value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the string stored at the given key
+ *   The returned pointer remains valid until the internal state of @p elektra is modified.
+ *   Calls to elektraSet*() functions may cause such modifications. In any case, it becomes
+ *   invalid when elektraClose() is called on @p elektra.
+ */
+const char * elektraGetStringById (Elektra * elektra, size_t id)
+{
+	const char * result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetString, stringValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a boolean value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the boolean stored at the given key
+ */
+kdb_boolean_t elektraGetBooleanById (Elektra * elektra, size_t id)
+{
+	kdb_boolean_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetBoolean, booleanValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a char value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the char stored at the given key
+ */
+kdb_char_t elektraGetCharById (Elektra * elektra, size_t id)
+{
+	kdb_char_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetChar, charValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets an octet value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the octet stored at the given key
+ */
+kdb_octet_t elektraGetOctetById (Elektra * elektra, size_t id)
+{
+	kdb_octet_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetOctet, octetValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a short value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the short stored at the given key
+ */
+kdb_short_t elektraGetShortById (Elektra * elektra, size_t id)
+{
+	kdb_short_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetShort, shortValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a unsigned short value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the unsigned short stored at the given key
+ */
+kdb_unsigned_short_t elektraGetUnsignedShortById (Elektra * elektra, size_t id)
+{
+	kdb_unsigned_short_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetUnsignedShort, unsignedShortValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a long value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the long stored at the given key
+ */
+kdb_long_t elektraGetLongById (Elektra * elektra, size_t id)
+{
+	kdb_long_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetLong, longValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a unsigned long value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the unsigned long stored at the given key
+ */
+kdb_unsigned_long_t elektraGetUnsignedLongById (Elektra * elektra, size_t id)
+{
+	kdb_unsigned_long_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetUnsignedLong, unsignedLongValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a long long value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the long long stored at the given key
+ */
+kdb_long_long_t elektraGetLongLongById (Elektra * elektra, size_t id)
+{
+	kdb_long_long_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetLongLong, longLongValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a unsigned long long value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the unsigned long long stored at the given key
+ */
+kdb_unsigned_long_long_t elektraGetUnsignedLongLongById (Elektra * elektra, size_t id)
+{
+	kdb_unsigned_long_long_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetUnsignedLongLong, unsignedLongLongValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a float value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the float stored at the given key
+ */
+kdb_float_t elektraGetFloatById (Elektra * elektra, size_t id)
+{
+	kdb_float_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetFloat, floatValue, elektra, id, result);
+	return result;
+}
+
+/**
+ * Gets a double value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the double stored at the given key
+ */
+kdb_double_t elektraGetDoubleById (Elektra * elektra, size_t id)
+{
+	kdb_double_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetDouble, doubleValue, elektra, id, result);
+	return result;
+}
+
+#ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
+
+/**
+ * Gets a long double value from the key index.
+ *
+ * @param elektra The elektra instance to use.
+ * @param id      The index of the key in the array passed to elektraBuildKeyIndex().
+ * @return the long double stored at the given key
+ */
+kdb_long_double_t elektraGetLongDoubleById (Elektra * elektra, size_t id)
+{
+	kdb_long_double_t result;
+	ELEKTRA_GET_VALUE_BY_ID (elektraGetLongDouble, longDoubleValue, elektra, id, result);
+	return result;
+}
+
+#endif // ELEKTRA_HAVE_KDB_LONG_DOUBLE
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+};
+#endif
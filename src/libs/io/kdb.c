@@ -0,0 +1,191 @@
+/**
+ * @file
+ *
+ * @brief Asynchronous kdbGet() and kdbSet() using I/O bindings as defined in kdbio.h
+ *
+ * The blocking kdbGet() or kdbSet() runs in a separate thread. When it is
+ * done, the thread writes to a pipe watched by the I/O binding, which then
+ * calls the callback of the operation in the thread of the event loop.
+ * Plugins (and therefore notification callbacks) run in the separate thread.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ *
+ */
+
+#include <kdbhelper.h>
+#include <kdbio.h>
+#include <kdblogger.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+// Indices for array returned by pipe()
+#define FD_READ_END 0
+#define FD_WRITE_END 1
+
+typedef int (*KdbFunction) (KDB * handle, KeySet * returned, Key * parentKey);
+
+struct _ElektraIoKdbOperation
+{
+	ElektraIoFdOperation * fdOp;
+	int fds[2];
+	pthread_t thread;
+
+	KdbFunction function;
+	KDB * kdb;
+	KeySet * returned;
+	Key * parentKey;
+	int result;
+
+	ElektraIoKdbCallback callback;
+	void * data;
+};
+
+static void closeOperation (ElektraIoKdbOperation * kdbOp)
+{
+	close (kdbOp->fds[FD_READ_END]);
+	close (kdbOp->fds[FD_WRITE_END]);
+	elektraFree (kdbOp->fdOp);
+	elektraFree (kdbOp);
+}
+
+/**
+ * Runs kdbGet() or kdbSet() and wakes up the I/O binding.
+ * Called in the thread of the operation.
+ */
+static void * kdbWorker (void * data)
+{
+	ElektraIoKdbOperation * kdbOp = data;
+	kdbOp->result = kdbOp->function (kdbOp->kdb, kdbOp->returned, kdbOp->parentKey);
+
+	char done = 1;
+	while (write (kdbOp->fds[FD_WRITE_END], &done, 1) == -1 && errno == EINTR)
+		;
+	return NULL;
+}
+
+/**
+ * Calls the callback of the completed operation.
+ * Called by the I/O binding once the pipe is readable.
+ */
+static void kdbDone (ElektraIoFdOperation * fdOp, int flags ELEKTRA_UNUSED)
+{
+	ElektraIoKdbOperation * kdbOp = elektraIoFdGetData (fdOp);
+
+	char done;
+	if (read (kdbOp->fds[FD_READ_END], &done, 1) != 1)
+	{
+		return;
+	}
+
+	pthread_join (kdbOp->thread, NULL);
+	elektraIoBindingRemoveFd (fdOp);
+
+	kdbOp->callback (kdbOp, kdbOp->result);
+	closeOperation (kdbOp);
+}
+
+static ElektraIoKdbOperation * startOperation (ElektraIoInterface * binding, KdbFunction function, KDB * kdb, KeySet * returned,
+					       Key * parentKey, ElektraIoKdbCallback callback, void * data)
+{
+	if (binding == NULL || kdb == NULL || returned == NULL || parentKey == NULL || callback == NULL)
+	{
+		ELEKTRA_LOG_WARNING ("binding, kdb, returned, parentKey and callback cannot be NULL");
+		return NULL;
+	}
+
+	ElektraIoKdbOperation * kdbOp = elektraCalloc (sizeof (ElektraIoKdbOperation));
+	if (kdbOp == NULL)
+	{
+		return NULL;
+	}
+	if (pipe (kdbOp->fds) == -1)
+	{
+		ELEKTRA_LOG_WARNING ("pipe() failed: %s", strerror (errno));
+		elektraFree (kdbOp);
+		return NULL;
+	}
+	// kdbDone () must not block the I/O binding on spurious wakeups
+	int flags = fcntl (kdbOp->fds[FD_READ_END], F_GETFL);
+	if (flags == -1 || fcntl (kdbOp->fds[FD_READ_END], F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		ELEKTRA_LOG_WARNING ("fcntl() failed: %s", strerror (errno));
+		closeOperation (kdbOp);
+		return NULL;
+	}
+
+	kdbOp->function = function;
+	kdbOp->kdb = kdb;
+	kdbOp->returned = returned;
+	kdbOp->parentKey = parentKey;
+	kdbOp->callback = callback;
+	kdbOp->data = data;
+
+	kdbOp->fdOp = elektraIoNewFdOperation (kdbOp->fds[FD_READ_END], ELEKTRA_IO_READABLE, 1, kdbDone, kdbOp);
+	if (kdbOp->fdOp == NULL)
+	{
+		closeOperation (kdbOp);
+		return NULL;
+	}
+	if (!elektraIoBindingAddFd (binding, kdbOp->fdOp))
+	{
+		ELEKTRA_LOG_WARNING ("could not add file descriptor to I/O binding");
+		closeOperation (kdbOp);
+		return NULL;
+	}
+
+	if (pthread_create (&kdbOp->thread, NULL, kdbWorker, kdbOp) != 0)
+	{
+		ELEKTRA_LOG_WARNING ("could not start thread for operation");
+		elektraIoBindingRemoveFd (kdbOp->fdOp);
+		closeOperation (kdbOp);
+		return NULL;
+	}
+
+	return kdbOp;
+}
+
+ElektraIoKdbOperation * elektraIoKdbGet (ElektraIoInterface * binding, KDB * kdb, KeySet * returned, Key * parentKey,
+					 ElektraIoKdbCallback callback, void * data)
+{
+	return startOperation (binding, kdbGet, kdb, returned, parentKey, callback, data);
+}
+
+ElektraIoKdbOperation * elektraIoKdbSet (ElektraIoInterface * binding, KDB * kdb, KeySet * returned, Key * parentKey,
+					 ElektraIoKdbCallback callback, void * data)
+{
+	return startOperation (binding, kdbSet, kdb, returned, parentKey, callback, data);
+}
+
+KeySet * elektraIoKdbGetKeySet (ElektraIoKdbOperation * kdbOp)
+{
+	if (kdbOp == NULL)
+	{
+		ELEKTRA_LOG_WARNING ("operation cannot be NULL");
+		return NULL;
+	}
+	return kdbOp->returned;
+}
+
+Key * elektraIoKdbGetParentKey (ElektraIoKdbOperation * kdbOp)
+{
+	if (kdbOp == NULL)
+	{
+		ELEKTRA_LOG_WARNING ("operation cannot be NULL");
+		return NULL;
+	}
+	return kdbOp->parentKey;
+}
+
+void * elektraIoKdbGetData (ElektraIoKdbOperation * kdbOp)
+{
+	if (kdbOp == NULL)
+	{
+		ELEKTRA_LOG_WARNING ("operation cannot be NULL");
+		return NULL;
+	}
+	return kdbOp->data;
+}
@@ -221,3 +221,76 @@ Plugin * elektraPluginFromMountpoint (Plugin * plugin, const char * ref)
 
 	return pluginKey == NULL ? NULL : *(Plugin **) keyValue (pluginKey);
 }
+
+/**
+ * Determines which Keys a storage plugin has to write to store @p returned.
+ *
+ * The changes are relative to the Keys the storage plugin last read (kdbGet()) or wrote (kdbSet())
+ * for the current mountpoint. Storage plugins whose format allows it can use them to only write
+ * the changes, instead of rewriting their whole file.
+ *
+ * Keys of @p returned that did not exist before are added to @p added, existing Keys that need
+ * sync (see keyNeedSync()) to @p changed and Keys that don't exist anymore to @p removed.
+ *
+ * The changes are only known during the storage phase of kdbSet(). If this function returns 0,
+ * everything has to be written.
+ *
+ * @param plugin active plugin handle
+ * @param returned the KeySet passed to the kdbSet() function of the plugin
+ * @param added KeySet for the added Keys
+ * @param changed KeySet for the changed Keys
+ * @param removed KeySet for the removed Keys
+ *
+ * @retval 1 if @p added, @p changed and @p removed contain all changes
+ * @retval 0 if the changes are not known, @p added, @p changed and @p removed are not modified
+ * @retval -1 on NULL pointers
+ */
+int elektraPluginGetChangeLog (Plugin * plugin, KeySet * returned, KeySet * added, KeySet * changed, KeySet * removed)
+{
+	if (plugin == NULL || returned == NULL || added == NULL || changed == NULL || removed == NULL)
+	{
+		return -1;
+	}
+
+	const Key * storedKeysKey = ksLookupByName (plugin->global, "system:/elektra/kdb/backend/storedkeys", 0);
+	if (storedKeysKey == NULL || elektraPluginGetPhase (plugin) != ELEKTRA_KDB_SET_PHASE_STORAGE)
+	{
+		return 0;
+	}
+
+	KeySet * stored = *(KeySet **) keyValue (storedKeysKey);
+	if (stored == NULL)
+	{
+		return 0;
+	}
+
+	// both KeySets are sorted, so a single pass finds all differences
+	elektraCursor r = 0;
+	elektraCursor s = 0;
+	while (r < ksGetSize (returned) || s < ksGetSize (stored))
+	{
+		Key * cur = ksAtCursor (returned, r);
+		Key * old = ksAtCursor (stored, s);
+		int cmp = cur == NULL ? 1 : old == NULL ? -1 : keyCmp (cur, old);
+		if (cmp < 0)
+		{
+			ksAppendKey (added, cur);
+			++r;
+		}
+		else if (cmp > 0)
+		{
+			ksAppendKey (removed, old);
+			++s;
+		}
+		else
+		{
+			if (keyNeedSync (cur) == 1)
+			{
+				ksAppendKey (changed, cur);
+			}
+			++r;
+			++s;
+		}
+	}
+	return 1;
+}
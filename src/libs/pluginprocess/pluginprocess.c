@@ -45,6 +45,14 @@
  *     and copies it back to originalKeySet set
  * 13) Parent returns the result value from the child process
  *
+ * With the shared memory transport (see elektraPluginProcessInitTransport) the
+ * payload pipes are not used. Instead the payload keysets are written by the
+ * mmapstorage plugin to two files in shared memory (one for each direction),
+ * before the commandKeySet is sent. The receiver maps the file and uses the
+ * keyset in it directly, without parsing or copying it. The mapping of the
+ * previous payload is released, as soon as none of its keys are used anymore.
+ * If the child cannot share its payload, it sends -1 as payload size.
+ *
  * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
  */
 
@@ -59,6 +67,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -75,15 +84,35 @@ struct _ElektraPluginProcess
 	Key * childCommandPipeKey;
 	Key * childPayloadPipeKey;
 
+	char * payloadDir;
+	Key * parentPayloadFileKey;
+	Key * childPayloadFileKey;
+
 	int pid;
 	int counter;
 	ElektraInvokeHandle * dump;
+	ElektraInvokeHandle * mmapstorage; // NULL if the payload is sent through the payload pipes
 	void * pluginData;
 };
 
 static void cleanupPluginData (ElektraPluginProcess * pp, Key * errorKey, int cleanAllPipes)
 {
 	if (pp->dump) elektraInvokeClose (pp->dump, errorKey);
+	if (pp->mmapstorage) elektraInvokeClose (pp->mmapstorage, errorKey);
+
+	// the files are shared, so only the parent removes them
+	if (pp->payloadDir)
+	{
+		if (elektraPluginProcessIsParent (pp))
+		{
+			unlink (keyString (pp->parentPayloadFileKey));
+			unlink (keyString (pp->childPayloadFileKey));
+			rmdir (pp->payloadDir);
+		}
+		elektraFree (pp->payloadDir);
+	}
+	if (pp->parentPayloadFileKey) keyDel (pp->parentPayloadFileKey);
+	if (pp->childPayloadFileKey) keyDel (pp->childPayloadFileKey);
 
 	if (pp->parentCommandPipeKey) keyDel (pp->parentCommandPipeKey);
 	if (pp->parentPayloadPipeKey) keyDel (pp->parentPayloadPipeKey);
@@ -113,6 +142,41 @@ static char * longToStr (long i)
 	return str;
 }
 
+/**
+ * Writes or reads a payload file with the mmapstorage plugin.
+ *
+ * Read keysets point into the mapped file. They are handed to the unmap function
+ * of mmapstorage, which releases the mapping once their keys are not used anymore.
+ *
+ * @param pp the data structure containing the plugin's process information
+ * @param function either "set" or "get"
+ * @param ks the payload keyset
+ * @param fileKey the key holding the name of the payload file
+ * @param errorKey a key where error messages will be set
+ * @retval 1 on success
+ * @retval 0 if the payload could not be shared
+ */
+static int sharePayload (const ElektraPluginProcess * pp, const char * function, KeySet * ks, const Key * fileKey, Key * errorKey)
+{
+	// mmapstorage reports errors on the key it gets, fileKey is used for every call
+	Key * file = keyDup (fileKey, KEY_CP_NAME | KEY_CP_VALUE);
+	int ret = elektraInvoke2Args (pp->mmapstorage, function, ks, file);
+	if (ret == ELEKTRA_PLUGIN_STATUS_SUCCESS && strcmp (function, "get") == 0)
+	{
+		ret = elektraInvoke2Args (pp->mmapstorage, "unmap", ks, file);
+	}
+
+	if (ret != ELEKTRA_PLUGIN_STATUS_SUCCESS)
+	{
+		const Key * reason = keyGetMeta (file, "error/reason");
+		ELEKTRA_SET_RESOURCE_ERRORF (errorKey, "Could not %s the payload in the shared file %s: %s",
+					     strcmp (function, "get") == 0 ? "read" : "write", keyString (fileKey),
+					     reason != NULL ? keyString (reason) : "unknown error");
+	}
+	keyDel (file);
+	return ret == ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
 /** Start the child process' command loop
  *
  * This will make the child process wait for plugin commands
@@ -149,12 +213,7 @@ void elektraPluginProcessStart (Plugin * handle, ElektraPluginProcess * pp)
 		errno = 0;
 		long payloadSize = strtol (keyString (payloadSizeKey), &endPtr, 10);
 		// in case the payload size fails to be transferred, that it shouldn't, we can only assume no payload
-		if (*endPtr == '\0' && errno != ERANGE && payloadSize >= 0)
-		{
-			keySet = ksNew (payloadSize, KS_END);
-			elektraInvoke2Args (pp->dump, "get", keySet, pp->parentPayloadPipeKey);
-			ELEKTRA_LOG_DEBUG ("Child: We received a KeySet with %zd keys in it", ksGetSize (keySet));
-		}
+		int hasPayload = *endPtr == '\0' && errno != ERANGE && payloadSize >= 0;
 		errno = prevErrno;
 
 		Key * commandKey = ksLookupByName (commandKeySet, "/pluginprocess/command", KDB_O_NONE);
@@ -164,11 +223,30 @@ void elektraPluginProcessStart (Plugin * handle, ElektraPluginProcess * pp)
 		keySetName (key, keyString (parentNameKey));
 		int result = ELEKTRA_PLUGIN_STATUS_ERROR;
 
+		int payloadReceived = 1;
+		if (hasPayload)
+		{
+			keySet = ksNew (payloadSize, KS_END);
+			if (pp->mmapstorage)
+			{
+				payloadReceived = sharePayload (pp, "get", keySet, pp->parentPayloadFileKey, key);
+			}
+			else
+			{
+				elektraInvoke2Args (pp->dump, "get", keySet, pp->parentPayloadPipeKey);
+			}
+			ELEKTRA_LOG_DEBUG ("Child: We received a KeySet with %zd keys in it", ksGetSize (keySet));
+		}
+
 		// We'll always write some int value into it, so this should be fine
 		prevErrno = errno;
 		errno = 0;
 		long command = strtol (keyString (commandKey), &endPtr, 10);
-		if (*endPtr == '\0' && errno != ERANGE)
+		if (!payloadReceived)
+		{
+			ELEKTRA_LOG_DEBUG ("Child: Could not read the payload, not executing command %s", keyString (commandKey));
+		}
+		else if (*endPtr == '\0' && errno != ERANGE)
 		{
 			ELEKTRA_LOG ("Child: We want to execute the command with the value %ld now", command);
 			// Its hard to figure out the enum size in a portable way but for this comparison it should be ok
@@ -209,6 +287,12 @@ void elektraPluginProcessStart (Plugin * handle, ElektraPluginProcess * pp)
 							       keyString (commandKey));
 		}
 		errno = prevErrno;
+
+		// the parent maps the payload file as soon as it receives the commandKeySet
+		int payloadShared = keySet == NULL || !pp->mmapstorage || !payloadReceived ||
+				    sharePayload (pp, "set", keySet, pp->childPayloadFileKey, key);
+		if (!payloadReceived || !payloadShared) result = ELEKTRA_PLUGIN_STATUS_ERROR;
+
 		char * resultStr = longToStr (result);
 		ksAppendKey (commandKeySet, keyNew ("/pluginprocess/result", KEY_VALUE, resultStr, KEY_END));
 		elektraFree (resultStr);
@@ -217,13 +301,17 @@ void elektraPluginProcessStart (Plugin * handle, ElektraPluginProcess * pp)
 		keyDel (parentKey);
 
 		ELEKTRA_LOG_DEBUG ("Child: Writing the results back to the parent");
-		elektraInvoke2Args (pp->dump, "set", commandKeySet, pp->childCommandPipeKey);
 		if (keySet != NULL)
 		{
-			char * resultPayloadSize = longToStr (ksGetSize (keySet));
+			// a negative size tells the parent that there is no shared payload to read
+			char * resultPayloadSize = longToStr (payloadReceived && payloadShared ? ksGetSize (keySet) : -1);
 			keySetString (payloadSizeKey, resultPayloadSize);
 			elektraFree (resultPayloadSize);
-			elektraInvoke2Args (pp->dump, "set", keySet, pp->childPayloadPipeKey);
+		}
+		elektraInvoke2Args (pp->dump, "set", commandKeySet, pp->childCommandPipeKey);
+		if (keySet != NULL)
+		{
+			if (!pp->mmapstorage) elektraInvoke2Args (pp->dump, "set", keySet, pp->childPayloadPipeKey);
 			ksDel (keySet);
 		}
 		ksDel (commandKeySet);
@@ -288,7 +376,7 @@ int elektraPluginProcessSend (const ElektraPluginProcess * pp, pluginprocess_t c
 	ksAppendKey (commandKeySet, keyNew ("/pluginprocess/version", KEY_VALUE, "1", KEY_END));
 
 	// Some plugin functions don't use keysets, in that case don't send any actual payload, signal via flag
-	KeySet * keySet = originalKeySet != NULL ? ksDup (originalKeySet) : NULL;
+	KeySet * keySet = NULL;
 	char * payloadSizeStr = longToStr (ksGetSize (originalKeySet));
 	ksAppendKey (commandKeySet,
 		     keyNew ("/pluginprocess/payload/size", KEY_VALUE, originalKeySet == NULL ? "-1" : payloadSizeStr, KEY_END));
@@ -296,32 +384,56 @@ int elektraPluginProcessSend (const ElektraPluginProcess * pp, pluginprocess_t c
 
 	// Serialize, currently statically use dump as our default format, this already writes everything out to the pipe
 	ELEKTRA_LOG ("Parent: Sending data to issue command %u it through pipe %s", command, keyString (pp->parentCommandPipeKey));
+	if (originalKeySet != NULL && pp->mmapstorage)
+	{
+		// the child maps the payload file as soon as it receives the commandKeySet
+		ELEKTRA_LOG ("Parent: Sharing the payload keyset with %zd keys in the file %s", ksGetSize (originalKeySet),
+			     keyString (pp->parentPayloadFileKey));
+		if (!sharePayload (pp, "set", originalKeySet, pp->parentPayloadFileKey, key))
+		{
+			ksDel (commandKeySet);
+			return ELEKTRA_PLUGIN_STATUS_ERROR;
+		}
+	}
 	elektraInvoke2Args (pp->dump, "set", commandKeySet, pp->parentCommandPipeKey);
-	if (keySet != NULL)
+	if (originalKeySet != NULL && !pp->mmapstorage)
 	{
-		ELEKTRA_LOG ("Parent: Sending the payload keyset with %zd keys through the pipe %s", ksGetSize (keySet),
+		ELEKTRA_LOG ("Parent: Sending the payload keyset with %zd keys through the pipe %s", ksGetSize (originalKeySet),
 			     keyString (pp->parentPayloadPipeKey));
-		elektraInvoke2Args (pp->dump, "set", keySet, pp->parentPayloadPipeKey);
+		elektraInvoke2Args (pp->dump, "set", originalKeySet, pp->parentPayloadPipeKey);
 	}
 
 	// Deserialize
 	ELEKTRA_LOG_DEBUG ("Parent: Waiting for the result now on pipe %s", keyString (pp->childCommandPipeKey));
 	elektraInvoke2Args (pp->dump, "get", commandKeySet, pp->childCommandPipeKey);
 
-	if (keySet != NULL)
+	Key * payloadErrorKey = NULL;
+	if (originalKeySet != NULL)
 	{
-		// clear the keyset before to avoid memleaks caused by dump
 		char * endPtr;
 		int prevErrno = errno;
 		errno = 0;
 		long payloadSize =
 			strtol (keyString (ksLookupByName (commandKeySet, "/pluginprocess/payload/size", KDB_O_NONE)), &endPtr, 10);
+		int hasPayload = *endPtr == '\0' && errno != ERANGE && payloadSize >= 0;
 		// in case the payload size fails to be transferred, that it shouldn't, we simply assume the previous size
-		if (*endPtr != '\0' || errno == ERANGE || payloadSize < 0) payloadSize = ksGetSize (keySet);
+		if (!hasPayload) payloadSize = ksGetSize (originalKeySet);
 		errno = prevErrno;
-		ksDel (keySet);
 		keySet = ksNew (payloadSize, KS_END);
-		elektraInvoke2Args (pp->dump, "get", keySet, pp->childPayloadPipeKey);
+		if (pp->mmapstorage)
+		{
+			// without a shared payload the child reported an error, originalKeySet stays as it is
+			payloadErrorKey = keyNew ("/", KEY_END);
+			if (!hasPayload || !sharePayload (pp, "get", keySet, pp->childPayloadFileKey, payloadErrorKey))
+			{
+				ksDel (keySet);
+				keySet = NULL;
+			}
+		}
+		else
+		{
+			elektraInvoke2Args (pp->dump, "get", keySet, pp->childPayloadPipeKey);
+		}
 		ELEKTRA_LOG ("Parent: We received %zd keys in return", ksGetSize (keySet));
 	}
 
@@ -378,9 +490,19 @@ int elektraPluginProcessSend (const ElektraPluginProcess * pp, pluginprocess_t c
 	}
 	errno = prevErrno;
 
+	// errors were copied from the child above, so add the own ones afterwards
+	if (payloadErrorKey != NULL && keyGetMeta (payloadErrorKey, "error") != NULL)
+	{
+		keyCopyAllMeta (key, payloadErrorKey);
+		lresult = ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+	keyDel (payloadErrorKey);
+
 	// Command finished, cleanup the remaining memory now
 	ksDel (commandKeySet);
 	if (keySet != NULL) ksDel (keySet);
+	// originalKeySet does not hold the keys of the previous payload anymore, so its mapping can be released
+	if (pp->mmapstorage) elektraInvoke2Args (pp->mmapstorage, "unmap", NULL, key);
 
 	return lresult; // Safe, we had a bound check before, and plugins should return values in the int range
 }
@@ -435,6 +557,45 @@ static Key * makePipeKey (const char * pipeName, const int pipeFd)
 	return key;
 }
 
+/**
+ * Sets up the shared memory transport: the mmapstorage plugin and a new
+ * directory (in /dev/shm if possible) for the payload files.
+ *
+ * @param pp the data structure containing the plugin's process information
+ * @retval 1 if the payload can be shared in files
+ * @retval 0 if the payload has to be sent through the pipes
+ */
+static int initSharedPayload (ElektraPluginProcess * pp)
+{
+	pp->mmapstorage = elektraInvokeOpen ("mmapstorage", NULL, NULL);
+	if (!pp->mmapstorage)
+	{
+		ELEKTRA_LOG_DEBUG ("The mmapstorage plugin is not available, sending the payload through pipes");
+		return 0;
+	}
+
+	struct stat buf;
+	const char * dir = stat ("/dev/shm", &buf) == 0 && S_ISDIR (buf.st_mode) ? "/dev/shm" : "/tmp";
+	pp->payloadDir = concat (dir, "/elektra-pluginprocess-XXXXXX");
+	if (mkdtemp (pp->payloadDir) == NULL)
+	{
+		ELEKTRA_LOG_DEBUG ("Could not create %s, sending the payload through pipes", pp->payloadDir);
+		elektraFree (pp->payloadDir);
+		pp->payloadDir = NULL;
+		elektraInvokeClose (pp->mmapstorage, NULL);
+		pp->mmapstorage = NULL;
+		return 0;
+	}
+
+	char * parentFile = concat (pp->payloadDir, "/parent");
+	char * childFile = concat (pp->payloadDir, "/child");
+	pp->parentPayloadFileKey = keyNew ("/pluginprocess/payload/parent", KEY_VALUE, parentFile, KEY_END);
+	pp->childPayloadFileKey = keyNew ("/pluginprocess/payload/child", KEY_VALUE, childFile, KEY_END);
+	elektraFree (parentFile);
+	elektraFree (childFile);
+	return 1;
+}
+
 /** Initialize a plugin to be executed in its own process
  *
  * This will prepare all the required resources and then fork the current
@@ -462,23 +623,52 @@ int elektraPluginOpen (Plugin * handle, Key * errorKey)
 }
  * @endcode
  *
- * @param handle the plugin's handle
+ * The payload keysets are shared in memory if possible, see elektraPluginProcessInitTransport.
+ *
  * @param errorKey a key where error messages will be set
  * @retval NULL if the initialization failed
  * @retval a pointer to the information
  * @ingroup processplugin
  **/
 ElektraPluginProcess * elektraPluginProcessInit (Key * errorKey)
+{
+	return elektraPluginProcessInitTransport (errorKey, ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM);
+}
+
+/** Initialize a plugin to be executed in its own process with the given transport for the payload
+ *
+ * Works like elektraPluginProcessInit, but allows to choose how the payload keysets are
+ * transferred between the processes:
+ * - ELEKTRA_PLUGINPROCESS_TRANSPORT_PIPE serializes them with the dump plugin and sends them through pipes
+ * - ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM writes them with the mmapstorage plugin to files in shared memory,
+ *   which the receiver maps without parsing them. If the mmapstorage plugin is not available
+ *   or the files cannot be created, the pipes are used instead.
+ *
+ * Keysets received via shared memory point into the mapped files, like keysets read by mmapstorage.
+ * The mapping of a payload is released once none of its keys are used anymore.
+ *
+ * @param errorKey a key where error messages will be set
+ * @param transport how to transfer the payload
+ * @retval NULL if the initialization failed
+ * @retval a pointer to the information
+ * @ingroup processplugin
+ **/
+ElektraPluginProcess * elektraPluginProcessInitTransport (Key * errorKey, pluginprocess_transport_t transport)
 {
 	// First time initialization
 	ElektraPluginProcess * pp;
 	pp = elektraMalloc (sizeof (ElektraPluginProcess));
+	pp->pid = -1;
 	pp->counter = 0;
 	pp->pluginData = NULL;
 	pp->parentCommandPipeKey = NULL;
 	pp->parentPayloadPipeKey = NULL;
 	pp->childCommandPipeKey = NULL;
 	pp->childPayloadPipeKey = NULL;
+	pp->payloadDir = NULL;
+	pp->parentPayloadFileKey = NULL;
+	pp->childPayloadFileKey = NULL;
+	pp->mmapstorage = NULL;
 
 	KeySet * config = ksNew (1, keyNew ("user:/fullname", KEY_END), KS_END);
 	pp->dump = elektraInvokeOpen ("dump", config, errorKey);
@@ -491,6 +681,8 @@ ElektraPluginProcess * elektraPluginProcessInit (Key * errorKey)
 		return NULL;
 	}
 
+	if (transport == ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM) initSharedPayload (pp);
+
 	// As generally recommended, ignore SIGPIPE because we will notice that the
 	// commandKeySet has been transferred incorrectly anyway to detect broken pipes
 	signal (SIGPIPE, SIG_IGN);
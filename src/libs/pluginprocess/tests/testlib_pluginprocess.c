@@ -15,15 +15,18 @@
 #include <kdbplugin.h>
 #include <kdbprivate.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <tests.h>
 
+static pluginprocess_transport_t transport = ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM;
+
 static int elektraDummyOpen (Plugin * handle, Key * errorKey)
 {
 	ElektraPluginProcess * pp = elektraPluginGetData (handle);
 	if (pp == NULL)
 	{
-		if ((pp = elektraPluginProcessInit (errorKey)) == NULL) return ELEKTRA_PLUGIN_STATUS_ERROR;
+		if ((pp = elektraPluginProcessInitTransport (errorKey, transport)) == NULL) return ELEKTRA_PLUGIN_STATUS_ERROR;
 		elektraPluginSetData (handle, pp);
 		// pass dummy plugin data over to the child
 		int * testData = (int *) malloc (sizeof (int));
@@ -362,6 +365,82 @@ static void test_childAddingParentKey (void)
 	elektraFree (plugin);
 }
 
+static int elektraDummySetPayload (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	ElektraPluginProcess * pp = elektraPluginGetData (handle);
+	if (elektraPluginProcessIsParent (pp))
+	{
+		return elektraPluginProcessSend (pp, ELEKTRA_PLUGINPROCESS_SET, returned, parentKey);
+	}
+
+	// check what the child received and change it
+	Key * key = ksLookupByName (returned, "user:/tests/pluginprocess/key", KDB_O_NONE);
+	if (key == NULL || elektraStrCmp (keyString (key), "value") != 0 || keyGetMeta (key, "meta") == NULL)
+	{
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+	keySetString (key, "changed");
+	ksAppendKey (returned, keyNew ("user:/tests/pluginprocess/child", KEY_BINARY, KEY_SIZE, 4, KEY_VALUE, "\0\1\2\3", KEY_END));
+	keyDel (ksLookupByName (returned, "user:/tests/pluginprocess/removed", KDB_O_POP));
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+static void test_payload (void)
+{
+	printf ("test payload\n");
+
+	Key * parentKey = keyNew ("user:/tests/pluginprocess", KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	Plugin * plugin = createDummyPlugin (conf);
+	plugin->kdbSet = &elektraDummySetPayload;
+
+	KeySet * ks = ksNew (3, keyNew ("user:/tests/pluginprocess/key", KEY_VALUE, "value", KEY_META, "meta", "data", KEY_END),
+			     keyNew ("user:/tests/pluginprocess/removed", KEY_END), KS_END);
+	for (int i = 0; i < 1000; ++i)
+	{
+		char name[64];
+		snprintf (name, sizeof (name), "user:/tests/pluginprocess/many/#%d", i);
+		ksAppendKey (ks, keyNew (name, KEY_VALUE, name, KEY_END));
+	}
+
+	succeed_if (plugin->kdbOpen (plugin, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbOpen was not successful");
+	ElektraPluginProcess * pp = elektraPluginGetData (plugin);
+	if (pp)
+	{
+		succeed_if (plugin->kdbSet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS,
+			    "child process didn't receive the payload");
+		succeed_if (ksGetSize (ks) == 1002, "wrong number of keys returned");
+
+		Key * key = ksLookupByName (ks, "user:/tests/pluginprocess/key", KDB_O_NONE);
+		succeed_if (key != NULL, "key got lost");
+		succeed_if_same_string (keyString (key), "changed");
+		succeed_if (keyGetMeta (key, "meta") != NULL, "metadata got lost");
+
+		Key * child = ksLookupByName (ks, "user:/tests/pluginprocess/child", KDB_O_NONE);
+		succeed_if (child != NULL, "key added by the child is missing");
+		succeed_if (child != NULL && keyIsBinary (child) && keyGetValueSize (child) == 4 && memcmp (keyValue (child), "\0\1\2\3", 4) == 0,
+			    "binary value of the child is wrong");
+		succeed_if (ksLookupByName (ks, "user:/tests/pluginprocess/removed", KDB_O_NONE) == NULL, "key removed by the child is present");
+
+		Key * many = ksLookupByName (ks, "user:/tests/pluginprocess/many/#999", KDB_O_NONE);
+		succeed_if (many != NULL, "key got lost");
+		succeed_if_same_string (keyString (many), "user:/tests/pluginprocess/many/#999");
+
+		// with shared memory the keys are used directly from the mapped payload file
+		succeed_if (many != NULL && (transport != ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM || test_bit (many->flags, KEY_FLAG_MMAP_STRUCT)),
+			    "key does not point into the payload file");
+	}
+	succeed_if (plugin->kdbClose (plugin, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbClose was not successful");
+
+	output_warnings (parentKey);
+	output_error (parentKey);
+
+	keyDel (parentKey);
+	ksDel (ks);
+	ksDel (conf);
+	elektraFree (plugin);
+}
+
 static int elektraDummyOpenWithError (Plugin * handle, Key * errorKey)
 {
 	ElektraPluginProcess * pp = elektraPluginGetData (handle);
@@ -422,6 +501,74 @@ static int elektraDummyOpenAndDie (Plugin * handle, Key * errorKey)
 	_Exit (0);
 }
 
+static int elektraDummySetUnchanged (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	ElektraPluginProcess * pp = elektraPluginGetData (handle);
+	if (elektraPluginProcessIsParent (pp))
+	{
+		return elektraPluginProcessSend (pp, ELEKTRA_PLUGINPROCESS_SET, returned, parentKey);
+	}
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+static int countPayloadMappings (void)
+{
+	FILE * maps = fopen ("/proc/self/maps", "r");
+	if (maps == NULL) return 0;
+
+	int count = 0;
+	char line[4096];
+	while (fgets (line, sizeof (line), maps) != NULL)
+	{
+		if (strstr (line, "elektra-pluginprocess-") != NULL) ++count;
+	}
+	fclose (maps);
+	return count;
+}
+
+static void test_payloadMappings (void)
+{
+	printf ("test payloadMappings\n");
+
+	Key * parentKey = keyNew ("user:/tests/pluginprocess", KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	Plugin * plugin = createDummyPlugin (conf);
+	plugin->kdbSet = &elektraDummySetUnchanged;
+
+	KeySet * ks = ksNew (0, KS_END);
+	for (int i = 0; i < 100; ++i)
+	{
+		char name[64];
+		snprintf (name, sizeof (name), "user:/tests/pluginprocess/many/#%d", i);
+		ksAppendKey (ks, keyNew (name, KEY_VALUE, name, KEY_META, "meta", "data", KEY_END));
+	}
+
+	succeed_if (plugin->kdbOpen (plugin, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbOpen was not successful");
+	ElektraPluginProcess * pp = elektraPluginGetData (plugin);
+	if (pp)
+	{
+		// every call shares new payload files, only the one ks points into may stay mapped,
+		// the payloads of earlier tests stay mapped, their keys were still used when their plugin was closed
+		int mappings = countPayloadMappings ();
+		for (int i = 0; i < 50; ++i)
+		{
+			succeed_if (plugin->kdbSet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+		}
+		succeed_if (ksGetSize (ks) == 100, "wrong number of keys returned");
+		succeed_if (countPayloadMappings () == mappings + (transport == ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM ? 1 : 0),
+			    "previous payload files stay mapped");
+
+		Key * key = ksLookupByName (ks, "user:/tests/pluginprocess/many/#99", KDB_O_NONE);
+		succeed_if (key != NULL && keyGetMeta (key, "meta") != NULL, "metadata got lost");
+	}
+	succeed_if (plugin->kdbClose (plugin, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbClose was not successful");
+
+	keyDel (parentKey);
+	ksDel (ks);
+	ksDel (conf);
+	elektraFree (plugin);
+}
+
 static void test_childDies (void)
 {
 	printf ("test childDies\n");
@@ -450,13 +597,22 @@ int main (int argc, char ** argv)
 {
 	init (argc, argv);
 
-	test_communication ();
-	test_emptyKeySet ();
-	test_reservedParentKeyName ();
-	test_keysetContainingParentKey ();
-	test_closeWithoutOpen ();
-	test_childAddingParentKey ();
-	test_childDies ();
+	pluginprocess_transport_t transports[] = { ELEKTRA_PLUGINPROCESS_TRANSPORT_SHM, ELEKTRA_PLUGINPROCESS_TRANSPORT_PIPE };
+	for (size_t i = 0; i < sizeof (transports) / sizeof (transports[0]); ++i)
+	{
+		transport = transports[i];
+		printf ("transport %d\n", transport);
+
+		test_communication ();
+		test_emptyKeySet ();
+		test_reservedParentKeyName ();
+		test_keysetContainingParentKey ();
+		test_closeWithoutOpen ();
+		test_childAddingParentKey ();
+		test_payload ();
+		test_payloadMappings ();
+		test_childDies ();
+	}
 
 	print_result ("pluginprocess");
 
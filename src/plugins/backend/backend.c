@@ -459,8 +459,13 @@ int ELEKTRA_PLUGIN_FUNCTION (get) (Plugin * plugin, KeySet * ks, Key * parentKey
 
 		return runPluginGet (handle->getPositions.resolver, ks, parentKey);
 	case ELEKTRA_KDB_GET_PHASE_CACHECHECK:
-		// TODO [new_backend]: implement cache
-		return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+		if (handle->getPositions.resolver == NULL)
+		{
+			// no resolver configured -> no way to check whether cache is still valid
+			return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+		}
+
+		return runPluginGet (handle->getPositions.resolver, ks, parentKey);
 	case ELEKTRA_KDB_GET_PHASE_PRE_STORAGE:
 		return runPluginListGet (handle->getPositions.prestorage, ks, parentKey);
 	case ELEKTRA_KDB_GET_PHASE_STORAGE:
@@ -68,13 +68,14 @@ static int resolveCacheDirectory (Plugin * handle, CacheHandle * ch, Key * error
 	if (cacheDir)
 	{
 		cacheDir = elektraStrConcat (cacheDir, "/elektra");
-		ch->cachePath = keyNew ("system:/elektracache", KEY_END);
+		// the resolver takes the path from the value of the parent key
+		ch->cachePath = keyNew ("system:/elektracache", KEY_VALUE, cacheDir, KEY_END);
 		resolverConfig = ksNew (5, keyNew ("system:/path", KEY_VALUE, cacheDir, KEY_END), KS_END);
 		elektraFree (cacheDir);
 	}
 	else
 	{
-		ch->cachePath = keyNew ("user:/elektracache", KEY_END);
+		ch->cachePath = keyNew ("user:/elektracache", KEY_VALUE, "/.cache/elektra", KEY_END);
 		resolverConfig = ksNew (5, keyNew ("user:/path", KEY_VALUE, "/.cache/elektra", KEY_END), KS_END);
 	}
 
@@ -294,6 +295,8 @@ int elektraCacheGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * pa
 			       keyNew ("system:/elektra/modules/cache/exports/close", KEY_FUNC, elektraCacheClose, KEY_END),
 			       keyNew ("system:/elektra/modules/cache/exports/get", KEY_FUNC, elektraCacheGet, KEY_END),
 			       keyNew ("system:/elektra/modules/cache/exports/set", KEY_FUNC, elektraCacheSet, KEY_END),
+			       keyNew ("system:/elektra/modules/cache/exports/hook/cache/get", KEY_FUNC, elektraCacheHookGet, KEY_END),
+			       keyNew ("system:/elektra/modules/cache/exports/hook/cache/set", KEY_FUNC, elektraCacheHookSet, KEY_END),
 #include ELEKTRA_README
 			       keyNew ("system:/elektra/modules/cache/infos/version", KEY_VALUE, PLUGINVERSION, KEY_END), KS_END);
 		ksAppend (returned, contract);
@@ -444,6 +447,143 @@ error:
 	return ELEKTRA_PLUGIN_STATUS_ERROR;
 }
 
+// the hash of the mountpoint configuration passed to the hooks, empty for mountpoints without configuration
+static const char * configHash (const Key * parentKey)
+{
+	const Key * hashKey = keyGetMeta (parentKey, "meta:/internal/kdb/confighash");
+	return hashKey != NULL ? keyString (hashKey) : "";
+}
+
+/**
+ * @brief Implementation of the `cache/get` hook.
+ *
+ * Loads the cache entry of a single mountpoint into @p returned.
+ * The entry is only used, if it was written for the same storage identifier
+ * and the same configuration of the mountpoint.
+ *
+ * @param handle The plugin handle.
+ * @param returned Receives the cached keys, only valid if #ELEKTRA_PLUGIN_STATUS_SUCCESS is returned.
+ * @param parentKey The name is the mountpoint, the value is the storage identifier returned by the resolver phase.
+ *                  The metakey `meta:/internal/kdb/confighash` contains the hash of the mountpoint configuration, if any.
+ *                  On success the metakey `meta:/internal/kdb/cachehandle` is set to the cache handle of the entry.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if a cache entry was loaded
+ * @retval ELEKTRA_PLUGIN_STATUS_NO_UPDATE if there is no usable cache entry
+ */
+int elektraCacheHookGet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	CacheHandle * ch = elektraPluginGetData (handle);
+
+	Key * cacheFile = keyDup (parentKey, KEY_CP_NAME);
+	char * cacheFileName = kdbCacheFileName (ch, cacheFile, modeFile);
+	if (cacheFileName == NULL || access (cacheFileName, R_OK) != 0)
+	{
+		ELEKTRA_LOG_DEBUG ("CACHE MISS: no cache entry for %s", keyName (parentKey));
+		elektraFree (cacheFileName);
+		keyDel (cacheFile);
+		return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+	}
+
+	keySetString (cacheFile, cacheFileName);
+	elektraFree (cacheFileName);
+
+	// the metadata of the entry is stored in the global keyset of the cache file
+	KeySet * global = ch->cacheStorage->global;
+	ch->cacheStorage->global = ksNew (0, KS_END);
+
+	int result = ch->cacheStorage->kdbGet (ch->cacheStorage, returned, cacheFile);
+
+	Key * storageKey = ksLookupByName (ch->cacheStorage->global, KDB_CACHE_PREFIX "/entry/storage", 0);
+	Key * cacheHandleKey = ksLookupByName (ch->cacheStorage->global, KDB_CACHE_PREFIX "/entry/handle", 0);
+	Key * configKey = ksLookupByName (ch->cacheStorage->global, KDB_CACHE_PREFIX "/entry/config", 0);
+
+	int ret = ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+	if (result == ELEKTRA_PLUGIN_STATUS_SUCCESS && storageKey != NULL && cacheHandleKey != NULL && configKey != NULL &&
+	    elektraStrCmp (keyString (storageKey), keyString (parentKey)) == 0 &&
+	    elektraStrCmp (keyString (configKey), configHash (parentKey)) == 0)
+	{
+		ELEKTRA_LOG_DEBUG ("CACHE entry found for %s, handle: %s", keyName (parentKey), keyString (cacheHandleKey));
+		keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", keyString (cacheHandleKey));
+		ret = ELEKTRA_PLUGIN_STATUS_SUCCESS;
+	}
+	else
+	{
+		ELEKTRA_LOG_DEBUG ("CACHE MISS: cache entry for %s is unusable", keyName (parentKey));
+		ksClear (returned);
+	}
+
+	ksDel (ch->cacheStorage->global);
+	ch->cacheStorage->global = global;
+	keyDel (cacheFile);
+	return ret;
+}
+
+/**
+ * @brief Implementation of the `cache/set` hook.
+ *
+ * Stores @p returned as the cache entry of a single mountpoint.
+ *
+ * @param handle The plugin handle.
+ * @param returned The keys of the mountpoint.
+ * @param parentKey The name is the mountpoint, the value is the storage identifier returned by the resolver phase.
+ *                  The metakey `meta:/internal/kdb/cachehandle` must contain the cache handle returned by the resolver phase,
+ *                  `meta:/internal/kdb/confighash` the hash of the mountpoint configuration, if any.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the cache entry was written
+ * @retval ELEKTRA_PLUGIN_STATUS_NO_UPDATE if there is no cache handle
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if the cache entry could not be written
+ */
+int elektraCacheHookSet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	CacheHandle * ch = elektraPluginGetData (handle);
+
+	const Key * cacheHandleKey = keyGetMeta (parentKey, "meta:/internal/kdb/cachehandle");
+	if (cacheHandleKey == NULL)
+	{
+		return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+	}
+
+	Key * cacheFile = keyDup (parentKey, KEY_CP_NAME);
+	char * cacheFileName = kdbCacheFileName (ch, cacheFile, modeFile);
+	if (cacheFileName == NULL)
+	{
+		keyDel (cacheFile);
+		return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+	}
+
+	char * tmpFile = elektraGenTempFilename (cacheFileName);
+	keySetString (cacheFile, tmpFile);
+
+	KeySet * global = ch->cacheStorage->global;
+	ch->cacheStorage->global = ksNew (3, keyNew (KDB_CACHE_PREFIX "/entry/storage", KEY_VALUE, keyString (parentKey), KEY_END),
+					  keyNew (KDB_CACHE_PREFIX "/entry/handle", KEY_VALUE, keyString (cacheHandleKey), KEY_END),
+					  keyNew (KDB_CACHE_PREFIX "/entry/config", KEY_VALUE, configHash (parentKey), KEY_END), KS_END);
+
+	int result = ch->cacheStorage->kdbSet (ch->cacheStorage, returned, cacheFile);
+
+	ksDel (ch->cacheStorage->global);
+	ch->cacheStorage->global = global;
+
+	int ret = ELEKTRA_PLUGIN_STATUS_SUCCESS;
+	if (result != ELEKTRA_PLUGIN_STATUS_SUCCESS)
+	{
+		ELEKTRA_LOG_WARNING ("could not write cache entry for %s", keyName (parentKey));
+		unlink (tmpFile);
+		ret = ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+	else if (rename (tmpFile, cacheFileName) == -1)
+	{
+		ELEKTRA_LOG_WARNING ("could not rename cache entry for %s: %s", keyName (parentKey), strerror (errno));
+		unlink (tmpFile);
+		ret = ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+
+	elektraFree (cacheFileName);
+	elektraFree (tmpFile);
+	keyDel (cacheFile);
+	return ret;
+}
+
 Plugin * ELEKTRA_PLUGIN_EXPORT
 {
 	// clang-format off
@@ -18,6 +18,9 @@ int elektraCacheClose (Plugin * handle, Key * errorKey);
 int elektraCacheGet (Plugin * handle, KeySet * ks, Key * parentKey);
 int elektraCacheSet (Plugin * handle, KeySet * ks, Key * parentKey);
 
+int elektraCacheHookGet (Plugin * handle, KeySet * returned, Key * parentKey);
+int elektraCacheHookSet (Plugin * handle, KeySet * returned, Key * parentKey);
+
 Plugin * ELEKTRA_PLUGIN_EXPORT;
 
 #endif
@@ -7,6 +7,10 @@
  *
  */
 
+#define _XOPEN_SOURCE 700
+
+#include <ftw.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -15,6 +19,8 @@
 
 #include <tests_plugin.h>
 
+#include "cache.h"
+
 static void test_basics (void)
 {
 	printf ("test basics\n");
@@ -62,6 +68,69 @@ static void test_cacheNonBackendKeys (void)
 	keyDel (key);
 }
 
+static void test_hooks (void)
+{
+	printf ("test hooks\n");
+
+	Key * parentKey = keyNew ("user:/tests/cache/hooks", KEY_VALUE, "/tests/cache/hooks.ecf", KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("cache");
+
+	KeySet * ks = ksNew (2, keyNew ("user:/tests/cache/hooks/a", KEY_VALUE, "a", KEY_END),
+			     keyNew ("user:/tests/cache/hooks/b", KEY_VALUE, "b", KEY_END), KS_END);
+
+	// without cache handle nothing is stored
+	succeed_if (elektraCacheHookSet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_NO_UPDATE, "entry without cache handle was stored");
+
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", "42.000000001");
+	succeed_if (elektraCacheHookSet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "could not store cache entry");
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+
+	KeySet * cached = ksNew (0, KS_END);
+	succeed_if (elektraCacheHookGet (plugin, cached, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "could not load cache entry");
+	compare_keyset (ks, cached);
+	succeed_if_same_string (keyString (keyGetMeta (parentKey, "meta:/internal/kdb/cachehandle")), "42.000000001");
+	ksDel (cached);
+
+	// entries of a different storage location must not be used
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+	keySetString (parentKey, "/tests/cache/other.ecf");
+	cached = ksNew (0, KS_END);
+	succeed_if (elektraCacheHookGet (plugin, cached, parentKey) == ELEKTRA_PLUGIN_STATUS_NO_UPDATE, "cache entry of other file was used");
+	succeed_if (ksGetSize (cached) == 0, "keys of unusable cache entry were returned");
+	succeed_if (keyGetMeta (parentKey, "meta:/internal/kdb/cachehandle") == NULL, "cache handle of unusable cache entry was set");
+	ksDel (cached);
+
+	// entries of a changed mountpoint configuration must not be used
+	keySetString (parentKey, "/tests/cache/config.ecf");
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", "42.000000001");
+	keySetMeta (parentKey, "meta:/internal/kdb/confighash", "0000000a");
+	succeed_if (elektraCacheHookSet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "could not store cache entry");
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+
+	cached = ksNew (0, KS_END);
+	succeed_if (elektraCacheHookGet (plugin, cached, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "could not load cache entry");
+	compare_keyset (ks, cached);
+	ksDel (cached);
+
+	keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", NULL);
+	keySetMeta (parentKey, "meta:/internal/kdb/confighash", "0000000b");
+	cached = ksNew (0, KS_END);
+	succeed_if (elektraCacheHookGet (plugin, cached, parentKey) == ELEKTRA_PLUGIN_STATUS_NO_UPDATE,
+		    "cache entry of other mountpoint configuration was used");
+	succeed_if (ksGetSize (cached) == 0, "keys of unusable cache entry were returned");
+	ksDel (cached);
+
+	keyDel (parentKey);
+	ksDel (ks);
+	PLUGIN_CLOSE ();
+}
+
+static int removeCacheFile (const char * fpath, const struct stat * sb ELEKTRA_UNUSED, int tflag ELEKTRA_UNUSED,
+			    struct FTW * ftwbuf ELEKTRA_UNUSED)
+{
+	return remove (fpath);
+}
 
 int main (int argc, char ** argv)
 {
@@ -70,8 +139,19 @@ int main (int argc, char ** argv)
 
 	init (argc, argv);
 
+	// keep the cache entries of the tests out of the cache of the user
+	char cacheDir[] = "/tmp/elektra-testmod-cache-XXXXXX";
+	if (mkdtemp (cacheDir) == NULL || setenv ("XDG_CACHE_HOME", cacheDir, 1) != 0)
+	{
+		yield_error ("could not create temporary cache directory");
+		return 1;
+	}
+
 	test_basics ();
 	test_cacheNonBackendKeys ();
+	test_hooks ();
+
+	succeed_if (nftw (cacheDir, removeCacheFile, 16, FTW_DEPTH | FTW_PHYS) == 0, "could not remove temporary cache directory");
 
 	print_result ("testmod_cache");
 
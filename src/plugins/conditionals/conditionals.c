@@ -58,6 +58,97 @@ typedef enum
 	NOEXPR = -3,
 } CondResult;
 
+/**
+ * A single condition `Key Operation Value` of a compiled condition.
+ */
+typedef struct
+{
+	Comparator cmpOp;
+	char * condition; ///< the whole single condition, used in error messages
+	char * leftSide;  ///< NULL if the condition is invalid
+	char * rightSide; ///< NULL if cmpOp is NEX
+} CondNode;
+
+/**
+ * The position in a later single condition where the result of an
+ * inner condition is inserted, as `1` or `0`.
+ */
+typedef struct
+{
+	char * target;
+	size_t source;
+} CondPlaceholder;
+
+/**
+ * A compiled (possibly nested) condition. Its single conditions are
+ * ordered so that inner conditions are evaluated before the conditions
+ * using their results.
+ */
+typedef struct
+{
+	CondNode * nodes;
+	CondResult * results;
+	size_t size;
+	CondPlaceholder * placeholders;
+	size_t placeholderCount;
+} CondProgram;
+
+typedef enum
+{
+	ASSIGN_INVALID,
+	ASSIGN_VALUE,
+	ASSIGN_KEY,
+} AssignKind;
+
+typedef struct
+{
+	AssignKind kind;
+	char * value; ///< the value to assign or the key to assign the value from
+} CondAssign;
+
+/**
+ * A compiled condition string, shared by all keys using the same string.
+ */
+typedef struct
+{
+	int invalid; ///< the condition string has a syntax error, reported for every key using it
+	char * condition;
+	char * thenExpr;
+	char * elseExpr; ///< NULL if there is no ELSE-condition
+	CondProgram * ifProgram;
+	CondProgram * thenProgram;
+	CondProgram * elseProgram;
+	CondAssign thenAssign;
+	CondAssign elseAssign;
+} CondExpression;
+
+/**
+ * Plugin data: compiled condition strings keyed by the string, which live
+ * as long as the plugin.
+ */
+typedef struct
+{
+	KeySet * cache;
+	Key * lookup;
+	regex_t ifRegex;
+	regex_t thenRegex;
+	regex_t elseRegex;
+	regex_t nestedRegex;
+} ConditionalsData;
+
+/**
+ * State of the evaluation of one KeySet.
+ */
+typedef struct
+{
+	ConditionalsData * data;
+	KeySet * returned;
+	KeySet * pending; ///< keys whose assign/condition was not evaluated yet
+	KeySet * done;	  ///< keys that were evaluated early, because another key reads them
+	Key * parentKey;
+	CondResult result;
+} CondContext;
+
 static int isValidSuffix (char * suffix, const Key * suffixList)
 {
 	if (!suffixList) return 0;
@@ -186,13 +277,26 @@ static int compareStrings (const char * s1, const char * s2, const Key * suffixL
 	return retval;
 }
 
+/**
+ * @return the name of the key referenced by @p reference, which is relative to
+ * @p parentKey (`@/`), relative to @p curKey (`./` or `../`) or absolute
+ */
+static char * referenceName (const char * reference, const Key * curKey, const Key * parentKey)
+{
+	if (reference[0] == '@')
+		return elektraFormat ("%s/%s", keyName (parentKey), reference + 1);
+	else if (reference[0] == '.') // either starts with . or .., doesn't matter at this point
+		return elektraFormat ("%s/%s", keyName (curKey), reference);
+	else
+		return elektraStrDup (reference);
+}
+
 static CondResult evalCondition (const Key * curKey, const char * leftSide, Comparator cmpOp, const char * rightSide,
 				 const char * condition, const Key * suffixList, KeySet * ks, Key * parentKey)
 {
 	char * lookupName = NULL;
 	char * compareTo = NULL;
 	Key * key;
-	int len;
 	long result = 0;
 	if (rightSide)
 	{
@@ -217,26 +321,13 @@ static CondResult evalCondition (const Key * curKey, const char * leftSide, Comp
 		else if (rightSide && elektraStrLen (rightSide) > 1)
 		{
 			// not a literal, it has to be a key
-			if (rightSide[0] == '@')
-				len = (int) ((size_t) keyGetNameSize (parentKey) + elektraStrLen (rightSide));
-			else if (!strncmp (rightSide, "..", 2) || (rightSide[0] == '.'))
-				len = (int) ((size_t) keyGetNameSize (curKey) + elektraStrLen (rightSide));
-			else
-				len = (int) elektraStrLen (rightSide);
-
-			if (elektraRealloc ((void **) &lookupName, (size_t) len) < 0)
+			lookupName = referenceName (rightSide, curKey, parentKey);
+			if (!lookupName)
 			{
 				ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey);
 				result = ERROR;
 				goto Cleanup;
 			}
-			if (rightSide[0] == '@')
-				snprintf (lookupName, (size_t) len, "%s/%s", keyName (parentKey), rightSide + 1);
-			else if (rightSide[0] == '.') // either starts with . or .., doesn't matter at this point
-				snprintf (lookupName, (size_t) len, "%s/%s", keyName (curKey), rightSide);
-			else
-				snprintf (lookupName, (size_t) len, "%s", rightSide);
-
 			key = ksLookupByName (ks, lookupName, 0);
 			if (!key)
 			{
@@ -258,25 +349,14 @@ static CondResult evalCondition (const Key * curKey, const char * leftSide, Comp
 			strcpy (compareTo, keyString (key));
 		}
 	}
-	if (leftSide[0] == '@')
-		len = (int) ((size_t) keyGetNameSize (parentKey) + elektraStrLen (leftSide));
-	else if (!strncmp (leftSide, "..", 2) || (leftSide[0] == '.'))
-		len = (int) ((size_t) keyGetNameSize (curKey) + elektraStrLen (leftSide));
-	else
-		len = (int) elektraStrLen (leftSide);
-
-	if (elektraRealloc ((void **) &lookupName, (size_t) len) < 0)
+	if (lookupName) elektraFree (lookupName);
+	lookupName = referenceName (leftSide, curKey, parentKey);
+	if (!lookupName)
 	{
 		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey);
 		result = ERROR;
 		goto Cleanup;
 	}
-	if (leftSide[0] == '@')
-		snprintf (lookupName, (size_t) len, "%s/%s", keyName (parentKey), leftSide + 1);
-	else if (leftSide[0] == '.') // either . or .., doesn't matter here
-		snprintf (lookupName, (size_t) len, "%s/%s", keyName (curKey), leftSide);
-	else
-		snprintf (lookupName, (size_t) len, "%s", leftSide);
 	key = ksLookupByName (ks, lookupName, 0);
 	if (cmpOp == NEX)
 	{
@@ -402,19 +482,37 @@ static char * condition2cmpOp (const char * condition, Comparator * cmpOp)
 	return opStr;
 }
 
-static CondResult parseSingleCondition (const Key * key, const char * condition, const Key * suffixList, KeySet * ks, Key * parentKey)
+/**
+ * @return a copy of the characters of @p string from @p start up to (excluding) @p end
+ */
+static char * copyRange (const char * string, size_t start, size_t end)
 {
-	Comparator cmpOp;
-	char * opStr;
-	opStr = condition2cmpOp (condition, &cmpOp);
+	char * result = elektraMalloc (end - start + 1);
+	memcpy (result, string + start, end - start);
+	result[end - start] = '\0';
+	return result;
+}
+
+/**
+ * Splits @p node->condition into its comparator and both sides.
+ *
+ * The positions of both sides within the condition are returned in
+ * @p leftRange and @p rightRange (start and end), so that results of inner
+ * conditions can be inserted into them later.
+ */
+static void compileSingleCondition (CondNode * node, size_t leftRange[2], size_t rightRange[2])
+{
+	const char * condition = node->condition;
+	char * opStr = condition2cmpOp (condition, &node->cmpOp);
 
 	if (!opStr)
 	{
-		return ERROR;
+		return;
 	}
 
+	size_t conditionLen = strlen (condition);
 	size_t opLen;
-	if (cmpOp == LT || cmpOp == GT || cmpOp == NEX)
+	if (node->cmpOp == LT || node->cmpOp == GT || node->cmpOp == NEX)
 	{
 		opLen = 1;
 	}
@@ -422,9 +520,9 @@ static CondResult parseSingleCondition (const Key * key, const char * condition,
 	{
 		opLen = 2;
 	}
-	unsigned long startPos = 0;
-	unsigned long endPos = 0;
-	char * ptr = (char *) condition;
+	size_t startPos = 0;
+	size_t endPos = 0;
+	const char * ptr = condition;
 	int firstNot = 1;
 	if (*ptr == '!')
 	{
@@ -435,7 +533,7 @@ static CondResult parseSingleCondition (const Key * key, const char * condition,
 	while (isspace (*ptr))
 	{
 		++ptr;
-		if ((cmpOp == NEX) && (*ptr == '!') && firstNot)
+		if ((node->cmpOp == NEX) && (*ptr == '!') && firstNot)
 		{
 			firstNot = 0;
 			++ptr;
@@ -444,382 +542,468 @@ static CondResult parseSingleCondition (const Key * key, const char * condition,
 		++startPos;
 	}
 
+	if (node->cmpOp == NEX)
+	{
+		// everything after the ! is the key
+		leftRange[0] = startPos;
+		leftRange[1] = conditionLen > startPos ? conditionLen : startPos;
+		node->leftSide = copyRange (condition, leftRange[0], leftRange[1]);
+		return;
+	}
+
+	size_t opPos = (size_t) (opStr - condition);
 	ptr = opStr - 1;
 	while (ptr > condition && isspace (*ptr))
 	{
 		--ptr;
 		++endPos;
 	}
-	int len = (int) ((unsigned long) (opStr - condition) - endPos - startPos + 2);
-	char * leftSide = elektraMalloc ((size_t) len);
-	char * rightSide = NULL;
-	strncpy (leftSide, condition + startPos, (size_t) (len - 2));
-	leftSide[len - 2] = '\0';
+	leftRange[0] = startPos;
+	leftRange[1] = opPos > endPos + startPos ? opPos - endPos : startPos;
+
 	startPos = 0;
 	endPos = 0;
-	if (cmpOp == NEX)
-	{
-		goto parseSingleEnd;
-	}
 	ptr = opStr + opLen;
 	while (isspace (*ptr))
 	{
 		++ptr;
 		++startPos;
 	}
-	ptr = (char *) condition + (elektraStrLen (condition) - 2);
+	ptr = condition + conditionLen - 1;
 	while (isspace (*ptr))
 	{
 		--ptr;
 		++endPos;
 	}
-	len = (int) (elektraStrLen (condition) - (unsigned long) (opStr - condition) - opLen - endPos - startPos);
-	rightSide = elektraMalloc ((size_t) len);
-	strncpy (rightSide, opStr + opLen + startPos, (size_t) (len - 1));
-	rightSide[len - 1] = '\0';
-	CondResult ret;
+	rightRange[0] = opPos + opLen + startPos;
+	rightRange[1] = conditionLen > endPos + rightRange[0] ? conditionLen - endPos : rightRange[0];
 
-parseSingleEnd:
-	ret = evalCondition (key, leftSide, cmpOp, rightSide, condition, suffixList, ks, parentKey);
-	if (rightSide) elektraFree (rightSide);
-	elektraFree (leftSide);
-	return ret;
+	node->leftSide = copyRange (condition, leftRange[0], leftRange[1]);
+	node->rightSide = copyRange (condition, rightRange[0], rightRange[1]);
 }
 
-static const char * isAssign (Key * key, char * expr, Key * parentKey, KeySet * ks)
+static void addPlaceholder (CondProgram * program, char * target, size_t source)
 {
-	char * firstPtr = expr + 1;
-	char * lastPtr = expr + elektraStrLen (expr) - 3;
-	while (isspace (*firstPtr))
-		++firstPtr;
-	while (isspace (*lastPtr))
-		--lastPtr;
-	if (*firstPtr != '\'' || *lastPtr != '\'')
+	elektraRealloc ((void **) &program->placeholders, (program->placeholderCount + 1) * sizeof (CondPlaceholder));
+	program->placeholders[program->placeholderCount].target = target;
+	program->placeholders[program->placeholderCount].source = source;
+	++program->placeholderCount;
+}
+
+/**
+ * Compiles a (possibly nested) condition.
+ *
+ * The innermost parentheses are compiled first. Each of them is replaced
+ * by a placeholder for its result (`'1'` or `'0'`), which becomes part of
+ * the enclosing condition. The result of the program is the result of the
+ * last condition.
+ */
+static CondProgram * compileProgram (ConditionalsData * data, const char * condition)
+{
+	CondProgram * program = elektraCalloc (sizeof (CondProgram));
+	char * localCondition = elektraStrDup (condition);
+	size_t length = strlen (localCondition);
+	// index + 1 of the condition whose result is inserted at the position
+	size_t * sources = elektraCalloc ((length + 2) * sizeof (size_t));
+	size_t subMatches = 4;
+	regmatch_t m[subMatches];
+	while (1)
 	{
-		if (lastPtr <= firstPtr)
+		int nomatch = regexec (&data->nestedRegex, localCondition, subMatches, m, 0);
+		if (nomatch || m[3].rm_so == -1)
 		{
-			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-				parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", expr);
-			return NULL;
-		}
-		*(lastPtr + 1) = '\0';
-		Key * lookupKey;
-		if (*firstPtr == '@')
-		{
-			lookupKey = keyDup (parentKey, KEY_CP_ALL);
-			++firstPtr;
-			keyAddName (lookupKey, firstPtr);
+			break;
 		}
-		else if (!strncmp (firstPtr, "..", 2) || !strncmp (firstPtr, ".", 1))
+		size_t startPos = (size_t) m[3].rm_so;
+		size_t endPos = (size_t) m[3].rm_eo;
+
+		size_t index = program->size;
+		elektraRealloc ((void **) &program->nodes, (index + 1) * sizeof (CondNode));
+		elektraRealloc ((void **) &program->results, (index + 1) * sizeof (CondResult));
+		++program->size;
+		CondNode * node = &program->nodes[index];
+		memset (node, 0, sizeof (CondNode));
+		node->condition = copyRange (localCondition, startPos, endPos);
+
+		size_t leftRange[2] = { 0, 0 };
+		size_t rightRange[2] = { 0, 0 };
+		compileSingleCondition (node, leftRange, rightRange);
+
+		for (size_t i = startPos; i < endPos; ++i)
 		{
-			lookupKey = keyDup (key, KEY_CP_ALL);
-			keyAddName (lookupKey, firstPtr);
+			if (!sources[i]) continue;
+			size_t pos = i - startPos;
+			addPlaceholder (program, node->condition + pos, sources[i] - 1);
+			if (node->leftSide && pos >= leftRange[0] && pos < leftRange[1])
+			{
+				addPlaceholder (program, node->leftSide + pos - leftRange[0], sources[i] - 1);
+			}
+			if (node->rightSide && pos >= rightRange[0] && pos < rightRange[1])
+			{
+				addPlaceholder (program, node->rightSide + pos - rightRange[0], sources[i] - 1);
+			}
 		}
-		else
+
+		for (size_t i = startPos - 1; i < endPos + 1; ++i)
 		{
-			lookupKey = keyNew (firstPtr, KEY_END);
+			localCondition[i] = ' ';
+			sources[i] = 0;
 		}
-		Key * assign = ksLookup (ks, lookupKey, KDB_O_NONE);
-		if (!assign)
+		localCondition[startPos - 1] = '\'';
+		localCondition[startPos] = '0';
+		localCondition[startPos + 1] = '\'';
+		sources[startPos] = index + 1;
+		sources[startPos + 1] = 0;
+	}
+	elektraFree (sources);
+	elektraFree (localCondition);
+	return program;
+}
+
+static void freeProgram (CondProgram * program)
+{
+	if (!program) return;
+	for (size_t i = 0; i < program->size; ++i)
+	{
+		elektraFree (program->nodes[i].condition);
+		elektraFree (program->nodes[i].leftSide);
+		elektraFree (program->nodes[i].rightSide);
+	}
+	elektraFree (program->nodes);
+	elektraFree (program->results);
+	elektraFree (program->placeholders);
+	elektraFree (program);
+}
+
+static CondResult evalProgram (CondProgram * program, const Key * key, const Key * suffixList, KeySet * ks, Key * parentKey)
+{
+	CondResult result = FALSE;
+	for (size_t i = 0; i < program->size; ++i)
+	{
+		CondNode * node = &program->nodes[i];
+		if (!node->leftSide)
 		{
-			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Key %s not found", keyName (lookupKey));
-			keyDel (lookupKey);
-			return NULL;
+			result = ERROR;
 		}
 		else
 		{
-			keyDel (lookupKey);
-			return keyString (assign);
+			result = evalCondition (key, node->leftSide, node->cmpOp, node->rightSide, node->condition, suffixList, ks, parentKey);
 		}
-	}
-	else
-	{
-		if (firstPtr == lastPtr) // only one quote in the assign string, invalid syntax
-		{
-			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-				parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", expr);
-			return NULL;
-		}
-		char * nextMark = strchr (firstPtr + 1, '\'');
-		if (nextMark != lastPtr) // more than two quotes, invalid syntax too
+		program->results[i] = result;
+
+		for (size_t j = 0; j < program->placeholderCount; ++j)
 		{
-			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-				parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", expr);
-			return NULL;
+			if (program->placeholders[j].source == i) *program->placeholders[j].target = (result == TRUE) ? '1' : '0';
 		}
-		*lastPtr = '\0';
-		*firstPtr = '\0';
-		++firstPtr;
-		return firstPtr;
 	}
+	return result;
 }
 
-static CondResult parseCondition (Key * key, const char * condition, const Key * suffixList, KeySet * ks, Key * parentKey)
+/**
+ * Compiles the THEN or ELSE part @p expr of an assignment, which is either
+ * a literal enclosed by '' or a key.
+ */
+static void compileAssign (const char * expr, CondAssign * assign)
 {
-	CondResult result = FALSE;
-	const char * regexString = "((\\(([^\\(\\)]*)\\)))";
-	regex_t regex;
-
-	if ((regcomp (&regex, regexString, REG_EXTENDED | REG_NEWLINE)))
+	char * localExpr = elektraStrDup (expr);
+	size_t length = strlen (localExpr);
+	assign->kind = ASSIGN_INVALID;
+	assign->value = NULL;
+	if (length < 2)
 	{
-		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey); // the regex compiles so the only
-		// possible error would be out of
-		// memory
-		ksDel (ks);
-		return ERROR;
+		elektraFree (localExpr);
+		return;
 	}
 
-	char * localCondition = elektraStrDup (condition);
-	size_t subMatches = 4;
-	regmatch_t m[subMatches];
-	char * ptr = localCondition;
-	while (1)
+	char * firstPtr = localExpr + 1;
+	char * lastPtr = localExpr + length - 2;
+	while (isspace (*firstPtr))
+		++firstPtr;
+	while (lastPtr > localExpr && isspace (*lastPtr))
+		--lastPtr;
+	if (*firstPtr != '\'' || *lastPtr != '\'')
 	{
-		int nomatch = regexec (&regex, ptr, subMatches, m, 0);
-		if (nomatch)
+		if (lastPtr > firstPtr)
 		{
-			break;
+			*(lastPtr + 1) = '\0';
+			assign->kind = ASSIGN_KEY;
+			assign->value = elektraStrDup (firstPtr);
 		}
-		if (m[3].rm_so == -1)
-		{
-			result = -1;
-			break;
-		}
-		int startPos;
-		int endPos;
-		startPos = (int) (m[3].rm_so + (ptr - localCondition));
-		endPos = (int) (m[3].rm_eo + (ptr - localCondition));
-		char * singleCondition = elektraMalloc ((size_t) (endPos - startPos + 1));
-		strncpy (singleCondition, localCondition + startPos, (size_t) (endPos - startPos));
-		singleCondition[endPos - startPos] = '\0';
-		result = parseSingleCondition (key, singleCondition, suffixList, ks, parentKey);
-		for (int i = startPos - 1; i < endPos + 1; ++i)
-			localCondition[i] = ' ';
-		localCondition[startPos - 1] = '\'';
-		localCondition[startPos] = (result == TRUE) ? '1' : '0';
-		localCondition[startPos + 1] = '\'';
-		elektraFree (singleCondition);
 	}
-	elektraFree (localCondition);
-	regfree (&regex);
-	return result;
+	else if (firstPtr != lastPtr && strchr (firstPtr + 1, '\'') == lastPtr)
+	{
+		// exactly two quotes
+		*lastPtr = '\0';
+		assign->kind = ASSIGN_VALUE;
+		assign->value = elektraStrDup (firstPtr + 1);
+	}
+	elektraFree (localExpr);
 }
 
-
-static CondResult parseConditionString (const Key * meta, const Key * suffixList, Key * parentKey, Key * key, KeySet * ks, Operation op)
+/**
+ * @return a key with the name of the key referenced by an assignment
+ */
+static Key * assignLookupKey (const char * reference, const Key * key, const Key * parentKey)
 {
-	const char * conditionString = keyString (meta);
-	const char * regexString1 = "(\\(((.*)?)\\))[[:space:]]*\\?";
-	const char * regexString2 = "\\?[[:space:]]*(\\(((.*)?)\\))";
-	const char * regexString3 = "[[:space:]]*:[[:space:]]*(\\(((.*)?)\\))";
-	regex_t regex1, regex2, regex3;
-	CondResult ret;
-	if ((ret = regcomp (&regex1, regexString1, REGEX_FLAGS_CONDITION)))
-	{
-		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey); // the regex compiles so the only
-		// possible error would be out of
-		// memory
-		ksDel (ks);
-		return ERROR;
-	}
-	if ((ret = regcomp (&regex2, regexString2, REGEX_FLAGS_CONDITION)))
+	Key * lookupKey;
+	if (*reference == '@')
 	{
-		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey); // the regex compiles so the only
-		// possible error would be out of
-		// memory
-		regfree (&regex1);
-		ksDel (ks);
-		return ERROR;
+		lookupKey = keyDup (parentKey, KEY_CP_NAME);
+		keyAddName (lookupKey, reference + 1);
 	}
-	if ((ret = regcomp (&regex3, regexString3, REGEX_FLAGS_CONDITION)))
+	else if (!strncmp (reference, "..", 2) || !strncmp (reference, ".", 1))
 	{
-		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey); // the regex compiles so the only
-		// possible error would be out of
-		// memory
-		regfree (&regex1);
-		regfree (&regex2);
-		ksDel (ks);
-		return ERROR;
+		lookupKey = keyDup (key, KEY_CP_NAME);
+		keyAddName (lookupKey, reference);
 	}
-	size_t subMatches = 6;
-	regmatch_t m[subMatches];
-	int nomatch = regexec (&regex1, conditionString, subMatches, m, 0);
-	if (nomatch)
+	else
 	{
-		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", conditionString);
-		regfree (&regex1);
-		regfree (&regex2);
-		regfree (&regex3);
-		ksDel (ks);
-		return ERROR;
+		lookupKey = keyNew (reference, KEY_END);
 	}
-	if (m[1].rm_so == -1)
+	return lookupKey;
+}
+
+static const char * evalAssign (const CondAssign * assign, const char * expr, const Key * key, KeySet * ks, Key * parentKey)
+{
+	if (assign->kind == ASSIGN_INVALID)
 	{
 		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", conditionString);
-		regfree (&regex1);
-		regfree (&regex2);
-		regfree (&regex3);
-		ksDel (ks);
-		return ERROR;
+			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", expr);
+		return NULL;
 	}
-	int startPos = (int) m[1].rm_so;
-	int endPos = (int) m[1].rm_eo;
-	char * condition = elektraMalloc ((size_t) (endPos - startPos + 1));
-	char * thenexpr = NULL;
-	char * elseexpr = NULL;
-	strncpy (condition, conditionString + startPos, (size_t) (endPos - startPos));
-	condition[endPos - startPos] = '\0';
-	nomatch = regexec (&regex2, conditionString, subMatches, m, 0);
-	if (nomatch)
+	if (assign->kind == ASSIGN_VALUE)
 	{
-		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", conditionString);
-		regfree (&regex1);
-		regfree (&regex2);
-		regfree (&regex3);
-		ksDel (ks);
-		return ERROR;
+		return assign->value;
 	}
-	if (m[1].rm_so == -1)
+
+	Key * lookupKey = assignLookupKey (assign->value, key, parentKey);
+	Key * found = ksLookup (ks, lookupKey, KDB_O_NONE);
+	if (!found)
 	{
-		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", conditionString);
-		regfree (&regex1);
-		regfree (&regex2);
-		regfree (&regex3);
-		ksDel (ks);
-		return ERROR;
+		ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Key %s not found", keyName (lookupKey));
+		keyDel (lookupKey);
+		return NULL;
 	}
+	keyDel (lookupKey);
+	return keyString (found);
+}
 
-	startPos = (int) m[1].rm_so;
-	endPos = (int) m[1].rm_eo;
-	thenexpr = elektraMalloc ((size_t) (endPos - startPos + 1));
-	strncpy (thenexpr, conditionString + startPos, (size_t) (endPos - startPos));
-	thenexpr[endPos - startPos] = '\0';
+/**
+ * Compiles a condition string `(IF-condition) ? (THEN-condition) : (ELSE-condition)`.
+ *
+ * THEN and ELSE are compiled both as conditions and as assignments, as the
+ * same string can be used in check/condition and assign/condition.
+ */
+static CondExpression * compileExpression (ConditionalsData * data, const char * conditionString)
+{
+	CondExpression * expr = elektraCalloc (sizeof (CondExpression));
+	size_t subMatches = 6;
+	regmatch_t m[subMatches];
+	if (regexec (&data->ifRegex, conditionString, subMatches, m, 0) || m[1].rm_so == -1)
+	{
+		expr->invalid = 1;
+		return expr;
+	}
+	char * condition = copyRange (conditionString, (size_t) m[1].rm_so, (size_t) m[1].rm_eo);
+	if (regexec (&data->thenRegex, conditionString, subMatches, m, 0) || m[1].rm_so == -1)
+	{
+		elektraFree (condition);
+		expr->invalid = 1;
+		return expr;
+	}
+	expr->condition = condition;
+	expr->thenExpr = copyRange (conditionString, (size_t) m[1].rm_so, (size_t) m[1].rm_eo);
 
-	nomatch = regexec (&regex3, conditionString, subMatches, m, 0);
-	if (!nomatch)
+	if (!regexec (&data->elseRegex, conditionString, subMatches, m, 0))
 	{
 		if (m[1].rm_so == -1)
 		{
-			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-				parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information",
-				conditionString);
-			regfree (&regex1);
-			regfree (&regex2);
-			regfree (&regex3);
-			ksDel (ks);
-			return ERROR;
+			expr->invalid = 1;
+			return expr;
 		}
-		thenexpr[strlen (thenexpr) - (size_t) ((m[0].rm_eo - m[0].rm_so))] = '\0';
-		startPos = (int) m[1].rm_so;
-		endPos = (int) m[1].rm_eo;
-		elseexpr = elektraMalloc ((size_t) (endPos - startPos + 1));
-		strncpy (elseexpr, conditionString + startPos, (size_t) (endPos - startPos));
-		elseexpr[endPos - startPos] = '\0';
+		expr->thenExpr[strlen (expr->thenExpr) - (size_t) ((m[0].rm_eo - m[0].rm_so))] = '\0';
+		expr->elseExpr = copyRange (conditionString, (size_t) m[1].rm_so, (size_t) m[1].rm_eo);
+	}
+
+	expr->ifProgram = compileProgram (data, expr->condition);
+	expr->thenProgram = compileProgram (data, expr->thenExpr);
+	compileAssign (expr->thenExpr, &expr->thenAssign);
+	if (expr->elseExpr)
+	{
+		expr->elseProgram = compileProgram (data, expr->elseExpr);
+		compileAssign (expr->elseExpr, &expr->elseAssign);
+	}
+	return expr;
+}
+
+static void freeExpression (CondExpression * expr)
+{
+	elektraFree (expr->condition);
+	elektraFree (expr->thenExpr);
+	elektraFree (expr->elseExpr);
+	freeProgram (expr->ifProgram);
+	freeProgram (expr->thenProgram);
+	freeProgram (expr->elseProgram);
+	elektraFree (expr->thenAssign.value);
+	elektraFree (expr->elseAssign.value);
+	elektraFree (expr);
+}
+
+/**
+ * Looks up the compiled expression for @p conditionString and compiles it on a cache miss.
+ */
+static CondExpression * lookupExpression (ConditionalsData * data, const char * conditionString)
+{
+	keySetName (data->lookup, "/");
+	keyAddBaseName (data->lookup, conditionString);
+
+	Key * cached = ksLookup (data->cache, data->lookup, 0);
+	if (cached)
+	{
+		return *(CondExpression **) keyValue (cached);
 	}
 
-	ret = parseCondition (key, condition, suffixList, ks, parentKey);
+	CondExpression * expr = compileExpression (data, conditionString);
+	Key * entry = keyDup (data->lookup, KEY_CP_NAME);
+	keySetBinary (entry, &expr, sizeof (expr));
+	ksAppendKey (data->cache, entry);
+	return expr;
+}
+
+static CondResult evalExpression (CondExpression * expr, const char * conditionString, const Key * suffixList, Key * parentKey, Key * key,
+				  KeySet * ks, Operation op)
+{
+	if (expr->invalid)
+	{
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
+			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", conditionString);
+		return ERROR;
+	}
+
+	CondResult ret = evalProgram (expr->ifProgram, key, suffixList, ks, parentKey);
 	if (ret == TRUE)
 	{
 		if (op == ASSIGN)
 		{
-			const char * assign = isAssign (key, thenexpr, parentKey, ks);
-			if (assign != NULL)
-			{
-				keySetString (key, assign);
-				ret = TRUE;
-				goto CleanUp;
-			}
-			else
-			{
-				ret = ERROR;
-				goto CleanUp;
-			}
+			const char * assign = evalAssign (&expr->thenAssign, expr->thenExpr, key, ks, parentKey);
+			if (assign == NULL) return ERROR;
+			keySetString (key, assign);
+			return TRUE;
 		}
-		else
+
+		ret = evalProgram (expr->thenProgram, key, suffixList, ks, parentKey);
+		if (ret == FALSE)
 		{
-			ret = parseCondition (key, thenexpr, suffixList, ks, parentKey);
-			if (ret == FALSE)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Validation of Key %s: %s failed. (%s failed)",
-									keyName (key) + strlen (keyName (parentKey)) + 1, conditionString,
-									thenexpr);
-			}
-			else if (ret == ERROR)
-			{
-				ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-					parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information",
-					thenexpr);
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Validation of Key %s: %s failed. (%s failed)",
+								keyName (key) + strlen (keyName (parentKey)) + 1, conditionString,
+								expr->thenExpr);
+		}
+		else if (ret == ERROR)
+		{
+			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
+				parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information",
+				expr->thenExpr);
 		}
 	}
 	else if (ret == FALSE)
 	{
-		if (elseexpr)
+		if (!expr->elseExpr)
 		{
-			if (op == ASSIGN)
-			{
-				const char * assign = isAssign (key, elseexpr, parentKey, ks);
-				if (assign != NULL)
-				{
-					keySetString (key, assign);
-					ret = TRUE;
-					goto CleanUp;
-				}
-				else
-				{
-					ret = ERROR;
-					goto CleanUp;
-				}
-			}
-			else
-			{
-				ret = parseCondition (key, elseexpr, suffixList, ks, parentKey);
+			return NOEXPR;
+		}
+		if (op == ASSIGN)
+		{
+			const char * assign = evalAssign (&expr->elseAssign, expr->elseExpr, key, ks, parentKey);
+			if (assign == NULL) return ERROR;
+			keySetString (key, assign);
+			return TRUE;
+		}
 
-				if (ret == FALSE)
-				{
-					ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Validation of Key %s: %s failed. (%s failed)",
-										keyName (key) + strlen (keyName (parentKey)) + 1,
-										conditionString, elseexpr);
-				}
-				else if (ret == ERROR)
-				{
-					ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-						parentKey,
-						"Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information",
-						elseexpr);
-				}
-			}
+		ret = evalProgram (expr->elseProgram, key, suffixList, ks, parentKey);
+		if (ret == FALSE)
+		{
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Validation of Key %s: %s failed. (%s failed)",
+								keyName (key) + strlen (keyName (parentKey)) + 1, conditionString,
+								expr->elseExpr);
 		}
-		else
+		else if (ret == ERROR)
 		{
-			ret = NOEXPR;
+			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
+				parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information",
+				expr->elseExpr);
 		}
 	}
 	else if (ret == ERROR)
 	{
 		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (
-			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", condition);
+			parentKey, "Invalid syntax: '%s'. Check kdb plugin-info conditionals for additional information", expr->condition);
 	}
-
-CleanUp:
-	elektraFree (condition);
-	elektraFree (thenexpr);
-	if (elseexpr) elektraFree (elseexpr);
-	regfree (&regex1);
-	regfree (&regex2);
-	regfree (&regex3);
-	ksDel (ks);
 	return ret;
 }
 
-static CondResult evaluateKey (const Key * meta, const Key * suffixList, Key * parentKey, Key * key, KeySet * ks, Operation op)
+static void evaluateDependency (CondContext * ctx, Key * dependency);
+
+/**
+ * Evaluates the assignments of keys that are read by @p program before it is evaluated for @p key.
+ */
+static void resolveProgram (CondContext * ctx, const CondProgram * program, const Key * key)
+{
+	if (!program) return;
+	for (size_t i = 0; i < program->size; ++i)
+	{
+		const CondNode * node = &program->nodes[i];
+		if (!node->leftSide || node->cmpOp == AND || node->cmpOp == OR) continue;
+
+		const char * sides[] = { node->leftSide, node->rightSide };
+		for (size_t j = 0; j < 2; ++j)
+		{
+			if (!sides[j] || sides[j][0] == '\'' || sides[j][0] == '\0') continue;
+			char * name = referenceName (sides[j], key, ctx->parentKey);
+			Key * dependency = name ? ksLookupByName (ctx->pending, name, KDB_O_POP) : NULL;
+			elektraFree (name);
+			if (dependency)
+			{
+				evaluateDependency (ctx, dependency);
+				keyDel (dependency);
+			}
+		}
+	}
+}
+
+static void resolveAssign (CondContext * ctx, const CondAssign * assign, const Key * key)
 {
-	CondResult result;
-	result = parseConditionString (meta, suffixList, parentKey, key, ksDup (ks), op);
+	if (assign->kind != ASSIGN_KEY) return;
+	Key * lookupKey = assignLookupKey (assign->value, key, ctx->parentKey);
+	Key * dependency = lookupKey ? ksLookup (ctx->pending, lookupKey, KDB_O_POP) : NULL;
+	keyDel (lookupKey);
+	if (dependency)
+	{
+		evaluateDependency (ctx, dependency);
+		keyDel (dependency);
+	}
+}
+
+static CondResult evaluateKey (CondContext * ctx, const Key * meta, const Key * suffixList, Key * key, Operation op)
+{
+	CondExpression * expr = lookupExpression (ctx->data, keyString (meta));
+
+	// keys read by the expression get their assigned values first
+	if (!expr->invalid)
+	{
+		resolveProgram (ctx, expr->ifProgram, key);
+		if (op == ASSIGN)
+		{
+			resolveAssign (ctx, &expr->thenAssign, key);
+			resolveAssign (ctx, &expr->elseAssign, key);
+		}
+		else
+		{
+			resolveProgram (ctx, expr->thenProgram, key);
+			resolveProgram (ctx, expr->elseProgram, key);
+		}
+	}
+
+	CondResult result = evalExpression (expr, keyString (meta), suffixList, ctx->parentKey, key, ctx->returned, op);
 	if (result == ERROR)
 	{
 		return ERROR;
@@ -839,7 +1023,7 @@ static CondResult evaluateKey (const Key * meta, const Key * suffixList, Key * p
 	return TRUE;
 }
 
-static CondResult evalMultipleConditions (Key * key, const Key * meta, const Key * suffixList, Key * parentKey, KeySet * returned)
+static CondResult evalMultipleConditions (CondContext * ctx, Key * key, const Key * meta, const Key * suffixList)
 {
 	int countSucceeded = 0;
 	int countFailed = 0;
@@ -851,7 +1035,7 @@ static CondResult evalMultipleConditions (Key * key, const Key * meta, const Key
 	{
 		Key * c = ksAtCursor (condKS, it);
 		if (!keyCmp (c, meta)) continue;
-		result = evaluateKey (c, suffixList, parentKey, key, returned, CONDITION);
+		result = evaluateKey (ctx, c, suffixList, key, CONDITION);
 		if (result == TRUE)
 			++countSucceeded;
 		else if (result == ERROR)
@@ -886,192 +1070,211 @@ static CondResult evalMultipleConditions (Key * key, const Key * meta, const Key
 	}
 }
 
-int elektraConditionalsGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned ELEKTRA_UNUSED, Key * parentKey ELEKTRA_UNUSED)
+/**
+ * Evaluates the assign/condition of @p cur.
+ */
+static void assignKey (CondContext * ctx, Key * cur)
 {
-	if (!strcmp (keyName (parentKey), "system:/elektra/modules/conditionals"))
-	{
-		KeySet * contract = ksNew (
-			30,
-			keyNew ("system:/elektra/modules/conditionals", KEY_VALUE, "conditionals plugin waits for your orders", KEY_END),
-			keyNew ("system:/elektra/modules/conditionals/exports", KEY_END),
-			keyNew ("system:/elektra/modules/conditionals/exports/get", KEY_FUNC, elektraConditionalsGet, KEY_END),
-			keyNew ("system:/elektra/modules/conditionals/exports/set", KEY_FUNC, elektraConditionalsSet, KEY_END),
-#include ELEKTRA_README
-			keyNew ("system:/elektra/modules/conditionals/infos/version", KEY_VALUE, PLUGINVERSION, KEY_END), KS_END);
-		ksAppend (returned, contract);
-		ksDel (contract);
-
-		return 1; /* success */
-	}
+	const Key * assignMeta = keyGetMeta (cur, "assign/condition");
+	const Key * suffixList = keyGetMeta (cur, "condition/validsuffix");
 
-	CondResult ret = FALSE;
-	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	if (keyString (assignMeta)[0] == '#')
 	{
-		Key * cur = ksAtCursor (returned, it);
-		Key * conditionMeta = (Key *) keyGetMeta (cur, "check/condition");
-		Key * assignMeta = (Key *) keyGetMeta (cur, "assign/condition");
-		Key * suffixList = (Key *) keyGetMeta (cur, "condition/validsuffix");
-		Key * anyConditionMeta = (Key *) keyGetMeta (cur, "check/condition/any");
-		Key * allConditionMeta = (Key *) keyGetMeta (cur, "check/condition/all");
-		Key * noneConditionMeta = (Key *) keyGetMeta (cur, "check/condition/none");
-
-		if (conditionMeta)
+		KeySet * assignKS = elektraMetaArrayToKS (cur, "assign/condition");
+		for (elektraCursor itAssign = 0; itAssign < ksGetSize (assignKS); ++itAssign)
 		{
-			CondResult result;
-
-			result = evaluateKey (conditionMeta, suffixList, parentKey, cur, returned, CONDITION);
-			if (result == NOEXPR)
+			Key * a = ksAtCursor (assignKS, itAssign);
+			if (keyCmp (a, assignMeta) == 0) continue;
+			CondResult result = evaluateKey (ctx, a, suffixList, cur, ASSIGN);
+			if (result == TRUE)
+			{
+				ctx->result |= TRUE;
+				break;
+			}
+			else if (result == NOEXPR)
 			{
-				ret |= TRUE;
+				ctx->result |= TRUE;
 			}
 			else
 			{
-				ret |= result;
+				ctx->result |= ERROR;
 			}
 		}
-		else if (allConditionMeta)
-		{
-			CondResult result;
-			result = evalMultipleConditions (cur, allConditionMeta, suffixList, parentKey, returned);
-			ret |= result;
-		}
-		else if (anyConditionMeta)
-		{
-			CondResult result;
-			result = evalMultipleConditions (cur, anyConditionMeta, suffixList, parentKey, returned);
-			ret |= result;
-		}
-		else if (noneConditionMeta)
+		ksDel (assignKS);
+	}
+	else
+	{
+		ctx->result |= evaluateKey (ctx, assignMeta, suffixList, cur, ASSIGN);
+	}
+}
+
+/**
+ * Evaluates the check/condition of @p cur.
+ */
+static void checkKey (CondContext * ctx, Key * cur)
+{
+	Key * conditionMeta = (Key *) keyGetMeta (cur, "check/condition");
+	Key * suffixList = (Key *) keyGetMeta (cur, "condition/validsuffix");
+	Key * anyConditionMeta = (Key *) keyGetMeta (cur, "check/condition/any");
+	Key * allConditionMeta = (Key *) keyGetMeta (cur, "check/condition/all");
+	Key * noneConditionMeta = (Key *) keyGetMeta (cur, "check/condition/none");
+
+	if (conditionMeta)
+	{
+		CondResult result;
+
+		result = evaluateKey (ctx, conditionMeta, suffixList, cur, CONDITION);
+		if (result == NOEXPR)
 		{
-			CondResult result;
-			result = evalMultipleConditions (cur, noneConditionMeta, suffixList, parentKey, returned);
-			ret |= result;
+			ctx->result |= TRUE;
 		}
-
-		if (assignMeta)
+		else
 		{
-			if (keyString (assignMeta)[0] == '#')
-			{
-				KeySet * assignKS = elektraMetaArrayToKS (cur, "assign/condition");
-				for (elektraCursor itAssign = 0; itAssign < ksGetSize (assignKS); ++itAssign)
-				{
-					Key * a = ksAtCursor (assignKS, itAssign);
-					if (keyCmp (a, assignMeta) == 0) continue;
-					CondResult result = evaluateKey (a, suffixList, parentKey, cur, returned, ASSIGN);
-					if (result == TRUE)
-					{
-						ret |= TRUE;
-						break;
-					}
-					else if (result == NOEXPR)
-					{
-						ret |= TRUE;
-					}
-					else
-					{
-						ret |= ERROR;
-					}
-				}
-				ksDel (assignKS);
-			}
-			else
-			{
-				ret |= evaluateKey (assignMeta, suffixList, parentKey, cur, returned, ASSIGN);
-			}
+			ctx->result |= result;
 		}
 	}
-	if (ret == TRUE) keySetMeta (parentKey, "error", 0);
-	return ret; /* success */
+	else if (allConditionMeta)
+	{
+		ctx->result |= evalMultipleConditions (ctx, cur, allConditionMeta, suffixList);
+	}
+	else if (anyConditionMeta)
+	{
+		ctx->result |= evalMultipleConditions (ctx, cur, anyConditionMeta, suffixList);
+	}
+	else if (noneConditionMeta)
+	{
+		ctx->result |= evalMultipleConditions (ctx, cur, noneConditionMeta, suffixList);
+	}
 }
 
+/**
+ * Evaluates @p dependency, which was removed from the pending keys, because another key reads it.
+ *
+ * As in the single pass, the conditions of the key see its value before its own assignment.
+ */
+static void evaluateDependency (CondContext * ctx, Key * dependency)
+{
+	ksAppendKey (ctx->done, dependency);
+	checkKey (ctx, dependency);
+	assignKey (ctx, dependency);
+}
 
-int elektraConditionalsSet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned ELEKTRA_UNUSED, Key * parentKey ELEKTRA_UNUSED)
+/**
+ * Evaluates all conditions and assignments of @p returned in a single pass.
+ *
+ * Keys are processed in the order of @p returned, but a key with assign/condition
+ * is evaluated before any condition or assignment that reads the key.
+ */
+static int evaluateKeySet (ConditionalsData * data, KeySet * returned, Key * parentKey)
 {
-	CondResult ret = FALSE;
+	CondContext ctx = { .data = data,
+			    .returned = returned,
+			    .pending = ksNew (0, KS_END),
+			    .done = ksNew (0, KS_END),
+			    .parentKey = parentKey,
+			    .result = FALSE };
 	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
 	{
 		Key * cur = ksAtCursor (returned, it);
-		Key * conditionMeta = (Key *) keyGetMeta (cur, "check/condition");
-		Key * assignMeta = (Key *) keyGetMeta (cur, "assign/condition");
-		Key * suffixList = (Key *) keyGetMeta (cur, "condition/validsuffix");
-		Key * anyConditionMeta = (Key *) keyGetMeta (cur, "check/condition/any");
-		Key * allConditionMeta = (Key *) keyGetMeta (cur, "check/condition/all");
-		Key * noneConditionMeta = (Key *) keyGetMeta (cur, "check/condition/none");
-
-		if (conditionMeta)
-		{
-			CondResult result;
+		if (keyGetMeta (cur, "assign/condition")) ksAppendKey (ctx.pending, cur);
+	}
 
-			result = evaluateKey (conditionMeta, suffixList, parentKey, cur, returned, CONDITION);
-			if (result == NOEXPR)
-			{
-				ret |= TRUE;
-			}
-			else
-			{
-				ret |= result;
-			}
-		}
-		else if (allConditionMeta)
-		{
-			CondResult result;
-			result = evalMultipleConditions (cur, allConditionMeta, suffixList, parentKey, returned);
-			ret |= result;
-		}
-		else if (anyConditionMeta)
-		{
-			CondResult result;
-			result = evalMultipleConditions (cur, anyConditionMeta, suffixList, parentKey, returned);
-			ret |= result;
-		}
-		else if (noneConditionMeta)
+	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	{
+		Key * cur = ksAtCursor (returned, it);
+		if (ksGetSize (ctx.done) > 0 && ksLookup (ctx.done, cur, 0) != NULL) continue;
+
+		Key * assign = ksGetSize (ctx.pending) > 0 ? ksLookup (ctx.pending, cur, KDB_O_POP) : NULL;
+
+		// conditions of the key itself see its value before the assignment
+		checkKey (&ctx, cur);
+
+		if (assign)
 		{
-			CondResult result;
-			result = evalMultipleConditions (cur, noneConditionMeta, suffixList, parentKey, returned);
-			ret |= result;
+			assignKey (&ctx, cur);
+			keyDel (assign);
 		}
+	}
+	ksDel (ctx.pending);
+	ksDel (ctx.done);
+	if (ctx.result == TRUE) keySetMeta (parentKey, "error", 0);
+	return ctx.result;
+}
 
-		if (assignMeta)
-		{
-			if (keyString (assignMeta)[0] == '#')
-			{
-				KeySet * assignKS = elektraMetaArrayToKS (cur, "assign/condition");
+int elektraConditionalsOpen (Plugin * handle, Key * errorKey)
+{
+	ConditionalsData * data = elektraCalloc (sizeof (ConditionalsData));
+	if (regcomp (&data->ifRegex, "(\\(((.*)?)\\))[[:space:]]*\\?", REGEX_FLAGS_CONDITION) ||
+	    regcomp (&data->thenRegex, "\\?[[:space:]]*(\\(((.*)?)\\))", REGEX_FLAGS_CONDITION) ||
+	    regcomp (&data->elseRegex, "[[:space:]]*:[[:space:]]*(\\(((.*)?)\\))", REGEX_FLAGS_CONDITION) ||
+	    regcomp (&data->nestedRegex, "((\\(([^\\(\\)]*)\\)))", REG_EXTENDED | REG_NEWLINE))
+	{
+		// the regexes compile so the only possible error would be out of memory
+		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (errorKey);
+		elektraFree (data);
+		return -1;
+	}
+	data->cache = ksNew (0, KS_END);
+	data->lookup = keyNew ("/", KEY_END);
+	elektraPluginSetData (handle, data);
+	return 1;
+}
 
-				for (elektraCursor itAssign = 0; itAssign < ksGetSize (assignKS); ++itAssign)
-				{
-					Key * a = ksAtCursor (assignKS, itAssign);
-					if (keyCmp (a, assignMeta) == 0) continue;
-					CondResult result = evaluateKey (a, suffixList, parentKey, cur, returned, ASSIGN);
-					if (result == TRUE)
-					{
-						ret |= TRUE;
-						break;
-					}
-					else if (result == NOEXPR)
-					{
-						ret |= TRUE;
-					}
-					else
-					{
-						ret |= ERROR;
-					}
-				}
-				ksDel (assignKS);
-			}
-			else
-			{
-				ret |= evaluateKey (assignMeta, suffixList, parentKey, cur, returned, ASSIGN);
-			}
-		}
+int elektraConditionalsClose (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	ConditionalsData * data = elektraPluginGetData (handle);
+	if (data == NULL) return 1;
+
+	for (elektraCursor it = 0; it < ksGetSize (data->cache); ++it)
+	{
+		freeExpression (*(CondExpression **) keyValue (ksAtCursor (data->cache, it)));
 	}
-	if (ret == TRUE) keySetMeta (parentKey, "error", 0);
-	return ret;
+	ksDel (data->cache);
+	keyDel (data->lookup);
+	regfree (&data->ifRegex);
+	regfree (&data->thenRegex);
+	regfree (&data->elseRegex);
+	regfree (&data->nestedRegex);
+	elektraFree (data);
+	elektraPluginSetData (handle, NULL);
+	return 1;
+}
+
+int elektraConditionalsGet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	if (!strcmp (keyName (parentKey), "system:/elektra/modules/conditionals"))
+	{
+		KeySet * contract = ksNew (
+			30,
+			keyNew ("system:/elektra/modules/conditionals", KEY_VALUE, "conditionals plugin waits for your orders", KEY_END),
+			keyNew ("system:/elektra/modules/conditionals/exports", KEY_END),
+			keyNew ("system:/elektra/modules/conditionals/exports/open", KEY_FUNC, elektraConditionalsOpen, KEY_END),
+			keyNew ("system:/elektra/modules/conditionals/exports/close", KEY_FUNC, elektraConditionalsClose, KEY_END),
+			keyNew ("system:/elektra/modules/conditionals/exports/get", KEY_FUNC, elektraConditionalsGet, KEY_END),
+			keyNew ("system:/elektra/modules/conditionals/exports/set", KEY_FUNC, elektraConditionalsSet, KEY_END),
+#include ELEKTRA_README
+			keyNew ("system:/elektra/modules/conditionals/infos/version", KEY_VALUE, PLUGINVERSION, KEY_END), KS_END);
+		ksAppend (returned, contract);
+		ksDel (contract);
+
+		return 1; /* success */
+	}
+
+	return evaluateKeySet (elektraPluginGetData (handle), returned, parentKey);
+}
+
+
+int elektraConditionalsSet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	return evaluateKeySet (elektraPluginGetData (handle), returned, parentKey);
 }
 
 Plugin * ELEKTRA_PLUGIN_EXPORT
 {
 	// clang-format off
     return elektraPluginExport ("conditionals",
+	    ELEKTRA_PLUGIN_OPEN, &elektraConditionalsOpen,
+	    ELEKTRA_PLUGIN_CLOSE, &elektraConditionalsClose,
 	    ELEKTRA_PLUGIN_GET, &elektraConditionalsGet,
 	    ELEKTRA_PLUGIN_SET, &elektraConditionalsSet,
 	    ELEKTRA_PLUGIN_END);
@@ -619,6 +619,55 @@ static void test_multiAssign3 (void)
 	PLUGIN_CLOSE ();
 }
 
+static void test_assignBeforeCheck (void)
+{
+	Key * parentKey = keyNew ("user:/tests/conditionals", KEY_VALUE, "", KEY_END);
+	// check and check2 share one condition, which reads the key assigned by totest
+	KeySet * ks = ksNew (5,
+			     keyNew ("user:/tests/conditionals/check", KEY_VALUE, "on", KEY_META, "check/condition",
+				     "(./ == 'on') ? (../totest == 'World')", KEY_END),
+			     keyNew ("user:/tests/conditionals/check2", KEY_VALUE, "on", KEY_META, "check/condition",
+				     "(./ == 'on') ? (../totest == 'World')", KEY_END),
+			     keyNew ("user:/tests/conditionals/totest", KEY_VALUE, "Hello", KEY_META, "assign/condition",
+				     "(./ == 'Hello') ? ('World') : ('Moon')", KEY_END),
+			     KS_END);
+
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("conditionals");
+	succeed_if (plugin->kdbGet (plugin, ks, parentKey) == 1, "keys reading an assigned key should be checked after the assignment");
+	Key * key = ksLookupByName (ks, "user:/tests/conditionals/totest", 0);
+	succeed_if (strcmp (keyString (key), "World") == 0, "error setting then value");
+
+	succeed_if (plugin->kdbGet (plugin, ks, parentKey) == -1, "cached condition should use the new value");
+	succeed_if (strcmp (keyString (key), "Moon") == 0, "error setting else value");
+	ksDel (ks);
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+}
+
+static void test_assignedDependencyChecksOwnValue (void)
+{
+	Key * parentKey = keyNew ("user:/tests/conditionals", KEY_VALUE, "", KEY_END);
+	// check reads totest, so totest is evaluated early, but its own condition must still see 'Hello'
+	KeySet * ks = ksNew (5,
+			     keyNew ("user:/tests/conditionals/check", KEY_VALUE, "on", KEY_META, "check/condition",
+				     "(./ == 'on') ? (../totest == 'World')", KEY_END),
+			     keyNew ("user:/tests/conditionals/other", KEY_VALUE, "no", KEY_END),
+			     keyNew ("user:/tests/conditionals/totest", KEY_VALUE, "Hello", KEY_META, "assign/condition",
+				     "(./ == 'Hello') ? ('World') : ('Moon')", KEY_META, "check/condition",
+				     "(./ == 'World') ? (../other == 'yes')", KEY_END),
+			     KS_END);
+
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("conditionals");
+	succeed_if (plugin->kdbGet (plugin, ks, parentKey) == 1, "condition of a key evaluated early saw its assigned value");
+	Key * key = ksLookupByName (ks, "user:/tests/conditionals/totest", 0);
+	succeed_if (strcmp (keyString (key), "World") == 0, "error setting then value");
+	ksDel (ks);
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("CONDITIONALS     TESTS\n");
@@ -660,6 +709,8 @@ int main (int argc, char ** argv)
 	test_multiCond2NoFail ();
 	test_multiAssign2 ();
 	test_multiAssign3 ();
+	test_assignBeforeCheck ();
+	test_assignedDependencyChecksOwnValue ();
 	print_result ("testmod_conditionals");
 
 	return nbError;
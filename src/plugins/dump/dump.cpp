@@ -18,6 +18,7 @@
 
 #include <kdberrors.h>
 #include <kdblogger.h>
+#include <kdbprivate.h>
 
 using namespace ckdb;
 
@@ -229,13 +230,14 @@ static int decodeLine (std::istream & is, ckdb::Key * parentKey, ckdb::KeySet *
 			name = name.substr (0, slashIndex) + ":" + name.substr (slashIndex);
 		}
 
+		ckdb::ksBuilderFinish (ks);
 		ckdb::Key * search = ckdb::ksLookupByName (ks, name.c_str (), 0);
 		ckdb::keyCopyMeta (cur, search, &valuebuffer[0]);
 		std::getline (is, line);
 	}
 	else if (command == "keyEnd")
 	{
-		ckdb::ksAppendKey (ks, cur);
+		ckdb::ksBuilderAdd (ks, cur);
 		cur = nullptr;
 	}
 	else if (command == "ksEnd")
@@ -370,7 +372,7 @@ int unserializeVersion2 (std::istream & is, ckdb::Key * parentKey, ckdb::KeySet
 				return ELEKTRA_PLUGIN_STATUS_ERROR;
 			}
 
-			ksAppendKey (ks, cur);
+			ksBuilderAdd (ks, cur);
 		}
 		else if (command == "$meta")
 		{
@@ -438,6 +440,7 @@ int unserializeVersion2 (std::istream & is, ckdb::Key * parentKey, ckdb::KeySet
 				return ELEKTRA_PLUGIN_STATUS_ERROR;
 			}
 
+			ckdb::ksBuilderFinish (ks);
 			ckdb::Key * source = ckdb::ksLookupByName (ks, (rootName + keyName).c_str (), 0);
 			keyCopyMeta (cur, source, metaName.c_str ());
 		}
@@ -465,12 +468,11 @@ int unserialize (std::istream & is, ckdb::Key * parentKey, ckdb::KeySet * ks, bo
 
 	if (std::getline (is, line))
 	{
-		if (line == "kdbOpen 2")
-		{
-			return unserializeVersion2 (is, parentKey, ks, useFullNames);
-		}
-
-		return unserializeVersion1 (is, parentKey, ks, line);
+		// keys are bulk loaded with ksBuilderAdd (), sort them in once at the end
+		int ret = line == "kdbOpen 2" ? unserializeVersion2 (is, parentKey, ks, useFullNames) :
+						unserializeVersion1 (is, parentKey, ks, line);
+		ckdb::ksBuilderFinish (ks);
+		return ret;
 	}
 
 	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
@@ -14,6 +14,7 @@
 #endif
 
 #include <fnmatch.h>
+#include <kdberrors.h>
 #include <kdbhelper.h>
 
 struct GlobFlagMap
@@ -24,7 +25,7 @@ struct GlobFlagMap
 
 struct GlobFlagMap flagMaps[] = { { "noescape", FNM_NOESCAPE }, { "pathname", FNM_PATHNAME }, { "period", FNM_PERIOD } };
 
-int elektraGlobMatch (Key * key, const Key * match, const char * globFlags)
+static int parseGlobFlags (const char * globFlags)
 {
 	char * tokenList = elektraStrDup (globFlags);
 	char delimiter[] = ",";
@@ -44,8 +45,12 @@ int elektraGlobMatch (Key * key, const Key * match, const char * globFlags)
 	}
 
 	free (tokenList);
+	return flags;
+}
 
-	if (!fnmatch (keyString (match), keyName (key), flags))
+int elektraGlobMatch (Key * key, const Key * match, const char * globFlags)
+{
+	if (!fnmatch (keyString (match), keyName (key), parseGlobFlags (globFlags)))
 	{
 		keyCopyAllMeta (key, match);
 		return 1;
@@ -137,34 +142,357 @@ static KeySet * getGlobKeys (Key * parentKey, KeySet * keys, enum GlobDirection
 	return glob;
 }
 
-static void applyGlob (KeySet * returned, KeySet * glob)
+/**
+ * A node of the glob matcher.
+ *
+ * Each node stands for one part of a glob expression (the text between two
+ * slashes). Parts without special characters are stored sorted in
+ * `literals` and found with a binary search, all other parts are matched
+ * with fnmatch against the corresponding part of the key name.
+ */
+typedef struct _GlobNode GlobNode;
+
+struct _GlobNode
 {
-	Key * cur;
+	char * part;
+	int flags;
+	ssize_t glob; ///< index of the first glob expression ending in this node or -1
+
+	GlobNode ** literals;
+	size_t literalsSize;
+	GlobNode ** wildcards;
+	size_t wildcardsSize;
+};
 
-	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+/**
+ * All glob expressions of one direction compiled into a single matcher.
+ *
+ * Glob expressions using FNM_PATHNAME are split at slashes and merged into
+ * a tree of GlobNodes, so that a key name is matched against all of them
+ * in one descent. The others can match across slashes and are tried one by
+ * one with fnmatch.
+ */
+typedef struct
+{
+	Key ** globs;
+	int * flags;
+	size_t size;
+
+	GlobNode * root;
+	size_t nodes;
+
+	size_t * linear; ///< indices of the glob expressions not in the tree
+	size_t * prefix; ///< length of the literal prefix of each glob expression in linear
+	size_t linearSize;
+
+	GlobNode ** current;
+	GlobNode ** next;
+	char * name;
+	size_t nameSize;
+} GlobMatcher;
+
+static int isLiteralPart (const char * part)
+{
+	return strpbrk (part, "*?[\\") == NULL;
+}
+
+/**
+ * @retval 1 if every slash in @p pattern separates two parts for FNM_PATHNAME
+ * @retval 0 if the pattern contains escaped slashes or slashes in brackets
+ */
+static int isSplittable (const char * pattern, int flags)
+{
+	if (!(flags & FNM_NOESCAPE) && strchr (pattern, '\\') != NULL) return 0;
+
+	const char * bracket = pattern;
+	while ((bracket = strchr (bracket, '[')) != NULL)
 	{
-		cur = ksAtCursor (returned, it);
-		Key * match;
+		const char * close = bracket + 1;
+		if (*close == '!' || *close == '^') ++close;
+		if (*close == ']') ++close;
+		close = strchr (close, ']');
+		const char * slash = strchr (bracket, '/');
+		if (slash != NULL && (close == NULL || slash < close)) return 0;
+		++bracket;
+	}
+	return 1;
+}
 
-		for (elektraCursor itGlob = 0; itGlob < ksGetSize (glob); ++itGlob)
+/**
+ * @return a new node for @p part or NULL on memory errors
+ */
+static GlobNode * newGlobNode (const char * part, size_t length, int flags)
+{
+	GlobNode * node = elektraCalloc (sizeof (GlobNode));
+	if (!node) return NULL;
+	node->part = elektraMalloc (length + 1);
+	if (!node->part)
+	{
+		elektraFree (node);
+		return NULL;
+	}
+	memcpy (node->part, part, length);
+	node->part[length] = '\0';
+	node->flags = flags;
+	node->glob = -1;
+	return node;
+}
+
+static void delGlobNode (GlobNode * node)
+{
+	if (!node) return;
+	for (size_t i = 0; i < node->literalsSize; ++i)
+	{
+		delGlobNode (node->literals[i]);
+	}
+	for (size_t i = 0; i < node->wildcardsSize; ++i)
+	{
+		delGlobNode (node->wildcards[i]);
+	}
+	elektraFree (node->literals);
+	elektraFree (node->wildcards);
+	elektraFree (node->part);
+	elektraFree (node);
+}
+
+/**
+ * @return the child of @p node for @p part, which is added if needed, or NULL on memory errors
+ */
+static GlobNode * addChild (GlobMatcher * matcher, GlobNode * node, const char * part, size_t length, int flags)
+{
+	char * copy = elektraMalloc (length + 1);
+	if (!copy) return NULL;
+	memcpy (copy, part, length);
+	copy[length] = '\0';
+
+	int literal = isLiteralPart (copy);
+	GlobNode *** children = literal ? &node->literals : &node->wildcards;
+	size_t * size = literal ? &node->literalsSize : &node->wildcardsSize;
+
+	GlobNode * child = NULL;
+	for (size_t i = 0; i < *size && child == NULL; ++i)
+	{
+		GlobNode * cur = (*children)[i];
+		if (strcmp (cur->part, copy) == 0 && (literal || cur->flags == flags)) child = cur;
+	}
+	elektraFree (copy);
+
+	if (child == NULL)
+	{
+		child = newGlobNode (part, length, flags);
+		if (!child) return NULL;
+		if (elektraRealloc ((void **) children, (*size + 1) * sizeof (GlobNode *)) == -1)
 		{
-			match = ksAtCursor (glob, itGlob);
-			const Key * flagKey = keyGetMeta (match, "glob/flags");
-			int matchApplied;
+			delGlobNode (child);
+			return NULL;
+		}
+		(*children)[(*size)++] = child;
+		++matcher->nodes;
+	}
+	return child;
+}
 
-			if (flagKey)
-			{
-				matchApplied = elektraGlobMatch (cur, match, keyString (flagKey));
-			}
-			else
+static int compareGlobNodes (const void * a, const void * b)
+{
+	return strcmp ((*(const GlobNode **) a)->part, (*(const GlobNode **) b)->part);
+}
+
+static void sortGlobNode (GlobNode * node)
+{
+	if (node->literalsSize > 1) qsort (node->literals, node->literalsSize, sizeof (GlobNode *), compareGlobNodes);
+	for (size_t i = 0; i < node->literalsSize; ++i)
+	{
+		sortGlobNode (node->literals[i]);
+	}
+	for (size_t i = 0; i < node->wildcardsSize; ++i)
+	{
+		sortGlobNode (node->wildcards[i]);
+	}
+}
+
+/**
+ * @retval 0 on success
+ * @retval -1 on memory errors
+ */
+static int addGlob (GlobMatcher * matcher, size_t index)
+{
+	const char * pattern = keyString (matcher->globs[index]);
+	int flags = matcher->flags[index];
+
+	if (!(flags & FNM_PATHNAME) || !isSplittable (pattern, flags))
+	{
+		matcher->prefix[matcher->linearSize] = strcspn (pattern, "*?[\\");
+		matcher->linear[matcher->linearSize++] = index;
+		return 0;
+	}
+
+	GlobNode * node = matcher->root;
+	const char * part = pattern;
+	for (;;)
+	{
+		const char * end = strchr (part, '/');
+		size_t length = end ? (size_t) (end - part) : strlen (part);
+		node = addChild (matcher, node, part, length, flags);
+		if (!node) return -1;
+		if (!end) break;
+		part = end + 1;
+	}
+	if (node->glob == -1) node->glob = index;
+	return 0;
+}
+
+static void delGlobMatcher (GlobMatcher * matcher)
+{
+	delGlobNode (matcher->root);
+	elektraFree (matcher->globs);
+	elektraFree (matcher->flags);
+	elektraFree (matcher->linear);
+	elektraFree (matcher->prefix);
+	elektraFree (matcher->current);
+	elektraFree (matcher->next);
+	elektraFree (matcher->name);
+	elektraFree (matcher);
+}
+
+/**
+ * @pre @p glob is not empty
+ *
+ * @return the matcher for all glob expressions in @p glob or NULL on memory errors
+ */
+static GlobMatcher * compileGlobs (KeySet * glob)
+{
+	GlobMatcher * matcher = elektraCalloc (sizeof (GlobMatcher));
+	if (!matcher) return NULL;
+	matcher->size = ksGetSize (glob);
+	matcher->globs = elektraMalloc (matcher->size * sizeof (Key *));
+	matcher->flags = elektraMalloc (matcher->size * sizeof (int));
+	matcher->linear = elektraMalloc (matcher->size * sizeof (size_t));
+	matcher->prefix = elektraMalloc (matcher->size * sizeof (size_t));
+	matcher->root = newGlobNode ("", 0, 0);
+	matcher->nodes = 1;
+	if (!matcher->globs || !matcher->flags || !matcher->linear || !matcher->prefix || !matcher->root)
+	{
+		delGlobMatcher (matcher);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < matcher->size; ++i)
+	{
+		Key * match = ksAtCursor (glob, i);
+		const Key * flagKey = keyGetMeta (match, "glob/flags");
+		matcher->globs[i] = match;
+		/* if no flags were provided, default to FNM_PATHNAME behaviour */
+		matcher->flags[i] = flagKey ? parseGlobFlags (keyString (flagKey)) : FNM_PATHNAME;
+		if (addGlob (matcher, i) == -1)
+		{
+			delGlobMatcher (matcher);
+			return NULL;
+		}
+	}
+
+	sortGlobNode (matcher->root);
+	matcher->current = elektraMalloc (matcher->nodes * sizeof (GlobNode *));
+	matcher->next = elektraMalloc (matcher->nodes * sizeof (GlobNode *));
+	if (!matcher->current || !matcher->next)
+	{
+		delGlobMatcher (matcher);
+		return NULL;
+	}
+	return matcher;
+}
+
+/**
+ * @return the index of the first glob expression matching @p name or -1
+ * @retval -2 on memory errors
+ */
+static ssize_t matchGlobs (GlobMatcher * matcher, const char * name)
+{
+	size_t nameSize = strlen (name) + 1;
+	if (nameSize > matcher->nameSize)
+	{
+		if (elektraRealloc ((void **) &matcher->name, nameSize) == -1) return -2;
+		matcher->nameSize = nameSize;
+	}
+	memcpy (matcher->name, name, nameSize);
+
+	size_t currentSize = 1;
+	matcher->current[0] = matcher->root;
+
+	char * part = matcher->name;
+	while (currentSize > 0)
+	{
+		char * end = strchr (part, '/');
+		if (end) *end = '\0';
+
+		size_t nextSize = 0;
+		GlobNode search = { .part = part };
+		GlobNode * searchPtr = &search;
+		for (size_t i = 0; i < currentSize; ++i)
+		{
+			GlobNode * node = matcher->current[i];
+			GlobNode ** literal = bsearch (&searchPtr, node->literals, node->literalsSize, sizeof (GlobNode *), compareGlobNodes);
+			if (literal) matcher->next[nextSize++] = *literal;
+			for (size_t j = 0; j < node->wildcardsSize; ++j)
 			{
-				/* if no flags were provided, default to FNM_PATHNAME behaviour */
-				matchApplied = elektraGlobMatch (cur, match, "pathname");
+				GlobNode * wildcard = node->wildcards[j];
+				if (!fnmatch (wildcard->part, part, wildcard->flags)) matcher->next[nextSize++] = wildcard;
 			}
+		}
 
-			if (matchApplied) break;
+		GlobNode ** swap = matcher->current;
+		matcher->current = matcher->next;
+		matcher->next = swap;
+		currentSize = nextSize;
+
+		if (!end) break;
+		part = end + 1;
+	}
+
+	ssize_t first = -1;
+	for (size_t i = 0; i < currentSize; ++i)
+	{
+		ssize_t glob = matcher->current[i]->glob;
+		if (glob != -1 && (first == -1 || glob < first)) first = glob;
+	}
+
+	for (size_t i = 0; i < matcher->linearSize; ++i)
+	{
+		size_t index = matcher->linear[i];
+		if (first != -1 && (ssize_t) index > first) break;
+		const char * pattern = keyString (matcher->globs[index]);
+		if (strncmp (pattern, name, matcher->prefix[i]) != 0) continue;
+		if (!fnmatch (pattern, name, matcher->flags[index])) return index;
+	}
+
+	return first;
+}
+
+/**
+ * @retval 0 on success
+ * @retval -1 on memory errors
+ */
+static int applyGlob (KeySet * returned, KeySet * glob)
+{
+	if (ksGetSize (glob) == 0) return 0;
+
+	GlobMatcher * matcher = compileGlobs (glob);
+	if (!matcher) return -1;
+
+	int ret = 0;
+	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	{
+		Key * cur = ksAtCursor (returned, it);
+		ssize_t match = matchGlobs (matcher, keyName (cur));
+		if (match == -2)
+		{
+			ret = -1;
+			break;
 		}
+		if (match != -1) keyCopyAllMeta (cur, matcher->globs[match]);
 	}
+
+	delGlobMatcher (matcher);
+	return ret;
 }
 
 int elektraGlobOpen (Plugin * handle ELEKTRA_UNUSED, Key * parentKey ELEKTRA_UNUSED)
@@ -187,7 +515,7 @@ int elektraGlobClose (Plugin * handle ELEKTRA_UNUSED, Key * errorKey ELEKTRA_UNU
 }
 
 
-int elektraGlobGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey ELEKTRA_UNUSED)
+int elektraGlobGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey)
 {
 	if (!strcmp (keyName (parentKey), "system:/elektra/modules/glob"))
 	{
@@ -202,10 +530,16 @@ int elektraGlobGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * par
 	KeySet * keys = elektraPluginGetConfig (handle);
 	KeySet * glob = getGlobKeys (parentKey, keys, GET);
 
-	applyGlob (returned, glob);
+	int ret = applyGlob (returned, glob);
 
 	ksDel (glob);
 
+	if (ret == -1)
+	{
+		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey);
+		return -1;
+	}
+
 	return 1; /* success */
 }
 
@@ -215,10 +549,16 @@ int elektraGlobSet (Plugin * handle, KeySet * returned, Key * parentKey)
 	KeySet * keys = elektraPluginGetConfig (handle);
 	KeySet * glob = getGlobKeys (parentKey, keys, SET);
 
-	applyGlob (returned, glob);
+	int ret = applyGlob (returned, glob);
 
 	ksDel (glob);
 
+	if (ret == -1)
+	{
+		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey);
+		return -1;
+	}
+
 	return 1; /* success */
 }
 
@@ -291,6 +291,67 @@ void test_onlyFirstMatchIsApplied (void)
 	PLUGIN_CLOSE ();
 }
 
+static void checkMatch (KeySet * ks, const char * name, const char * expected)
+{
+	Key * key = ksLookupByName (ks, name, 0);
+	exit_if_fail (key, "key not found");
+	const Key * meta = keyGetMeta (key, "match");
+	if (expected)
+	{
+		succeed_if_fmt (meta && strcmp (keyString (meta), expected) == 0, "key %s should be matched by glob %s", name, expected);
+	}
+	else
+	{
+		succeed_if_fmt (!meta, "key %s should not be matched", name);
+	}
+}
+
+void test_compiledMatcher (void)
+{
+	Key * parentKey = keyNew ("user:/tests/glob", KEY_END);
+	// clang-format off
+	KeySet * conf = ksNew (20,
+				keyNew ("user:/glob/#1", KEY_VALUE, "user:/tests/glob/a/b", KEY_META, "match", "1", KEY_END),
+				keyNew ("user:/glob/#2", KEY_VALUE, "user:/tests/glob/*/c", KEY_META, "match", "2", KEY_END),
+				keyNew ("user:/glob/#3", KEY_VALUE, "user:/tests/glob/[xy]/d", KEY_META, "match", "3", KEY_END),
+				keyNew ("user:/glob/#4", KEY_VALUE, "user:/tests/glob/*", KEY_META, "match", "4", KEY_END),
+				keyNew ("user:/glob/#4/flags", KEY_VALUE, "", KEY_END),
+				keyNew ("user:/glob/#5", KEY_VALUE, "user:/tests/glob/a/*", KEY_META, "match", "5", KEY_END),
+				keyNew ("user:/glob/#6", KEY_VALUE, "user:/tests/period/*", KEY_META, "match", "6", KEY_END),
+				keyNew ("user:/glob/#6/flags", KEY_VALUE, "pathname,period", KEY_END),
+				keyNew ("user:/glob/#7", KEY_VALUE, "user:/tests/escape/\\*", KEY_META, "match", "7", KEY_END),
+				keyNew ("user:/glob/#8", KEY_VALUE, "user:/tests/[/]", KEY_META, "match", "8", KEY_END),
+				KS_END);
+	// clang-format on
+	PLUGIN_OPEN ("glob");
+
+	KeySet * ks = ksNew (20, keyNew ("user:/tests/glob/a/b", KEY_END), keyNew ("user:/tests/glob/q/c", KEY_END),
+			     keyNew ("user:/tests/glob/x/d", KEY_END), keyNew ("user:/tests/glob/y/d", KEY_END),
+			     keyNew ("user:/tests/glob/z/d", KEY_END), keyNew ("user:/tests/glob/a/e", KEY_END),
+			     keyNew ("user:/tests/glob/a/b/c", KEY_END), keyNew ("user:/tests/period/x", KEY_END),
+			     keyNew ("user:/tests/period/.x", KEY_END), keyNew ("user:/tests/escape/*", KEY_END),
+			     keyNew ("user:/tests/escape/x", KEY_END), keyNew ("user:/tests/other", KEY_END), KS_END);
+
+	succeed_if (plugin->kdbGet (plugin, ks, parentKey) >= 1, "call to kdbGet was not successful");
+
+	checkMatch (ks, "user:/tests/glob/a/b", "1");
+	checkMatch (ks, "user:/tests/glob/q/c", "2");
+	checkMatch (ks, "user:/tests/glob/x/d", "3");
+	checkMatch (ks, "user:/tests/glob/y/d", "3");
+	checkMatch (ks, "user:/tests/glob/z/d", "4");
+	checkMatch (ks, "user:/tests/glob/a/e", "4");
+	checkMatch (ks, "user:/tests/glob/a/b/c", "4");
+	checkMatch (ks, "user:/tests/period/x", "6");
+	checkMatch (ks, "user:/tests/period/.x", NULL);
+	checkMatch (ks, "user:/tests/escape/*", "7");
+	checkMatch (ks, "user:/tests/escape/x", NULL);
+	checkMatch (ks, "user:/tests/other", NULL);
+
+	ksDel (ks);
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("GLOB      TESTS\n");
@@ -306,6 +367,7 @@ int main (int argc, char ** argv)
 	test_getDirectionMatch ();
 	test_namedMatchFlags ();
 	test_onlyFirstMatchIsApplied ();
+	test_compiledMatcher ();
 
 	print_result ("testmod_glob");
 
@@ -51,6 +51,61 @@ typedef struct
 	Operation op;
 } PNElem;
 
+typedef struct
+{
+	PNElem elem;	  ///< the element as it is pushed on the stack
+	char * reference; ///< the referenced key for operands whose value is looked up, otherwise NULL
+} MathToken;
+
+/**
+ * A compiled check/math expression, shared by all keys using the same
+ * expression.
+ */
+typedef struct
+{
+	MathToken * tokens;
+	size_t size;
+	Operation resultOp;
+	char invalidOp; ///< an unsupported operation, reported for every key using the expression
+} MathExpression;
+
+/**
+ * Plugin data: compiled expressions keyed by the expression, which live as
+ * long as the plugin.
+ */
+typedef struct
+{
+	KeySet * cache;
+	Key * lookup;
+} MathcheckData;
+
+static void freeExpression (MathExpression * expr);
+
+int elektraMathcheckOpen (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	MathcheckData * data = elektraMalloc (sizeof (MathcheckData));
+	data->cache = ksNew (0, KS_END);
+	data->lookup = keyNew ("/", KEY_END);
+	elektraPluginSetData (handle, data);
+	return 1;
+}
+
+int elektraMathcheckClose (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	MathcheckData * data = elektraPluginGetData (handle);
+	if (data == NULL) return 1;
+
+	for (elektraCursor it = 0; it < ksGetSize (data->cache); ++it)
+	{
+		freeExpression (*(MathExpression **) keyValue (ksAtCursor (data->cache, it)));
+	}
+	ksDel (data->cache);
+	keyDel (data->lookup);
+	elektraFree (data);
+	elektraPluginSetData (handle, NULL);
+	return 1;
+}
+
 
 int elektraMathcheckGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned ELEKTRA_UNUSED, Key * parentKey)
 {
@@ -59,6 +114,8 @@ int elektraMathcheckGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned ELEKT
 		KeySet * contract = ksNew (
 			30, keyNew ("system:/elektra/modules/mathcheck", KEY_VALUE, "mathcheck plugin waits for your orders", KEY_END),
 			keyNew ("system:/elektra/modules/mathcheck/exports", KEY_END),
+			keyNew ("system:/elektra/modules/mathcheck/exports/open", KEY_FUNC, elektraMathcheckOpen, KEY_END),
+			keyNew ("system:/elektra/modules/mathcheck/exports/close", KEY_FUNC, elektraMathcheckClose, KEY_END),
 			keyNew ("system:/elektra/modules/mathcheck/exports/get", KEY_FUNC, elektraMathcheckGet, KEY_END),
 			keyNew ("system:/elektra/modules/mathcheck/exports/set", KEY_FUNC, elektraMathcheckSet, KEY_END),
 #include ELEKTRA_README
@@ -195,42 +252,51 @@ static PNElem doPrefixCalculation (PNElem * stack, PNElem * stackPtr)
 	result.value = stackPtr->value;
 	return result;
 }
-static PNElem parsePrefixString (const char * prefixString, Key * curKey, KeySet * ks, Key * parentKey)
+/**
+ * Compiles @p prefixString into the tokens of an expression.
+ *
+ * The tokens are pushed on the stack in the same order for every key,
+ * only the values of referenced keys differ.
+ */
+static MathExpression * compileExpression (const char * prefixString)
 {
 	const char * regexString =
 		"(((((\\.)|(\\.\\.\\/)*|(@)|(\\/))([[:alnum:]]*/)*[[:alnum:]]+))|('[0-9]*[.,]{0,1}[0-9]*')|(==)|([-+:/<>=!{*]))";
 	char * ptr = (char *) prefixString;
 	regex_t regex;
-	Key * key;
-
-	PNElem * stack = elektraMalloc (MIN_VALID_STACK * sizeof (PNElem));
 
-	PNElem * stackPtr = stack;
-	PNElem result;
-	Operation resultOp = ERROR;
-	result.op = ERROR;
-	int ret;
-	if ((ret = regcomp (&regex, regexString, REG_EXTENDED | REG_NEWLINE)))
+	if (regcomp (&regex, regexString, REG_EXTENDED | REG_NEWLINE))
 	{
-		ksDel (ks);
-		return result;
+		return NULL;
 	}
+
+	MathExpression * expr = elektraCalloc (sizeof (MathExpression));
+	expr->resultOp = ERROR;
+	size_t alloc = MIN_VALID_STACK;
+	expr->tokens = elektraCalloc (alloc * sizeof (MathToken));
 	regmatch_t match;
-	char * searchKey = NULL;
 	while (1)
 	{
-		stackPtr->op = ERROR;
-		stackPtr->value = 0;
 		int nomatch = regexec (&regex, ptr, 1, &match, 0);
 		if (nomatch)
 		{
 			break;
 		}
+		if (expr->size == alloc)
+		{
+			alloc *= 2;
+			elektraRealloc ((void **) &expr->tokens, alloc * sizeof (MathToken));
+		}
+		MathToken * token = &expr->tokens[expr->size];
+		token->elem.op = ERROR;
+		token->elem.value = 0;
+		token->reference = NULL;
+
 		int len = match.rm_eo - match.rm_so;
 		int start = match.rm_so + (ptr - prefixString);
 		if (!strncmp (prefixString + start, "==", 2))
 		{
-			resultOp = EQU;
+			expr->resultOp = EQU;
 		}
 		else if (len == 1 && !isalpha (prefixString[start]) && prefixString[start] != '\'' && prefixString[start] != '.' &&
 			 prefixString[start] != '@')
@@ -240,66 +306,47 @@ static PNElem parsePrefixString (const char * prefixString, Key * curKey, KeySet
 			{
 
 			case '+':
-				stackPtr->op = ADD;
+				token->elem.op = ADD;
 				break;
 			case '-':
-				stackPtr->op = SUB;
+				token->elem.op = SUB;
 				break;
 			case '/':
-				stackPtr->op = DIV;
+				token->elem.op = DIV;
 				break;
 			case '*':
-				stackPtr->op = MUL;
+				token->elem.op = MUL;
 				break;
 			case ':':
-				resultOp = SET;
+				expr->resultOp = SET;
 				break;
 			case '=':
-				if (resultOp == LT)
+				if (expr->resultOp == LT)
 				{
-					resultOp = LE;
+					expr->resultOp = LE;
 				}
-				else if (resultOp == GT)
+				else if (expr->resultOp == GT)
 				{
-					resultOp = GE;
+					expr->resultOp = GE;
 				}
-				else if (resultOp == ERROR)
+				else if (expr->resultOp == ERROR)
 				{
-					resultOp = EQU;
-				}
-				else if (resultOp == EQU)
-				{
-					resultOp = EQU;
-				}
-				else if (resultOp == NOT)
-				{
-					resultOp = NOT;
-				}
-				else if (resultOp == SET)
-				{
-					resultOp = SET;
+					expr->resultOp = EQU;
 				}
 				break;
 			case '<':
-				resultOp = LT;
+				expr->resultOp = LT;
 				break;
 			case '>':
-				resultOp = GT;
+				expr->resultOp = GT;
 				break;
 			case '!':
-				resultOp = NOT;
+				expr->resultOp = NOT;
 				break;
 			default:
-				ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "%c isn't a valid operation", prefixString[start]);
+				expr->invalidOp = prefixString[start];
 				regfree (&regex);
-				if (searchKey)
-				{
-					elektraFree (searchKey);
-				}
-				elektraFree (stack);
-				ksDel (ks);
-				return result;
-				break;
+				return expr;
 			}
 		}
 		else
@@ -310,60 +357,111 @@ static PNElem parsePrefixString (const char * prefixString, Key * curKey, KeySet
 			if (subString[0] == '\'' && subString[len - 1] == '\'')
 			{
 				subString[len - 1] = '\0';
-				char * subPtr = (subString + 1);
-				stackPtr->value = elektraEFtoF (subPtr);
+				token->elem.value = elektraEFtoF (subString + 1);
 				elektraFree (subString);
 			}
 			else
 			{
-				if (subString[0] == '@')
-				{
-					searchKey = realloc (searchKey, len + 2 + strlen (keyName (parentKey)));
-					strcpy (searchKey, keyName (parentKey));
-					strcat (searchKey, "/");
-					strcat (searchKey, subString + 2);
-				}
-				else if (subString[0] == '.')
-				{
-					searchKey = realloc (searchKey, len + 2 + strlen (keyName (curKey)));
-					strcpy (searchKey, keyName (curKey));
-					strcat (searchKey, "/");
-					strcat (searchKey, subString);
-				}
-				else
-				{
-					searchKey = realloc (searchKey, len + 1);
-					strcpy (searchKey, subString);
-				}
-				key = ksLookupByName (ks, searchKey, 0);
-				if (!key)
-				{
-					stackPtr->value = 0;
-					stackPtr->op = NA;
-				}
-				else
-				{
-					stackPtr->value = elektraEFtoF (keyString (key));
-				}
-				elektraFree (subString);
+				token->reference = subString;
 			}
-			if (stackPtr->op != NA) stackPtr->op = VAL;
+			token->elem.op = VAL;
 		}
-		++stackPtr;
-		int offset = stackPtr - stack;
-		stack = realloc (stack, (offset + 1) * sizeof (PNElem));
-		stackPtr = stack;
-		stackPtr += offset;
+		++expr->size;
 		ptr += match.rm_eo;
 	}
 	regfree (&regex);
-	elektraFree (searchKey);
-	ksDel (ks);
-	stackPtr->op = END;
-	result = doPrefixCalculation (stack, stackPtr);
+	return expr;
+}
+
+static void freeExpression (MathExpression * expr)
+{
+	for (size_t i = 0; i < expr->size; ++i)
+	{
+		elektraFree (expr->tokens[i].reference);
+	}
+	elektraFree (expr->tokens);
+	elektraFree (expr);
+}
+
+/**
+ * Looks up the compiled expression for @p prefixString and compiles it on a cache miss.
+ */
+static MathExpression * lookupExpression (MathcheckData * data, const char * prefixString)
+{
+	keySetName (data->lookup, "/");
+	keyAddBaseName (data->lookup, prefixString);
+
+	Key * cached = ksLookup (data->cache, data->lookup, 0);
+	if (cached)
+	{
+		return *(MathExpression **) keyValue (cached);
+	}
+
+	MathExpression * expr = compileExpression (prefixString);
+	if (expr == NULL) return NULL;
+
+	Key * entry = keyDup (data->lookup, KEY_CP_NAME);
+	keySetBinary (entry, &expr, sizeof (expr));
+	ksAppendKey (data->cache, entry);
+	return expr;
+}
+
+/**
+ * @return the name of the key referenced by @p reference, relative to @p curKey or @p parentKey
+ */
+static char * referenceName (const char * reference, const Key * curKey, const Key * parentKey)
+{
+	if (reference[0] == '@')
+	{
+		return elektraFormat ("%s/%s", keyName (parentKey), reference + 2);
+	}
+	else if (reference[0] == '.')
+	{
+		return elektraFormat ("%s/%s", keyName (curKey), reference);
+	}
+	return elektraStrDup (reference);
+}
+
+static PNElem evalExpression (const MathExpression * expr, const char * prefixString, Key * curKey, KeySet * ks, Key * parentKey)
+{
+	PNElem result;
+	result.op = ERROR;
+	result.value = 0;
+	if (expr->invalidOp)
+	{
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "%c isn't a valid operation", expr->invalidOp);
+		return result;
+	}
+	if (expr->size == 0)
+	{
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Not a valid Polish prefix notation syntax: %s\n", prefixString);
+		return result;
+	}
+
+	PNElem * stack = elektraMalloc ((expr->size + 1) * sizeof (PNElem));
+	for (size_t i = 0; i < expr->size; ++i)
+	{
+		stack[i] = expr->tokens[i].elem;
+		if (!expr->tokens[i].reference) continue;
+
+		char * name = referenceName (expr->tokens[i].reference, curKey, parentKey);
+		Key * key = ksLookupByName (ks, name, 0);
+		if (!key)
+		{
+			stack[i].value = 0;
+			stack[i].op = NA;
+		}
+		else
+		{
+			stack[i].value = elektraEFtoF (keyString (key));
+		}
+		elektraFree (name);
+	}
+	stack[expr->size].op = END;
+	result = doPrefixCalculation (stack, stack + expr->size);
 	if (result.op != ERROR)
 	{
-		result.op = resultOp;
+		result.op = expr->resultOp;
 	}
 	else
 	{
@@ -373,89 +471,147 @@ static PNElem parsePrefixString (const char * prefixString, Key * curKey, KeySet
 	return result;
 }
 
-int elektraMathcheckSet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey)
+/**
+ * Checks (or sets) the value of @p cur with its compiled expression.
+ *
+ * Keys referenced by the expression whose value is calculated with `:=`
+ * and which are still in @p pending are calculated first.
+ *
+ * @retval 1 on success
+ * @retval 0 if the expression is invalid, no further keys are checked
+ * @retval -1 if the check failed
+ */
+static int checkKey (MathcheckData * data, Key * cur, KeySet * returned, KeySet * pending, Key * parentKey)
 {
-	Key * cur;
-	PNElem result;
+	const Key * meta = keyGetMeta (cur, "check/math");
+	MathExpression * expr = lookupExpression (data, keyString (meta));
+	if (expr == NULL)
+	{
+		return 0;
+	}
 
-	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	for (size_t i = 0; i < expr->size; ++i)
 	{
-		cur = ksAtCursor (returned, it);
-		const Key * meta = keyGetMeta (cur, "check/math");
-		if (!meta) continue;
-		ELEKTRA_LOG_DEBUG ("Check key “%s” with value “%s”", keyName (cur), keyString (meta));
-		result = parsePrefixString (keyString (meta), cur, ksDup (returned), parentKey);
-		ELEKTRA_LOG_DEBUG ("Result: “%f”", result.value);
-		char val1[MAX_CHARS_DOUBLE + 1]; // Include storage for trailing `\0` character
-		char val2[MAX_CHARS_DOUBLE];
-		strncpy (val1, keyString (cur), MAX_CHARS_DOUBLE);
-		elektraFtoA (val2, sizeof (val2), result.value);
-		if (result.op == ERROR)
+		if (!expr->tokens[i].reference) continue;
+
+		char * name = referenceName (expr->tokens[i].reference, cur, parentKey);
+		Key * dependency = ksLookupByName (pending, name, KDB_O_POP);
+		elektraFree (name);
+		if (dependency)
 		{
-			return 1;
+			int ret = checkKey (data, dependency, returned, pending, parentKey);
+			keyDel (dependency);
+			if (ret != 1) return ret;
 		}
-		else if (result.op == EQU)
+	}
+
+	ELEKTRA_LOG_DEBUG ("Check key “%s” with value “%s”", keyName (cur), keyString (meta));
+	PNElem result = evalExpression (expr, keyString (meta), cur, returned, parentKey);
+	ELEKTRA_LOG_DEBUG ("Result: “%f”", result.value);
+	char val1[MAX_CHARS_DOUBLE + 1]; // Include storage for trailing `\0` character
+	char val2[MAX_CHARS_DOUBLE];
+	strncpy (val1, keyString (cur), MAX_CHARS_DOUBLE);
+	elektraFtoA (val2, sizeof (val2), result.value);
+	if (result.op == ERROR)
+	{
+		return 0;
+	}
+	else if (result.op == EQU)
+	{
+		if (fabs (elektraEFtoF (keyString (cur)) - result.value) > EPSILON)
 		{
-			if (fabs (elektraEFtoF (keyString (cur)) - result.value) > EPSILON)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s != %s", val1, val2);
-				return -1;
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s != %s", val1, val2);
+			return -1;
 		}
-		else if (result.op == NOT)
+	}
+	else if (result.op == NOT)
+	{
+		if (fabs (elektraEFtoF (keyString (cur)) - result.value) < EPSILON)
 		{
-			if (fabs (elektraEFtoF (keyString (cur)) - result.value) < EPSILON)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey,
-									"Mathcheck failed: %s == %s but requirement was !=", val1, val2);
-				return -1;
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s == %s but requirement was !=", val1, val2);
+			return -1;
 		}
-		else if (result.op == LT)
+	}
+	else if (result.op == LT)
+	{
+		if (elektraEFtoF (keyString (cur)) >= result.value)
 		{
-			if (elektraEFtoF (keyString (cur)) >= result.value)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not < %s", val1, val2);
-				return -1;
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not < %s", val1, val2);
+			return -1;
 		}
-		else if (result.op == GT)
+	}
+	else if (result.op == GT)
+	{
+		if (elektraEFtoF (keyString (cur)) <= result.value)
 		{
-			if (elektraEFtoF (keyString (cur)) <= result.value)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not > %s", val1, val2);
-				return -1;
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not > %s", val1, val2);
+			return -1;
 		}
-		else if (result.op == LE)
+	}
+	else if (result.op == LE)
+	{
+		if (elektraEFtoF (keyString (cur)) > result.value)
 		{
-			if (elektraEFtoF (keyString (cur)) > result.value)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not <=	%s", val1, val2);
-				return -1;
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not <=	%s", val1, val2);
+			return -1;
 		}
-		else if (result.op == GE)
+	}
+	else if (result.op == GE)
+	{
+		if (elektraEFtoF (keyString (cur)) < result.value)
 		{
-			if (elektraEFtoF (keyString (cur)) < result.value)
-			{
-				ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not >= %s", val1, val2);
-				return -1;
-			}
+			ELEKTRA_SET_VALIDATION_SEMANTIC_ERRORF (parentKey, "Mathcheck failed: %s not >= %s", val1, val2);
+			return -1;
 		}
-		else if (result.op == SET)
+	}
+	else if (result.op == SET)
+	{
+		ELEKTRA_LOG_DEBUG ("Set value of “%s” to “%s”", keyName (cur), val2);
+		keySetString (cur, val2);
+	}
+	return 1;
+}
+
+int elektraMathcheckSet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	MathcheckData * data = elektraPluginGetData (handle);
+
+	// keys whose value is calculated, they are calculated before keys referencing them
+	KeySet * pending = ksNew (0, KS_END);
+	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	{
+		Key * cur = ksAtCursor (returned, it);
+		const Key * meta = keyGetMeta (cur, "check/math");
+		if (!meta) continue;
+		MathExpression * expr = lookupExpression (data, keyString (meta));
+		if (expr && expr->resultOp == SET) ksAppendKey (pending, cur);
+	}
+
+	int ret = 1;
+	for (elektraCursor it = 0; it < ksGetSize (returned) && ret == 1; ++it)
+	{
+		Key * cur = ksAtCursor (returned, it);
+		const Key * meta = keyGetMeta (cur, "check/math");
+		if (!meta) continue;
+		MathExpression * expr = lookupExpression (data, keyString (meta));
+		if (expr && expr->resultOp == SET)
 		{
-			ELEKTRA_LOG_DEBUG ("Set value of “%s” to “%s”", keyName (cur), val2);
-			keySetString (cur, val2);
+			Key * calculated = ksLookup (pending, cur, KDB_O_POP);
+			if (!calculated) continue; // already calculated as dependency of another key
+			keyDel (calculated);
 		}
+		ret = checkKey (data, cur, returned, pending, parentKey);
 	}
-	return 1; /* success */
+	ksDel (pending);
+	return ret == -1 ? -1 : 1; /* success */
 }
 
 Plugin * ELEKTRA_PLUGIN_EXPORT
 {
 	// clang-format off
 	return elektraPluginExport("mathcheck",
+			ELEKTRA_PLUGIN_OPEN,	&elektraMathcheckOpen,
+			ELEKTRA_PLUGIN_CLOSE,	&elektraMathcheckClose,
 			ELEKTRA_PLUGIN_GET,	&elektraMathcheckGet,
 			ELEKTRA_PLUGIN_SET,	&elektraMathcheckSet,
 			ELEKTRA_PLUGIN_END);
@@ -63,6 +63,31 @@ static void test_multiUp (void)
 	ksDel (ks);
 }
 
+static void test_dependencyOrder (void)
+{
+	Key * parentKey = keyNew ("user:/tests/mathcheck", KEY_VALUE, "", KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	// dir/a and dir/b share one expression, dir/sum is calculated before they are checked
+	KeySet * ks = ksNew (5,
+			     keyNew ("user:/tests/mathcheck/dir/a", KEY_VALUE, "13", KEY_META, "check/math", "== + ../sum '1'", KEY_END),
+			     keyNew ("user:/tests/mathcheck/dir/b", KEY_VALUE, "13", KEY_META, "check/math", "== + ../sum '1'", KEY_END),
+			     keyNew ("user:/tests/mathcheck/dir/sum", KEY_VALUE, "0", KEY_META, "check/math", ":= + ../val1 ../val2", KEY_END),
+			     keyNew ("user:/tests/mathcheck/dir/val1", KEY_VALUE, "2", KEY_END),
+			     keyNew ("user:/tests/mathcheck/dir/val2", KEY_VALUE, "10", KEY_END), KS_END);
+
+	PLUGIN_OPEN ("mathcheck");
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == 1, "keys referencing a calculated key should be checked after it");
+	succeed_if (!strcmp (keyString (ksLookupByName (ks, "user:/tests/mathcheck/dir/sum", 0)), "12"), "sum not calculated");
+
+	keySetString (ksLookupByName (ks, "user:/tests/mathcheck/dir/val1", 0), "3");
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == -1, "cached expression should use the new value");
+	succeed_if (!strcmp (keyString (ksLookupByName (ks, "user:/tests/mathcheck/dir/sum", 0)), "13"), "sum not recalculated");
+
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+	ksDel (ks);
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("MATHCHECK	   TESTS\n");
@@ -143,6 +168,7 @@ int main (int argc, char ** argv)
 	ksDel (ks);
 
 	test_multiUp ();
+	test_dependencyOrder ();
 
 	print_result ("testmod_mathcheck");
 
@@ -58,6 +58,24 @@ typedef enum
 	MODE_NONREGULAR_FILE = 1 << 2
 } PluginMode;
 
+// a region mapped by get and handed to ELEKTRA_PLUGIN_FUNCTION (unmap)
+typedef struct _MmapRegion
+{
+	char * address;
+	size_t size;
+	KeySet * keys; // holds a reference to every key of the region
+	struct _MmapRegion * next;
+} MmapRegion;
+
+typedef struct
+{
+	// the region mapped by the last successful get
+	char * mappedRegion;
+	size_t mappedSize;
+	// the regions handed to unmap, released as soon as their keys are not used anymore
+	MmapRegion * regions;
+} MmapstorageData;
+
 /* -- File handling --------------------------------------------------------------------------------------------------------------------- */
 
 /**
@@ -402,11 +420,12 @@ static void initMagicKeySet (const uintptr_t magicNumber)
 	magicKeySet.array = (Key **) magicNumber;
 	magicKeySet.size = SIZE_MAX;
 	magicKeySet.alloc = 0;
+	magicKeySet.pending = 0;
 	magicKeySet.cursor = (Key *) ~magicNumber;
 	magicKeySet.current = SIZE_MAX / 2;
 	magicKeySet.flags = KS_FLAG_MMAP_ARRAY | KS_FLAG_SYNC;
 	magicKeySet.refs = UINT16_MAX;
-	magicKeySet.reserved = 0;
+	magicKeySet.shares = 0;
 #ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
 	magicKeySet.opmphm = (Opmphm *) ELEKTRA_MMAP_MAGIC_BOM;
 	magicKeySet.opmphmPredictor = 0;
@@ -429,7 +448,8 @@ static void initMagicKey (const uintptr_t magicNumber)
 	magicKey.meta = (KeySet *) ELEKTRA_MMAP_MAGIC_BOM;
 	magicKey.flags = KEY_FLAG_MMAP_STRUCT | KEY_FLAG_MMAP_DATA | KEY_FLAG_MMAP_KEY | KEY_FLAG_SYNC;
 	magicKey.refs = UINT16_MAX / 2;
-	magicKey.reserved = UINT16_MAX;
+	magicKey.inlineSize = UINT16_MAX;
+	magicKey.typedValue = 0;
 }
 
 /**
@@ -608,27 +628,47 @@ static int verifyChecksum (char * mappedRegion, MmapHeader * mmapHeader, PluginM
 }
 #endif
 
+/**
+ * @brief Checks whether the meta KeySet @p meta needs to be stored in the mapped region.
+ *
+ * Meta KeySets shared by several Keys (see KS_FLAG_SHARED_META) are stored only once,
+ * their pointers are collected in @p sharedMetaArray.
+ *
+ * @param meta the meta KeySet of a Key
+ * @param sharedMetaArray to store shared meta-keyset pointers for deduplication
+ *
+ * @retval true if @p meta is not shared or was not seen before
+ * @retval false if @p meta is shared and already counted
+ */
+static bool isNewMetaKeySet (KeySet * meta, DynArray * sharedMetaArray)
+{
+	if (!test_bit (meta->flags, KS_FLAG_SHARED_META)) return true;
+	// the DynArray only compares pointers, so it can hold KeySets as well
+	return ELEKTRA_PLUGIN_FUNCTION (dynArrayFindOrInsert) ((Key *) meta, sharedMetaArray) == 0;
+}
+
 /**
  * @brief Calculates the size, in bytes, needed to store the KeySet in a mmap region.
  *
  * Iterates over the KeySet and calculates the complete size in bytes, needed to store the KeySet
  * within a mapped region. The size includes all mmap meta-information, magic KeySet and Key for
  * consistency checks, KeySets, meta-KeySets, Keys, meta-Keys, Key names and values.
- * Copied meta-Keys are counted once for deduplication. If needed, padding is added to align the
+ * Copied meta-Keys and shared meta-KeySets are counted once for deduplication. If needed, padding is added to align the
  * MmapFooter properly at the end of the mapping. When the plugin is in a global position,
  * acting as a cache, the calculated size includes the global KeySet.
  *
  * The complete size and some other meta-information are stored in the MmapHeader and MmapMetaData.
- * The DynArray stores the unique meta-Key pointers needed for deduplication.
+ * The DynArrays store the unique meta-Key and shared meta-KeySet pointers needed for deduplication.
  *
  * @param mmapHeader to store the allocation size
  * @param mmapMetaData to store the number of KeySets and Keys
  * @param returned the KeySet that should be stored
  * @param global the global KeySet
  * @param dynArray to store meta-key pointers for deduplication
+ * @param sharedMetaArray to store shared meta-keyset pointers for deduplication
  */
 static void calculateMmapDataSize (MmapHeader * mmapHeader, MmapMetaData * mmapMetaData, KeySet * returned, KeySet * global,
-				   DynArray * dynArray)
+				   DynArray * dynArray, DynArray * sharedMetaArray)
 {
 	Key * cur;
 	size_t dataBlocksSize = 0; // sum of keyName and keyValue sizes
@@ -641,7 +681,7 @@ static void calculateMmapDataSize (MmapHeader * mmapHeader, MmapMetaData * mmapM
 		cur = ksAtCursor (returned, it);
 		dataBlocksSize += (cur->keySize + cur->keyUSize + cur->dataSize);
 
-		if (cur->meta && cur->meta->size > 0)
+		if (cur->meta && cur->meta->size > 0 && isNewMetaKeySet (cur->meta, sharedMetaArray))
 		{
 			++mmapMetaData->numKeySets;
 
@@ -672,7 +712,7 @@ static void calculateMmapDataSize (MmapHeader * mmapHeader, MmapMetaData * mmapM
 			globalKey = ksAtCursor (global, it);
 			dataBlocksSize += (globalKey->keySize + globalKey->keyUSize + globalKey->dataSize);
 
-			if (globalKey->meta && globalKey->meta->size > 0)
+			if (globalKey->meta && globalKey->meta->size > 0 && isNewMetaKeySet (globalKey->meta, sharedMetaArray))
 			{
 				++mmapMetaData->numKeySets;
 
@@ -780,6 +820,9 @@ static void writeMetaKeys (MmapAddr * mmapAddr, DynArray * dynArray)
 
 		// move Key itself
 		mmapMetaKey->flags |= KEY_FLAG_MMAP_STRUCT;
+		clear_bit (mmapMetaKey->flags, (keyflag_t) KEY_FLAG_ARENA);
+		mmapMetaKey->inlineSize = 0;
+		mmapMetaKey->typedValue = 0;
 		mmapMetaKey->meta = 0;
 		mmapMetaKey->refs = 0;
 
@@ -790,21 +833,47 @@ static void writeMetaKeys (MmapAddr * mmapAddr, DynArray * dynArray)
 /**
  * @brief Writes a meta keyset of a key to the mapped region.
  *
+ * Meta keysets shared by several keys are only written once, the keys in the
+ * mapped region share them as well.
+ *
  * @param key holding the meta-keyset
  * @param mmapAddr structure holding pointers to the mapped region
  * @param dynArray holding deduplicated references to meta-keys
+ * @param sharedMetaArray holding deduplicated references to shared meta-keysets
  *
  * @return pointer to the new meta keyset
  */
-static KeySet * writeMetaKeySet (Key * key, MmapAddr * mmapAddr, DynArray * dynArray)
+static KeySet * writeMetaKeySet (Key * key, MmapAddr * mmapAddr, DynArray * dynArray, DynArray * sharedMetaArray)
 {
 	// write the meta KeySet
 	if (!key->meta || !(key->meta->size > 0)) return 0;
 
+	ssize_t sharedIndex = -1;
+	if (test_bit (key->meta->flags, KS_FLAG_SHARED_META))
+	{
+		sharedIndex = ELEKTRA_PLUGIN_FUNCTION (dynArrayFind) ((Key *) key->meta, sharedMetaArray);
+		KeySet * mappedMeta = (KeySet *) sharedMetaArray->mappedKeyArray[sharedIndex];
+		if (mappedMeta)
+		{
+			// already written for another key
+			++(mappedMeta->shares);
+			return (KeySet *) ((char *) mappedMeta - mmapAddr->mmapAddrInt);
+		}
+	}
+
 	KeySet * newMeta = (KeySet *) mmapAddr->metaKsPtr;
 	mmapAddr->metaKsPtr += SIZEOF_KEYSET;
 
-	newMeta->flags = key->meta->flags | KS_FLAG_MMAP_STRUCT | KS_FLAG_MMAP_ARRAY;
+	newMeta->flags = (key->meta->flags & ~(KS_FLAG_FROZEN | KS_FLAG_SHARED_META | KS_FLAG_EXPOSED_META)) | KS_FLAG_MMAP_STRUCT |
+			 KS_FLAG_MMAP_ARRAY;
+	newMeta->refs = 0;
+	newMeta->shares = 0;
+	if (sharedIndex >= 0)
+	{
+		set_bit (newMeta->flags, KS_FLAG_SHARED_META);
+		newMeta->shares = 1;
+		sharedMetaArray->mappedKeyArray[sharedIndex] = (Key *) newMeta;
+	}
 	newMeta->array = (Key **) mmapAddr->metaKsArrayPtr;
 	mmapAddr->metaKsArrayPtr += SIZEOF_KEY_PTR * key->meta->alloc;
 
@@ -813,7 +882,7 @@ static KeySet * writeMetaKeySet (Key * key, MmapAddr * mmapAddr, DynArray * dynA
 	const Key * metaKey;
 
 
-	KeySet * metaKeys = keyMeta (key);
+	const KeySet * metaKeys = key->meta;
 	for (elektraCursor it = 0; it < ksGetSize (metaKeys); ++it)
 	{
 		metaKey = ksAtCursor (metaKeys, it);
@@ -843,8 +912,9 @@ static KeySet * writeMetaKeySet (Key * key, MmapAddr * mmapAddr, DynArray * dynA
  * @param keySet holding the keys to be written to the mapped region
  * @param mmapAddr structure holding pointers to the mapped region
  * @param dynArray holding deduplicated meta-key pointers
+ * @param sharedMetaArray holding deduplicated shared meta-keyset pointers
  */
-static void writeKeys (KeySet * keySet, MmapAddr * mmapAddr, DynArray * dynArray, PluginMode mode)
+static void writeKeys (KeySet * keySet, MmapAddr * mmapAddr, DynArray * dynArray, DynArray * sharedMetaArray, PluginMode mode)
 {
 	Key * cur;
 	size_t keyIndex = 0;
@@ -899,10 +969,13 @@ static void writeKeys (KeySet * keySet, MmapAddr * mmapAddr, DynArray * dynArray
 		}
 
 		// write the meta KeySet
-		mmapKey->meta = writeMetaKeySet (cur, mmapAddr, dynArray);
+		mmapKey->meta = writeMetaKeySet (cur, mmapAddr, dynArray, sharedMetaArray);
 
 		// move Key itself
 		mmapKey->flags |= KEY_FLAG_MMAP_STRUCT;
+		clear_bit (mmapKey->flags, (keyflag_t) KEY_FLAG_ARENA);
+		mmapKey->inlineSize = 0;
+		mmapKey->typedValue = 0;
 		mmapKey->refs = 1;
 
 		// write the relative Key pointer into the KeySet array
@@ -947,13 +1020,14 @@ static void printMmapMetaData (MmapMetaData * mmapMetaData ELEKTRA_UNUSED)
  * @param mmapMetaData containing meta-information of the mapped region
  * @param mmapFooter containing a magic number for consistency checks
  * @param dynArray containing deduplicated pointers to meta-keys
+ * @param sharedMetaArray containing deduplicated pointers to shared meta-keysets
  * @param mode the current plugin mode
  *
  * @retval 0 on success
  * @retval -1 if msync() failed
  */
 static int copyKeySetToMmap (char * const dest, KeySet * keySet, KeySet * global, MmapHeader * mmapHeader, MmapMetaData * mmapMetaData,
-			     MmapFooter * mmapFooter, DynArray * dynArray, PluginMode mode)
+			     MmapFooter * mmapFooter, DynArray * dynArray, DynArray * sharedMetaArray, PluginMode mode)
 {
 	writeMagicData (dest);
 
@@ -1021,10 +1095,16 @@ static int copyKeySetToMmap (char * const dest, KeySet * keySet, KeySet * global
 	// first write the meta keys into place
 	writeMetaKeys (&mmapAddr, dynArray);
 
+	// shared meta keysets are written with the first key using them, remember where
+	if (sharedMetaArray->size > 0)
+	{
+		sharedMetaArray->mappedKeyArray = elektraCalloc (sharedMetaArray->size * sizeof (Key *));
+	}
+
 	if (global)
 	{
 		ELEKTRA_LOG_DEBUG ("writing GLOBAL KEYSET");
-		if (global->size != 0) writeKeys (global, &mmapAddr, dynArray, MODE_GLOBALCACHE);
+		if (global->size != 0) writeKeys (global, &mmapAddr, dynArray, sharedMetaArray, MODE_GLOBALCACHE);
 
 		set_bit (mmapHeader->formatFlags, MMAP_FLAG_TIMESTAMPS);
 		mmapAddr.globalKsPtr->flags = global->flags | KS_FLAG_MMAP_STRUCT | KS_FLAG_MMAP_ARRAY;
@@ -1038,7 +1118,7 @@ static int copyKeySetToMmap (char * const dest, KeySet * keySet, KeySet * global
 	if (keySet->size != 0)
 	{
 		// now write Keys including meta KeySets
-		writeKeys (keySet, &mmapAddr, dynArray, MODE_STORAGE);
+		writeKeys (keySet, &mmapAddr, dynArray, sharedMetaArray, MODE_STORAGE);
 	}
 
 	mmapAddr.ksPtr->flags = keySet->flags | KS_FLAG_MMAP_STRUCT | KS_FLAG_MMAP_ARRAY;
@@ -1252,18 +1332,92 @@ static void updatePointers (MmapMetaData * mmapMetaData, char * dest)
 	}
 }
 
+/* -- Region release -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief Checks whether the keys of a region are still used outside of it.
+ *
+ * The keys of a region are used, if anything besides the region keyset holds
+ * a reference to them. Mapped metadata is referenced once by every metadata
+ * keyset of the region that contains it, further references come from elsewhere.
+ *
+ * @param region the region to check
+ *
+ * @retval 1 if any key or metadata key of the region is still used
+ * @retval 0 if the region can be released
+ */
+static int isRegionUsed (MmapRegion * region)
+{
+	for (elektraCursor it = 0; it < ksGetSize (region->keys); ++it)
+	{
+		if (ksAtCursor (region->keys, it)->refs > 1) return 1;
+	}
+
+	// remove the references of the region, the remaining ones come from elsewhere
+	int used = 0;
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		for (elektraCursor it = 0; it < ksGetSize (region->keys); ++it)
+		{
+			const KeySet * meta = elektraKeyGetMetaKeySet (ksAtCursor (region->keys, it));
+			for (elektraCursor metaIt = 0; metaIt < ksGetSize (meta); ++metaIt)
+			{
+				Key * metaKey = ksAtCursor (meta, metaIt);
+				if ((char *) metaKey < region->address || (char *) metaKey >= region->address + region->size) continue;
+
+				if (pass == 0)
+					--metaKey->refs;
+				else if (pass == 1)
+					used |= metaKey->refs != 0;
+				else
+					++metaKey->refs;
+			}
+		}
+	}
+	return used;
+}
+
+/**
+ * @brief Releases the regions whose keys are not used anymore.
+ *
+ * @param data the plugin data
+ * @param all if non-zero, also stops tracking regions that are still used, they stay mapped then
+ */
+static void releaseRegions (MmapstorageData * data, int all)
+{
+	MmapRegion ** next = &data->regions;
+	while (*next != NULL)
+	{
+		MmapRegion * region = *next;
+		int used = isRegionUsed (region);
+		if (used && !all)
+		{
+			next = &region->next;
+			continue;
+		}
+
+		*next = region->next;
+		ksDel (region->keys);
+		if (!used && munmap (region->address, region->size) != 0)
+		{
+			ELEKTRA_LOG_WARNING ("could not munmap");
+		}
+		elektraFree (region);
+	}
+}
+
 /* -- Exported Elektra Plugin Functions ------------------------------------------------------------------------------------------------- */
 
 /**
  * @brief Initializes the plugin data and magic keyset and key.
  *
  * @param handle The plugin handle.
- * @param errorKey Unused.
+ * @param errorKey Holding the error message.
  *
  * @retval ELEKTRA_PLUGIN_STATUS_ERROR on memory error (plugin data (keyset) could not be allocated).
  * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if initialization was successful.
  */
-int ELEKTRA_PLUGIN_FUNCTION (open) (Plugin * handle ELEKTRA_UNUSED, Key * errorKey ELEKTRA_UNUSED)
+int ELEKTRA_PLUGIN_FUNCTION (open) (Plugin * handle, Key * errorKey)
 {
 	// plugin initialization logic
 
@@ -1291,6 +1445,17 @@ int ELEKTRA_PLUGIN_FUNCTION (open) (Plugin * handle ELEKTRA_UNUSED, Key * errorK
 	if (magicOpmphmPredictor.ksSize == 0) initMagicOpmphmPredictor (magicNumber);
 #endif
 
+	if (elektraPluginGetData (handle) == NULL)
+	{
+		MmapstorageData * data = elektraCalloc (sizeof (MmapstorageData));
+		if (data == NULL)
+		{
+			ELEKTRA_SET_OUT_OF_MEMORY_ERROR (errorKey);
+			return ELEKTRA_PLUGIN_STATUS_ERROR;
+		}
+		elektraPluginSetData (handle, data);
+	}
+
 	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
 
 error:
@@ -1301,16 +1466,23 @@ error:
 }
 
 /**
- * @brief Cleans up the plugin data and unlinks all mapped files.
+ * @brief Cleans up the plugin data.
+ *
+ * Regions handed to unmap are released, unless their keys are still used. Other
+ * mapped regions are not released, keysets returned by get may still point into them.
  *
  * @param handle The plugin handle.
  * @param errorKey Unused.
  *
  * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS always.
  */
-int ELEKTRA_PLUGIN_FUNCTION (close) (Plugin * handle ELEKTRA_UNUSED, Key * errorKey ELEKTRA_UNUSED)
+int ELEKTRA_PLUGIN_FUNCTION (close) (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
 {
 	// free all plugin resources and shut it down
+	MmapstorageData * data = elektraPluginGetData (handle);
+	if (data != NULL) releaseRegions (data, 1);
+	elektraFree (data);
+	elektraPluginSetData (handle, NULL);
 
 	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
 }
@@ -1328,7 +1500,7 @@ int ELEKTRA_PLUGIN_FUNCTION (close) (Plugin * handle ELEKTRA_UNUSED, Key * error
  * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the file was mapped successfully.
  * @retval ELEKTRA_PLUGIN_STATUS_ERROR if the file could not be mapped successfully.
  */
-int ELEKTRA_PLUGIN_FUNCTION (get) (Plugin * handle ELEKTRA_UNUSED, KeySet * ks, Key * parentKey)
+int ELEKTRA_PLUGIN_FUNCTION (get) (Plugin * handle, KeySet * ks, Key * parentKey)
 {
 	// get all keys
 	int errnosave = errno;
@@ -1470,6 +1642,14 @@ int ELEKTRA_PLUGIN_FUNCTION (get) (Plugin * handle ELEKTRA_UNUSED, KeySet * ks,
 	updatePointers (mmapMetaData, mappedRegion);
 	mmapToKeySet (handle, mappedRegion, ks, mode);
 
+	MmapstorageData * data = elektraPluginGetData (handle);
+	if (data != NULL)
+	{
+		// the global keyset of the cache also points into the region, so it must not be released
+		data->mappedRegion = test_bit (mode, MODE_GLOBALCACHE) ? NULL : mappedRegion;
+		data->mappedSize = (size_t) sbuf.st_size;
+	}
+
 	if (close (fd) != 0)
 	{
 		ELEKTRA_MMAP_LOG_WARNING ("could not close");
@@ -1502,6 +1682,55 @@ error:
 	return ELEKTRA_PLUGIN_STATUS_ERROR;
 }
 
+/**
+ * @brief Releases the regions of earlier calls of get, whose keys are not used anymore.
+ *
+ * Keysets returned by get point into a region that is otherwise never released, because their keys
+ * may be referenced elsewhere. Callers that read many files with the same plugin handle (e.g. the
+ * pluginprocess library) hand each keyset returned by get to this function. Its region is then released
+ * by a later call of unmap or by close, as soon as no key of it is used outside of the region anymore.
+ * The keyset @p ks itself must be deleted or replaced by then, its array points into the region.
+ *
+ * @param handle The plugin handle, whose last call of get returned @p ks.
+ * @param ks The keyset returned by the last call of get, or NULL to only release earlier regions.
+ * @param errorKey Holding the error message.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the region of @p ks is tracked or @p ks does not point into a region.
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR on memory errors, the region of @p ks then stays mapped.
+ */
+int ELEKTRA_PLUGIN_FUNCTION (unmap) (Plugin * handle, KeySet * ks, Key * errorKey)
+{
+	MmapstorageData * data = elektraPluginGetData (handle);
+	if (data == NULL) return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+
+	releaseRegions (data, 0);
+
+	if (data->mappedRegion == NULL || ks == NULL || !test_bit (ks->flags, KS_FLAG_MMAP_ARRAY) ||
+	    (char *) ks->array < data->mappedRegion || (char *) ks->array >= data->mappedRegion + data->mappedSize)
+	{
+		return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+	}
+
+	MmapRegion * region = elektraMalloc (sizeof (MmapRegion));
+	KeySet * keys = ksNew (ksGetSize (ks), KS_END);
+	if (region == NULL || keys == NULL || ksAppend (keys, ks) < 0)
+	{
+		elektraFree (region);
+		ksDel (keys);
+		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (errorKey);
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+
+	region->address = data->mappedRegion;
+	region->size = data->mappedSize;
+	region->keys = keys;
+	region->next = data->regions;
+	data->regions = region;
+	data->mappedRegion = NULL;
+	data->mappedSize = 0;
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
 /**
  * @brief The mmapstorage set function writes a keyset to a new file.
  *
@@ -1531,6 +1760,7 @@ int ELEKTRA_PLUGIN_FUNCTION (set) (Plugin * handle ELEKTRA_UNUSED, KeySet * ks,
 	int fd = -1;
 	char * mappedRegion = MAP_FAILED;
 	DynArray * dynArray = 0;
+	DynArray * sharedMetaArray = 0;
 	Key * initialParent = keyDup (parentKey, KEY_CP_ALL);
 
 	if (elektraStrCmp (keyString (parentKey), STDOUT_FILENAME) == 0)
@@ -1561,12 +1791,13 @@ int ELEKTRA_PLUGIN_FUNCTION (set) (Plugin * handle ELEKTRA_UNUSED, KeySet * ks,
 	}
 
 	dynArray = ELEKTRA_PLUGIN_FUNCTION (dynArrayNew) ();
+	sharedMetaArray = ELEKTRA_PLUGIN_FUNCTION (dynArrayNew) ();
 
 	MmapHeader mmapHeader;
 	MmapMetaData mmapMetaData;
 	initHeader (&mmapHeader);
 	initMetaData (&mmapMetaData);
-	calculateMmapDataSize (&mmapHeader, &mmapMetaData, ks, global, dynArray);
+	calculateMmapDataSize (&mmapHeader, &mmapMetaData, ks, global, dynArray, sharedMetaArray);
 	ELEKTRA_LOG_DEBUG ("mmapsize: %" PRIu64, mmapHeader.allocSize);
 
 	if (!test_bit (mode, MODE_NONREGULAR_FILE) && truncateFile (fd, mmapHeader.allocSize, parentKey, mode) != 1)
@@ -1584,7 +1815,7 @@ int ELEKTRA_PLUGIN_FUNCTION (set) (Plugin * handle ELEKTRA_UNUSED, KeySet * ks,
 
 	MmapFooter mmapFooter;
 	initFooter (&mmapFooter);
-	if (copyKeySetToMmap (mappedRegion, ks, global, &mmapHeader, &mmapMetaData, &mmapFooter, dynArray, mode) != 0)
+	if (copyKeySetToMmap (mappedRegion, ks, global, &mmapHeader, &mmapMetaData, &mmapFooter, dynArray, sharedMetaArray, mode) != 0)
 	{
 		goto error;
 	}
@@ -1620,6 +1851,7 @@ int ELEKTRA_PLUGIN_FUNCTION (set) (Plugin * handle ELEKTRA_UNUSED, KeySet * ks,
 	}
 
 	ELEKTRA_PLUGIN_FUNCTION (dynArrayDelete) (dynArray);
+	ELEKTRA_PLUGIN_FUNCTION (dynArrayDelete) (sharedMetaArray);
 	keySetString (parentKey, keyString (initialParent));
 	if (initialParent) keyDel (initialParent);
 	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
@@ -1649,6 +1881,7 @@ error:
 	keySetString (parentKey, keyString (initialParent));
 	if (initialParent) keyDel (initialParent);
 	ELEKTRA_PLUGIN_FUNCTION (dynArrayDelete) (dynArray);
+	ELEKTRA_PLUGIN_FUNCTION (dynArrayDelete) (sharedMetaArray);
 
 	errno = errnosave;
 	return ELEKTRA_PLUGIN_STATUS_ERROR;
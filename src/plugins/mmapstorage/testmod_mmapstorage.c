@@ -11,6 +11,7 @@
 /* -- Imports --------------------------------------------------------------------------------------------------------------------------- */
 
 #include <fcntl.h> // fcntl(), open()
+#include <inttypes.h> // SCNxPTR
 #include <stdio.h> // fopen(), fileno()
 #include <stdlib.h>
 #include <string.h>
@@ -737,6 +738,108 @@ static void test_mmap_metacopy (const char * tmpFile)
 	PLUGIN_CLOSE ();
 }
 
+static void test_mmap_shared_meta (const char * tmpFile)
+{
+	Key * parentKey = keyNew (TEST_ROOT_KEY, KEY_VALUE, tmpFile, KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("mmapstorage");
+
+	Key * spec = keyNew ("/", KEY_META, "type", "long", KEY_META, "default", "5", KEY_END);
+	KeySet * ks = ksNew (0, KS_END);
+	char name[KEY_NAME_LENGTH];
+	for (int i = 0; i < 10; ++i)
+	{
+		snprintf (name, KEY_NAME_LENGTH, "%s/shared%d", TEST_ROOT_KEY, i);
+		Key * key = keyNew (name, KEY_VALUE, "value", KEY_END);
+		keyCopyAllMeta (key, spec);
+		ksAppendKey (ks, key);
+	}
+	keyDel (spec);
+
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == 1, "kdbSet was not successful");
+
+	KeySet * returned = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, returned, parentKey) == 1, "kdbGet was not successful");
+
+	Key * first = ksLookupByName (returned, TEST_ROOT_KEY "/shared0", 0);
+	Key * last = ksLookupByName (returned, TEST_ROOT_KEY "/shared9", 0);
+	const KeySet * shared = elektraKeyGetMetaKeySet (first);
+	succeed_if (elektraKeyGetMetaKeySet (last) == shared, "shared metadata not restored");
+	succeed_if (shared->shares == 10, "wrong number of Keys sharing the metadata");
+
+	// copy-on-write works for metadata in the mapped region too
+	succeed_if (keySetMeta (first, "type", "string") == sizeof ("string"), "could not change metadata");
+	succeed_if_same_string (keyString (keyGetMeta (first, "type")), "string");
+	succeed_if_same_string (keyString (keyGetMeta (last, "type")), "long");
+	succeed_if (shared->shares == 9, "wrong number of Keys sharing the metadata");
+
+	ksDel (returned);
+
+	keyDel (parentKey);
+	ksDel (ks);
+	PLUGIN_CLOSE ();
+}
+
+static int isMapped (const void * address)
+{
+	FILE * maps = fopen ("/proc/self/maps", "r");
+	if (maps == NULL) return 0;
+
+	int mapped = 0;
+	char line[4096];
+	while (!mapped && fgets (line, sizeof (line), maps) != NULL)
+	{
+		uintptr_t start, end;
+		if (sscanf (line, "%" SCNxPTR "-%" SCNxPTR, &start, &end) == 2)
+		{
+			mapped = (uintptr_t) address >= start && (uintptr_t) address < end;
+		}
+	}
+	fclose (maps);
+	return mapped;
+}
+
+static void test_mmap_unmap (const char * tmpFile)
+{
+	Key * parentKey = keyNew (TEST_ROOT_KEY, KEY_VALUE, tmpFile, KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("mmapstorage");
+
+	KeySet * ks = metaTestKeySet ();
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == 1, "kdbSet was not successful");
+
+	KeySet * returned = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, returned, parentKey) == 1, "kdbGet was not successful");
+	succeed_if (ELEKTRA_PLUGIN_FUNCTION (unmap) (plugin, returned, parentKey) == 1, "unmap was not successful");
+
+	// the keys stay in the mapped region
+	Key * used = ksAtCursor (returned, 0);
+	succeed_if (test_bit (used->flags, KEY_FLAG_MMAP_STRUCT), "key does not point into the mapped region");
+	compare_keyset (ks, returned);
+
+	// a key used elsewhere keeps the region mapped
+	KeySet * other = ksNew (1, used, KS_END);
+	ksDel (returned);
+	succeed_if (ELEKTRA_PLUGIN_FUNCTION (unmap) (plugin, NULL, parentKey) == 1, "unmap was not successful");
+	succeed_if (isMapped (used), "region of a used key was released");
+
+	// so does metadata used elsewhere
+	Key * metaUser = keyNew ("user:/metauser", KEY_END);
+	keyCopyAllMeta (metaUser, used);
+	ksDel (other);
+	succeed_if (ELEKTRA_PLUGIN_FUNCTION (unmap) (plugin, NULL, parentKey) == 1, "unmap was not successful");
+	succeed_if (isMapped (used), "region of used metadata was released");
+	succeed_if (keyGetMeta (metaUser, "a") == keyGetMeta (used, "a"), "metadata is not shared");
+
+	keyDel (metaUser);
+	succeed_if (ELEKTRA_PLUGIN_FUNCTION (unmap) (plugin, NULL, parentKey) == 1, "unmap was not successful");
+	succeed_if (!isMapped (used), "unused region was not released");
+
+	keyDel (parentKey);
+	ksDel (ks);
+	PLUGIN_CLOSE ();
+}
+
 static void test_mmap_ks_copy_with_meta (const char * tmpFile)
 {
 	Key * parentKey = keyNew (TEST_ROOT_KEY, KEY_VALUE, tmpFile, KEY_END);
@@ -1141,6 +1244,8 @@ int main (int argc, char ** argv)
 	test_mmap_meta_get_after_reopen (tmpFile);
 
 	test_mmap_metacopy (tmpFile);
+	clearStorage (tmpFile);
+	test_mmap_shared_meta (tmpFile);
 
 	clearStorage (tmpFile);
 	test_mmap_filter_meta (tmpFile);
@@ -1148,6 +1253,9 @@ int main (int argc, char ** argv)
 	clearStorage (tmpFile);
 	test_mmap_ks_copy_with_meta (tmpFile);
 
+	clearStorage (tmpFile);
+	test_mmap_unmap (tmpFile);
+
 #ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
 	clearStorage (tmpFile);
 	test_mmap_opmphm (tmpFile);
@@ -13,13 +13,40 @@
 #include <kdbhelper.h>
 
 #include <kdberrors.h>
+#include <kdbprivate.h>
 #include <stdio.h>
+#include <sys/stat.h>
 
 #define MAGIC_NUMBER_BASE (0x454b444200000000UL) // EKDB (in ASCII) + Version placeholder
 
 #define MAGIC_NUMBER_V1 ((kdb_unsigned_long_long_t) (MAGIC_NUMBER_BASE + 1))
 #define MAGIC_NUMBER_V2 ((kdb_unsigned_long_long_t) (MAGIC_NUMBER_BASE + 2))
 #define MAGIC_NUMBER_V3 ((kdb_unsigned_long_long_t) (MAGIC_NUMBER_BASE + 3))
+#define MAGIC_NUMBER_V4 ((kdb_unsigned_long_long_t) (MAGIC_NUMBER_BASE + 4))
+#define MAGIC_NUMBER_V5 ((kdb_unsigned_long_long_t) (MAGIC_NUMBER_BASE + 5))
+
+// the OPMPHM is only stored for KeySets where ksLookup () would consider building it (see opmphmPredictorActionLimit)
+#define OPMPHM_MIN_SIZE 600
+// written in native byte order, the stored OPMPHM is only used on machines with the same byte order
+#define OPMPHM_BYTE_ORDER ((uint32_t) 1)
+
+// files are only patched, if at most every PATCH_MAX_FRACTION-th Key changed ...
+#define PATCH_MAX_FRACTION 4
+// ... and the file won't contain more than PATCH_MAX_RECORDS_FACTOR records per Key afterwards
+#define PATCH_MAX_RECORDS_FACTOR 2
+
+typedef struct
+{
+	char * parentName; // the name of the parent Key of the last kdbGet ()
+	char * filename;   // the file read by the last kdbGet (), patches are written to a copy of it
+	size_t records;	   // the number of records in this file, including removed and overwritten Keys
+
+	// the file written by the last kdbSet (), it only replaces filename once it is committed (see updateRecords ())
+	bool pending;
+	size_t pendingRecords;
+	dev_t pendingDevice;
+	ino_t pendingInode;
+} QuickdumpData;
 
 struct metaLink
 {
@@ -97,65 +124,139 @@ static inline bool readStringIntoBuffer (FILE * file, struct stringbuffer * buff
 	return true;
 }
 
-int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey)
+static void freeOpmphm (Opmphm * opmphm)
 {
-	if (!elektraStrCmp (keyName (parentKey), "system:/elektra/modules/quickdump"))
+	elektraFree (opmphm->hashFunctionSeeds);
+	elektraFree (opmphm->graph);
+	elektraFree (opmphm);
+}
+
+/**
+ * Reads the OPMPHM stored in front of the Keys of a v4 file.
+ *
+ * @p opmphm is only set, if the OPMPHM was stored for the name of @p parentKey and
+ * for the byte order of this machine. Otherwise the OPMPHM is skipped.
+ *
+ * @param hashedSize set to the number of Keys the OPMPHM was built for
+ */
+static bool readOpmphm (FILE * file, Key * parentKey, Opmphm ** opmphm, kdb_unsigned_long_long_t * hashedSize)
+{
+	*opmphm = NULL;
+
+	struct stringbuffer nameBuffer;
+	setupBuffer (&nameBuffer, 64);
+
+	uint32_t byteOrder;
+	int rUniPar;
+	kdb_unsigned_long_long_t componentSize;
+	kdb_unsigned_long_long_t graphSize;
+	if (!varintRead (file, hashedSize) || !readStringIntoBuffer (file, &nameBuffer, parentKey) ||
+	    fread (&byteOrder, sizeof (uint32_t), 1, file) < 1 || (rUniPar = fgetc (file)) == EOF || rUniPar == 0 ||
+	    !varintRead (file, &componentSize))
 	{
-		KeySet * contract = ksNew (
-			30, keyNew ("system:/elektra/modules/quickdump", KEY_VALUE, "quickdump plugin waits for your orders", KEY_END),
-			keyNew ("system:/elektra/modules/quickdump/exports", KEY_END),
-			keyNew ("system:/elektra/modules/quickdump/exports/get", KEY_FUNC, elektraQuickdumpGet, KEY_END),
-			keyNew ("system:/elektra/modules/quickdump/exports/set", KEY_FUNC, elektraQuickdumpSet, KEY_END),
-#include ELEKTRA_README
-			keyNew ("system:/elektra/modules/quickdump/infos/version", KEY_VALUE, PLUGINVERSION, KEY_END), KS_END);
-		ksAppend (returned, contract);
-		ksDel (contract);
+		ELEKTRA_SET_RESOURCE_ERROR (parentKey, feof (file) ? "Premature end of file" : "Unknown error");
+		elektraFree (nameBuffer.string);
+		return false;
+	}
 
-		return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+	int32_t * seeds = elektraMalloc (rUniPar * sizeof (int32_t));
+	if (fread (seeds, sizeof (int32_t), rUniPar, file) < (size_t) rUniPar || !varintRead (file, &graphSize))
+	{
+		ELEKTRA_SET_RESOURCE_ERROR (parentKey, feof (file) ? "Premature end of file" : "Unknown error");
+		elektraFree (seeds);
+		elektraFree (nameBuffer.string);
+		return false;
 	}
-	// get all keys
 
-	FILE * file = fopen (keyString (parentKey), "rb");
+	if (componentSize == 0 || componentSize > UINT32_MAX || graphSize != rUniPar * componentSize * sizeof (uint32_t))
+	{
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERROR (parentKey, "Invalid OPMPHM");
+		elektraFree (seeds);
+		elektraFree (nameBuffer.string);
+		return false;
+	}
 
-	if (file == NULL)
+	uint32_t * graph = elektraMalloc (graphSize);
+	if (graph == NULL || fread (graph, sizeof (char), graphSize, file) < graphSize)
 	{
-		ELEKTRA_SET_ERROR_GET (parentKey);
-		return ELEKTRA_PLUGIN_STATUS_ERROR;
+		ELEKTRA_SET_RESOURCE_ERROR (parentKey, feof (file) ? "Premature end of file" : "Unknown error");
+		elektraFree (graph);
+		elektraFree (seeds);
+		elektraFree (nameBuffer.string);
+		return false;
 	}
 
-	kdb_unsigned_long_long_t magic;
-	if (fread (&magic, sizeof (kdb_unsigned_long_long_t), 1, file) < 1)
+	bool matches = byteOrder == OPMPHM_BYTE_ORDER && elektraStrCmp (nameBuffer.string, keyName (parentKey)) == 0 && *hashedSize > 0;
+	elektraFree (nameBuffer.string);
+
+	if (!matches)
 	{
-		if (feof (file) && ftell (file) == 0)
-		{
-			fclose (file);
-			return ELEKTRA_PLUGIN_STATUS_SUCCESS;
-		}
-		else
-		{
-			fclose (file);
-			return ELEKTRA_PLUGIN_STATUS_ERROR;
-		}
+		elektraFree (graph);
+		elektraFree (seeds);
+		return true;
 	}
-	magic = be64toh (magic); // magic number is written big endian so EKDB magic string is readable
 
-	switch (magic)
+	*opmphm = elektraCalloc (sizeof (Opmphm));
+	(*opmphm)->hashFunctionSeeds = seeds;
+	(*opmphm)->rUniPar = rUniPar;
+	(*opmphm)->componentSize = componentSize;
+	(*opmphm)->graph = graph;
+	(*opmphm)->size = graphSize;
+	return true;
+}
+
+/**
+ * Writes the OPMPHM of @p returned in front of the Keys of a v4 file,
+ * so that lookups after loading the file don't need to build it first.
+ */
+static bool writeOpmphm (FILE * file, const Opmphm * opmphm, KeySet * returned, Key * parentKey)
+{
+	uint32_t byteOrder = OPMPHM_BYTE_ORDER;
+	return varintWrite (file, ksGetSize (returned)) && writeData (file, keyName (parentKey), keyGetNameSize (parentKey) - 1, parentKey) &&
+	       fwrite (&byteOrder, sizeof (uint32_t), 1, file) == 1 && fputc (opmphm->rUniPar, file) != EOF &&
+	       varintWrite (file, opmphm->componentSize) &&
+	       fwrite (opmphm->hashFunctionSeeds, sizeof (int32_t), opmphm->rUniPar, file) == opmphm->rUniPar &&
+	       writeData (file, (const char *) opmphm->graph, opmphm->size, parentKey);
+}
+
+/**
+ * Returns the OPMPHM of @p returned, if it should be stored.
+ *
+ * Version 4 is only written if `/opmphm` is set, because older versions of
+ * the plugin cannot read it. Only the names of Keys below @p parentKey are restored exactly by
+ * elektraQuickdumpGet (), the OPMPHM would be useless otherwise.
+ */
+static const Opmphm * opmphmToStore (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	KeySet * config = elektraPluginGetConfig (handle);
+	if (ksLookupByName (config, "/opmphm", 0) == NULL || ksGetSize (returned) < OPMPHM_MIN_SIZE ||
+	    ksLookupByName (config, "/noparent", 0) != NULL)
 	{
-	case MAGIC_NUMBER_V1:
-		ELEKTRA_SET_RESOURCE_ERROR (parentKey, "Quickdump v1 no longer supported");
-		return ELEKTRA_PLUGIN_STATUS_ERROR;
-	case MAGIC_NUMBER_V2:
-		ELEKTRA_SET_RESOURCE_ERROR (parentKey, "Quickdump v2 no longer supported");
-		return ELEKTRA_PLUGIN_STATUS_ERROR;
-	case MAGIC_NUMBER_V3:
-		// break, current version implemented below
-		break;
-	default:
-		fclose (file);
-		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Unknown magic number " ELEKTRA_UNSIGNED_LONG_LONG_F, magic);
-		return ELEKTRA_PLUGIN_STATUS_ERROR;
+		return NULL;
 	}
 
+	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	{
+		if (keyIsBelowOrSame (parentKey, ksAtCursor (returned, it)) != 1)
+		{
+			return NULL;
+		}
+	}
+
+	return elektraKsGetOpmphm (returned);
+}
+
+/**
+ * Reads all records after the magic number from @p file.
+ *
+ * The Keys are added to @p returned with ksBuilderAdd(). Copied metadata is looked up in @p run,
+ * which contains the current run of sorted Keys. The names of removed Keys are collected in @p removed.
+ * @p file is closed in any case.
+ *
+ * @param records set to the number of records in @p file
+ */
+static int readRecords (FILE * file, KeySet * returned, KeySet * run, KeySet * removed, Key * parentKey, size_t * records)
+{
 	// setup buffers
 	struct stringbuffer valueBuffer;
 	setupBuffer (&valueBuffer, 4);
@@ -174,11 +275,14 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 	nameBuffer.string[parentSize] = '\0';	 // set new null terminator
 	nameBuffer.offset = parentSize;		 // set offset to null terminator
 
+	*records = 0;
+
 	int fc;
 	while ((fc = fgetc (file)) != EOF)
 	{
 		char c = fc;
 		ungetc (c, file);
+		++*records;
 
 		if (!readStringIntoBuffer (file, &nameBuffer, parentKey))
 		{
@@ -205,6 +309,22 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 
 		switch (type)
 		{
+		case 'r': {
+			// removed by a patch, see writePatch ()
+			if (fgetc (file) != 0)
+			{
+				elektraFree (nameBuffer.string);
+				elektraFree (metaNameBuffer.string);
+				elektraFree (valueBuffer.string);
+				fclose (file);
+				ELEKTRA_SET_VALIDATION_SYNTACTIC_ERROR (parentKey, "Missing key end");
+				return ELEKTRA_PLUGIN_STATUS_ERROR;
+			}
+
+			// applied once all records were read, unless the Key is added again
+			ksAppendKey (removed, keyNew (nameBuffer.string, KEY_END));
+			continue;
+		}
 		case 'b': {
 			// binary key value
 			kdb_unsigned_long_long_t valueSize = 0;
@@ -260,6 +380,10 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 			return ELEKTRA_PLUGIN_STATUS_ERROR;
 		}
 
+		// metadata copied completely from a single key is shared with that key
+		const Key * metaSource = NULL;
+		bool shareMeta = true;
+
 		while ((fc = fgetc (file)) != 0)
 		{
 			if (fc == EOF)
@@ -297,6 +421,7 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 				const char * metaValue = valueBuffer.string;
 
 				keySetMeta (k, metaNameBuffer.string, metaValue);
+				shareMeta = false;
 				break;
 			}
 			case 'c': {
@@ -321,7 +446,13 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 					return ELEKTRA_PLUGIN_STATUS_ERROR;
 				}
 
-				const Key * sourceKey = ksLookupByName (returned, nameBuffer.string, 0);
+				// the source Key was written by the same kdbSet (), so it is part of the current run
+				const Key * sourceKey = ksLookupByName (run, nameBuffer.string, 0);
+				if (sourceKey == NULL)
+				{
+					ksBuilderFinish (returned);
+					sourceKey = ksLookupByName (returned, nameBuffer.string, 0);
+				}
 				if (sourceKey == NULL)
 				{
 					ELEKTRA_SET_RESOURCE_ERRORF (parentKey, "Could not copy meta data from key '%s': Key not found",
@@ -345,6 +476,15 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 					fclose (file);
 					return ELEKTRA_PLUGIN_STATUS_ERROR;
 				}
+
+				if (metaSource == NULL)
+				{
+					metaSource = sourceKey;
+				}
+				else if (metaSource != sourceKey)
+				{
+					shareMeta = false;
+				}
 				break;
 			}
 			default:
@@ -358,7 +498,23 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 			}
 		}
 
-		ksAppendKey (returned, k);
+		if (shareMeta && metaSource != NULL &&
+		    ksGetSize (elektraKeyGetMetaKeySet (k)) == ksGetSize (elektraKeyGetMetaKeySet (metaSource)))
+		{
+			// all metadata Keys are already shared, now share the KeySet too
+			keyCopy (k, metaSource, KEY_CP_META);
+		}
+
+		// a later record replaces an earlier removal
+		keyDel (ksLookup (removed, k, KDB_O_POP));
+
+		// every kdbSet () writes its Keys sorted, a smaller name starts the run of the next one
+		if (ksGetSize (run) > 0 && keyCmp (ksAtCursor (run, ksGetSize (run) - 1), k) >= 0)
+		{
+			ksClear (run);
+		}
+		ksAppendKey (run, k);
+		ksBuilderAdd (returned, k);
 	}
 
 	elektraFree (nameBuffer.string);
@@ -370,181 +526,601 @@ int elektraQuickdumpGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
 }
 
-int elektraQuickdumpSet (Plugin * handle, KeySet * returned, Key * parentKey)
+/**
+ * Reads all Keys after the magic number from @p file into @p returned.
+ *
+ * ksBuilderFinish() is only called once at the end, afterwards the removal records are applied.
+ * @p file is closed in any case.
+ *
+ * @param records set to the number of records in @p file
+ */
+static int readKeys (FILE * file, KeySet * returned, Key * parentKey, size_t * records)
 {
-	FILE * file;
+	KeySet * run = ksNew (0, KS_END);
+	KeySet * removed = ksNew (0, KS_END);
 
-	// cannot open stdout for writing, because its already open
-	if (elektraStrCmp (keyString (parentKey), STDOUT_FILENAME) == 0)
+	int status = readRecords (file, returned, run, removed, parentKey, records);
+	ksBuilderFinish (returned);
+
+	if (status == ELEKTRA_PLUGIN_STATUS_SUCCESS && ksGetSize (removed) > 0)
 	{
-		file = stdout;
+		// both KeySets are sorted, so the remaining Keys are collected in a single pass
+		KeySet * kept = ksNew (ksGetSize (returned), KS_END);
+		elektraCursor next = 0;
+		for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+		{
+			Key * cur = ksAtCursor (returned, it);
+			while (next < ksGetSize (removed) && keyCmp (ksAtCursor (removed, next), cur) < 0)
+			{
+				++next;
+			}
+			if (next == ksGetSize (removed) || keyCmp (ksAtCursor (removed, next), cur) != 0)
+			{
+				ksAppendKey (kept, cur);
+			}
+		}
+		ksClear (returned);
+		ksAppend (returned, kept);
+		ksDel (kept);
 	}
-	else
+
+	ksDel (run);
+	ksDel (removed);
+	return status;
+}
+
+int elektraQuickdumpGet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	if (!elektraStrCmp (keyName (parentKey), "system:/elektra/modules/quickdump"))
 	{
-		file = fopen (keyString (parentKey), "wb");
+		KeySet * contract = ksNew (
+			30, keyNew ("system:/elektra/modules/quickdump", KEY_VALUE, "quickdump plugin waits for your orders", KEY_END),
+			keyNew ("system:/elektra/modules/quickdump/exports", KEY_END),
+			keyNew ("system:/elektra/modules/quickdump/exports/open", KEY_FUNC, elektraQuickdumpOpen, KEY_END),
+			keyNew ("system:/elektra/modules/quickdump/exports/close", KEY_FUNC, elektraQuickdumpClose, KEY_END),
+			keyNew ("system:/elektra/modules/quickdump/exports/get", KEY_FUNC, elektraQuickdumpGet, KEY_END),
+			keyNew ("system:/elektra/modules/quickdump/exports/set", KEY_FUNC, elektraQuickdumpSet, KEY_END),
+#include ELEKTRA_README
+			keyNew ("system:/elektra/modules/quickdump/infos/version", KEY_VALUE, PLUGINVERSION, KEY_END), KS_END);
+		ksAppend (returned, contract);
+		ksDel (contract);
+
+		return ELEKTRA_PLUGIN_STATUS_SUCCESS;
 	}
+	// get all keys
+
+	FILE * file = fopen (keyString (parentKey), "rb");
 
 	if (file == NULL)
 	{
-		ELEKTRA_SET_ERROR_SET (parentKey);
+		ELEKTRA_SET_ERROR_GET (parentKey);
 		return ELEKTRA_PLUGIN_STATUS_ERROR;
 	}
 
-	// magic number is written big endian so EKDB magic string is readable
-	kdb_unsigned_long_long_t magic = htobe64 (MAGIC_NUMBER_V3);
-	if (fwrite (&magic, sizeof (kdb_unsigned_long_long_t), 1, file) < 1)
+	kdb_unsigned_long_long_t magic;
+	if (fread (&magic, sizeof (kdb_unsigned_long_long_t), 1, file) < 1)
+	{
+		if (feof (file) && ftell (file) == 0)
+		{
+			fclose (file);
+			return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+		}
+		else
+		{
+			fclose (file);
+			return ELEKTRA_PLUGIN_STATUS_ERROR;
+		}
+	}
+	magic = be64toh (magic); // magic number is written big endian so EKDB magic string is readable
+
+	switch (magic)
 	{
+	case MAGIC_NUMBER_V1:
+		ELEKTRA_SET_RESOURCE_ERROR (parentKey, "Quickdump v1 no longer supported");
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	case MAGIC_NUMBER_V2:
+		ELEKTRA_SET_RESOURCE_ERROR (parentKey, "Quickdump v2 no longer supported");
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	case MAGIC_NUMBER_V3:
+	case MAGIC_NUMBER_V4:
+	case MAGIC_NUMBER_V5:
+		// break, current version implemented below
+		break;
+	default:
 		fclose (file);
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Unknown magic number " ELEKTRA_UNSIGNED_LONG_LONG_F, magic);
 		return ELEKTRA_PLUGIN_STATUS_ERROR;
 	}
 
-	struct list metaKeys;
-	metaKeys.alloc = 16;
-	metaKeys.size = 0;
-	metaKeys.array = elektraMalloc (metaKeys.alloc * sizeof (struct metaLink *));
+	// v4 is v3 with the OPMPHM in front of the Keys
+	Opmphm * opmphm = NULL;
+	kdb_unsigned_long_long_t hashedSize = 0;
+	if (magic == MAGIC_NUMBER_V4 && !readOpmphm (file, parentKey, &opmphm, &hashedSize))
+	{
+		fclose (file);
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
 
-	// we assume all keys in returned are below parentKey
-	size_t parentOffset = keyGetNameSize (parentKey);
+	ssize_t sizeBefore = ksGetSize (returned);
+	size_t records;
+	int status = readKeys (file, returned, parentKey, &records);
+
+	QuickdumpData * data = elektraPluginGetData (handle);
+	if (data != NULL && status == ELEKTRA_PLUGIN_STATUS_SUCCESS)
+	{
+		elektraFree (data->parentName);
+		elektraFree (data->filename);
+		data->parentName = elektraStrDup (keyName (parentKey));
+		data->filename = elektraStrDup (keyString (parentKey));
+		data->records = records;
+		data->pending = false;
+	}
+
+	if (opmphm != NULL)
+	{
+		// the OPMPHM only fits, if returned contains exactly the Keys of the file
+		if (status != ELEKTRA_PLUGIN_STATUS_SUCCESS || sizeBefore != 0 || (kdb_unsigned_long_long_t) ksGetSize (returned) != hashedSize ||
+		    elektraKsSetOpmphm (returned, opmphm) != 0)
+		{
+			freeOpmphm (opmphm);
+		}
+	}
+
+	return status;
+}
 
+static size_t getParentOffset (Plugin * handle, Key * parentKey)
+{
+	// we assume all keys in returned are below parentKey
 	// ... unless /noparent is in config, then we just take the full
 	// (cascading) keynames as relative to the parentKey
 	KeySet * config = elektraPluginGetConfig (handle);
-	if (ksLookupByName (config, "/noparent", 0) != NULL)
+	return ksLookupByName (config, "/noparent", 0) != NULL ? 1 : keyGetNameSize (parentKey);
+}
+
+static void freeMetaLinks (struct list * metaKeys)
+{
+	for (size_t i = 0; i < metaKeys->size; ++i)
 	{
-		parentOffset = 1;
+		elektraFree (metaKeys->array[i]);
 	}
+	elektraFree (metaKeys->array);
+}
 
-	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+static bool writeName (FILE * file, Key * cur, size_t parentOffset, Key * parentKey)
+{
+	size_t fullNameSize = keyGetNameSize (cur);
+	if (fullNameSize < parentOffset)
 	{
-		Key * cur = ksAtCursor (returned, it);
-		size_t fullNameSize = keyGetNameSize (cur);
-		if (fullNameSize < parentOffset)
+		return false;
+	}
+
+	kdb_unsigned_long_long_t nameSize = fullNameSize == parentOffset ? 0 : fullNameSize - 1 - parentOffset;
+	return writeData (file, keyName (cur) + parentOffset, nameSize, parentKey);
+}
+
+/**
+ * Writes the record of @p cur (name, value and metadata) to @p file.
+ */
+static bool writeKey (FILE * file, Key * cur, struct list * metaKeys, size_t parentOffset, Key * parentKey)
+{
+	if (!writeName (file, cur, parentOffset, parentKey))
+	{
+		return false;
+	}
+
+	if (keyIsBinary (cur))
+	{
+		if (fputc ('b', file) == EOF)
 		{
-			fclose (file);
-			return ELEKTRA_PLUGIN_STATUS_ERROR;
+			return false;
+		}
+
+		kdb_unsigned_long_long_t valueSize = keyGetValueSize (cur);
+
+		char * value = NULL;
+		if (valueSize > 0)
+		{
+			value = elektraMalloc (valueSize);
+			if (keyGetBinary (cur, value, valueSize) == -1)
+			{
+				elektraFree (value);
+				return false;
+			}
 		}
 
-		kdb_unsigned_long_long_t nameSize = fullNameSize == parentOffset ? 0 : fullNameSize - 1 - parentOffset;
-		if (!writeData (file, keyName (cur) + parentOffset, nameSize, parentKey))
+		if (!writeData (file, value, valueSize, parentKey))
 		{
-			fclose (file);
-			return ELEKTRA_PLUGIN_STATUS_ERROR;
+			elektraFree (value);
+			return false;
 		}
+		elektraFree (value);
+	}
+	else
+	{
+		if (fputc ('s', file) == EOF)
+		{
+			return false;
+		}
+
+		kdb_unsigned_long_long_t valueSize = keyGetValueSize (cur) - 1;
+		if (!writeData (file, keyString (cur), valueSize, parentKey))
+		{
+			return false;
+		}
+	}
+
+	const KeySet * metaKS = elektraKeyGetMetaKeySet (cur);
 
-		if (keyIsBinary (cur))
+	for (elektraCursor itMeta = 0; itMeta < ksGetSize (metaKS); ++itMeta)
+	{
+		const Key * meta = ksAtCursor (metaKS, itMeta);
+		ssize_t result = findMetaLink (metaKeys, meta);
+		if (result < 0)
 		{
-			if (fputc ('b', file) == EOF)
+			if (fputc ('m', file) == EOF)
 			{
-				fclose (file);
-				return ELEKTRA_PLUGIN_STATUS_ERROR;
+				return false;
 			}
 
-			kdb_unsigned_long_long_t valueSize = keyGetValueSize (cur);
-
-			char * value = NULL;
-			if (valueSize > 0)
+			// ignore meta namespace when writing to file
+			kdb_unsigned_long_long_t metaNameSize = keyGetNameSize (meta) - 1 - (sizeof ("meta:/") - 1);
+			if (!writeData (file, keyName (meta) + sizeof ("meta:/") - 1, metaNameSize, parentKey))
 			{
-				value = elektraMalloc (valueSize);
-				if (keyGetBinary (cur, value, valueSize) == -1)
-				{
-					fclose (file);
-					elektraFree (value);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
+				return false;
 			}
 
-			if (!writeData (file, value, valueSize, parentKey))
+			kdb_unsigned_long_long_t metaValueSize = keyGetValueSize (meta) - 1;
+			if (!writeData (file, keyString (meta), metaValueSize, parentKey))
 			{
-				fclose (file);
-				elektraFree (value);
-				return ELEKTRA_PLUGIN_STATUS_ERROR;
+				return false;
 			}
-			elektraFree (value);
+
+			insertMetaLink (metaKeys, -result - 1, meta, cur, parentOffset);
 		}
 		else
 		{
-			if (fputc ('s', file) == EOF)
+			if (fputc ('c', file) == EOF)
 			{
-				fclose (file);
-				return ELEKTRA_PLUGIN_STATUS_ERROR;
+				return false;
 			}
 
-			kdb_unsigned_long_long_t valueSize = keyGetValueSize (cur) - 1;
-			if (!writeData (file, keyString (cur), valueSize, parentKey))
+			kdb_unsigned_long_long_t keyNameSize = metaKeys->array[result]->keyNameSize;
+			if (!writeData (file, metaKeys->array[result]->keyName, keyNameSize, parentKey))
 			{
-				fclose (file);
-				return ELEKTRA_PLUGIN_STATUS_ERROR;
+				return false;
+			}
+
+			// ignore meta namespace when writing to file
+			kdb_unsigned_long_long_t metaNameSize = keyGetNameSize (meta) - 1 - (sizeof ("meta:/") - 1);
+			if (!writeData (file, keyName (meta) + sizeof ("meta:/") - 1, metaNameSize, parentKey))
+			{
+				return false;
 			}
 		}
+	}
 
-		KeySet * metaKS = keyMeta (cur);
+	return fputc (0, file) != EOF;
+}
 
-		for (elektraCursor itMeta = 0; itMeta < ksGetSize (metaKS); ++itMeta)
+/**
+ * Writes a record that removes @p removed from the Keys written before.
+ */
+static bool writeRemovedKey (FILE * file, Key * removed, size_t parentOffset, Key * parentKey)
+{
+	return writeName (file, removed, parentOffset, parentKey) && fputc ('r', file) != EOF && fputc (0, file) != EOF;
+}
+
+/**
+ * Copies @p source from @p offset to the end into @p file.
+ */
+static bool copyFile (FILE * source, long offset, FILE * file)
+{
+	if (fseek (source, offset, SEEK_SET) != 0)
+	{
+		return false;
+	}
+
+	char buffer[64 * 1024];
+	size_t read;
+	while ((read = fread (buffer, sizeof (char), sizeof (buffer), source)) > 0)
+	{
+		if (fwrite (buffer, sizeof (char), read, file) < read)
 		{
-			const Key * meta = ksAtCursor (metaKS, itMeta);
-			ssize_t result = findMetaLink (&metaKeys, meta);
-			if (result < 0)
-			{
-				if (fputc ('m', file) == EOF)
-				{
-					fclose (file);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
+			return false;
+		}
+	}
+	return !ferror (source);
+}
 
-				// ignore meta namespace when writing to file
-				kdb_unsigned_long_long_t metaNameSize = keyGetNameSize (meta) - 1 - (sizeof ("meta:/") - 1);
-				if (!writeData (file, keyName (meta) + sizeof ("meta:/") - 1, metaNameSize, parentKey))
-				{
-					fclose (file);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
+/**
+ * Remembers that the open @p file written by kdbSet () contains @p records records.
+ *
+ * The storage phase writes to a temporary file, which only replaces the file read by kdbGet () if
+ * kdbSet () commits. Until then, the records of the file read by kdbGet () stay the base for patches.
+ */
+static void setPendingRecords (QuickdumpData * data, FILE * file, size_t records)
+{
+	struct stat buf;
+	data->pending = fstat (fileno (file), &buf) == 0;
+	data->pendingRecords = records;
+	data->pendingDevice = data->pending ? buf.st_dev : 0;
+	data->pendingInode = data->pending ? buf.st_ino : 0;
+}
 
-				kdb_unsigned_long_long_t metaValueSize = keyGetValueSize (meta) - 1;
-				if (!writeData (file, keyString (meta), metaValueSize, parentKey))
-				{
-					fclose (file);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
+/**
+ * Takes over the records of the file written by the last kdbSet (), if it was committed,
+ * i.e. if it replaced the file read by kdbGet ().
+ */
+static void updateRecords (QuickdumpData * data)
+{
+	if (!data->pending)
+	{
+		return;
+	}
 
-				insertMetaLink (&metaKeys, -result - 1, meta, cur, parentOffset);
-			}
-			else
-			{
-				if (fputc ('c', file) == EOF)
-				{
-					fclose (file);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
+	struct stat buf;
+	if (data->filename != NULL && stat (data->filename, &buf) == 0 && buf.st_dev == data->pendingDevice &&
+	    buf.st_ino == data->pendingInode)
+	{
+		data->records = data->pendingRecords;
+	}
+	data->pending = false;
+}
 
-				kdb_unsigned_long_long_t keyNameSize = metaKeys.array[result]->keyNameSize;
-				if (!writeData (file, metaKeys.array[result]->keyName, keyNameSize, parentKey))
-				{
-					fclose (file);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
+/**
+ * Writes the file read by the last kdbGet () with the changes of @p added, @p changed and @p removed appended.
+ *
+ * @retval 1 if the patched file was written
+ * @retval 0 if the file cannot be patched, all Keys have to be written
+ * @retval -1 on errors
+ */
+static int writePatchedFile (Plugin * handle, QuickdumpData * data, KeySet * returned, KeySet * added, KeySet * changed, KeySet * removed,
+			     Key * parentKey)
+{
+	// rewrite everything, if most of the Keys changed or the file contains too many old records
+	size_t size = ksGetSize (returned);
+	size_t patchRecords = ksGetSize (added) + ksGetSize (changed) + ksGetSize (removed);
+	if (patchRecords * PATCH_MAX_FRACTION > size || data->records + patchRecords > PATCH_MAX_RECORDS_FACTOR * size)
+	{
+		return 0;
+	}
 
-				// ignore meta namespace when writing to file
-				kdb_unsigned_long_long_t metaNameSize = keyGetNameSize (meta) - 1 - (sizeof ("meta:/") - 1);
-				if (!writeData (file, keyName (meta) + sizeof ("meta:/") - 1, metaNameSize, parentKey))
-				{
-					fclose (file);
-					return ELEKTRA_PLUGIN_STATUS_ERROR;
-				}
-			}
+	FILE * source = fopen (data->filename, "rb");
+	if (source == NULL)
+	{
+		return 0;
+	}
+
+	kdb_unsigned_long_long_t magic;
+	if (fread (&magic, sizeof (kdb_unsigned_long_long_t), 1, source) < 1)
+	{
+		fclose (source);
+		return 0;
+	}
+	magic = be64toh (magic);
+
+	long keysOffset = sizeof (kdb_unsigned_long_long_t);
+	if (magic == MAGIC_NUMBER_V4)
+	{
+		// skip the OPMPHM, errors are not reported, because everything is written instead
+		Key * errorKey = keyDup (parentKey, KEY_CP_NAME);
+		Opmphm * opmphm = NULL;
+		kdb_unsigned_long_long_t hashedSize;
+		bool skipped = readOpmphm (source, errorKey, &opmphm, &hashedSize);
+		keyDel (errorKey);
+		if (opmphm != NULL)
+		{
+			freeOpmphm (opmphm);
+		}
+		if (!skipped)
+		{
+			fclose (source);
+			return 0;
 		}
+		keysOffset = ftell (source);
+	}
+	else if (magic != MAGIC_NUMBER_V3 && magic != MAGIC_NUMBER_V5)
+	{
+		fclose (source);
+		return 0;
+	}
+
+	// the stored OPMPHM only fits, if no Key was added or removed
+	kdb_unsigned_long_long_t newMagic = magic;
+	long copyOffset = sizeof (kdb_unsigned_long_long_t);
+	if (magic == MAGIC_NUMBER_V4 && (ksGetSize (added) > 0 || ksGetSize (removed) > 0))
+	{
+		newMagic = MAGIC_NUMBER_V3;
+		copyOffset = keysOffset;
+	}
+	// older versions cannot read removal records
+	if (ksGetSize (removed) > 0)
+	{
+		newMagic = MAGIC_NUMBER_V5;
+	}
+
+	FILE * file = fopen (keyString (parentKey), "wb");
+	if (file == NULL)
+	{
+		ELEKTRA_SET_ERROR_SET (parentKey);
+		fclose (source);
+		return -1;
+	}
+
+	kdb_unsigned_long_long_t magicBe = htobe64 (newMagic);
+	if (fwrite (&magicBe, sizeof (kdb_unsigned_long_long_t), 1, file) < 1 || !copyFile (source, copyOffset, file))
+	{
+		ELEKTRA_SET_RESOURCE_ERRORF (parentKey, "Could not copy '%s' to '%s'. Reason: %s", data->filename, keyString (parentKey),
+					     strerror (errno));
+		fclose (source);
+		fclose (file);
+		return -1;
+	}
+	fclose (source);
+
+	struct list metaKeys;
+	metaKeys.alloc = 16;
+	metaKeys.size = 0;
+	metaKeys.array = elektraMalloc (metaKeys.alloc * sizeof (struct metaLink *));
+
+	size_t parentOffset = getParentOffset (handle, parentKey);
+
+	// later records replace earlier ones with the same name
+	KeySet * written = ksDup (changed);
+	ksAppend (written, added);
+
+	bool success = true;
+	for (elektraCursor it = 0; success && it < ksGetSize (written); ++it)
+	{
+		success = writeKey (file, ksAtCursor (written, it), &metaKeys, parentOffset, parentKey);
+	}
+	for (elektraCursor it = 0; success && it < ksGetSize (removed); ++it)
+	{
+		success = writeRemovedKey (file, ksAtCursor (removed, it), parentOffset, parentKey);
+	}
+
+	ksDel (written);
+	freeMetaLinks (&metaKeys);
+
+	if (success)
+	{
+		setPendingRecords (data, file, data->records + patchRecords);
+	}
+	if (fclose (file) != 0 || !success)
+	{
+		data->pending = false;
+		return -1;
+	}
+
+	return 1;
+}
+
+/**
+ * Only writes the changes since the last kdbGet () or kdbSet (), if they are known (see elektraPluginGetChangeLog ()).
+ *
+ * @retval 1 if the patched file was written
+ * @retval 0 if all Keys have to be written
+ * @retval -1 on errors
+ */
+static int writePatch (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	QuickdumpData * data = elektraPluginGetData (handle);
+
+	if (data != NULL)
+	{
+		updateRecords (data);
+	}
+
+	// patches are written to a copy (e.g. the temporary file of the resolver)
+	if (data == NULL || data->filename == NULL || elektraStrCmp (data->parentName, keyName (parentKey)) != 0 ||
+	    elektraStrCmp (data->filename, keyString (parentKey)) == 0 || elektraStrCmp (keyString (parentKey), STDOUT_FILENAME) == 0)
+	{
+		return 0;
+	}
+
+	KeySet * added = ksNew (0, KS_END);
+	KeySet * changed = ksNew (0, KS_END);
+	KeySet * removed = ksNew (0, KS_END);
+
+	int ret = 0;
+	if (elektraPluginGetChangeLog (handle, returned, added, changed, removed) == 1)
+	{
+		ret = writePatchedFile (handle, data, returned, added, changed, removed, parentKey);
+	}
+
+	ksDel (added);
+	ksDel (changed);
+	ksDel (removed);
+	return ret;
+}
+
+int elektraQuickdumpOpen (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	elektraPluginSetData (handle, elektraCalloc (sizeof (QuickdumpData)));
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+int elektraQuickdumpClose (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	QuickdumpData * data = elektraPluginGetData (handle);
+	if (data != NULL)
+	{
+		elektraFree (data->parentName);
+		elektraFree (data->filename);
+		elektraFree (data);
+		elektraPluginSetData (handle, NULL);
+	}
+	return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+int elektraQuickdumpSet (Plugin * handle, KeySet * returned, Key * parentKey)
+{
+	int patched = writePatch (handle, returned, parentKey);
+	if (patched != 0)
+	{
+		return patched == 1 ? ELEKTRA_PLUGIN_STATUS_SUCCESS : ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+
+	FILE * file;
+
+	// cannot open stdout for writing, because its already open
+	if (elektraStrCmp (keyString (parentKey), STDOUT_FILENAME) == 0)
+	{
+		file = stdout;
+	}
+	else
+	{
+		file = fopen (keyString (parentKey), "wb");
+	}
+
+	if (file == NULL)
+	{
+		ELEKTRA_SET_ERROR_SET (parentKey);
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+
+	// files without OPMPHM stay v3, so that older versions can still read them
+	const Opmphm * opmphm = opmphmToStore (handle, returned, parentKey);
+
+	// magic number is written big endian so EKDB magic string is readable
+	kdb_unsigned_long_long_t magic = htobe64 (opmphm != NULL ? MAGIC_NUMBER_V4 : MAGIC_NUMBER_V3);
+	if (fwrite (&magic, sizeof (kdb_unsigned_long_long_t), 1, file) < 1)
+	{
+		fclose (file);
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
 
-		if (fputc (0, file) == EOF)
+	if (opmphm != NULL && !writeOpmphm (file, opmphm, returned, parentKey))
+	{
+		fclose (file);
+		return ELEKTRA_PLUGIN_STATUS_ERROR;
+	}
+
+	struct list metaKeys;
+	metaKeys.alloc = 16;
+	metaKeys.size = 0;
+	metaKeys.array = elektraMalloc (metaKeys.alloc * sizeof (struct metaLink *));
+
+	size_t parentOffset = getParentOffset (handle, parentKey);
+
+	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	{
+		if (!writeKey (file, ksAtCursor (returned, it), &metaKeys, parentOffset, parentKey))
 		{
+			freeMetaLinks (&metaKeys);
 			fclose (file);
 			return ELEKTRA_PLUGIN_STATUS_ERROR;
 		}
 	}
 
-	for (size_t i = 0; i < metaKeys.size; ++i)
+	freeMetaLinks (&metaKeys);
+
+	QuickdumpData * data = elektraPluginGetData (handle);
+	if (data != NULL && file != stdout)
 	{
-		elektraFree (metaKeys.array[i]);
+		setPendingRecords (data, file, ksGetSize (returned));
 	}
-	elektraFree (metaKeys.array);
 
 	fclose (file);
 
@@ -642,6 +1218,8 @@ Plugin * ELEKTRA_PLUGIN_EXPORT
 {
 	// clang-format off
 	return elektraPluginExport ("quickdump",
+				    ELEKTRA_PLUGIN_OPEN,	&elektraQuickdumpOpen,
+				    ELEKTRA_PLUGIN_CLOSE,	&elektraQuickdumpClose,
 				    ELEKTRA_PLUGIN_GET,	&elektraQuickdumpGet,
 				    ELEKTRA_PLUGIN_SET,	&elektraQuickdumpSet,
 				    ELEKTRA_PLUGIN_END);
@@ -13,6 +13,8 @@
 #include <kdbplugin.h>
 
 
+int elektraQuickdumpOpen (Plugin * handle, Key * errorKey);
+int elektraQuickdumpClose (Plugin * handle, Key * errorKey);
 int elektraQuickdumpGet (Plugin * handle, KeySet * ks, Key * parentKey);
 int elektraQuickdumpSet (Plugin * handle, KeySet * ks, Key * parentKey);
 
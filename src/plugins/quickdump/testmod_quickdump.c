@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include <kdbconfig.h>
+#include <kdbprivate.h>
 #include <kdbtypes.h>
 
 #include <tests_plugin.h>
@@ -266,6 +267,442 @@ static void test_varint (void)
 	}
 }
 
+static int read_magic_version (const char * filename)
+{
+	unsigned char magic[8] = { 0 };
+	FILE * file = fopen (filename, "rb");
+	size_t read = fread (magic, 1, sizeof (magic), file);
+	fclose (file);
+	return read == sizeof (magic) ? magic[7] : -1;
+}
+
+static void test_opmphm (void)
+{
+	printf ("test opmphm\n");
+
+	KeySet * input = ksNew (1000, KS_END);
+	char name[64];
+	for (int i = 0; i < 1000; ++i)
+	{
+		snprintf (name, sizeof (name), "dir:/tests/bench/section%d/key%d", i % 17, i);
+		ksAppendKey (input, keyNew (name, KEY_VALUE, "value", KEY_END));
+	}
+	char * outfile = elektraStrDup (elektraFilename ());
+
+	{
+		Key * setKey = keyNew ("dir:/tests/bench", KEY_VALUE, outfile, KEY_END);
+
+		KeySet * conf = ksNew (1, keyNew ("user:/opmphm", KEY_END), KS_END);
+		PLUGIN_OPEN ("quickdump");
+
+		succeed_if (plugin->kdbSet (plugin, input, setKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
+		succeed_if (read_magic_version (outfile) == 4, "OPMPHM not stored");
+#else
+		succeed_if (read_magic_version (outfile) == 3, "OPMPHM stored without optimizations");
+#endif
+
+		keyDel (setKey);
+		PLUGIN_CLOSE ();
+	}
+
+	{
+		Key * getKey = keyNew ("dir:/tests/bench", KEY_VALUE, outfile, KEY_END);
+
+		KeySet * conf = ksNew (0, KS_END);
+		PLUGIN_OPEN ("quickdump");
+
+		KeySet * actual = ksNew (0, KS_END);
+		succeed_if (plugin->kdbGet (plugin, actual, getKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
+		succeed_if (actual->opmphm != NULL && actual->opmphm->size > 0, "OPMPHM not restored");
+#endif
+		compare_keyset (input, actual);
+		for (elektraCursor it = 0; it < ksGetSize (input); ++it)
+		{
+			Key * key = ksAtCursor (input, it);
+			succeed_if (ksLookup (actual, key, 0) != NULL, "lookup with restored OPMPHM failed");
+		}
+		Key * missing = keyNew ("dir:/tests/bench/section0/missing", KEY_END);
+		succeed_if (ksLookup (actual, missing, 0) == NULL, "found missing key");
+		keyDel (missing);
+		ksDel (actual);
+
+		// the OPMPHM does not fit, if the KeySet was not empty
+		actual = ksNew (1, keyNew ("dir:/tests/bench/other", KEY_END), KS_END);
+		succeed_if (plugin->kdbGet (plugin, actual, getKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+		succeed_if (ksGetSize (actual) == 1001, "wrong size");
+		succeed_if (ksLookupByName (actual, "dir:/tests/bench/section3/key3", 0) != NULL, "lookup failed");
+		ksDel (actual);
+
+		// the OPMPHM does not fit for other parents
+		keySetName (getKey, "dir:/tests/other");
+		actual = ksNew (0, KS_END);
+		succeed_if (plugin->kdbGet (plugin, actual, getKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+		succeed_if (ksLookupByName (actual, "dir:/tests/other/section3/key3", 0) != NULL, "lookup failed");
+		ksDel (actual);
+
+		keyDel (getKey);
+		PLUGIN_CLOSE ();
+	}
+
+	{
+		Key * setKey = keyNew ("dir:/tests/bench", KEY_VALUE, outfile, KEY_END);
+
+		KeySet * conf = ksNew (0, KS_END);
+		PLUGIN_OPEN ("quickdump");
+
+		succeed_if (plugin->kdbSet (plugin, input, setKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+		succeed_if (read_magic_version (outfile) == 3, "OPMPHM stored without /opmphm");
+
+		keyDel (setKey);
+		PLUGIN_CLOSE ();
+	}
+
+	remove (outfile);
+
+	elektraFree (outfile);
+	ksDel (input);
+}
+
+static void test_sharedMeta (void)
+{
+	printf ("test shared meta\n");
+
+	Key * spec = keyNew ("/", KEY_META, "type", "long", KEY_META, "default", "5", KEY_END);
+	KeySet * input = ksNew (100, KS_END);
+	char name[64];
+	for (int i = 0; i < 100; ++i)
+	{
+		snprintf (name, sizeof (name), "dir:/tests/bench/key%d", i);
+		Key * key = keyNew (name, KEY_VALUE, "value", KEY_END);
+		keyCopyAllMeta (key, spec);
+		ksAppendKey (input, key);
+	}
+	// only partially shared
+	keySetMeta (ksLookupByName (input, "dir:/tests/bench/key50", 0), "type", "string");
+	keyDel (spec);
+
+	char * outfile = elektraStrDup (elektraFilename ());
+	Key * parentKey = keyNew ("dir:/tests/bench", KEY_VALUE, outfile, KEY_END);
+
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("quickdump");
+
+	succeed_if (plugin->kdbSet (plugin, input, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+	succeed_if (elektraKeyGetMetaKeySet (ksAtCursor (input, 0)) == elektraKeyGetMetaKeySet (ksAtCursor (input, 99)),
+		    "kdbSet unshared metadata");
+
+	KeySet * actual = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, actual, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+
+	const KeySet * shared = elektraKeyGetMetaKeySet (ksLookupByName (actual, "dir:/tests/bench/key0", 0));
+	succeed_if (elektraKeyGetMetaKeySet (ksLookupByName (actual, "dir:/tests/bench/key99", 0)) == shared, "metadata not shared");
+	succeed_if (elektraKeyGetMetaKeySet (ksLookupByName (actual, "dir:/tests/bench/key50", 0)) != shared,
+		    "changed metadata shared");
+	succeed_if (shared->shares == 99, "wrong number of Keys sharing the metadata");
+
+	// compares the metadata with keyMeta(), which unshares it
+	compare_keyset (input, actual);
+
+	ksDel (actual);
+	remove (outfile);
+
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+
+	elektraFree (outfile);
+	ksDel (input);
+}
+
+static long file_size (const char * filename)
+{
+	FILE * file = fopen (filename, "rb");
+	fseek (file, 0, SEEK_END);
+	long size = ftell (file);
+	fclose (file);
+	return size;
+}
+
+static KeySet * read_file (const char * filename, const char * parentName)
+{
+	Key * parentKey = keyNew (parentName, KEY_VALUE, filename, KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("quickdump");
+
+	KeySet * ks = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+	return ks;
+}
+
+/**
+ * Like kdbSet () does: sets up the change log relative to @p stored and writes @p returned to @p filename
+ */
+static void set_with_change_log (Plugin * plugin, KeySet * stored, KeySet * returned, const char * filename)
+{
+	ElektraKdbPhase phase = ELEKTRA_KDB_SET_PHASE_STORAGE;
+	ksAppendKey (plugin->global, keyNew ("system:/elektra/kdb/backend/phase", KEY_BINARY, KEY_SIZE, sizeof (ElektraKdbPhase), KEY_VALUE,
+					     &phase, KEY_END));
+	ksAppendKey (plugin->global, keyNew ("system:/elektra/kdb/backend/storedkeys", KEY_BINARY, KEY_SIZE, sizeof (stored), KEY_VALUE,
+					     &stored, KEY_END));
+
+	Key * parentKey = keyNew ("dir:/tests/bench", KEY_VALUE, filename, KEY_END);
+	succeed_if (plugin->kdbSet (plugin, returned, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+	succeed_if (keyGetMeta (parentKey, "error") == NULL, "kdbSet reported an error");
+	keyDel (parentKey);
+
+	keyDel (ksLookupByName (plugin->global, "system:/elektra/kdb/backend/storedkeys", KDB_O_POP));
+}
+
+static KeySet * dup_without_sync (KeySet * ks)
+{
+	KeySet * dup = ksDeepDup (ks);
+	for (elektraCursor it = 0; it < ksGetSize (dup); ++it)
+	{
+		clear_bit (ksAtCursor (dup, it)->flags, KEY_FLAG_SYNC);
+	}
+	return dup;
+}
+
+static void test_patch (void)
+{
+	printf ("test patch\n");
+
+	KeySet * input = ksNew (1000, KS_END);
+	char name[64];
+	for (int i = 0; i < 1000; ++i)
+	{
+		snprintf (name, sizeof (name), "dir:/tests/bench/section%d/key%d", i % 17, i);
+		ksAppendKey (input, keyNew (name, KEY_VALUE, "value", KEY_META, "type", "string", KEY_END));
+	}
+	char * infile = elektraStrDup (elektraFilename ());
+	char * outfile = elektraFormat ("%s.patched", infile);
+
+	KeySet * conf = ksNew (1, keyNew ("user:/opmphm", KEY_END), KS_END);
+	PLUGIN_OPEN ("quickdump");
+	plugin->global = ksNew (0, KS_END);
+
+	Key * parentKey = keyNew ("dir:/tests/bench", KEY_VALUE, infile, KEY_END);
+	succeed_if (plugin->kdbSet (plugin, input, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+	int fullVersion = read_magic_version (infile);
+	long fullSize = file_size (infile);
+
+	// the file read by kdbGet is patched, like the temporary file of the resolver would be
+	KeySet * stored = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, stored, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+	keyDel (parentKey);
+
+	// only changed values: the OPMPHM still fits
+	KeySet * returned = dup_without_sync (stored);
+	keySetString (ksLookupByName (returned, "dir:/tests/bench/section1/key1", 0), "changed");
+	keySetMeta (ksLookupByName (returned, "dir:/tests/bench/section2/key2", 0), "type", "long");
+	set_with_change_log (plugin, stored, returned, outfile);
+	succeed_if (read_magic_version (outfile) == fullVersion, "version changed by patch with changed values");
+	succeed_if (file_size (outfile) > fullSize && file_size (outfile) < fullSize + 100, "not only the changes were written");
+
+	KeySet * actual = read_file (outfile, "dir:/tests/bench");
+	compare_keyset (returned, actual);
+	succeed_if (fullVersion != 4 || (actual->opmphm != NULL && actual->opmphm->size > 0), "OPMPHM not restored");
+	succeed_if (ksLookupByName (actual, "dir:/tests/bench/section1/key1", 0) != NULL, "lookup with restored OPMPHM failed");
+	ksDel (actual);
+
+	// added and removed Keys
+	ksDel (returned);
+	returned = dup_without_sync (stored);
+	ksAppendKey (returned, keyNew ("dir:/tests/bench/section0/added", KEY_VALUE, "new", KEY_END));
+	keyDel (ksLookupByName (returned, "dir:/tests/bench/section3/key3", KDB_O_POP));
+	set_with_change_log (plugin, stored, returned, outfile);
+	succeed_if (read_magic_version (outfile) == 5, "removal records need version 5");
+	succeed_if (file_size (outfile) < fullSize + 100, "not only the changes were written");
+
+	actual = read_file (outfile, "dir:/tests/bench");
+	compare_keyset (returned, actual);
+	succeed_if (ksLookupByName (actual, "dir:/tests/bench/section3/key3", 0) == NULL, "removed key read");
+	ksDel (actual);
+
+	// too many changes: everything is written
+	ksDel (returned);
+	returned = dup_without_sync (stored);
+	for (elektraCursor it = 0; it < ksGetSize (returned); it += 2)
+	{
+		keySetString (ksAtCursor (returned, it), "changed");
+	}
+	set_with_change_log (plugin, stored, returned, outfile);
+	succeed_if (read_magic_version (outfile) == fullVersion, "everything should be written");
+
+	actual = read_file (outfile, "dir:/tests/bench");
+	compare_keyset (returned, actual);
+	ksDel (actual);
+
+	// without change log: everything is written
+	ksDel (returned);
+	returned = dup_without_sync (stored);
+	ksAppendKey (returned, keyNew ("dir:/tests/bench/section0/added", KEY_VALUE, "new", KEY_END));
+	set_with_change_log (plugin, NULL, returned, outfile);
+	succeed_if (read_magic_version (outfile) == fullVersion, "everything should be written");
+
+	actual = read_file (outfile, "dir:/tests/bench");
+	compare_keyset (returned, actual);
+	ksDel (actual);
+
+	ksDel (returned);
+	ksDel (stored);
+	ksDel (plugin->global);
+	PLUGIN_CLOSE ();
+
+	remove (infile);
+	remove (outfile);
+	elektraFree (infile);
+	elektraFree (outfile);
+	ksDel (input);
+}
+
+static void change_values (KeySet * ks, int count, int round)
+{
+	char value[64];
+	snprintf (value, sizeof (value), "changed%d", round);
+	for (elektraCursor it = 0; it < count; ++it)
+	{
+		keySetString (ksAtCursor (ks, it), value);
+	}
+}
+
+static void test_patchCommit (void)
+{
+	printf ("test patch commit\n");
+
+	KeySet * input = ksNew (1000, KS_END);
+	char name[64];
+	for (int i = 0; i < 1000; ++i)
+	{
+		snprintf (name, sizeof (name), "dir:/tests/bench/section%d/key%d", i % 17, i);
+		ksAppendKey (input, keyNew (name, KEY_VALUE, "value", KEY_END));
+	}
+	char * infile = elektraStrDup (elektraFilename ());
+	char * outfile = elektraFormat ("%s.patched", infile);
+
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("quickdump");
+	plugin->global = ksNew (0, KS_END);
+
+	Key * parentKey = keyNew ("dir:/tests/bench", KEY_VALUE, infile, KEY_END);
+	succeed_if (plugin->kdbSet (plugin, input, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+	long fullSize = file_size (infile);
+
+	KeySet * stored = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, stored, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+	keyDel (parentKey);
+
+	// patches that are never committed must not count towards the records of the file read by kdbGet
+	for (int round = 0; round < 8; ++round)
+	{
+		KeySet * returned = dup_without_sync (stored);
+		change_values (returned, 200, round);
+		set_with_change_log (plugin, stored, returned, outfile);
+		succeed_if (file_size (outfile) > fullSize + 1000, "uncommitted patch caused a full rewrite");
+		ksDel (returned);
+	}
+
+	// committed patches (the resolver renames the temporary file) add up, until everything is written again
+	for (int round = 0; round < 7; ++round)
+	{
+		KeySet * returned = dup_without_sync (stored);
+		change_values (returned, 200, round);
+		set_with_change_log (plugin, stored, returned, outfile);
+		bool patched = file_size (outfile) > file_size (infile);
+		succeed_if (patched == (round != 5), round == 5 ? "file with too many records was patched" : "file was not patched");
+		succeed_if (rename (outfile, infile) == 0, "could not commit file");
+
+		KeySet * actual = read_file (infile, "dir:/tests/bench");
+		compare_keyset (returned, actual);
+		ksDel (actual);
+
+		ksDel (stored);
+		stored = dup_without_sync (returned);
+		ksDel (returned);
+	}
+
+	ksDel (stored);
+	ksDel (plugin->global);
+	PLUGIN_CLOSE ();
+
+	remove (infile);
+	remove (outfile);
+	elektraFree (infile);
+	elektraFree (outfile);
+	ksDel (input);
+}
+
+static void test_patchReadd (void)
+{
+	printf ("test patch readd\n");
+
+	KeySet * input = ksNew (1000, KS_END);
+	char name[64];
+	for (int i = 0; i < 1000; ++i)
+	{
+		snprintf (name, sizeof (name), "dir:/tests/bench/section%d/key%d", i % 17, i);
+		ksAppendKey (input, keyNew (name, KEY_VALUE, "value", KEY_END));
+	}
+	char * infile = elektraStrDup (elektraFilename ());
+	char * outfile = elektraFormat ("%s.patched", infile);
+
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("quickdump");
+	plugin->global = ksNew (0, KS_END);
+
+	Key * parentKey = keyNew ("dir:/tests/bench", KEY_VALUE, infile, KEY_END);
+	succeed_if (plugin->kdbSet (plugin, input, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+
+	KeySet * stored = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, stored, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+	keyDel (parentKey);
+
+	// the first patch removes a Key
+	KeySet * returned = dup_without_sync (stored);
+	keyDel (ksLookupByName (returned, "dir:/tests/bench/section3/key3", KDB_O_POP));
+	set_with_change_log (plugin, stored, returned, outfile);
+	succeed_if (read_magic_version (outfile) == 5, "removal records need version 5");
+	succeed_if (rename (outfile, infile) == 0, "could not commit file");
+	ksDel (stored);
+	stored = dup_without_sync (returned);
+	ksDel (returned);
+
+	// the second patch adds it again, together with Keys whose metadata is written as copy records
+	returned = dup_without_sync (stored);
+	Key * source = keyNew ("dir:/tests/bench/section0/added", KEY_VALUE, "new", KEY_META, "type", "string", KEY_END);
+	Key * copy = keyNew ("dir:/tests/bench/section0/added2", KEY_VALUE, "new", KEY_END);
+	keyCopyMeta (copy, source, "type");
+	ksAppendKey (returned, source);
+	ksAppendKey (returned, copy);
+	ksAppendKey (returned, keyNew ("dir:/tests/bench/section3/key3", KEY_VALUE, "again", KEY_END));
+	set_with_change_log (plugin, stored, returned, outfile);
+	succeed_if (file_size (outfile) < file_size (infile) + 200, "not only the changes were written");
+	succeed_if (rename (outfile, infile) == 0, "could not commit file");
+
+	KeySet * actual = read_file (infile, "dir:/tests/bench");
+	compare_keyset (returned, actual);
+	succeed_if_same_string (keyString (ksLookupByName (actual, "dir:/tests/bench/section3/key3", 0)), "again");
+	succeed_if (keyGetMeta (ksLookupByName (actual, "dir:/tests/bench/section0/added2", 0), "type") ==
+			    keyGetMeta (ksLookupByName (actual, "dir:/tests/bench/section0/added", 0), "type"),
+		    "copied metadata not shared");
+	ksDel (actual);
+
+	ksDel (returned);
+	ksDel (stored);
+	ksDel (plugin->global);
+	PLUGIN_CLOSE ();
+
+	remove (infile);
+	remove (outfile);
+	elektraFree (infile);
+	elektraFree (outfile);
+	ksDel (input);
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("QUICKDUMP     TESTS\n");
@@ -278,6 +715,11 @@ int main (int argc, char ** argv)
 	test_basics ();
 	test_noParent ();
 	test_parentKeyValue ();
+	test_opmphm ();
+	test_sharedMeta ();
+	test_patch ();
+	test_patchCommit ();
+	test_patchReadd ();
 
 	print_result ("testmod_quickdump");
 
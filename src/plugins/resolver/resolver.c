@@ -11,7 +11,7 @@
 #include <kdbassert.h>
 #include <kdbconfig.h>
 #include <kdbhelper.h>	// elektraStrDup
-#include <kdbprivate.h> // KDB_CACHE_PREFIX
+#include <kdbprivate.h>
 
 #include "kdbos.h"
 
@@ -413,23 +413,68 @@ static int mapFilesForNamespaces (resolverHandles * p, Key * errorKey)
 }
 
 /**
- * @brief Generate key name for the cache
+ * @brief Generate the cache handle for the resolved file
  *
- * @param filename the name of the config file
- * @ret pointer to the generated key name
+ * The cache handle is the modification time of the file. It is only
+ * generated if the file system provides modification times with
+ * nanosecond precision, otherwise the modification time is not
+ * accurate enough to detect changes.
+ *
+ * @param pk the resolver handle with the modification time
+ * @param buffer receives the cache handle
+ * @param size the size of @p buffer
+ *
+ * @retval 1 if the cache handle was generated
+ * @retval 0 if there is no cache handle for the file
  */
-static char * elektraCacheKeyName (char * filename)
+static int elektraResolverCacheHandle (resolverHandle * pk, char * buffer, size_t size)
 {
-	char * name = 0;
-	size_t len = strlen (KDB_CACHE_PREFIX) + strlen ("/") + strlen (ELEKTRA_PLUGIN_NAME) + strlen (filename) + 1;
-	name = elektraMalloc (len);
-	name = strcpy (name, KDB_CACHE_PREFIX);
-	name = strcat (name, "/");
-	name = strcat (name, ELEKTRA_PLUGIN_NAME);
-	name = strcat (name, filename);
-
-	ELEKTRA_LOG_DEBUG ("persistent chid key: %s", name);
-	return name;
+	if (pk->isMissing || pk->mtime.tv_nsec == 0)
+	{
+		return 0;
+	}
+
+	snprintf (buffer, size, "%lld.%09ld", (long long) pk->mtime.tv_sec, (long) pk->mtime.tv_nsec);
+	return 1;
+}
+
+/**
+ * @brief Check if the cache entry for the resolved file is still valid
+ *
+ * Called during the cachecheck phase, which directly follows the
+ * resolver phase. Therefore, the modification time remembered in
+ * the resolver phase is still current.
+ *
+ * @param pk the resolver handle with the modification time
+ * @param parentKey holds the cache handle of the cache entry in `meta:/internal/kdb/cachehandle`
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_CACHE_HIT if the cache entry is valid
+ * @retval ELEKTRA_PLUGIN_STATUS_NO_UPDATE if the cache entry must not be used
+ */
+static int elektraResolverCacheCheck (resolverHandle * pk, Key * parentKey)
+{
+	char cacheHandle[ELEKTRA_RESOLVER_CACHE_HANDLE_SIZE];
+	const Key * cachedHandle = keyGetMeta (parentKey, "meta:/internal/kdb/cachehandle");
+	if (cachedHandle == NULL || !elektraResolverCacheHandle (pk, cacheHandle, sizeof (cacheHandle)))
+	{
+		return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+	}
+
+	if (strcmp (keyString (cachedHandle), cacheHandle) != 0)
+	{
+		ELEKTRA_LOG_DEBUG ("global-cache: cache entry outdated, cached: %s, file: %s", keyString (cachedHandle), cacheHandle);
+		return ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+	}
+
+	ELEKTRA_LOG_DEBUG ("global-cache: no update needed, everything is fine");
+	return ELEKTRA_PLUGIN_STATUS_CACHE_HIT;
+}
+
+static int isCacheCheckPhase (Plugin * handle)
+{
+	KeySet * global = elektraPluginGetGlobalKeySet (handle);
+	return global != NULL && ksLookupByName (global, "system:/elektra/kdb/backend/phase", 0) != NULL &&
+	       elektraPluginGetPhase (handle) == ELEKTRA_KDB_GET_PHASE_CACHECHECK;
 }
 
 static int initHandles (Plugin * handle, Key * parentKey)
@@ -540,6 +585,12 @@ int ELEKTRA_PLUGIN_FUNCTION (get) (Plugin * handle, KeySet * returned, Key * par
 	}
 
 	resolverHandle * pk = elektraGetResolverHandle (handle, parentKey);
+
+	if (isCacheCheckPhase (handle))
+	{
+		return elektraResolverCacheCheck (pk, parentKey);
+	}
+
 	keySetString (parentKey, pk->filename);
 
 	int errnoSave = errno;
@@ -575,52 +626,16 @@ int ELEKTRA_PLUGIN_FUNCTION (get) (Plugin * handle, KeySet * returned, Key * par
 		return 0;
 	}
 
-	/* Check if cache update needed */
-	KeySet * global;
-	char * name = elektraCacheKeyName (pk->filename);
-
-
-	if ((global = elektraPluginGetGlobalKeySet (handle)) != NULL && ELEKTRA_STAT_NANO_SECONDS (buf) != 0)
-	{
-		// TODO [new_backend]: implement cache
-		/*
-		ELEKTRA_LOG_DEBUG ("global-cache: check cache update needed?");
-		Key * time = ksLookupByName (global, name, KDB_O_NONE);
-		if (time && keyGetValueSize (time) == sizeof (struct timespec))
-		{
-			struct timespec cached;
-			keyGetBinary (time, &cached, sizeof (struct timespec));
-			if (cached.tv_sec == ELEKTRA_STAT_SECONDS (buf) && cached.tv_nsec == ELEKTRA_STAT_NANO_SECONDS (buf))
-			{
-				ELEKTRA_LOG_DEBUG ("global-cache: no update needed, everything is fine");
-				ELEKTRA_LOG_DEBUG ("cached.tv_sec:\t%ld", cached.tv_sec);
-				ELEKTRA_LOG_DEBUG ("cached.tv_nsec:\t%ld", cached.tv_nsec);
-				ELEKTRA_LOG_DEBUG ("buf.tv_sec:\t%ld", ELEKTRA_STAT_SECONDS (buf));
-				ELEKTRA_LOG_DEBUG ("buf.tv_nsec:\t%ld", ELEKTRA_STAT_NANO_SECONDS (buf));
-				// update timestamp inside resolver
-				pk->mtime.tv_sec = ELEKTRA_STAT_SECONDS (buf);
-				pk->mtime.tv_nsec = ELEKTRA_STAT_NANO_SECONDS (buf);
-
-				if (name) elektraFree (name);
-				errno = errnoSave;
-				return ELEKTRA_PLUGIN_STATUS_CACHE_HIT;
-			}
-		}
-		*/
-	}
-
 	pk->mtime.tv_sec = ELEKTRA_STAT_SECONDS (buf);
 	pk->mtime.tv_nsec = ELEKTRA_STAT_NANO_SECONDS (buf);
 
-	/* Persist modification times for cache */
-	if (global != NULL && ELEKTRA_STAT_NANO_SECONDS (buf) != 0)
+	/* Tell libelektra-kdb how to identify this version of the file in the cache */
+	char cacheHandle[ELEKTRA_RESOLVER_CACHE_HANDLE_SIZE];
+	if (elektraResolverCacheHandle (pk, cacheHandle, sizeof (cacheHandle)))
 	{
-		ELEKTRA_LOG_DEBUG ("global-cache: adding file modification times");
-		Key * time = keyNew (name, KEY_BINARY, KEY_SIZE, sizeof (struct timespec), KEY_VALUE, &(pk->mtime), KEY_END);
-		ksAppendKey (global, time);
+		keySetMeta (parentKey, "meta:/internal/kdb/cachehandle", cacheHandle);
 	}
 
-	if (name) elektraFree (name);
 	errno = errnoSave;
 	return 1;
 }
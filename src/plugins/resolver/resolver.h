@@ -21,6 +21,7 @@
 #include <unistd.h>
 
 #define ERROR_SIZE 1024
+#define ELEKTRA_RESOLVER_CACHE_HANDLE_SIZE 64
 
 typedef struct _resolverHandle resolverHandle;
 
@@ -16,6 +16,7 @@
 #include <kdbhelper.h>
 #include <kdblogger.h>
 #include <kdbmeta.h>
+#include <kdbprivate.h>
 #include <kdbtypes.h>
 
 #ifndef __MINGW32__
@@ -101,6 +102,42 @@ static inline void safeFree (void * ptr)
 	}
 }
 
+static void appendHierarchy (KeySet * result, KeySet * ks, const Key * root)
+{
+	elektraCursor end;
+	for (elektraCursor it = ksFindHierarchy (ks, root, &end); it < end; ++it)
+	{
+		ksAppendKey (result, ksAtCursor (ks, it));
+	}
+}
+
+/**
+ * Returns the keys of @p ks that ksCut() would cut with @p cutpoint,
+ * without removing them from @p ks.
+ */
+static KeySet * ksCutCopy (KeySet * ks, const Key * cutpoint)
+{
+	KeySet * result = ksNew (0, KS_END);
+	if (keyGetNamespace (cutpoint) != KEY_NS_CASCADING)
+	{
+		appendHierarchy (result, ks, cutpoint);
+		return result;
+	}
+
+	// same namespaces as ksCut() uses for a cascading cutpoint
+	static const elektraNamespace namespaces[] = { KEY_NS_SPEC,   KEY_NS_PROC, KEY_NS_DIR,	     KEY_NS_USER,
+						       KEY_NS_SYSTEM, KEY_NS_META, KEY_NS_CASCADING };
+
+	Key * lookup = keyDup (cutpoint, KEY_CP_NAME);
+	for (size_t i = 0; i < sizeof (namespaces) / sizeof (namespaces[0]); ++i)
+	{
+		keySetNamespace (lookup, namespaces[i]);
+		appendHierarchy (result, ks, lookup);
+	}
+	keyDel (lookup);
+	return result;
+}
+
 /*  region Config parsing    */
 /* ========================= */
 
@@ -471,10 +508,7 @@ static void validateEmptyArray (KeySet * ks, Key * arraySpecParent, Key * parent
 		arrayParent = keyNew (keyName (parentLookup), KEY_END);
 	}
 
-	// TODO: [improvement] ksExtract?, like ksCut, but doesn't remove -> no need for ksDup
-	KeySet * ksCopy = ksDup (ks);
-	KeySet * subKeys = ksCut (ksCopy, parentLookup);
-	ksDel (ksCopy);
+	KeySet * subKeys = ksCutCopy (ks, parentLookup);
 
 	ssize_t parentLen = keyGetUnescapedNameSize (parentLookup);
 
@@ -536,10 +570,7 @@ static void validateArrayMembers (KeySet * ks, Key * arraySpec)
 		return;
 	}
 
-	// TODO: [improvement] ksExtract?, like ksCut, but doesn't remove -> no need for ksDup
-	KeySet * ksCopy = ksDup (ks);
-	KeySet * subKeys = ksCut (ksCopy, parentLookup);
-	ksDel (ksCopy);
+	KeySet * subKeys = ksCutCopy (ks, parentLookup);
 
 	ssize_t parentLen = keyGetUnescapedNameSize (parentLookup);
 
@@ -723,10 +754,7 @@ static void validateWildcardSubs (KeySet * ks, Key * key)
 	Key * parent = keyDup (key, KEY_CP_ALL);
 	keySetBaseName (parent, NULL);
 
-	// TODO: [improvement] ksExtract?, like ksCut, but doesn't remove -> no need for ksDup
-	KeySet * ksCopy = ksDup (ks);
-	KeySet * subKeys = ksCut (ksCopy, parent);
-	ksDel (ksCopy);
+	KeySet * subKeys = ksCutCopy (ks, parent);
 
 	for (elektraCursor it = 0; it < ksGetSize (subKeys); ++it)
 	{
@@ -747,12 +775,32 @@ static void validateWildcardSubs (KeySet * ks, Key * key)
 
 // endregion Wildcard (_) handling
 
+/**
+ * Checks whether @p meta contains @p name or any metadata below it
+ */
+static bool hasMetaBelow (const KeySet * meta, const char * name)
+{
+	Key * root = keyNew (name, KEY_END);
+	elektraCursor pos = ksFindHierarchy (meta, root, NULL);
+	keyDel (root);
+	return pos >= 0 && pos < ksGetSize (meta);
+}
+
 /**
  * Copies all metadata (except for internal/ and conflict/) from @p dest to @p src
  */
 static void copyMeta (Key * dest, Key * src)
 {
-	KeySet * metaKS = ksDup (keyMeta (src));
+	const KeySet * srcMeta = elektraKeyGetMetaKeySet (src);
+	if (ksGetSize (elektraKeyGetMetaKeySet (dest)) <= 0 && !hasMetaBelow (srcMeta, "meta:/internal") &&
+	    !hasMetaBelow (srcMeta, "meta:/conflict"))
+	{
+		// no conflicts possible, dest shares the metadata of src until one of them changes it
+		keyCopyAllMeta (dest, src);
+		return;
+	}
+
+	KeySet * metaKS = ksDup (srcMeta);
 
 	Key * cutpoint = keyNew ("meta:/internal", KEY_END);
 	ksDel (ksCut (metaKS, cutpoint)); // don't care for internal stuff
@@ -791,19 +839,262 @@ static void copyMeta (Key * dest, Key * src)
 	ksDel (metaKS);
 }
 
+/* region Spec matching index              */
+/* ========================================= */
+
+/**
+ * A node of the spec matching index.
+ *
+ * Each node stands for one part of the names of the indexed spec keys
+ * (without namespace). Literal parts are stored sorted in `literals`,
+ * a `_` part is stored as `wildcard`.
+ */
+typedef struct _SpecIndexNode SpecIndexNode;
+
+struct _SpecIndexNode
+{
+	char * part;
+	SpecIndexNode ** literals;
+	size_t literalsSize;
+	SpecIndexNode * wildcard;
+	elektraCursor spec; ///< position of the spec key ending in this node or -1
+};
+
+/**
+ * Index of the spec keys, which finds all spec keys matching a key in one
+ * descent instead of calling specMatches() for every pair of spec key and key.
+ *
+ * Array specs are not matched at all and spec keys using other globbing
+ * features are not indexed, their matches are collected with specMatches().
+ */
+typedef struct
+{
+	SpecIndexNode * root;
+	size_t nodes;
+	KeySet ** matches; ///< for every spec key the matching keys, if the spec key is indexed
+	bool * indexed;
+	size_t size;
+
+	SpecIndexNode ** current;
+	SpecIndexNode ** next;
+	char * name;
+	size_t nameSize;
+} SpecIndex;
+
+static SpecIndexNode * newSpecIndexNode (const char * part, size_t length)
+{
+	SpecIndexNode * node = elektraCalloc (sizeof (SpecIndexNode));
+	node->part = elektraMalloc (length + 1);
+	memcpy (node->part, part, length);
+	node->part[length] = '\0';
+	node->spec = -1;
+	return node;
+}
+
+static void delSpecIndexNode (SpecIndexNode * node)
+{
+	for (size_t i = 0; i < node->literalsSize; ++i)
+	{
+		delSpecIndexNode (node->literals[i]);
+	}
+	if (node->wildcard != NULL) delSpecIndexNode (node->wildcard);
+	elektraFree (node->literals);
+	elektraFree (node->part);
+	elektraFree (node);
+}
+
+/**
+ * @return position of the literal child @p part or the position where it has to be inserted
+ */
+static size_t findLiteral (const SpecIndexNode * node, const char * part, size_t length, bool * found)
+{
+	size_t low = 0;
+	size_t high = node->literalsSize;
+	while (low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		const char * cur = node->literals[mid]->part;
+		int cmp = strncmp (cur, part, length);
+		if (cmp == 0) cmp = cur[length] == '\0' ? 0 : 1;
+		if (cmp == 0)
+		{
+			*found = true;
+			return mid;
+		}
+		if (cmp < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	*found = false;
+	return low;
+}
+
+static SpecIndexNode * addSpecIndexChild (SpecIndex * index, SpecIndexNode * node, const char * part, size_t length)
+{
+	if (length == 1 && part[0] == '_')
+	{
+		if (node->wildcard == NULL)
+		{
+			node->wildcard = newSpecIndexNode (part, length);
+			++index->nodes;
+		}
+		return node->wildcard;
+	}
+
+	bool found;
+	size_t pos = findLiteral (node, part, length, &found);
+	if (found) return node->literals[pos];
+
+	SpecIndexNode * child = newSpecIndexNode (part, length);
+	elektraRealloc ((void **) &node->literals, (node->literalsSize + 1) * sizeof (SpecIndexNode *));
+	memmove (node->literals + pos + 1, node->literals + pos, (node->literalsSize - pos) * sizeof (SpecIndexNode *));
+	node->literals[pos] = child;
+	++node->literalsSize;
+	++index->nodes;
+	return child;
+}
+
+/**
+ * Checks whether specMatches() for @p specKey can be answered by the index,
+ * i.e. the name contains no globbing characters other than `_` parts.
+ */
+static bool isIndexable (const Key * specKey)
+{
+#ifdef __MINGW32__
+	(void) specKey;
+	return false; // specMatches() doesn't use globbing
+#else
+	const char * name = strchr (keyName (specKey), '/');
+	size_t len = strlen (name);
+	return strpbrk (name, "*?[\\") == NULL && (len < 3 || strcmp (name + len - 3, "/__") != 0);
+#endif
+}
+
+static SpecIndex * buildSpecIndex (KeySet * specKS)
+{
+	SpecIndex * index = elektraCalloc (sizeof (SpecIndex));
+	index->root = newSpecIndexNode ("", 0);
+	index->nodes = 1;
+	index->size = ksGetSize (specKS);
+	index->matches = elektraCalloc (index->size * sizeof (KeySet *) + 1);
+	index->indexed = elektraCalloc (index->size * sizeof (bool) + 1);
+
+	for (elektraCursor it = 0; it < ksGetSize (specKS); ++it)
+	{
+		Key * specKey = ksAtCursor (specKS, it);
+		if (isArraySpec (specKey) || !isIndexable (specKey)) continue;
+
+		index->indexed[it] = true;
+		SpecIndexNode * node = index->root;
+		const char * part = strchr (keyName (specKey), '/') + 1;
+		while (*part != '\0')
+		{
+			const char * end = strchr (part, '/');
+			size_t length = end ? (size_t) (end - part) : strlen (part);
+			node = addSpecIndexChild (index, node, part, length);
+			if (!end) break;
+			part = end + 1;
+		}
+		node->spec = it;
+	}
+
+	index->current = elektraMalloc (index->nodes * sizeof (SpecIndexNode *));
+	index->next = elektraMalloc (index->nodes * sizeof (SpecIndexNode *));
+	return index;
+}
+
+static void delSpecIndex (SpecIndex * index)
+{
+	for (size_t i = 0; i < index->size; ++i)
+	{
+		if (index->matches[i] != NULL) ksDel (index->matches[i]);
+	}
+	delSpecIndexNode (index->root);
+	elektraFree (index->matches);
+	elektraFree (index->indexed);
+	elektraFree (index->current);
+	elektraFree (index->next);
+	elektraFree (index->name);
+	elektraFree (index);
+}
+
+/**
+ * Adds @p key to the matches of all indexed spec keys matching it.
+ */
+static void addToSpecIndex (SpecIndex * index, Key * key)
+{
+	const char * name = strchr (keyName (key), '/') + 1;
+	size_t nameSize = strlen (name) + 1;
+	if (nameSize > index->nameSize)
+	{
+		elektraRealloc ((void **) &index->name, nameSize);
+		index->nameSize = nameSize;
+	}
+	memcpy (index->name, name, nameSize);
+
+	size_t currentSize = 1;
+	index->current[0] = index->root;
+
+	char * part = index->name;
+	size_t depth = 0;
+	while (*name != '\0' && currentSize > 0)
+	{
+		char * end = strchr (part, '/');
+		size_t length = end ? (size_t) (end - part) : strlen (part);
+		if (end) *end = '\0';
+
+		// like elektraKeyGlob(), `_` matches array elements only in the first part
+		bool wildcardMatches = depth == 0 || elektraArrayValidateBaseNameString (part) <= 0;
+
+		size_t nextSize = 0;
+		for (size_t i = 0; i < currentSize; ++i)
+		{
+			SpecIndexNode * node = index->current[i];
+			bool found;
+			size_t pos = findLiteral (node, part, length, &found);
+			if (found) index->next[nextSize++] = node->literals[pos];
+			if (node->wildcard != NULL && wildcardMatches) index->next[nextSize++] = node->wildcard;
+		}
+
+		SpecIndexNode ** swap = index->current;
+		index->current = index->next;
+		index->next = swap;
+		currentSize = nextSize;
+
+		if (!end) break;
+		part = end + 1;
+		++depth;
+	}
+
+	for (size_t i = 0; i < currentSize; ++i)
+	{
+		elektraCursor spec = index->current[i]->spec;
+		if (spec == -1) continue;
+
+		if (index->matches[spec] == NULL) index->matches[spec] = ksNew (0, KS_END);
+		ksAppendKey (index->matches[spec], key);
+	}
+}
+
+// endregion Spec matching index
+
 /**
  * Process exactly one key of the specification.
  *
  * @param specKey        The spec Key to process.
  * @param parentKey      The parent key (for errors)
  * @param ks	         The full KeySet
+ * @param matches        The keys of @p ks matching @p specKey or NULL
+ * @param index          The index for keys added to @p ks
  * @param ch             How should conflicts be handled?
  * @param isKdbGet       is this the kdbGet call?
  *
  * @retval  0 on success
  * @retval -1 otherwise
  */
-static int processSpecKey (Key * specKey, Key * parentKey, KeySet * ks, const ConflictHandling * ch, bool isKdbGet)
+static int processSpecKey (Key * specKey, Key * parentKey, KeySet * ks, KeySet * matches, SpecIndex * index, const ConflictHandling * ch,
+			   bool isKdbGet)
 {
 	bool require = keyGetMeta (specKey, "require") != NULL;
 	bool wildcardSpec = isWildcardSpec (specKey);
@@ -822,14 +1113,9 @@ static int processSpecKey (Key * specKey, Key * parentKey, KeySet * ks, const Co
 	}
 
 	int found = 0;
-	for (elektraCursor cursor = 0; cursor < ksGetSize (ks); ++cursor)
+	for (elektraCursor cursor = 0; cursor < ksGetSize (matches); ++cursor)
 	{
-		Key * cur = ksAtCursor (ks, cursor);
-		if (!specMatches (specKey, cur))
-		{
-			continue;
-		}
-
+		Key * cur = ksAtCursor (matches, cursor);
 		found = 1;
 
 		if (wildcardSpec)
@@ -869,6 +1155,7 @@ static int processSpecKey (Key * specKey, Key * parentKey, KeySet * ks, const Co
 				keyAddName (newKey, strchr (keyName (specKey), '/'));
 				copyMeta (newKey, specKey);
 				ksAppendKey (ks, newKey);
+				addToSpecIndex (index, newKey);
 			}
 			else if (keyGetMeta (specKey, "default") != NULL)
 			{
@@ -876,6 +1163,7 @@ static int processSpecKey (Key * specKey, Key * parentKey, KeySet * ks, const Co
 				keyAddName (newKey, strchr (keyName (specKey), '/'));
 				copyMeta (newKey, specKey);
 				ksAppendKey (ks, newKey);
+				addToSpecIndex (index, newKey);
 			}
 		}
 
@@ -889,6 +1177,7 @@ static int processSpecKey (Key * specKey, Key * parentKey, KeySet * ks, const Co
 				keySetMeta (newKey, "internal/spec/remove", "");
 			}
 			ksAppendKey (ks, newKey);
+			addToSpecIndex (index, newKey);
 		}
 	}
 
@@ -936,16 +1225,38 @@ int elektraSpecCopy (Plugin * handle, KeySet * returned, Key * parentKey, bool i
 	// extract other namespaces
 	KeySet * ks = ksCut (returned, parentKey);
 
+	// match all keys against the spec at once
+	SpecIndex * index = buildSpecIndex (specKS);
+	for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+	{
+		addToSpecIndex (index, ksAtCursor (ks, it));
+	}
+
 	// do actual work
 	Key * specKey = NULL;
 	for (elektraCursor it = 0; it < ksGetSize (specKS); ++it)
 	{
 		specKey = ksAtCursor (specKS, it);
-		if (processSpecKey (specKey, parentKey, ks, &ch, isKdbGet) != 0)
+
+		KeySet * matches = index->matches[it];
+		bool linear = !index->indexed[it] && !isArraySpec (specKey);
+		if (linear)
+		{
+			matches = ksNew (0, KS_END);
+			for (elektraCursor cursor = 0; cursor < ksGetSize (ks); ++cursor)
+			{
+				Key * cur = ksAtCursor (ks, cursor);
+				if (specMatches (specKey, cur)) ksAppendKey (matches, cur);
+			}
+		}
+
+		if (processSpecKey (specKey, parentKey, ks, matches, index, &ch, isKdbGet) != 0)
 		{
 			ret = ELEKTRA_PLUGIN_STATUS_ERROR;
 		}
 
+		if (linear) ksDel (matches);
+
 		if (!isKdbGet)
 		{
 			keySetMeta (specKey, "internal/spec/array/validated", NULL);
@@ -962,6 +1273,8 @@ int elektraSpecCopy (Plugin * handle, KeySet * returned, Key * parentKey, bool i
 		ret = ELEKTRA_PLUGIN_STATUS_ERROR;
 	}
 
+	delSpecIndex (index);
+
 	// reconstruct KeySet
 	ksAppend (returned, specKS);
 	ksAppend (returned, ks);
@@ -998,7 +1311,7 @@ int elektraSpecRemove (ELEKTRA_UNUSED Plugin * handle, KeySet * returned, Key *
 			// Found a spec:/ key!
 			// Now remove all meta from the current key that is also contained in the spec:/ key
 
-			KeySet * specMeta = keyMeta (specKey);
+			const KeySet * specMeta = elektraKeyGetMetaKeySet (specKey);
 			KeySet * meta = keyMeta (cur);
 
 			for (elektraCursor j = 0; j < ksGetSize (specMeta); j++)
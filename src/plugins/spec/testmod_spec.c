@@ -630,6 +630,51 @@ static void test_remove_meta (void)
 	ksDel (_conf);
 }
 
+static void test_hook_copy_index (void)
+{
+	printf ("test %s\n", __func__);
+
+	KeySet * _conf = ksNew (1, keyNew ("user:/conflict/get", KEY_VALUE, "ERROR", KEY_END), KS_END);
+
+	TEST_BEGIN
+	{
+		KeySet * ks = ksNew (
+			10, keyNew ("spec:/" PARENT_KEY "/A/x", KEY_META, "default", "1", KEY_END),
+			keyNew ("spec:/" PARENT_KEY "/_/x", KEY_META, "wildcard", "", KEY_END),
+			keyNew ("spec:/" PARENT_KEY "/b/_", KEY_META, "end", "", KEY_END),
+			keyNew ("spec:/" PARENT_KEY "/b/c", KEY_META, "literal", "", KEY_END),
+			keyNew ("spec:/" PARENT_KEY "/[xy]", KEY_META, "glob", "", KEY_END), keyNew ("user:/" PARENT_KEY "/b/c", KEY_END),
+			keyNew ("user:/" PARENT_KEY "/b/#0", KEY_END), keyNew ("user:/" PARENT_KEY "/q/x", KEY_END),
+			keyNew ("user:/" PARENT_KEY "/#0/x", KEY_END), keyNew ("user:/" PARENT_KEY "/x", KEY_END), KS_END);
+
+		TEST_CHECK (elektraSpecCopy (plugin, ks, parentKey, true) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "hook spec/copy failed");
+		TEST_ON_FAIL (output_error (parentKey));
+
+		Key * lookup = ksLookupByName (ks, "user:/" PARENT_KEY "/b/c", 0);
+		succeed_if (keyGetMeta (lookup, "literal") != NULL, "literal spec not applied");
+		succeed_if (keyGetMeta (lookup, "end") != NULL, "wildcard spec not applied");
+
+		lookup = ksLookupByName (ks, "user:/" PARENT_KEY "/b/#0", 0);
+		succeed_if (keyGetMeta (lookup, "end") == NULL, "wildcard spec should not match array element");
+
+		lookup = ksLookupByName (ks, "user:/" PARENT_KEY "/q/x", 0);
+		succeed_if (keyGetMeta (lookup, "wildcard") != NULL, "wildcard spec not applied");
+
+		lookup = ksLookupByName (ks, "user:/" PARENT_KEY "/#0/x", 0);
+		succeed_if (keyGetMeta (lookup, "wildcard") == NULL, "wildcard spec should not match array element");
+
+		lookup = ksLookupByName (ks, "user:/" PARENT_KEY "/x", 0);
+		succeed_if (keyGetMeta (lookup, "glob") != NULL, "globbing spec not applied");
+
+		lookup = ksLookupByName (ks, "default:/" PARENT_KEY "/A/x", 0);
+		succeed_if (lookup != NULL, "default key not created");
+		succeed_if (keyGetMeta (lookup, "wildcard") != NULL, "wildcard spec not applied to created default key");
+
+		ksDel (ks);
+	}
+	TEST_END
+	ksDel (_conf);
+}
 
 int main (int argc, char ** argv)
 {
@@ -647,6 +692,7 @@ int main (int argc, char ** argv)
 	test_hook_copy_array ();
 	test_hook_copy_require_array ();
 	test_hook_copy_array_member ();
+	test_hook_copy_index ();
 	test_remove_meta ();
 
 	print_result ("testmod_spec");
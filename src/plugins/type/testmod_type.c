@@ -10,8 +10,10 @@
 
 #include "type.h"
 
+#include <kdbease.h>
 #include <kdbmodule.h>
 #include <kdbplugin.h>
+#include <kdbprivate.h>
 #include <tests_plugin.h>
 
 static bool checkType (const Key * key)
@@ -802,6 +804,53 @@ static void test_booleanRestoreDisabled (const char * type)
 	PLUGIN_CLOSE ();
 }
 
+static void test_cachedValue (void)
+{
+	Key * parentKey = keyNew ("user:/tests/type", KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	PLUGIN_OPEN ("type");
+	KeySet * ks = ksNew (30, keyNew ("user:/tests/type/long", KEY_VALUE, "42", KEY_META, "type", "long", KEY_END),
+			     keyNew ("user:/tests/type/double", KEY_VALUE, "1.5", KEY_META, "type", "double", KEY_END),
+			     keyNew ("user:/tests/type/boolean", KEY_VALUE, "true", KEY_META, "type", "boolean", KEY_END),
+			     keyNew ("user:/tests/type/string", KEY_VALUE, "42", KEY_META, "type", "string", KEY_END), KS_END);
+	succeed_if (plugin->kdbGet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbGet was not successful");
+
+	Key * longKey = ksLookupByName (ks, "user:/tests/type/long", 0);
+	kdb_long_t longValue = 0;
+	succeed_if (elektraKeyGetTypedValue (longKey, "long", &longValue, sizeof (longValue)) == 1, "long value should be cached");
+	succeed_if (longValue == 42, "wrong cached long value");
+
+	kdb_double_t doubleValue = 0;
+	succeed_if (elektraKeyGetTypedValue (ksLookupByName (ks, "user:/tests/type/double", 0), "double", &doubleValue,
+					     sizeof (doubleValue)) == 1,
+		    "double value should be cached");
+	succeed_if (doubleValue > 1.4 && doubleValue < 1.6, "wrong cached double value");
+
+	Key * booleanKey = ksLookupByName (ks, "user:/tests/type/boolean", 0);
+	kdb_boolean_t booleanValue = 0;
+	succeed_if (elektraKeyGetTypedValue (booleanKey, "boolean", &booleanValue, sizeof (booleanValue)) == 1,
+		    "boolean value should be cached");
+	succeed_if (booleanValue == 1, "wrong cached boolean value");
+
+	succeed_if (elektraKeyGetTypedValue (ksLookupByName (ks, "user:/tests/type/string", 0), "long", &longValue, sizeof (longValue)) ==
+			    0,
+		    "string value should not be cached");
+
+	// the conversion functions must use the new value, once it changed
+	keySetString (longKey, "43");
+	succeed_if (elektraKeyToLong (longKey, &longValue) == 1 && longValue == 43, "changed long value not converted");
+
+	// restoring the original boolean value drops the cache
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == ELEKTRA_PLUGIN_STATUS_SUCCESS, "call to kdbSet was not successful");
+	succeed_if_same_string (keyString (booleanKey), "true");
+	succeed_if (elektraKeyToBoolean (booleanKey, &booleanValue) == 0, "restored boolean value should not be cached");
+
+	ksDel (ks);
+	keyDel (parentKey);
+
+	PLUGIN_CLOSE ();
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("TYPE     TESTS\n");
@@ -863,6 +912,8 @@ int main (int argc, char ** argv)
 
 	test_booleanUserValueError ();
 
+	test_cachedValue ();
+
 	print_result ("testmod_type");
 
 	return nbError;
@@ -19,6 +19,7 @@ struct _Type
 	const char * name;
 	bool (*normalize) (Plugin * handle, Key * key);
 	bool (*check) (const Key * key);
+	bool (*cache) (Key * key);
 	bool (*restore) (Plugin * handle, Key * key);
 	void (*setError) (Plugin * handle, Key * errorKey, const Key * key);
 };
@@ -26,26 +27,28 @@ struct _Type
 static void elektraTypeSetDefaultError (Plugin * handle, Key * errorKey, const Key * key);
 
 static const Type elektraTypesList[] = {
-	{ "any", NULL, &elektraTypeCheckAny, NULL, &elektraTypeSetDefaultError },
-	{ "string", NULL, &elektraTypeCheckString, NULL, &elektraTypeSetDefaultError },
-	{ "wstring", NULL, &elektraTypeCheckWString, NULL, &elektraTypeSetDefaultError },
-	{ "char", NULL, &elektraTypeCheckChar, NULL, &elektraTypeSetDefaultError },
-	{ "wchar", NULL, &elektraTypeCheckWChar, NULL, &elektraTypeSetDefaultError },
-	{ "octet", NULL, &elektraTypeCheckChar, NULL, &elektraTypeSetDefaultError },
-	{ "short", NULL, &elektraTypeCheckShort, NULL, &elektraTypeSetDefaultError },
-	{ "long", NULL, &elektraTypeCheckLong, NULL, &elektraTypeSetDefaultError },
-	{ "long_long", NULL, &elektraTypeCheckLongLong, NULL, &elektraTypeSetDefaultError },
-	{ "unsigned_short", NULL, &elektraTypeCheckUnsignedShort, NULL, &elektraTypeSetDefaultError },
-	{ "unsigned_long", NULL, &elektraTypeCheckUnsignedLong, NULL, &elektraTypeSetDefaultError },
-	{ "unsigned_long_long", NULL, &elektraTypeCheckUnsignedLongLong, NULL, &elektraTypeSetDefaultError },
-	{ "float", NULL, &elektraTypeCheckFloat, NULL, &elektraTypeSetDefaultError },
-	{ "double", NULL, &elektraTypeCheckDouble, NULL, &elektraTypeSetDefaultError },
+	{ "any", NULL, &elektraTypeCheckAny, NULL, NULL, &elektraTypeSetDefaultError },
+	{ "string", NULL, &elektraTypeCheckString, NULL, NULL, &elektraTypeSetDefaultError },
+	{ "wstring", NULL, &elektraTypeCheckWString, NULL, NULL, &elektraTypeSetDefaultError },
+	{ "char", NULL, &elektraTypeCheckChar, NULL, NULL, &elektraTypeSetDefaultError },
+	{ "wchar", NULL, &elektraTypeCheckWChar, NULL, NULL, &elektraTypeSetDefaultError },
+	{ "octet", NULL, &elektraTypeCheckChar, NULL, NULL, &elektraTypeSetDefaultError },
+	{ "short", NULL, &elektraTypeCheckShort, &elektraTypeCacheShort, NULL, &elektraTypeSetDefaultError },
+	{ "long", NULL, &elektraTypeCheckLong, &elektraTypeCacheLong, NULL, &elektraTypeSetDefaultError },
+	{ "long_long", NULL, &elektraTypeCheckLongLong, &elektraTypeCacheLongLong, NULL, &elektraTypeSetDefaultError },
+	{ "unsigned_short", NULL, &elektraTypeCheckUnsignedShort, &elektraTypeCacheUnsignedShort, NULL, &elektraTypeSetDefaultError },
+	{ "unsigned_long", NULL, &elektraTypeCheckUnsignedLong, &elektraTypeCacheUnsignedLong, NULL, &elektraTypeSetDefaultError },
+	{ "unsigned_long_long", NULL, &elektraTypeCheckUnsignedLongLong, &elektraTypeCacheUnsignedLongLong, NULL,
+	  &elektraTypeSetDefaultError },
+	{ "float", NULL, &elektraTypeCheckFloat, &elektraTypeCacheFloat, NULL, &elektraTypeSetDefaultError },
+	{ "double", NULL, &elektraTypeCheckDouble, &elektraTypeCacheDouble, NULL, &elektraTypeSetDefaultError },
 #ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
-	{ "long_double", NULL, &elektraTypeCheckLongDouble, NULL, &elektraTypeSetDefaultError },
+	{ "long_double", NULL, &elektraTypeCheckLongDouble, &elektraTypeCacheLongDouble, NULL, &elektraTypeSetDefaultError },
 #endif
-	{ "boolean", &elektraTypeNormalizeBoolean, &elektraTypeCheckBoolean, &elektraTypeRestoreBoolean, &elektraTypeSetDefaultError },
-	{ "enum", &elektraTypeNormalizeEnum, &elektraTypeCheckEnum, &elektraTypeRestoreEnum, &elektraTypeSetErrorEnum },
-	{ NULL, NULL, NULL, NULL, NULL }
+	{ "boolean", &elektraTypeNormalizeBoolean, &elektraTypeCheckBoolean, &elektraTypeCacheBoolean, &elektraTypeRestoreBoolean,
+	  &elektraTypeSetDefaultError },
+	{ "enum", &elektraTypeNormalizeEnum, &elektraTypeCheckEnum, NULL, &elektraTypeRestoreEnum, &elektraTypeSetErrorEnum },
+	{ NULL, NULL, NULL, NULL, NULL, NULL }
 };
 
 static const Type * findType (const char * name)
@@ -338,7 +341,8 @@ int elektraTypeGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * par
 			}
 		}
 
-		if (!type->check (cur))
+		// the value stays as it is, so the converted value can be cached for the application
+		if (!(type->cache != NULL ? type->cache (cur) : type->check (cur)))
 		{
 			type->setError (handle, parentKey, cur);
 			return ELEKTRA_PLUGIN_STATUS_ERROR;
@@ -19,6 +19,7 @@
 
 #include <kdbease.h>
 #include <kdberrors.h>
+#include <kdbprivate.h>
 
 #define CHECK_TYPE(key, var, toValue)                                                                                                      \
 	{                                                                                                                                  \
@@ -39,6 +40,28 @@
 		elektraFree (string);                                                                                                      \
 	}
 
+/**
+ * Defines elektraTypeCheck<TYPE_NAME>() and elektraTypeCache<TYPE_NAME>()
+ * from the function check<TYPE_NAME>(), which returns the converted value.
+ */
+#define TYPE_CHECK_FUNCTIONS(TYPE_NAME, TYPE, KDB_TYPE)                                                                                    \
+	bool elektraTypeCheck##TYPE_NAME (const Key * key)                                                                                 \
+	{                                                                                                                                  \
+		TYPE value;                                                                                                                \
+		return check##TYPE_NAME (key, &value);                                                                                     \
+	}                                                                                                                                  \
+                                                                                                                                           \
+	bool elektraTypeCache##TYPE_NAME (Key * key)                                                                                       \
+	{                                                                                                                                  \
+		TYPE value;                                                                                                                \
+		if (!check##TYPE_NAME (key, &value))                                                                                       \
+		{                                                                                                                          \
+			return false;                                                                                                      \
+		}                                                                                                                          \
+		elektraKeySetTypedValue (key, KDB_TYPE, &value, sizeof (value));                                                           \
+		return true;                                                                                                               \
+	}
+
 bool elektraTypeCheckAny (const Key * key ELEKTRA_UNUSED)
 {
 	return true;
@@ -165,6 +188,18 @@ bool elektraTypeCheckBoolean (const Key * key)
 	return (value[0] == '1' || value[0] == '0') && value[1] == '\0';
 }
 
+bool elektraTypeCacheBoolean (Key * key)
+{
+	if (!elektraTypeCheckBoolean (key))
+	{
+		return false;
+	}
+
+	kdb_boolean_t value = keyString (key)[0] == '1';
+	elektraKeySetTypedValue (key, "boolean", &value, sizeof (value));
+	return true;
+}
+
 bool elektraTypeRestoreBoolean (Plugin * handle ELEKTRA_UNUSED, Key * key)
 {
 	const Key * orig = keyGetMeta (key, "origvalue");
@@ -176,78 +211,81 @@ bool elektraTypeRestoreBoolean (Plugin * handle ELEKTRA_UNUSED, Key * key)
 	return true;
 }
 
-bool elektraTypeCheckFloat (const Key * key)
+static bool checkFloat (const Key * key, kdb_float_t * value)
 {
-	kdb_float_t value;
-	CHECK_TYPE (key, value, elektraKeyToFloat)
+	CHECK_TYPE (key, *value, elektraKeyToFloat)
 	return true;
 }
 
-bool elektraTypeCheckDouble (const Key * key)
+static bool checkDouble (const Key * key, kdb_double_t * value)
 {
-	kdb_double_t value;
-	CHECK_TYPE (key, value, elektraKeyToDouble)
+	CHECK_TYPE (key, *value, elektraKeyToDouble)
 	return true;
 }
 
 #ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
-bool elektraTypeCheckLongDouble (const Key * key)
+static bool checkLongDouble (const Key * key, kdb_long_double_t * value)
 {
-	kdb_long_double_t value;
-	CHECK_TYPE (key, value, elektraKeyToLongDouble)
+	CHECK_TYPE (key, *value, elektraKeyToLongDouble)
 	return true;
 }
 
 #endif
 
-bool elektraTypeCheckShort (const Key * key)
+static bool checkShort (const Key * key, kdb_short_t * value)
 {
-	kdb_short_t value;
-	CHECK_TYPE (key, value, elektraKeyToShort)
-	CHECK_TYPE_REVERSIBLE (key, value, elektraShortToString);
+	CHECK_TYPE (key, *value, elektraKeyToShort)
+	CHECK_TYPE_REVERSIBLE (key, *value, elektraShortToString);
 	return true;
 }
 
-bool elektraTypeCheckLong (const Key * key)
+static bool checkLong (const Key * key, kdb_long_t * value)
 {
-	kdb_long_t value;
-	CHECK_TYPE (key, value, elektraKeyToLong)
-	CHECK_TYPE_REVERSIBLE (key, value, elektraLongToString);
+	CHECK_TYPE (key, *value, elektraKeyToLong)
+	CHECK_TYPE_REVERSIBLE (key, *value, elektraLongToString);
 	return true;
 }
 
-bool elektraTypeCheckLongLong (const Key * key)
+static bool checkLongLong (const Key * key, kdb_long_long_t * value)
 {
-	kdb_long_long_t value;
-	CHECK_TYPE (key, value, elektraKeyToLongLong)
-	CHECK_TYPE_REVERSIBLE (key, value, elektraLongLongToString);
+	CHECK_TYPE (key, *value, elektraKeyToLongLong)
+	CHECK_TYPE_REVERSIBLE (key, *value, elektraLongLongToString);
 	return true;
 }
 
-bool elektraTypeCheckUnsignedShort (const Key * key)
+static bool checkUnsignedShort (const Key * key, kdb_unsigned_short_t * value)
 {
-	kdb_unsigned_short_t value;
-	CHECK_TYPE (key, value, elektraKeyToUnsignedShort)
-	CHECK_TYPE_REVERSIBLE (key, value, elektraUnsignedShortToString);
+	CHECK_TYPE (key, *value, elektraKeyToUnsignedShort)
+	CHECK_TYPE_REVERSIBLE (key, *value, elektraUnsignedShortToString);
 	return true;
 }
 
-bool elektraTypeCheckUnsignedLong (const Key * key)
+static bool checkUnsignedLong (const Key * key, kdb_unsigned_long_t * value)
 {
-	kdb_unsigned_long_t value;
-	CHECK_TYPE (key, value, elektraKeyToUnsignedLong)
-	CHECK_TYPE_REVERSIBLE (key, value, elektraUnsignedLongToString);
+	CHECK_TYPE (key, *value, elektraKeyToUnsignedLong)
+	CHECK_TYPE_REVERSIBLE (key, *value, elektraUnsignedLongToString);
 	return true;
 }
 
-bool elektraTypeCheckUnsignedLongLong (const Key * key)
+static bool checkUnsignedLongLong (const Key * key, kdb_unsigned_long_long_t * value)
 {
-	kdb_unsigned_long_long_t value;
-	CHECK_TYPE (key, value, elektraKeyToUnsignedLongLong)
-	CHECK_TYPE_REVERSIBLE (key, value, elektraUnsignedLongLongToString);
+	CHECK_TYPE (key, *value, elektraKeyToUnsignedLongLong)
+	CHECK_TYPE_REVERSIBLE (key, *value, elektraUnsignedLongLongToString);
 	return true;
 }
 
+TYPE_CHECK_FUNCTIONS (Float, kdb_float_t, "float")
+TYPE_CHECK_FUNCTIONS (Double, kdb_double_t, "double")
+#ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
+TYPE_CHECK_FUNCTIONS (LongDouble, kdb_long_double_t, "long_double")
+#endif
+TYPE_CHECK_FUNCTIONS (Short, kdb_short_t, "short")
+TYPE_CHECK_FUNCTIONS (Long, kdb_long_t, "long")
+TYPE_CHECK_FUNCTIONS (LongLong, kdb_long_long_t, "long_long")
+TYPE_CHECK_FUNCTIONS (UnsignedShort, kdb_unsigned_short_t, "unsigned_short")
+TYPE_CHECK_FUNCTIONS (UnsignedLong, kdb_unsigned_long_t, "unsigned_long")
+TYPE_CHECK_FUNCTIONS (UnsignedLongLong, kdb_unsigned_long_long_t, "unsigned_long_long")
+
 static bool enumValidValues (const Key * key, KeySet * validValues, char * delim)
 {
 
@@ -25,21 +25,31 @@ bool elektraTypeCheckWString (const Key * key);
 
 bool elektraTypeNormalizeBoolean (Plugin * handle, Key * key);
 bool elektraTypeCheckBoolean (const Key * key);
+bool elektraTypeCacheBoolean (Key * key);
 bool elektraTypeRestoreBoolean (Plugin * handle, Key * key);
 
 bool elektraTypeCheckFloat (const Key * key);
+bool elektraTypeCacheFloat (Key * key);
 bool elektraTypeCheckDouble (const Key * key);
+bool elektraTypeCacheDouble (Key * key);
 
 #ifdef ELEKTRA_HAVE_KDB_LONG_DOUBLE
 bool elektraTypeCheckLongDouble (const Key * key);
+bool elektraTypeCacheLongDouble (Key * key);
 #endif
 
 bool elektraTypeCheckShort (const Key * key);
+bool elektraTypeCacheShort (Key * key);
 bool elektraTypeCheckLong (const Key * key);
+bool elektraTypeCacheLong (Key * key);
 bool elektraTypeCheckLongLong (const Key * key);
+bool elektraTypeCacheLongLong (Key * key);
 bool elektraTypeCheckUnsignedShort (const Key * key);
+bool elektraTypeCacheUnsignedShort (Key * key);
 bool elektraTypeCheckUnsignedLong (const Key * key);
+bool elektraTypeCacheUnsignedLong (Key * key);
 bool elektraTypeCheckUnsignedLongLong (const Key * key);
+bool elektraTypeCacheUnsignedLongLong (Key * key);
 
 bool elektraTypeNormalizeEnum (Plugin * handle, Key * key);
 bool elektraTypeCheckEnum (const Key * key);
@@ -228,6 +228,48 @@ void icase_test (void)
 	PLUGIN_CLOSE ();
 }
 
+void cache_test (void)
+{
+	Key * parentKey = keyNew ("user:/tests/validation", KEY_VALUE, "", KEY_END);
+	KeySet * conf = ksNew (0, KS_END);
+	KeySet * ks;
+	PLUGIN_OPEN ("validation");
+
+	ks = ksNew (4, keyNew ("user:/tests/validation/any", KEY_VALUE, "xxabcxx", KEY_META, "check/validation", "abc", KEY_END),
+		    keyNew ("user:/tests/validation/regex", KEY_VALUE, "abcabc", KEY_META, "check/validation", "^(abc)+$", KEY_END),
+		    keyNew ("user:/tests/validation/same", KEY_VALUE, "abc", KEY_META, "check/validation", "abc", KEY_END), KS_END);
+	for (int i = 0; i < 2; ++i)
+	{
+		succeed_if (plugin->kdbSet (plugin, ks, parentKey) == (1), "kdbSet failed");
+	}
+	ksDel (ks);
+
+	ks = ksNew (2, keyNew ("user:/tests/validation/invalid", KEY_VALUE, "xxabxx", KEY_META, "check/validation", "abc", KEY_END),
+		    KS_END);
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == (-1), "kdbSet should fail with cached pattern");
+	ksDel (ks);
+
+	ks = ksNew (2, keyNew ("user:/tests/validation/invalid", KEY_VALUE, "abcab", KEY_META, "check/validation", "^(abc)+$", KEY_END),
+		    KS_END);
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == (-1), "kdbSet should fail with cached regex");
+	ksDel (ks);
+
+	ks = ksNew (2, keyNew ("user:/tests/validation/icase", KEY_VALUE, "xxABCxx", KEY_META, "check/validation", "abc", KEY_META,
+			       "check/validation/ignorecase", "", KEY_END),
+		    KS_END);
+	succeed_if (plugin->kdbSet (plugin, ks, parentKey) == (1), "flags should be part of the cached pattern");
+	ksDel (ks);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		ks = ksNew (2, keyNew ("user:/tests/validation/error", KEY_VALUE, "a", KEY_META, "check/validation", "(a", KEY_END), KS_END);
+		succeed_if (plugin->kdbSet (plugin, ks, parentKey) == (-1), "invalid regex should fail every time");
+		ksDel (ks);
+	}
+
+	keyDel (parentKey);
+	PLUGIN_CLOSE ();
+}
 
 int main (int argc, char ** argv)
 {
@@ -243,6 +285,7 @@ int main (int argc, char ** argv)
 	line_test ();
 	icase_test ();
 	invert_test ();
+	cache_test ();
 	print_result ("testmod_validation");
 
 	return nbError;
@@ -10,15 +10,70 @@
 #include "kdbconfig.h"
 #endif
 
-#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "validation.h"
 
+/**
+ * A compiled check/validation pattern.
+ *
+ * Patterns without any regex special characters are matched with string
+ * functions, the compiled regex is then only used for error messages.
+ */
+typedef struct
+{
+	regex_t regex;
+	char * literal; ///< the pattern itself if it is a plain string, otherwise NULL
+	int anchored;	///< the pattern has to match the whole string (or line)
+	int newline;	///< REG_NEWLINE was used, i.e. anchors match at line boundaries
+} ValidationRegex;
+
+/**
+ * Plugin data: compiled patterns keyed by (flags, pattern), which live as
+ * long as the plugin.
+ */
+typedef struct
+{
+	KeySet * cache;
+	Key * lookup;
+} ValidationData;
+
 static int validateKey (Key *, Key *);
 
+static void freeRegex (ValidationRegex * re)
+{
+	regfree (&re->regex);
+	elektraFree (re->literal);
+	elektraFree (re);
+}
+
+int elektraValidationOpen (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	ValidationData * data = elektraMalloc (sizeof (ValidationData));
+	data->cache = ksNew (0, KS_END);
+	data->lookup = keyNew ("/", KEY_END);
+	elektraPluginSetData (handle, data);
+	return 1;
+}
+
+int elektraValidationClose (Plugin * handle, Key * errorKey ELEKTRA_UNUSED)
+{
+	ValidationData * data = elektraPluginGetData (handle);
+	if (data == NULL) return 1;
+
+	for (elektraCursor it = 0; it < ksGetSize (data->cache); ++it)
+	{
+		freeRegex (*(ValidationRegex **) keyValue (ksAtCursor (data->cache, it)));
+	}
+	ksDel (data->cache);
+	keyDel (data->lookup);
+	elektraFree (data);
+	elektraPluginSetData (handle, NULL);
+	return 1;
+}
+
 int elektraValidationGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey ELEKTRA_UNUSED)
 {
 	KeySet * n;
@@ -26,6 +81,8 @@ int elektraValidationGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 		  n = ksNew (30,
 			     keyNew ("system:/elektra/modules/validation", KEY_VALUE, "validation plugin waits for your orders", KEY_END),
 			     keyNew ("system:/elektra/modules/validation/exports", KEY_END),
+			     keyNew ("system:/elektra/modules/validation/exports/open", KEY_FUNC, elektraValidationOpen, KEY_END),
+			     keyNew ("system:/elektra/modules/validation/exports/close", KEY_FUNC, elektraValidationClose, KEY_END),
 			     keyNew ("system:/elektra/modules/validation/exports/get", KEY_FUNC, elektraValidationGet, KEY_END),
 			     keyNew ("system:/elektra/modules/validation/exports/set", KEY_FUNC, elektraValidationSet, KEY_END),
 			     keyNew ("system:/elektra/modules/validation/exports/ksLookupRE", KEY_FUNC, ksLookupRE, KEY_END),
@@ -36,7 +93,98 @@ int elektraValidationGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key
 	return 1;
 }
 
-static int validateKey (Key * key, Key * parentKey)
+/**
+ * Compiles @p regexString.
+ *
+ * @param pattern     the pattern of the key without anchors
+ * @param regexString the pattern that is compiled
+ *
+ * @retval NULL if the regex could not be compiled, the error is set on @p parentKey
+ */
+static ValidationRegex * compileRegex (const char * pattern, const char * regexString, int cflags, int anchored, const Key * key,
+				       Key * parentKey)
+{
+	ValidationRegex * re = elektraCalloc (sizeof (ValidationRegex));
+	int ret = regcomp (&re->regex, regexString, cflags);
+	if (ret != 0)
+	{
+		char buffer[1000];
+		regerror (ret, &re->regex, buffer, 999);
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Could not compile regex '%s' of the key '%s'. Reason: %s", pattern,
+							 keyName (key), buffer);
+		regfree (&re->regex);
+		elektraFree (re);
+		return NULL;
+	}
+
+	re->anchored = anchored;
+	re->newline = (cflags & REG_NEWLINE) != 0;
+	if (!(cflags & REG_ICASE) && strpbrk (pattern, ".[]()*+?{}|^$\\\n") == NULL)
+	{
+		re->literal = elektraStrDup (pattern);
+	}
+	return re;
+}
+
+/**
+ * Looks up the compiled regex for (@p regexString, @p cflags) and compiles it on a cache miss.
+ */
+static ValidationRegex * lookupRegex (ValidationData * data, const char * pattern, const char * regexString, int cflags, int anchored,
+				      const Key * key, Key * parentKey)
+{
+	char flags[32];
+	snprintf (flags, sizeof (flags), "%d", cflags);
+	keySetName (data->lookup, "/");
+	keyAddBaseName (data->lookup, flags);
+	keyAddBaseName (data->lookup, regexString);
+
+	Key * cached = ksLookup (data->cache, data->lookup, 0);
+	if (cached)
+	{
+		return *(ValidationRegex **) keyValue (cached);
+	}
+
+	ValidationRegex * re = compileRegex (pattern, regexString, cflags, anchored, key, parentKey);
+	if (re == NULL) return NULL;
+
+	Key * entry = keyDup (data->lookup, KEY_CP_NAME);
+	keySetBinary (entry, &re, sizeof (re));
+	ksAppendKey (data->cache, entry);
+	return re;
+}
+
+static int matchLiteral (const ValidationRegex * re, const char * string)
+{
+	if (!re->anchored) return strstr (string, re->literal) != NULL;
+	if (!re->newline) return strcmp (string, re->literal) == 0;
+
+	size_t length = strlen (re->literal);
+	const char * line = string;
+	for (;;)
+	{
+		const char * end = strchr (line, '\n');
+		size_t lineLength = end ? (size_t) (end - line) : strlen (line);
+		if (lineLength == length && strncmp (line, re->literal, length) == 0) return 1;
+		if (!end) return 0;
+		line = end + 1;
+	}
+}
+
+static int matchRegex (const ValidationRegex * re, const char * string, int * ret)
+{
+	if (re->literal)
+	{
+		int match = matchLiteral (re, string);
+		*ret = match ? 0 : REG_NOMATCH;
+		return match;
+	}
+
+	regmatch_t offsets;
+	*ret = regexec (&re->regex, string, 1, &offsets, 0);
+	return *ret == 0;
+}
+
+static int validateKeyWithCache (ValidationData * data, Key * key, Key * parentKey)
 {
 	const Key * regexMeta = keyGetMeta (key, "check/validation");
 
@@ -54,21 +202,14 @@ static int validateKey (Key * key, Key * parentKey)
 	if (invertMeta) invertValidation = 1;
 	if (matchMeta)
 	{
-		char * matchCopy = elektraStrDup (keyString (matchMeta));
-		char * ptr = matchCopy;
-		while (*ptr)
-		{
-			*ptr = toupper (*ptr);
-			++ptr;
-		}
-		if (!strcmp (matchCopy, "LINE")) lineValidation = 1;
-		if (!strcmp (matchCopy, "WORD")) wordValidation = 1;
-		if (!strcmp (matchCopy, "ANY"))
+		const char * match = keyString (matchMeta);
+		if (!elektraStrCaseCmp (match, "LINE")) lineValidation = 1;
+		if (!elektraStrCaseCmp (match, "WORD")) wordValidation = 1;
+		if (!elektraStrCaseCmp (match, "ANY"))
 		{
 			lineValidation = 0;
 			wordValidation = 0;
 		}
-		elektraFree (matchCopy);
 	}
 
 	int cflags = REG_NOSUB | REG_EXTENDED;
@@ -76,52 +217,49 @@ static int validateKey (Key * key, Key * parentKey)
 	if (lineValidation) cflags |= REG_NEWLINE;
 	if (typeMeta)
 	{
-		char * typeCopy = elektraStrDup (keyString (typeMeta));
-		char * ptr = typeCopy;
-		while (*ptr)
-		{
-			*ptr = toupper (*ptr);
-			++ptr;
-		}
-		if (!strcmp (typeCopy, "ERE"))
+		const char * type = keyString (typeMeta);
+		if (!elektraStrCaseCmp (type, "ERE"))
 			cflags |= REG_EXTENDED;
-		else if (!strcmp (typeCopy, "BRE"))
+		else if (!elektraStrCaseCmp (type, "BRE"))
 			cflags &= REG_EXTENDED;
-		elektraFree (typeCopy);
 	}
 
+	const char * pattern = keyString (regexMeta);
 	char * regexString = NULL;
 	int freeString = 0;
-	if (lineValidation || wordValidation)
+	int anchored = lineValidation || wordValidation;
+	if (anchored)
 	{
 		regexString = elektraMalloc (keyGetValueSize (regexMeta) + 2);
 		freeString = 1;
-		sprintf (regexString, "^%s$", keyString (regexMeta));
+		sprintf (regexString, "^%s$", pattern);
 	}
 	else
 	{
-		regexString = (char *) keyString (regexMeta);
+		regexString = (char *) pattern;
 	}
 
-	regex_t regex;
-	regmatch_t offsets;
-	int ret = regcomp (&regex, regexString, cflags);
+	ValidationRegex * re;
+	if (data)
+	{
+		re = lookupRegex (data, pattern, regexString, cflags, anchored, key, parentKey);
+	}
+	else
+	{
+		re = compileRegex (pattern, regexString, cflags, anchored, key, parentKey);
+	}
 
-	if (ret != 0)
+	if (re == NULL)
 	{
-		char buffer[1000];
-		regerror (ret, &regex, buffer, 999);
-		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Could not compile regex '%s' of the key '%s'. Reason: %s",
-							 keyString (regexMeta), keyName (key), buffer);
-		regfree (&regex);
 		if (freeString) elektraFree (regexString);
 		return 0;
 	}
+
+	int ret = 0;
 	int match = 0;
 	if (!wordValidation)
 	{
-		ret = regexec (&regex, keyString (key), 1, &offsets, 0);
-		if (ret == 0) match = 1;
+		match = matchRegex (re, keyString (key), &ret);
 	}
 	else
 	{
@@ -130,8 +268,7 @@ static int validateKey (Key * key, Key * parentKey)
 		char * string = (char *) keyString (key);
 		while ((token = strtok_r (string, " \t\n", &savePtr)) != NULL)
 		{
-			ret = regexec (&regex, token, 1, &offsets, 0);
-			if (ret == 0)
+			if (matchRegex (re, token, &ret))
 			{
 				match = 1;
 				break;
@@ -149,37 +286,40 @@ static int validateKey (Key * key, Key * parentKey)
 			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey,
 								 "The key '%s' with value '%s' does not confirm to '%s'. Reason: %s",
 								 keyName (key), keyString (key), regexString, keyString (msg));
-			regfree (&regex);
-			if (freeString) elektraFree (regexString);
-			return 0;
 		}
 		else
 		{
 			char buffer[1000];
-			regerror (ret, &regex, buffer, 999);
+			regerror (ret, &re->regex, buffer, 999);
 			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey,
 								 "The key '%s' with value '%s' does not confirm to '%s'. Reason: %s",
 								 keyName (key), keyString (key), regexString, buffer);
-			regfree (&regex);
-			if (freeString) elektraFree (regexString);
-			return 0;
 		}
 	}
 
-	regfree (&regex);
+	if (!data) freeRegex (re);
 	if (freeString) elektraFree (regexString);
-	return 1;
+	return match;
+}
+
+/**
+ * Validates a single key without using the cache of an opened plugin.
+ */
+static int validateKey (Key * key, Key * parentKey)
+{
+	return validateKeyWithCache (NULL, key, parentKey);
 }
 
-int elektraValidationSet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey)
+int elektraValidationSet (Plugin * handle, KeySet * returned, Key * parentKey)
 {
+	ValidationData * data = elektraPluginGetData (handle);
 	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
 	{
 		Key * cur = ksAtCursor (returned, it);
 		const Key * regexMeta = keyGetMeta (cur, "check/validation");
 
 		if (!regexMeta) continue;
-		int rc = validateKey (cur, parentKey);
+		int rc = validateKeyWithCache (data, cur, parentKey);
 		if (!rc) return -1;
 	}
 
@@ -190,6 +330,8 @@ Plugin * ELEKTRA_PLUGIN_EXPORT
 {
 	// clang-format off
 	return elektraPluginExport("validation",
+			ELEKTRA_PLUGIN_OPEN,	&elektraValidationOpen,
+			ELEKTRA_PLUGIN_CLOSE,	&elektraValidationClose,
 			ELEKTRA_PLUGIN_GET,	&elektraValidationGet,
 			ELEKTRA_PLUGIN_SET,	&elektraValidationSet,
 			ELEKTRA_PLUGIN_END);
@@ -14,9 +14,12 @@
 #include "kdbconfig.h"
 #endif
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <tests_internal.h>
 
@@ -681,6 +684,201 @@ void test_writing (void)
 	elektraPluginClose (plugin, 0);
 }
 
+#define LARGE_ENTRIES 2000
+#define LARGE_DEPTH 40
+#define LARGE_PADDING "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz"
+
+/**
+ * Writes a JSON file that is read from pipes in several chunks,
+ * with maps nested deeper than the initial stack of the parser.
+ */
+static void writeLargeJson (const char * fileName)
+{
+	FILE * file = fopen (fileName, "w");
+	exit_if_fail (file != NULL, "could not create json file");
+
+	fprintf (file, "{\n");
+	for (int i = 0; i < LARGE_ENTRIES; ++i)
+	{
+		fprintf (file, "\t\"key%05d\": \"value %05d " LARGE_PADDING "\",\n", i, i);
+	}
+	fprintf (file, "\t\"deep\": ");
+	for (int i = 0; i < LARGE_DEPTH; ++i)
+	{
+		fprintf (file, "{\"level\": ");
+	}
+	fprintf (file, "\"leaf\"");
+	for (int i = 0; i < LARGE_DEPTH; ++i)
+	{
+		fprintf (file, "}");
+	}
+	fprintf (file, "\n}\n");
+
+	fclose (file);
+}
+
+/**
+ * @return the number of keys written by writeLargeJson() that are missing or wrong in @p ks
+ */
+static int countLargeMismatches (KeySet * ks)
+{
+	int mismatches = 0;
+	char name[64];
+	char value[256];
+	for (int i = 0; i < LARGE_ENTRIES; ++i)
+	{
+		snprintf (name, sizeof (name), "user:/tests/yajl/key%05d", i);
+		snprintf (value, sizeof (value), "value %05d " LARGE_PADDING, i);
+		Key * key = ksLookupByName (ks, name, 0);
+		if (!key || strcmp (keyString (key), value) != 0) ++mismatches;
+	}
+
+	Key * deep = keyNew ("user:/tests/yajl/deep", KEY_END);
+	for (int i = 0; i < LARGE_DEPTH; ++i)
+	{
+		keyAddBaseName (deep, "level");
+	}
+	Key * leaf = ksLookup (ks, deep, 0);
+	if (!leaf || strcmp (keyString (leaf), "leaf") != 0) ++mismatches;
+	keyDel (deep);
+
+	return mismatches;
+}
+
+void test_largeMapped (void)
+{
+	printf ("Test mapped large file\n");
+
+	writeLargeJson (elektraFilename ());
+
+	KeySet * conf = ksNew (0, KS_END);
+	Plugin * plugin = elektraPluginOpen ("yajl", modules, conf, 0);
+	exit_if_fail (plugin != 0, "could not open plugin");
+
+	Key * parentKey = keyNew ("user:/tests/yajl", KEY_VALUE, elektraFilename (), KEY_END);
+	KeySet * keys = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, keys, parentKey) == 1, "kdbGet was not successful");
+	succeed_if (output_error (parentKey), "error in kdbGet");
+	succeed_if (output_warnings (parentKey), "warnings in kdbGet");
+	succeed_if (countLargeMismatches (keys) == 0, "keys of mapped file are wrong");
+
+	elektraUnlink (elektraFilename ());
+	keyDel (parentKey);
+	ksDel (keys);
+
+	elektraPluginClose (plugin, 0);
+}
+
+void test_largeStream (void)
+{
+	printf ("Test streamed large file from a pipe\n");
+
+	writeLargeJson (elektraFilename ());
+
+	int fds[2];
+	exit_if_fail (pipe (fds) == 0, "could not create pipe");
+
+	pid_t pid = fork ();
+	exit_if_fail (pid != -1, "could not fork");
+	if (pid == 0)
+	{
+		// child: copy the file into the pipe, in smaller chunks than the plugin reads
+		close (fds[0]);
+		FILE * file = fopen (elektraFilename (), "r");
+		if (!file) _Exit (EXIT_FAILURE);
+		char buffer[1000];
+		size_t rd;
+		while ((rd = fread (buffer, 1, sizeof (buffer), file)) > 0)
+		{
+			if (write (fds[1], buffer, rd) != (ssize_t) rd) _Exit (EXIT_FAILURE);
+		}
+		fclose (file);
+		close (fds[1]);
+		_Exit (EXIT_SUCCESS);
+	}
+	close (fds[1]);
+
+	char pipeName[64];
+	snprintf (pipeName, sizeof (pipeName), "/dev/fd/%d", fds[0]);
+
+	KeySet * conf = ksNew (0, KS_END);
+	Plugin * plugin = elektraPluginOpen ("yajl", modules, conf, 0);
+	exit_if_fail (plugin != 0, "could not open plugin");
+
+	Key * parentKey = keyNew ("user:/tests/yajl", KEY_VALUE, pipeName, KEY_END);
+	KeySet * keys = ksNew (0, KS_END);
+	succeed_if (plugin->kdbGet (plugin, keys, parentKey) == 1, "kdbGet was not successful");
+	succeed_if (output_error (parentKey), "error in kdbGet");
+	succeed_if (output_warnings (parentKey), "warnings in kdbGet");
+	succeed_if (countLargeMismatches (keys) == 0, "keys of streamed pipe are wrong");
+
+	close (fds[0]);
+	int status;
+	succeed_if (waitpid (pid, &status, 0) == pid, "could not wait for writer");
+	succeed_if (WIFEXITED (status) && WEXITSTATUS (status) == EXIT_SUCCESS, "writer did not succeed");
+
+	elektraUnlink (elektraFilename ());
+	keyDel (parentKey);
+	ksDel (keys);
+
+	elektraPluginClose (plugin, 0);
+}
+
+typedef struct
+{
+	Plugin * plugin;
+	int failures;
+} ParserThread;
+
+static void * parseLargeRepeatedly (void * arg)
+{
+	ParserThread * thread = arg;
+	for (int i = 0; i < 10; ++i)
+	{
+		Key * parentKey = keyNew ("user:/tests/yajl", KEY_VALUE, elektraFilename (), KEY_END);
+		KeySet * keys = ksNew (0, KS_END);
+		if (thread->plugin->kdbGet (thread->plugin, keys, parentKey) != 1)
+		{
+			++thread->failures;
+		}
+		else
+		{
+			thread->failures += countLargeMismatches (keys);
+		}
+		keyDel (parentKey);
+		ksDel (keys);
+	}
+	return NULL;
+}
+
+void test_concurrentParsers (void)
+{
+	printf ("Test two parsers in concurrent threads\n");
+
+	writeLargeJson (elektraFilename ());
+
+	ParserThread threads[2];
+	pthread_t ids[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		threads[i].plugin = elektraPluginOpen ("yajl", modules, ksNew (0, KS_END), 0);
+		exit_if_fail (threads[i].plugin != 0, "could not open plugin");
+		threads[i].failures = 0;
+	}
+	for (int i = 0; i < 2; ++i)
+	{
+		exit_if_fail (pthread_create (&ids[i], NULL, parseLargeRepeatedly, &threads[i]) == 0, "could not create thread");
+	}
+	for (int i = 0; i < 2; ++i)
+	{
+		pthread_join (ids[i], NULL);
+		succeed_if (threads[i].failures == 0, "parser in thread read wrong keys");
+		elektraPluginClose (threads[i].plugin, 0);
+	}
+
+	elektraUnlink (elektraFilename ());
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("YAJL       TESTS\n");
@@ -706,6 +904,10 @@ int main (int argc, char ** argv)
 	test_json ("yajl/testdata_below.json", getBelowKeys (), ksNew (0, KS_END));
 	test_json ("yajl/OpenICC_device_config_DB.json", getOpenICCKeys (), ksNew (0, KS_END));
 
+	test_largeMapped ();
+	test_largeStream ();
+	test_concurrentParsers ();
+
 	// TODO currently do not have a KeySet, wait for C-plugin to make
 	// it easy to generate it..
 	test_readWrite ("yajl/empty_object.json", ksNew (0, KS_END));
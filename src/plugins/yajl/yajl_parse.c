@@ -9,56 +9,122 @@
 #include "yajl.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <kdbease.h>
 #include <kdberrors.h>
+#include <kdbhelper.h>
 #include <kdbmacros.h>
 #include <yajl/yajl_parse.h>
 
 
-static elektraCursor itKs;
+/**
+ * State of one parse, passed to all callbacks of yajl.
+ */
+typedef struct
+{
+	KeySet * ks;
+	Key * current; ///< the key which gets the next value
+	Key * name;    ///< name of the current key, parts are added and removed while parsing
+	Key ** parents; ///< stack of the maps and arrays containing the current key
+	size_t depth;
+	size_t size;
+	char * buffer; ///< null-terminated copy of the string passed to a callback
+	size_t bufferSize;
+	int outOfMemory; ///< set if a callback canceled the parse, because memory could not be allocated
+} YajlParser;
+
+/**
+ * @return @p stringVal terminated by a null character
+ *
+ * The strings passed by yajl point into the input, which is not
+ * terminated and might be read-only.
+ *
+ * @retval NULL if the buffer could not be allocated
+ */
+static const char * elektraYajlTerminate (YajlParser * parser, const unsigned char * stringVal, yajl_size_type stringLen)
+{
+	if (stringLen + 1 > parser->bufferSize)
+	{
+		size_t bufferSize = stringLen + 1 > 2 * parser->bufferSize ? stringLen + 1 : 2 * parser->bufferSize;
+		if (elektraRealloc ((void **) &parser->buffer, bufferSize) == -1)
+		{
+			parser->outOfMemory = 1;
+			return NULL;
+		}
+		parser->bufferSize = bufferSize;
+	}
+	memcpy (parser->buffer, stringVal, stringLen);
+	parser->buffer[stringLen] = '\0';
+	return parser->buffer;
+}
+
+/**
+ * Appends a key with the current name, which becomes the current key.
+ */
+static Key * elektraYajlAppendKey (YajlParser * parser)
+{
+	Key * key = keyDup (parser->name, KEY_CP_NAME);
+	ksAppendKey (parser->ks, key);
+	parser->current = key;
+	return key;
+}
 
-static void elektraYajlSetArrayLength (KeySet * ks, Key * current)
+/**
+ * @retval 1 on success
+ * @retval 0 if the stack could not be allocated
+ */
+static int elektraYajlPushParent (YajlParser * parser)
 {
-	// Update array length in array key
-	Key * arrayKey = keyNew (keyName (current), KEY_END);
-	keySetBaseName (arrayKey, 0);
-	Key * foundKey = ksLookup (ks, arrayKey, 0);
-	keySetMeta (foundKey, "array", keyBaseName (current));
-	keyDel (arrayKey);
+	if (parser->depth == parser->size)
+	{
+		size_t size = parser->size ? 2 * parser->size : 16;
+		if (elektraRealloc ((void **) &parser->parents, size * sizeof (Key *)) == -1)
+		{
+			parser->outOfMemory = 1;
+			return 0;
+		}
+		parser->size = size;
+	}
+	parser->parents[parser->depth++] = parser->current;
+	return 1;
 }
 
 /**
- @retval 0 if ksAtCursor(ks, it) does not hold an array entry
+ @retval 0 if the current key does not hold an array entry
  @retval 1 if the array entry will be used because its the first
  @retval 2 if a new array entry was created
- @retval -1 error in snprintf
  */
-static int elektraYajlIncrementArrayEntry (KeySet * ks)
+static int elektraYajlIncrementArrayEntry (YajlParser * parser)
 {
-	Key * current = ksAtCursor (ks, itKs);
+	Key * current = parser->current;
 	const char * baseName = keyBaseName (current);
 	const char * meta = keyString (keyGetMeta (current, "array"));
 	if (!strcmp (meta, "empty"))
 	{
-		current = keyNew (keyName (current), KEY_END);
-		keyAddName (current, "#0");
-		ksAppendKey (ks, current);
-		itKs = ksSearch (ks, current);
-		elektraYajlSetArrayLength (ks, current);
+		keyAddName (parser->name, "#0");
+		elektraYajlAppendKey (parser);
+		// update array length in array key
+		keySetMeta (current, "array", "#0");
 
 		return 1;
 	}
 	else if (baseName && *baseName == '#')
 	{
 		// we are in an array
-		current = keyNew (keyName (current), KEY_END);
-		elektraArrayIncName (current);
-		ksAppendKey (ks, current);
-		itKs = ksSearch (ks, current);
-		elektraYajlSetArrayLength (ks, current);
+		elektraArrayIncName (parser->name);
+		elektraYajlAppendKey (parser);
+		if (parser->depth > 0)
+		{
+			// update array length in array key
+			keySetMeta (parser->parents[parser->depth - 1], "array", keyBaseName (parser->current));
+		}
 
 		return 2;
 	}
@@ -71,12 +137,10 @@ static int elektraYajlIncrementArrayEntry (KeySet * ks)
 
 static int elektraYajlParseNull (void * ctx)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
-
-	Key * current = ksAtCursor (ks, itKs);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
 
-	keySetBinary (current, NULL, 0);
+	keySetBinary (parser->current, NULL, 0);
 
 	ELEKTRA_LOG_DEBUG ("parse null");
 
@@ -85,10 +149,10 @@ static int elektraYajlParseNull (void * ctx)
 
 static int elektraYajlParseBoolean (void * ctx, int boolean)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
 
-	Key * current = ksAtCursor (ks, itKs);
+	Key * current = parser->current;
 
 	if (boolean == 1)
 	{
@@ -107,103 +171,79 @@ static int elektraYajlParseBoolean (void * ctx, int boolean)
 
 static int elektraYajlParseNumber (void * ctx, const char * stringVal, yajl_size_type stringLen)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
 
-	Key * current = ksAtCursor (ks, itKs);
+	const char * stringValue = elektraYajlTerminate (parser, (const unsigned char *) stringVal, stringLen);
+	if (!stringValue) return 0;
 
-	unsigned char delim = stringVal[stringLen];
-	char * stringValue = (char *) stringVal;
-	stringValue[stringLen] = '\0';
+	ELEKTRA_LOG_DEBUG ("%s %zu", stringValue, (size_t) stringLen);
 
-	ELEKTRA_LOG_DEBUG ("%s %zu", stringVal, stringLen);
-
-	keySetString (current, stringVal);
-	keySetMeta (current, "type", "double");
-
-	// restore old character in buffer
-	stringValue[stringLen] = delim;
+	keySetString (parser->current, stringValue);
+	keySetMeta (parser->current, "type", "double");
 
 	return 1;
 }
 
 static int elektraYajlParseString (void * ctx, const unsigned char * stringVal, yajl_size_type stringLen)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
-
-	Key * current = ksAtCursor (ks, itKs);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
 
-	unsigned char delim = stringVal[stringLen];
-	char * stringValue = (char *) stringVal;
-	stringValue[stringLen] = '\0';
+	const char * stringValue = elektraYajlTerminate (parser, stringVal, stringLen);
+	if (!stringValue) return 0;
 
-	ELEKTRA_LOG_DEBUG ("%s %zu", stringVal, stringLen);
+	ELEKTRA_LOG_DEBUG ("%s %zu", stringValue, (size_t) stringLen);
 
-	keySetString (current, stringValue);
+	keySetString (parser->current, stringValue);
 
-	// restore old character in buffer
-	stringValue[stringLen] = delim;
 	return 1;
 }
 
 static int elektraYajlParseMapKey (void * ctx, const unsigned char * stringVal, yajl_size_type stringLen)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
-
-	Key * currentKey = keyNew (keyName (ksAtCursor (ks, itKs)), KEY_END);
-	keySetString (currentKey, 0);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
 
-	unsigned char delim = stringVal[stringLen];
-	char * stringValue = (char *) stringVal;
-	stringValue[stringLen] = '\0';
+	const char * stringValue = elektraYajlTerminate (parser, stringVal, stringLen);
+	if (!stringValue) return 0;
 
-	ELEKTRA_LOG_DEBUG ("stringValue: %s currentKey: %s", stringValue, keyName (currentKey));
-	if (currentKey && !strcmp (keyBaseName (currentKey), "___empty_map"))
+	ELEKTRA_LOG_DEBUG ("stringValue: %s currentKey: %s", stringValue, keyName (parser->current));
+	if (!strcmp (keyBaseName (parser->current), "___empty_map"))
 	{
-		// remove old key
-		keyDel (ksLookup (ks, currentKey, KDB_O_POP));
-		itKs = 0; // current key was popped from KeySet
-		// now we know the name of the object
-		keySetBaseName (currentKey, stringValue);
+		// remove old key, now we know the name of the object
+		keyDel (ksLookup (parser->ks, parser->current, KDB_O_POP));
+		parser->current = NULL;
 	}
-	else
-	{
-		// we entered a new pair (inside the previous object)
-		keySetBaseName (currentKey, stringValue);
-	}
-	ksAppendKey (ks, currentKey);
-	itKs = ksSearch (ks, currentKey);
 
-	// restore old character in buffer
-	stringValue[stringLen] = delim;
+	// we entered a new pair (inside the previous object)
+	keySetBaseName (parser->name, stringValue);
+	Key * currentKey = elektraYajlAppendKey (parser);
+	keySetString (currentKey, 0);
 
 	return 1;
 }
 
 static int elektraYajlParseStartMap (void * ctx)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
+	if (!elektraYajlPushParent (parser)) return 0;
 
-	Key * currentKey = ksAtCursor (ks, itKs);
-
-	Key * newKey = keyNew (keyName (currentKey), KEY_END);
 	// add a pseudo element for empty map
-	keyAddBaseName (newKey, "___empty_map");
-	ksAppendKey (ks, newKey);
-	itKs = ksSearch (ks, newKey);
+	keyAddBaseName (parser->name, "___empty_map");
+	elektraYajlAppendKey (parser);
 
-	ELEKTRA_LOG_DEBUG ("with new key %s", keyName (newKey));
+	ELEKTRA_LOG_DEBUG ("with new key %s", keyName (parser->current));
 
 	return 1;
 }
 
 static int elektraYajlParseEnd (void * ctx)
 {
-	KeySet * ks = (KeySet *) ctx;
-	Key * currentKey = ksAtCursor (ks, itKs);
+	YajlParser * parser = (YajlParser *) ctx;
+	Key * currentKey = parser->current;
+	Key * container = parser->parents[--parser->depth];
 
 	const char * meta = keyString (keyGetMeta (currentKey, "array"));
 	// If array is still empty by the time we reach the end, replace with ""
@@ -213,39 +253,26 @@ static int elektraYajlParseEnd (void * ctx)
 		return 1;
 	}
 
-	Key * lookupKey = keyNew (keyName (currentKey), KEY_END);
-	keySetBaseName (lookupKey, 0); // remove current baseName
-
-	// lets move iterator to the correct place
-	itKs = ksSearch (ks, lookupKey);
+	// lets move to the map or array containing the current key
+	keySetBaseName (parser->name, 0);
+	parser->current = container;
 
-#ifdef HAVE_LOGGER
-	if (itKs >= 0)
-	{
-		ELEKTRA_LOG_DEBUG ("Iterator position: %zd", itKs);
-	}
-	else
-	{
-		ELEKTRA_LOG_DEBUG ("Did not find key %s", keyName (lookupKey));
-	}
-#endif
-
-	keyDel (lookupKey);
+	ELEKTRA_LOG_DEBUG ("back at key %s", keyName (container));
 
 	return 1;
 }
 
 static int elektraYajlParseStartArray (void * ctx)
 {
-	KeySet * ks = (KeySet *) ctx;
-	elektraYajlIncrementArrayEntry (ks);
-
-	Key * currentKey = ksAtCursor (ks, itKs);
+	YajlParser * parser = (YajlParser *) ctx;
+	elektraYajlIncrementArrayEntry (parser);
 
-	Key * newKey = keyNew (keyName (currentKey), KEY_END);
+	// replaces the current key
+	Key * newKey = keyDup (parser->name, KEY_CP_NAME);
 	keySetMeta (newKey, "array", "empty");
-	ksAppendKey (ks, newKey);
-	itKs = ksSearch (ks, newKey);
+	ksAppendKey (parser->ks, newKey);
+	parser->current = newKey;
+	if (!elektraYajlPushParent (parser)) return 0;
 
 	ELEKTRA_LOG_DEBUG ("with new key %s", keyName (newKey));
 
@@ -268,10 +295,7 @@ static void elektraYajlParseSuppressNonLeafKeys (KeySet * returned)
 		if (next == NULL) break;
 
 
-		Key * peekDup = keyDup (next, KEY_CP_ALL);
-		keySetBaseName (peekDup, 0);
-
-		if (!strcmp (keyName (peekDup), keyName (cur)))
+		if (keyIsDirectlyBelow (cur, next) == 1)
 		{
 			const char * baseName = keyBaseName (next);
 			// TODO: Add test for empty array check
@@ -288,7 +312,6 @@ static void elektraYajlParseSuppressNonLeafKeys (KeySet * returned)
 			}
 		}
 
-		keyDel (peekDup);
 		cur = ksAtCursor (returned, it);
 	}
 }
@@ -304,7 +327,7 @@ static void elektraYajlParseSuppressEmptyMap (KeySet * returned, Key * parentKey
 
 	if (ksGetSize (returned) == 2)
 	{
-		Key * lookupKey = keyDup (parentKey, KEY_CP_ALL);
+		Key * lookupKey = keyDup (parentKey, KEY_CP_NAME);
 		keyAddBaseName (lookupKey, "___empty_map");
 		Key * toRemove = ksLookup (returned, lookupKey, KDB_O_POP);
 
@@ -348,6 +371,103 @@ static inline KeySet * elektraGetModuleConfig (void)
 		      keyNew ("system:/elektra/modules/yajl/config/needs/boolean/restoreas", KEY_VALUE, "none", KEY_END), KS_END);
 }
 
+/**
+ * Passes @p size bytes of @p data to yajl.
+ *
+ * @param complete if all data was passed and yajl should finish parsing
+ *
+ * @retval 0 on success
+ * @retval -1 on parse or memory errors, which are set in @p parentKey
+ */
+static int elektraYajlParseData (yajl_handle hand, YajlParser * parser, const unsigned char * data, yajl_size_type size, int complete,
+				 Key * parentKey)
+{
+	yajl_status stat;
+	if (complete)
+	{
+#if YAJL_MAJOR == 1
+		stat = yajl_parse_complete (hand);
+#else
+		stat = yajl_complete_parse (hand);
+#endif
+	}
+	else
+	{
+		stat = yajl_parse (hand, data, size);
+	}
+	int test_status = (stat != yajl_status_ok);
+#if YAJL_MAJOR == 1
+	test_status = test_status && (stat != yajl_status_insufficient_data);
+#endif
+	if (test_status && parser->outOfMemory)
+	{
+		ELEKTRA_SET_OUT_OF_MEMORY_ERROR (parentKey);
+		return -1;
+	}
+	if (test_status)
+	{
+		unsigned char * str = yajl_get_error (hand, 1, data, size);
+		ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Yajl parse error happened. Reason: %s", (char *) str);
+		yajl_free_error (hand, str);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Parses the file directly from memory, without copying it.
+ */
+static int elektraYajlParseMapped (yajl_handle hand, YajlParser * parser, int fd, size_t size, Key * parentKey)
+{
+	unsigned char * data = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		ELEKTRA_SET_RESOURCE_ERRORF (parentKey, "Could not map file %s into memory. Reason: %s", keyString (parentKey),
+					     strerror (errno));
+		return -1;
+	}
+	madvise (data, size, MADV_SEQUENTIAL);
+
+	int ret = elektraYajlParseData (hand, parser, data, size, 0, parentKey);
+	if (ret == 0)
+	{
+		ret = elektraYajlParseData (hand, parser, data, size, 1, parentKey);
+	}
+
+	munmap (data, size);
+	return ret;
+}
+
+/**
+ * Parses the file in chunks, for files that cannot be mapped (e.g. pipes).
+ */
+static int elektraYajlParseStream (yajl_handle hand, YajlParser * parser, int fd, Key * parentKey)
+{
+	unsigned char fileData[65536];
+	int done = 0;
+	while (!done)
+	{
+		ssize_t rd = read (fd, fileData, sizeof (fileData) - 1);
+		if (rd == -1 && errno == EINTR) continue;
+		if (rd == -1)
+		{
+			ELEKTRA_SET_RESOURCE_ERRORF (parentKey, "Error while reading file: %s", keyString (parentKey));
+			return -1;
+		}
+		if (rd == 0)
+		{
+			done = 1;
+		}
+		fileData[rd] = 0;
+
+		if (elektraYajlParseData (hand, parser, fileData, (yajl_size_type) rd, done, parentKey) != 0)
+		{
+			return -1;
+		}
+	}
+	return 0;
+}
+
 int elektraYajlGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * parentKey)
 {
 	if (!strcmp (keyName (parentKey), "system:/elektra/modules/yajl"))
@@ -370,77 +490,57 @@ int elektraYajlGet (Plugin * handle ELEKTRA_UNUSED, KeySet * returned, Key * par
 				     elektraYajlParseStartArray,
 				     elektraYajlParseEnd };
 
-	ksAppendKey (returned, keyNew (keyName ((parentKey)), KEY_END));
-
-#if YAJL_MAJOR == 1
-	yajl_parser_config cfg = { 1, 1 };
-	yajl_handle hand = yajl_alloc (&callbacks, &cfg, NULL, returned);
-#else
-	yajl_handle hand = yajl_alloc (&callbacks, NULL, returned);
-	yajl_config (hand, yajl_allow_comments, 1);
-#endif
-
 	int errnosave = errno;
-	unsigned char fileData[65536];
-	int done = 0;
-	FILE * fileHandle = fopen (keyString (parentKey), "r");
-	if (!fileHandle)
+	int fd = open (keyString (parentKey), O_RDONLY);
+	if (fd == -1)
 	{
-		yajl_free (hand);
 		ELEKTRA_SET_ERROR_GET (parentKey);
 		errno = errnosave;
 		return -1;
 	}
-
-	/* external iteration of the keyset */
-	itKs = 0;
-	while (!done)
+	struct stat sbuf;
+	if (fstat (fd, &sbuf) == -1)
 	{
-		yajl_size_type rd = fread ((void *) fileData, 1, sizeof (fileData) - 1, fileHandle);
-		if (rd == 0)
-		{
-			if (!feof (fileHandle))
-			{
-				ELEKTRA_SET_RESOURCE_ERRORF (parentKey, "Error while reading file: %s", keyString (parentKey));
-				fclose (fileHandle);
-				yajl_free (hand);
-				return -1;
-			}
-			done = 1;
-		}
-		fileData[rd] = 0;
+		ELEKTRA_SET_ERROR_GET (parentKey);
+		close (fd);
+		errno = errnosave;
+		return -1;
+	}
+
+	Key * root = keyNew (keyName (parentKey), KEY_END);
+	ksAppendKey (returned, root);
+
+	YajlParser parser = { .ks = returned, .current = root, .name = keyDup (root, KEY_CP_NAME) };
 
-		yajl_status stat;
-		if (done)
-		{
 #if YAJL_MAJOR == 1
-			stat = yajl_parse_complete (hand);
+	yajl_parser_config cfg = { 1, 1 };
+	yajl_handle hand = yajl_alloc (&callbacks, &cfg, NULL, &parser);
 #else
-			stat = yajl_complete_parse (hand);
-#endif
-		}
-		else
-		{
-			stat = yajl_parse (hand, fileData, rd);
-		}
-		int test_status = (stat != yajl_status_ok);
-#if YAJL_MAJOR == 1
-		test_status = test_status && (stat != yajl_status_insufficient_data);
+	yajl_handle hand = yajl_alloc (&callbacks, NULL, &parser);
+	yajl_config (hand, yajl_allow_comments, 1);
 #endif
-		if (test_status)
-		{
-			unsigned char * str = yajl_get_error (hand, 1, fileData, rd);
-			ELEKTRA_SET_VALIDATION_SYNTACTIC_ERRORF (parentKey, "Yajl parse error happened. Reason: %s", (char *) str);
-			yajl_free_error (hand, str);
-			yajl_free (hand);
-			fclose (fileHandle);
 
-			return -1;
-		}
+	int ret;
+	if (S_ISREG (sbuf.st_mode) && sbuf.st_size > 0 && (uintmax_t) sbuf.st_size <= (yajl_size_type) -1)
+	{
+		ret = elektraYajlParseMapped (hand, &parser, fd, (size_t) sbuf.st_size, parentKey);
+	}
+	else
+	{
+		ret = elektraYajlParseStream (hand, &parser, fd, parentKey);
 	}
 
 	yajl_free (hand);
-	fclose (fileHandle);
+	close (fd);
+	keyDel (parser.name);
+	elektraFree (parser.parents);
+	elektraFree (parser.buffer);
+	errno = errnosave;
+	if (ret != 0)
+	{
+		return -1;
+	}
+
 	elektraYajlParseSuppressNonLeafKeys (returned);
 	elektraYajlParseSuppressEmptyMap (returned, parentKey);
 
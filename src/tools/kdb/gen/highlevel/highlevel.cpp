@@ -294,6 +294,7 @@ kainjow::mustache::data HighlevelGenTemplate::getTemplateData (const std::string
 	list enums;
 	list structs;
 	list keys;
+	list indexedKeys;
 	list unions;
 	list commands;
 
@@ -611,6 +612,13 @@ kainjow::mustache::data HighlevelGenTemplate::getTemplateData (const std::string
 			}
 		}
 
+		// keys with a fixed name and a builtin type are read via the key index
+		if (args.empty () && type != "enum" && type != "struct" && type != "struct_ref")
+		{
+			keyObject["key_id?"] = object{ { "key_id", std::to_string (indexedKeys.size ()) } };
+			indexedKeys.emplace_back (object{ { "name", keyObject["name"].string_value () }, { "type", type } });
+		}
+
 		keys.emplace_back (keyObject);
 	}
 
@@ -639,6 +647,9 @@ kainjow::mustache::data HighlevelGenTemplate::getTemplateData (const std::string
 
 	data["keys_count"] = std::to_string (keys.size ());
 	data["keys"] = keys;
+	data["indexed_keys?"] = !indexedKeys.empty ();
+	data["indexed_keys"] = indexedKeys;
+	data["indexed_keys_count"] = std::to_string (indexedKeys.size ());
 	data["enums"] = enums;
 	data["unions"] = unions;
 	data["structs"] = structs;
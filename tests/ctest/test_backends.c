@@ -127,6 +127,73 @@ void test_backendsDivide (void)
 	ksDel (ks9);
 }
 
+static void checkFindParent (KeySet * backends, const BackendsIndex * index, const char * name, const char * expected)
+{
+	Key * key = keyNew (name, KEY_END);
+
+	Key * parent = backendsFindParent (backends, index, key);
+	succeed_if_same_string (keyName (parent), expected);
+
+	// searching without the index must give the same result
+	parent = backendsFindParent (backends, NULL, key);
+	succeed_if_same_string (keyName (parent), expected);
+
+	keyDel (key);
+}
+
+static void test_backendsFindParent (void)
+{
+	printf ("Test backendsFindParent");
+
+	KeySet * backends = ksNew (0, KS_END);
+
+	addBackendForDivide (backends, "dir:/");
+	addBackendForDivide (backends, "user:/");
+	addBackendForDivide (backends, "user:/bar");
+	addBackendForDivide (backends, "user:/bar/bar");
+	addBackendForDivide (backends, "user:/bar/baz/deep/mountpoint");
+	addBackendForDivide (backends, "user:/foo\\/bar");
+	addBackendForDivide (backends, "system:/elektra");
+	addBackendForDivide (backends, "default:/");
+
+	BackendsIndex * index = backendsIndexNew (backends);
+	exit_if_fail (index != NULL, "couldn't create index");
+
+	checkFindParent (backends, index, "dir:/", "dir:/");
+	checkFindParent (backends, index, "dir:/abc/def", "dir:/");
+	checkFindParent (backends, index, "user:/", "user:/");
+	checkFindParent (backends, index, "user:/abc", "user:/");
+	checkFindParent (backends, index, "user:/ba", "user:/");
+	checkFindParent (backends, index, "user:/barx", "user:/");
+	checkFindParent (backends, index, "user:/bar", "user:/bar");
+	checkFindParent (backends, index, "user:/bar/%", "user:/bar");
+	checkFindParent (backends, index, "user:/bar/abc", "user:/bar");
+	checkFindParent (backends, index, "user:/bar/bar/abc/def", "user:/bar/bar");
+	checkFindParent (backends, index, "user:/bar/baz/deep", "user:/bar");
+	checkFindParent (backends, index, "user:/bar/baz/deep/mountpoint/abc", "user:/bar/baz/deep/mountpoint");
+	checkFindParent (backends, index, "user:/foo/bar", "user:/");
+	checkFindParent (backends, index, "user:/foo\\/bar/abc", "user:/foo\\/bar");
+	checkFindParent (backends, index, "system:/", "default:/");
+	checkFindParent (backends, index, "system:/abc", "default:/");
+	checkFindParent (backends, index, "system:/elektra/mountpoints", "system:/elektra");
+	checkFindParent (backends, index, "spec:/abc", "default:/");
+	checkFindParent (backends, index, "/abc", "default:/");
+	checkFindParent (backends, index, "default:/abc", "default:/");
+
+	Key * parentKey = keyNew ("/bar/bar", KEY_END);
+	KeySet * selected = backendsForParentKey (backends, index, parentKey);
+	succeed_if_same_string (keyName (parentKey), "/bar/bar");
+	succeed_if (ksGetSize (selected) == 3, "wrong number of backends selected");
+	succeed_if (ksLookupByName (selected, "dir:/", 0) != NULL, "dir:/ not selected");
+	succeed_if (ksLookupByName (selected, "user:/bar/bar", 0) != NULL, "user:/bar/bar not selected");
+	succeed_if (ksLookupByName (selected, "default:/", 0) != NULL, "default:/ not selected");
+	ksDel (selected);
+	keyDel (parentKey);
+
+	backendsIndexDel (index);
+	deleteBackends (backends);
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("BACKENDS       TESTS\n");
@@ -135,6 +202,7 @@ int main (int argc, char ** argv)
 	init (argc, argv);
 
 	test_backendsDivide ();
+	test_backendsFindParent ();
 
 	printf ("\ntest_backends RESULTS: %d test(s) done. %d error(s).\n", nbTest, nbError);
 
@@ -818,6 +818,91 @@ static void test_keyCopy (void)
 	keyDel (keyValDest);
 }
 
+static void test_keyInline (void)
+{
+	printf ("test name and small values stored together with the key\n");
+
+	Key * k = keyNew ("user:/inline/#10", KEY_VALUE, "small", KEY_END);
+	succeed_if (k->data.v == (char *) k + sizeof (Key), "small value should be stored inline");
+	succeed_if (test_bit (k->flags, KEY_FLAG_MMAP_KEY | KEY_FLAG_MMAP_DATA), "inline buffers must not be freed");
+	succeed_if_same_string (keyName (k), "user:/inline/#_10");
+	succeed_if_same_string (keyString (k), "small");
+	succeed_if (keyNeedSync (k), "new key should need sync");
+
+	// values that still fit reuse the inline buffer
+	keySetString (k, "tiny");
+	succeed_if (k->data.v == (char *) k + sizeof (Key), "value should still be inline");
+	succeed_if_same_string (keyString (k), "tiny");
+
+	// bigger values move to the heap
+	char big[KEY_INLINE_VALUE_SIZE * 2];
+	memset (big, 'x', sizeof (big) - 1);
+	big[sizeof (big) - 1] = '\0';
+	keySetString (k, big);
+	succeed_if (k->data.v != (char *) k + sizeof (Key), "big value should not be inline");
+	succeed_if_same_string (keyString (k), big);
+
+	// and back into the inline buffer
+	keySetString (k, "small");
+	succeed_if (k->data.v == (char *) k + sizeof (Key), "small value should be inline again");
+	succeed_if_same_string (keyString (k), "small");
+
+	// renaming copies the name out of the Key allocation
+	succeed_if (keySetName (k, "system:/renamed") > 0, "could not rename");
+	succeed_if_same_string (keyName (k), "system:/renamed");
+	succeed_if_same_string (keyString (k), "small");
+	succeed_if (keyAddBaseName (k, "sub") > 0, "could not add base name");
+	succeed_if_same_string (keyName (k), "system:/renamed/sub");
+
+	Key * d = keyDup (k, KEY_CP_ALL);
+	succeed_if (d->data.v == (char *) d + sizeof (Key), "duplicated small value should be inline");
+	compare_key (d, k);
+	succeed_if (keyDup (k, KEY_CP_VALUE | KEY_CP_STRING) == NULL, "could dup despite of illegal flags");
+	keyDel (d);
+
+	d = keyDup (k, KEY_CP_NAME);
+	succeed_if_same_string (keyName (d), "system:/renamed/sub");
+	succeed_if (keyValue (d) == NULL || keyGetValueSize (d) <= 1, "value should not be copied");
+	// no buffer was reserved, so the value goes to the heap
+	keySetString (d, "value");
+	succeed_if (d->data.v != (char *) d + sizeof (Key), "value should not be inline");
+	succeed_if_same_string (keyString (d), "value");
+	keyDel (d);
+
+	d = keyDup (NULL, KEY_CP_ALL);
+	succeed_if_same_string (keyName (d), "/");
+	keyDel (d);
+
+	// keyClear keeps the inline buffer
+	keyClear (k);
+	succeed_if_same_string (keyName (k), "/");
+	keySetString (k, "again");
+	succeed_if (k->data.v == (char *) k + sizeof (Key), "inline buffer should survive keyClear");
+	succeed_if_same_string (keyString (k), "again");
+	keyDel (k);
+
+	int data = 42;
+	Key * b = keyNew ("user:/binary", KEY_BINARY, KEY_SIZE, sizeof (data), KEY_VALUE, &data, KEY_END);
+	succeed_if (keyIsBinary (b), "key should be binary");
+	succeed_if (b->data.v == (char *) b + sizeof (Key), "small binary value should be inline");
+	succeed_if (keyGetValueSize (b) == sizeof (data), "wrong value size");
+	succeed_if (*(const int *) keyValue (b) == 42, "wrong binary value");
+
+	Key * c = keyNew ("user:/copy", KEY_VALUE, "12345678", KEY_END);
+	succeed_if (keyCopy (c, b, KEY_CP_VALUE) != NULL, "could not copy value");
+	succeed_if (c->data.v == (char *) c + sizeof (Key), "copied value should be inline");
+	succeed_if (*(const int *) keyValue (c) == 42, "wrong copied value");
+	keyDel (b);
+	keyDel (c);
+
+	Key * f = keyNew ("user:/func", KEY_FUNC, test_keyInline, KEY_END);
+	succeed_if (f->data.v == (char *) f + sizeof (Key), "function pointer should be inline");
+	void (*func) (void) = 0;
+	succeed_if (keyGetBinary (f, &func, sizeof (func)) == sizeof (func), "could not get function");
+	succeed_if (func == test_keyInline, "wrong function");
+	keyDel (f);
+}
+
 static void test_keyFixedNew (void)
 {
 	printf ("test fixed new\n");
@@ -1211,6 +1296,52 @@ static void test_keyReplacePrefix (void)
 	keyDel (newPrefix);
 }
 
+static void test_keyTypedValue (void)
+{
+	printf ("Test typed value cache\n");
+
+	Key * key = keyNew ("user:/key", KEY_VALUE, "42", KEY_END);
+	long value = 0;
+	succeed_if (elektraKeyGetTypedValue (key, "long", &value, sizeof (value)) == 0, "no value should be cached");
+
+	long cached = 42;
+	succeed_if (elektraKeySetTypedValue (key, "long", &cached, sizeof (cached)) == 1, "could not cache value");
+	succeed_if (elektraKeyGetTypedValue (key, "long", &value, sizeof (value)) == 1, "value should be cached");
+	succeed_if (value == 42, "wrong cached value");
+
+	short shortValue = 0;
+	succeed_if (elektraKeyGetTypedValue (key, "short", &shortValue, sizeof (shortValue)) == 0, "other type should not be cached");
+	succeed_if (elektraKeyGetTypedValue (key, "long", &shortValue, sizeof (shortValue)) == 0, "other size should not be cached");
+
+	Key * dup = keyDup (key, KEY_CP_ALL);
+	value = 0;
+	succeed_if (elektraKeyGetTypedValue (dup, "long", &value, sizeof (value)) == 1 && value == 42, "keyDup should copy cached value");
+	keyCopy (dup, key, KEY_CP_NAME);
+	succeed_if (elektraKeyGetTypedValue (dup, "long", &value, sizeof (value)) == 1, "copying the name should keep cached value");
+	keyDel (dup);
+
+	keySetString (key, "43");
+	succeed_if (elektraKeyGetTypedValue (key, "long", &value, sizeof (value)) == 0, "keySetString should drop cached value");
+
+	elektraKeySetTypedValue (key, "long", &cached, sizeof (cached));
+	keySetBinary (key, "43", 3);
+	succeed_if (elektraKeyGetTypedValue (key, "long", &value, sizeof (value)) == 0, "keySetBinary should drop cached value");
+
+	elektraKeySetTypedValue (key, "long", &cached, sizeof (cached));
+	Key * other = keyNew ("user:/other", KEY_VALUE, "44", KEY_END);
+	keyCopy (key, other, KEY_CP_VALUE);
+	succeed_if (elektraKeyGetTypedValue (key, "long", &value, sizeof (value)) == 0, "keyCopy should drop cached value");
+	keyDel (other);
+
+	keyLock (key, KEY_LOCK_VALUE);
+	succeed_if (elektraKeySetTypedValue (key, "long", &cached, sizeof (cached)) == 0, "read-only value should not be cached");
+
+	char tooBig[sizeof (long double) + 1] = { 0 };
+	succeed_if (elektraKeySetTypedValue (key, "big", tooBig, sizeof (tooBig)) == 0, "too big value should not be cached");
+
+	keyDel (key);
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("KEY      TESTS\n");
@@ -1230,10 +1361,12 @@ int main (int argc, char ** argv)
 	test_keyLock ();
 	test_keyNeedSync ();
 	test_keyCopy ();
+	test_keyInline ();
 	test_keyFixedNew ();
 	test_keyFlags ();
 	test_warnings ();
 	test_keyReplacePrefix ();
+	test_keyTypedValue ();
 
 	print_result ("test_key");
 	return nbError;
@@ -0,0 +1,98 @@
+/**
+ * @file
+ *
+ * @brief Tests for the scanners used in key name canonicalization and unescaping
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#define ELEKTRA_KEYNAME_SCANNER_OVERRIDE
+#include <keyname.c>
+#include <tests_internal.h>
+
+static const char * scanners[] = { "sse2", "avx2" };
+
+static const char * names[] = {
+	"user:/",
+	"/a",
+	"system:/elektra/mountpoints/user:\\/sw\\/org\\/app/config",
+	"user:/sw/org/app/#0/current/../current/./%/section/#10/#_11/#123456789",
+	"user:/escaped\\\\backslashes\\\\\\/and\\/slashes/\\%/\\#1/\\./\\../\\%",
+	"dir://many////slashes///",
+};
+
+static void canonicalizeAndUnescape (const char * name, char ** canonical, size_t * canonicalSize, char ** unescaped, size_t * unescapedSize)
+{
+	*canonical = NULL;
+	*canonicalSize = 0;
+	*unescapedSize = 0;
+	elektraKeyNameCanonicalize (name, canonical, canonicalSize, 0, unescapedSize);
+	*unescaped = elektraMalloc (*unescapedSize);
+	elektraKeyNameUnescape (*canonical, *unescaped);
+}
+
+static void test_scanners (void)
+{
+	printf ("test key name scanners\n");
+
+	char name[256];
+	for (size_t s = 0; s < sizeof (scanners) / sizeof (scanners[0]); ++s)
+	{
+		if (!useScanner (scanners[s]))
+		{
+			printf ("scanner %s is not supported, skipping\n", scanners[s]);
+			continue;
+		}
+
+		for (size_t n = 0; n < sizeof (names) / sizeof (names[0]); ++n)
+		{
+			// different lengths and alignments, so that special characters appear everywhere in a block
+			for (size_t pad = 0; pad < 40; ++pad)
+			{
+				snprintf (name, sizeof (name), "%s/%.*s/x", names[n], (int) pad,
+					  "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+				exit_if_fail (elektraKeyNameValidate (name, true), "invalid test name");
+
+				char * expected;
+				char * expectedUnescaped;
+				size_t expectedSize;
+				size_t expectedUnescapedSize;
+				succeed_if (useScanner ("scalar"), "scalar scanner must always be available");
+				canonicalizeAndUnescape (name, &expected, &expectedSize, &expectedUnescaped, &expectedUnescapedSize);
+
+				char * actual;
+				char * actualUnescaped;
+				size_t actualSize;
+				size_t actualUnescapedSize;
+				succeed_if (useScanner (scanners[s]), "could not select scanner");
+				canonicalizeAndUnescape (name, &actual, &actualSize, &actualUnescaped, &actualUnescapedSize);
+
+				succeed_if_same_string (actual, expected);
+				succeed_if (actualSize == expectedSize, "wrong canonical size");
+				succeed_if (actualUnescapedSize == expectedUnescapedSize, "wrong unescaped size");
+				succeed_if (memcmp (actualUnescaped, expectedUnescaped, expectedUnescapedSize) == 0, "wrong unescaped name");
+
+				elektraFree (expected);
+				elektraFree (expectedUnescaped);
+				elektraFree (actual);
+				elektraFree (actualUnescaped);
+			}
+		}
+	}
+
+	succeed_if (!useScanner ("unknown"), "unknown scanner selected");
+}
+
+int main (int argc, char ** argv)
+{
+	printf ("KEYNAME SCANNER TESTS\n");
+	printf ("=====================\n\n");
+
+	init (argc, argv);
+
+	test_scanners ();
+
+	print_result ("test_keyname_scanner");
+
+	return nbError;
+}
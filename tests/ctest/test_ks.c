@@ -554,6 +554,364 @@ static void test_ksSearch (void)
 	ksDel (a);
 }
 
+static void test_ksSearchCommonPrefix (void)
+{
+	printf ("Testing ksSearch with long common prefixes\n");
+
+	// names with long shared prefixes, differing at various offsets
+	KeySet * ks = ksNew (0, KS_END);
+	char name[256];
+	for (int i = 0; i < 20; ++i)
+	{
+		for (int j = 0; j < 20; ++j)
+		{
+			snprintf (name, sizeof (name), "user:/sw/org/application/#0/current/section%d/entry%d", i, j);
+			ksAppendKey (ks, keyNew (name, KEY_END));
+			snprintf (name, sizeof (name), "user:/sw/org/application/#0/current/section%d/entry%d/sub", i, j);
+			ksAppendKey (ks, keyNew (name, KEY_END));
+		}
+	}
+	ksAppendKey (ks, keyNew ("user:/sw/org/application", KEY_END));
+	ksAppendKey (ks, keyNew ("system:/sw/org/application", KEY_END));
+
+	for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+	{
+		Key * cur = ksAtCursor (ks, it);
+		succeed_if (ksSearch (ks, cur) == it, "existing key not found at its position");
+		succeed_if (ksLookup (ks, cur, 0) == cur, "existing key not found by lookup");
+
+		// a key directly after cur, which is not part of ks
+		Key * next = keyDup (cur, KEY_CP_NAME);
+		keyAddBaseName (next, "%");
+		elektraCursor expected = it + 1;
+		while (expected < ksGetSize (ks) && keyCmp (ksAtCursor (ks, expected), next) < 0)
+		{
+			++expected;
+		}
+		succeed_if (ksSearch (ks, next) == -expected - 1, "insertpos wrong");
+		succeed_if (ksLookup (ks, next, 0) == NULL, "found key that is not part of ks");
+		keyDel (next);
+	}
+
+	Key * key = keyNew ("user:/sw/org/application/#0/current/section10/entry5/sub", KEY_END);
+	Key * popped = ksLookup (ks, key, KDB_O_POP);
+	succeed_if (popped != NULL, "could not pop key");
+	succeed_if (ksLookup (ks, key, 0) == NULL, "popped key still found");
+	keyDel (popped);
+	keyDel (key);
+
+	ksDel (ks);
+}
+
+static void test_ksAppendMerge (void)
+{
+	printf ("Testing ksAppend merging\n");
+
+	Key * shared = keyNew ("user:/b", KEY_VALUE, "shared", KEY_END);
+	Key * replaced = keyNew ("user:/c", KEY_VALUE, "old", KEY_END);
+	keyIncRef (replaced);
+	KeySet * ks = ksNew (4, keyNew ("user:/a", KEY_END), shared, replaced, keyNew ("user:/e", KEY_END), KS_END);
+	KeySet * toAppend = ksNew (5, keyNew ("system:/a", KEY_END), shared, keyNew ("user:/c", KEY_VALUE, "new", KEY_END),
+				   keyNew ("user:/d", KEY_END), keyNew ("user:/f", KEY_END), KS_END);
+
+	succeed_if (ksAppend (ks, toAppend) == 7, "wrong size after merge");
+	succeed_if (ksGetSize (toAppend) == 5, "toAppend must be unchanged");
+
+	const char * expected[] = { "user:/a", "user:/b", "user:/c", "user:/d", "user:/e", "user:/f", "system:/a" };
+	for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+	{
+		succeed_if_same_string (keyName (ksAtCursor (ks, it)), expected[it]);
+	}
+	succeed_if (ksAtCursor (ks, 7) == NULL, "array must be null terminated");
+
+	succeed_if (ksLookupByName (ks, "user:/b", 0) == shared, "shared key must stay");
+	succeed_if (shared->refs == 2, "shared key must be referenced by both KeySets");
+	succeed_if_same_string (keyString (ksLookupByName (ks, "user:/c", 0)), "new");
+	succeed_if (replaced->refs == 1, "replaced key must not be referenced by ks anymore");
+	Key * appended = ksLookupByName (toAppend, "user:/f", 0);
+	succeed_if (ksLookupByName (ks, "user:/f", 0) == appended, "appended key not found");
+	succeed_if (keyIsLocked (appended, KEY_LOCK_NAME), "appended keys must have locked names");
+
+	succeed_if (ksAppend (ks, ks) == 7, "appending to itself must not change ks");
+	succeed_if (ksAppend (ks, toAppend) == 7, "appending again must not change size");
+
+	KeySet * empty = ksNew (0, KS_END);
+	succeed_if (ksAppend (empty, toAppend) == 5, "could not append to empty KeySet");
+	compare_keyset (empty, toAppend);
+
+	// with enough room, the Keys are merged into the existing array
+	KeySet * roomy = ksNew (100, keyNew ("user:/a", KEY_END), keyNew ("user:/c", KEY_END), keyNew ("user:/e", KEY_END), KS_END);
+	Key ** array = roomy->array;
+	KeySet * few = ksNew (2, keyNew ("user:/b", KEY_END), keyNew ("user:/d", KEY_END), KS_END);
+	succeed_if (ksAppend (roomy, few) == 5, "wrong size after merge");
+	succeed_if (roomy->array == array, "array with enough room must not be reallocated");
+	const char * expectedRoomy[] = { "user:/a", "user:/b", "user:/c", "user:/d", "user:/e" };
+	for (elektraCursor it = 0; it < ksGetSize (roomy); ++it)
+	{
+		succeed_if_same_string (keyName (ksAtCursor (roomy, it)), expectedRoomy[it]);
+	}
+	succeed_if (ksGetCursor (roomy) == 3, "cursor must be at the last appended key");
+
+	keyDecRef (replaced);
+	keyDel (replaced);
+	ksDel (few);
+	ksDel (roomy);
+	ksDel (empty);
+	ksDel (toAppend);
+	ksDel (ks);
+}
+
+static void test_ksBuilder (void)
+{
+	printf ("Testing ksBuilderAdd and ksBuilderFinish\n");
+
+	// sorted input is appended directly
+	KeySet * ks = ksNew (0, KS_END);
+	succeed_if (ksBuilderAdd (ks, keyNew ("user:/a", KEY_END)) == 1, "wrong size after add");
+	succeed_if (ksBuilderAdd (ks, keyNew ("user:/b", KEY_END)) == 2, "wrong size after add");
+	succeed_if (ksBuilderAdd (ks, keyNew ("user:/b", KEY_VALUE, "new", KEY_END)) == 2, "duplicate must replace");
+	succeed_if (ksBuilderAdd (ks, keyNew ("system:/a", KEY_END)) == 3, "wrong size after add");
+	succeed_if (ks->pending == 0, "sorted input must not be pending");
+	succeed_if (ksBuilderFinish (ks) == 3, "wrong size after finish");
+	succeed_if_same_string (keyString (ksLookupByName (ks, "user:/b", 0)), "new");
+	ksDel (ks);
+
+	// unsorted input with duplicates, merged into existing keys
+	Key * shared = keyNew ("user:/c", KEY_VALUE, "shared", KEY_END);
+	Key * replaced = keyNew ("user:/e", KEY_VALUE, "old", KEY_END);
+	keyIncRef (replaced);
+	ks = ksNew (3, keyNew ("user:/a", KEY_END), shared, replaced, KS_END);
+
+	ksBuilderAdd (ks, keyNew ("user:/f", KEY_END));
+	ksBuilderAdd (ks, keyNew ("user:/d", KEY_VALUE, "first", KEY_END));
+	ksBuilderAdd (ks, shared);
+	ksBuilderAdd (ks, keyNew ("system:/a", KEY_END));
+	ksBuilderAdd (ks, keyNew ("user:/e", KEY_VALUE, "new", KEY_END));
+	ksBuilderAdd (ks, keyNew ("user:/d", KEY_VALUE, "second", KEY_END));
+	Key * b = keyNew ("user:/b", KEY_END);
+	ksBuilderAdd (ks, b);
+	succeed_if (ksBuilderAdd (ks, b) == 11, "wrong size including pending keys");
+	succeed_if (ksBuilderAdd (ks, NULL) == -1, "NULL key accepted");
+
+	succeed_if (ksBuilderFinish (ks) == 7, "wrong size after finish");
+	succeed_if (ksBuilderFinish (ks) == 7, "finishing twice must not change anything");
+
+	const char * expected[] = { "user:/a", "user:/b", "user:/c", "user:/d", "user:/e", "user:/f", "system:/a" };
+	for (elektraCursor it = 0; it < ksGetSize (ks); ++it)
+	{
+		succeed_if_same_string (keyName (ksAtCursor (ks, it)), expected[it]);
+	}
+	succeed_if (ksAtCursor (ks, 7) == NULL, "array must be null terminated");
+
+	succeed_if_same_string (keyString (ksLookupByName (ks, "user:/d", 0)), "second");
+	succeed_if_same_string (keyString (ksLookupByName (ks, "user:/e", 0)), "new");
+	succeed_if (replaced->refs == 1, "replaced key must not be referenced by ks anymore");
+	succeed_if (shared->refs == 1, "shared key must be referenced once");
+	succeed_if (b->refs == 1, "key added twice must be referenced once");
+	succeed_if (keyIsLocked (b, KEY_LOCK_NAME), "added keys must have locked names");
+
+	keyDecRef (replaced);
+	keyDel (replaced);
+	ksDel (ks);
+
+	// many keys in scrambled order give the same result as ksAppendKey
+	KeySet * built = ksNew (0, KS_END);
+	KeySet * appended = ksNew (0, KS_END);
+	char name[64];
+	for (int i = 0; i < 1000; ++i)
+	{
+		snprintf (name, sizeof (name), "user:/tests/builder/%d/%d", (i * 7919) % 251, i % 13);
+		ksBuilderAdd (built, keyNew (name, KEY_VALUE, "v", KEY_END));
+		ksAppendKey (appended, keyNew (name, KEY_VALUE, "v", KEY_END));
+	}
+	ksBuilderFinish (built);
+	compare_keyset (built, appended);
+	ksDel (appended);
+	ksDel (built);
+
+	// keys of an unfinished build are freed by ksDel
+	ks = ksNew (0, KS_END);
+	ksBuilderAdd (ks, keyNew ("user:/b", KEY_END));
+	ksBuilderAdd (ks, keyNew ("user:/a", KEY_END));
+	ksDel (ks);
+}
+
+static void test_ksFreeze (void)
+{
+	printf ("Testing ksFreeze\n");
+
+	Key * a = keyNew ("user:/tests/freeze/a", KEY_VALUE, "va", KEY_META, "type", "string", KEY_END);
+	KeySet * ks = ksNew (10, a, keyNew ("user:/tests/freeze/b", KEY_VALUE, "vb", KEY_END),
+			     keyNew ("spec:/tests/freeze/c", KEY_META, "default", "vc", KEY_END), KS_END);
+	char name[64];
+	for (int i = 0; i < 1000; ++i)
+	{
+		snprintf (name, sizeof (name), "system:/tests/freeze/many/%d", i);
+		ksAppendKey (ks, keyNew (name, KEY_VALUE, "v", KEY_END));
+	}
+
+	succeed_if (ksFreeze (NULL) == NULL, "NULL accepted");
+	succeed_if (ksIsFrozen (NULL) == -1, "NULL accepted");
+	succeed_if (ksIsFrozen (ks) == 0, "regular keyset must not be frozen");
+
+	KeySet * frozen = ksFreeze (ks);
+	exit_if_fail (frozen != NULL, "could not freeze keyset");
+	succeed_if (ksIsFrozen (frozen) == 1, "keyset not frozen");
+	compare_keyset (frozen, ks);
+
+	// the snapshot does not change with the original
+	keySetString (a, "changed");
+	ksAppendKey (ks, keyNew ("user:/tests/freeze/d", KEY_END));
+	Key * found = ksLookupByName (frozen, "user:/tests/freeze/a", 0);
+	exit_if_fail (found != NULL, "key not found");
+	succeed_if (found != a, "keys must be copied");
+	succeed_if_same_string (keyString (found), "va");
+	succeed_if_same_string (keyString (keyGetMeta (found, "type")), "string");
+	succeed_if (ksLookupByName (frozen, "user:/tests/freeze/d", 0) == NULL, "snapshot changed");
+	succeed_if (ksLookupByName (frozen, "system:/tests/freeze/many/999", 0) != NULL, "key not found");
+	succeed_if (ksLookupByName (frozen, "system:/tests/freeze/many/1000", 0) == NULL, "missing key found");
+	succeed_if (ksLookupByName (frozen, "system:/tests/freeze/many/500", KDB_O_BINSEARCH) != NULL, "key not found");
+	succeed_if_same_string (keyString (ksLookupByName (frozen, "/tests/freeze/b", 0)), "vb");
+
+#ifdef ELEKTRA_ENABLE_OPTIMIZATIONS
+	succeed_if (frozen->opmphm && frozen->opmphm->size > 0, "OPMPHM must be built by ksFreeze");
+	succeed_if (frozen->opmphmPredictor == NULL, "lookups must not create the predictor");
+#endif
+
+	// lookups have no side effects
+	succeed_if (ksGetCursor (frozen) == -1, "lookup moved the cursor");
+	succeed_if (ksLookupByName (frozen, "user:/tests/freeze/a", KDB_O_POP) == NULL, "pop must fail");
+	succeed_if (ksLookupByName (frozen, "user:/tests/freeze/e", KDB_O_CREATE) == NULL, "create must fail");
+	succeed_if (ksLookupByName (frozen, "/tests/freeze/c", 0) == NULL, "default key must not be created");
+	succeed_if (ksGetSize (frozen) == 1003, "lookup changed the size");
+
+	// no modifications
+	succeed_if (ksAppendKey (frozen, keyNew ("user:/tests/freeze/e", KEY_END)) == -1, "append must fail");
+	succeed_if (ksAppend (frozen, ks) == -1, "append must fail");
+	succeed_if (ksCut (frozen, a) == NULL, "cut must fail");
+	succeed_if (ksPop (frozen) == NULL, "pop must fail");
+	succeed_if (ksClear (frozen) == -1, "clear must fail");
+	succeed_if (ksCopy (frozen, ks) == -1, "copy must fail");
+	succeed_if (ksSetCursor (frozen, 1) == -1, "setting the cursor must fail");
+	succeed_if (ksNext (frozen) == NULL, "next must fail");
+	succeed_if (ksRewind (frozen) == 0, "rewind must not fail");
+	succeed_if (keySetString (found, "x") == -1, "value of frozen key changed");
+	succeed_if (keySetMeta (found, "type", "long") == -1, "metadata of frozen key changed");
+	succeed_if (ksGetSize (frozen) == 1003, "frozen keyset changed");
+
+	// copies can be changed again and do not share metadata
+	Key * dup = keyDup (found, KEY_CP_ALL);
+	succeed_if (keySetString (dup, "x") > 0, "could not change duplicated key");
+	succeed_if (keySetMeta (dup, "type", "long") > 0, "could not change metadata of duplicated key");
+	succeed_if_same_string (keyString (keyGetMeta (dup, "type")), "long");
+	succeed_if (keyGetRef (keyGetMeta (found, "type")) == 1, "metadata of frozen key must not be shared");
+	keyDel (dup);
+
+	Key * metaCopy = keyNew ("user:/tests/freeze/meta", KEY_END);
+	succeed_if (keyCopyAllMeta (metaCopy, found) == 1, "could not copy metadata");
+	succeed_if (keyCopyMeta (metaCopy, found, "type") == 1, "could not copy metadata");
+	succeed_if (keyGetMeta (metaCopy, "type") != keyGetMeta (found, "type"), "metadata of frozen key must not be shared");
+	keyDel (metaCopy);
+
+	KeySet * deep = ksDeepDup (frozen);
+	succeed_if (ksIsFrozen (deep) == 0, "deep copy must not be frozen");
+	succeed_if (ksAppendKey (deep, keyNew ("user:/tests/freeze/e", KEY_END)) == 1004, "could not append to deep copy");
+	ksDel (deep);
+
+	KeySet * refrozen = ksFreeze (frozen);
+	compare_keyset (refrozen, frozen);
+	ksDel (refrozen);
+
+	ksDel (frozen);
+	ksDel (ks);
+
+	// a snapshot only matches its source as long as the source is unchanged
+	ks = ksNew (2, keyNew ("user:/tests/freeze/a", KEY_VALUE, "va", KEY_META, "type", "string", KEY_END),
+		    keyNew ("user:/tests/freeze/b", KEY_VALUE, "vb", KEY_END), KS_END);
+	frozen = ksFreeze (ks);
+	succeed_if (ksFrozenMatches (NULL, ks) == -1, "NULL accepted");
+	succeed_if (ksFrozenMatches (frozen, NULL) == -1, "NULL accepted");
+	succeed_if (ksFrozenMatches (frozen, ks) == 1, "unchanged keyset does not match");
+	keySetString (ksLookupByName (ks, "user:/tests/freeze/b", 0), "changed");
+	succeed_if (ksFrozenMatches (frozen, ks) == 0, "changed value not detected");
+	keySetString (ksLookupByName (ks, "user:/tests/freeze/b", 0), "vb");
+	succeed_if (ksFrozenMatches (frozen, ks) == 1, "restored value does not match");
+	keySetMeta (ksLookupByName (ks, "user:/tests/freeze/a", 0), "type", "long");
+	succeed_if (ksFrozenMatches (frozen, ks) == 0, "changed metadata not detected");
+	keySetMeta (ksLookupByName (ks, "user:/tests/freeze/a", 0), "type", "string");
+	ksAppendKey (ks, keyNew ("user:/tests/freeze/c", KEY_END));
+	succeed_if (ksFrozenMatches (frozen, ks) == 0, "added key not detected");
+	keyDel (ksLookupByName (ks, "user:/tests/freeze/c", KDB_O_POP));
+	keyDel (ksLookupByName (ks, "user:/tests/freeze/b", KDB_O_POP));
+	ksAppendKey (ks, keyNew ("user:/tests/freeze/bb", KEY_VALUE, "vb", KEY_END));
+	succeed_if (ksFrozenMatches (frozen, ks) == 0, "renamed key not detected");
+	ksDel (frozen);
+	ksDel (ks);
+
+	KeySet * empty = ksNew (0, KS_END);
+	frozen = ksFreeze (empty);
+	succeed_if (ksFrozenMatches (frozen, empty) == 1, "empty keysets do not match");
+	succeed_if (ksGetSize (frozen) == 0, "wrong size");
+	succeed_if (ksLookupByName (frozen, "user:/tests/freeze/a", 0) == NULL, "key found in empty keyset");
+	ksDel (frozen);
+	ksDel (empty);
+}
+
+static void test_ksArena (void)
+{
+	printf ("test arena keyset\n");
+
+	KeySet * ks = ksNewArena (10);
+	exit_if_fail (ks != NULL, "could not create arena keyset");
+
+	Key * a = ksArenaKeyNew (ks, "user:/tests/arena/a", "va", sizeof ("va"));
+	Key * b = ksArenaKeyNew (ks, "user:/tests//arena/./b/../#10", NULL, 0);
+	Key * c = ksArenaKeyNew (ks, "user:/tests/arena/c", "vc", sizeof ("vc"));
+	succeed_if (ksArenaKeyNew (ks, "invalid", "x", 2) == NULL, "invalid name accepted");
+	exit_if_fail (a != NULL && b != NULL && c != NULL, "could not create arena keys");
+
+	succeed_if (ksGetSize (ks) == 3, "keys not appended");
+	succeed_if_same_string (keyName (b), "user:/tests/arena/#_10");
+	Key * cmp = keyNew ("user:/tests/arena/#10", KEY_END);
+	succeed_if (keyGetUnescapedNameSize (b) == keyGetUnescapedNameSize (cmp) &&
+			    memcmp (keyUnescapedName (b), keyUnescapedName (cmp), keyGetUnescapedNameSize (cmp)) == 0,
+		    "wrong unescaped name");
+	keyDel (cmp);
+	succeed_if_same_string (keyString (a), "va");
+	succeed_if (b->data.v == NULL, "value should be NULL");
+	succeed_if (ksLookupByName (ks, "user:/tests/arena/c", 0) == c, "lookup failed");
+	succeed_if (keyGetRef (a) == 1, "wrong reference count");
+
+	// changing a value moves it out of the arena
+	keySetString (a, "a longer value than before");
+	succeed_if_same_string (keyString (a), "a longer value than before");
+	keySetMeta (a, "meta:/tests", "meta");
+	succeed_if_same_string (keyString (keyGetMeta (a, "meta:/tests")), "meta");
+
+	// escaping keys are detached and outlive the arena keyset
+	KeySet * other = ksNew (0, KS_END);
+	ksAppendKey (other, c);
+	keyIncRef (a);
+
+	ksDel (ks);
+
+	succeed_if_same_string (keyName (c), "user:/tests/arena/c");
+	succeed_if_same_string (keyString (c), "vc");
+	succeed_if_same_string (keyName (a), "user:/tests/arena/a");
+	succeed_if_same_string (keyString (keyGetMeta (a, "meta:/tests")), "meta");
+
+	keyDecRef (a);
+	keyDel (a);
+	ksDel (other);
+
+	// ksArenaKeyNew on a regular keyset creates regular keys
+	ks = ksNew (0, KS_END);
+	a = ksArenaKeyNew (ks, "user:/tests/arena/a", "va", sizeof ("va"));
+	succeed_if (a != NULL && ksGetSize (ks) == 1, "key not created");
+	succeed_if_same_string (keyString (a), "va");
+	ksDel (ks);
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("KS         TESTS\n");
@@ -569,6 +927,11 @@ int main (int argc, char ** argv)
 	test_ksRename ();
 	test_ksFindHierarchy ();
 	test_ksSearch ();
+	test_ksSearchCommonPrefix ();
+	test_ksAppendMerge ();
+	test_ksBuilder ();
+	test_ksFreeze ();
+	test_ksArena ();
 
 	printf ("\ntest_ks RESULTS: %d test(s) done. %d error(s).\n", nbTest, nbError);
 
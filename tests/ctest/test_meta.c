@@ -309,6 +309,120 @@ static void test_top (void)
 	ksDel (testCycleOrder3);
 	elektraFree (array);
 }
+static void test_metaNames (void)
+{
+	printf ("Test names of metadata\n");
+
+	Key * key = keyNew ("user:/tests/meta", KEY_END);
+
+	succeed_if (keySetMeta (key, "check/type", "long") == sizeof ("long"), "could not set metadata");
+	succeed_if (keySetMeta (key, "meta:/array/#10", "ten") == sizeof ("ten"), "could not set metadata");
+	succeed_if (keySetMeta (key, "weird/./na\\/me//", "escaped") == sizeof ("escaped"), "could not set metadata");
+	succeed_if (keySetMeta (key, "_under-score", "special") == sizeof ("special"), "could not set metadata");
+
+	char longName[600];
+	memset (longName, 'x', sizeof (longName) - 1);
+	longName[sizeof (longName) - 1] = '\0';
+	longName[100] = '/';
+	succeed_if (keySetMeta (key, longName, "long name") == sizeof ("long name"), "could not set metadata with long name");
+
+	// all spellings of a name find the same metadata
+	succeed_if_same_string (keyString (keyGetMeta (key, "check/type")), "long");
+	succeed_if_same_string (keyString (keyGetMeta (key, "meta:/check/type")), "long");
+	succeed_if_same_string (keyString (keyGetMeta (key, "check//type/")), "long");
+	succeed_if_same_string (keyString (keyGetMeta (key, "check/./type")), "long");
+	succeed_if_same_string (keyString (keyGetMeta (key, "array/#_10")), "ten");
+	succeed_if_same_string (keyString (keyGetMeta (key, "weird/na\\/me")), "escaped");
+	succeed_if_same_string (keyString (keyGetMeta (key, "meta:/_under-score")), "special");
+	succeed_if_same_string (keyString (keyGetMeta (key, longName)), "long name");
+	succeed_if_same_string (keyName (keyGetMeta (key, "check/type")), "meta:/check/type");
+	succeed_if_same_string (keyName (keyGetMeta (key, "weird/na\\/me")), "meta:/weird/na\\/me");
+
+	succeed_if (keyGetMeta (key, "check") == NULL, "found parent of metadata");
+	succeed_if (keyGetMeta (key, "check/type/sub") == NULL, "found child of metadata");
+	succeed_if (keyGetMeta (key, "array/#10/\\") == NULL, "invalid name accepted");
+	succeed_if (keySetMeta (key, "array/#10/\\", "x") == -1, "invalid name accepted");
+
+	// replacing and removing keeps the others
+	succeed_if (keySetMeta (key, "check//type", "short") == sizeof ("short"), "could not replace metadata");
+	succeed_if_same_string (keyString (keyGetMeta (key, "check/type")), "short");
+	succeed_if (ksGetSize (keyMeta (key)) == 5, "wrong number of metadata");
+	succeed_if (keySetMeta (key, "missing", NULL) == 0, "could not remove missing metadata");
+	succeed_if (keySetMeta (key, longName, NULL) == 0, "could not remove metadata");
+	succeed_if (keyGetMeta (key, longName) == NULL, "metadata not removed");
+	succeed_if (ksGetSize (keyMeta (key)) == 4, "wrong number of metadata");
+	succeed_if_same_string (keyString (keyGetMeta (key, "array/#_10")), "ten");
+
+	keyDel (key);
+}
+
+static void test_sharedMeta (void)
+{
+	printf ("Test copy-on-write sharing of metadata\n");
+
+	Key * spec = keyNew ("spec:/tests/shared", KEY_META, "type", "long", KEY_META, "default", "5", KEY_END);
+	Key * a = keyNew ("user:/tests/shared", KEY_END);
+	Key * b = keyDup (spec, KEY_CP_ALL);
+
+	succeed_if (keyCopyAllMeta (a, spec) == 1, "could not copy metadata");
+	succeed_if (elektraKeyGetMetaKeySet (a) == elektraKeyGetMetaKeySet (spec), "metadata KeySet not shared");
+	succeed_if (elektraKeyGetMetaKeySet (b) == elektraKeyGetMetaKeySet (spec), "metadata KeySet not shared by keyDup");
+	succeed_if (elektraKeyGetMetaKeySet (a)->shares == 3, "wrong number of Keys sharing the metadata");
+
+	// reading does not unshare
+	succeed_if_same_string (keyString (keyGetMeta (a, "type")), "long");
+	succeed_if (keyCopyMeta (a, spec, "default") == 1, "could not copy metadata");
+	succeed_if (elektraKeyGetMetaKeySet (a) == elektraKeyGetMetaKeySet (spec), "keyCopyMeta of shared metadata unshared it");
+
+	// changing unshares only the changed Key
+	succeed_if (keySetMeta (a, "type", "string") == sizeof ("string"), "could not set metadata");
+	succeed_if (elektraKeyGetMetaKeySet (a) != elektraKeyGetMetaKeySet (spec), "metadata still shared after change");
+	succeed_if_same_string (keyString (keyGetMeta (a, "type")), "string");
+	succeed_if_same_string (keyString (keyGetMeta (spec, "type")), "long");
+	succeed_if_same_string (keyString (keyGetMeta (b, "type")), "long");
+	succeed_if (keyGetMeta (a, "default") == keyGetMeta (spec, "default"), "metadata Keys not shared anymore");
+	succeed_if (elektraKeyGetMetaKeySet (spec)->shares == 2, "wrong number of Keys sharing the metadata");
+
+	// keyMeta() may be used for changes, so it unshares as well
+	KeySet * meta = keyMeta (b);
+	succeed_if (meta != elektraKeyGetMetaKeySet (spec), "keyMeta returned shared metadata");
+	ksAppendKey (meta, keyNew ("meta:/check/range", KEY_VALUE, "1-10", KEY_END));
+	succeed_if (keyGetMeta (spec, "check/range") == NULL, "change of copy visible in original");
+	succeed_if (keyGetMeta (b, "check/range") != NULL, "change not visible");
+
+	// the KeySet returned by keyMeta() stays private, later changes through it only affect its Key
+	Key * d = keyDup (b, KEY_CP_ALL);
+	succeed_if (elektraKeyGetMetaKeySet (d) != meta, "metadata returned by keyMeta shared by keyDup");
+	ksAppendKey (meta, keyNew ("meta:/check/enum", KEY_VALUE, "#0", KEY_END));
+	succeed_if (keyGetMeta (d, "check/enum") == NULL, "change through keyMeta visible in copy");
+	succeed_if (keyGetMeta (d, "check/range") != NULL, "copy misses metadata");
+	keyDel (d);
+
+	// sharing does not use the reference counter, a KeySet referenced elsewhere is copied
+	KeySet * specMeta = (KeySet *) elektraKeyGetMetaKeySet (spec);
+	uint16_t shares = specMeta->shares;
+	ksIncRef (specMeta);
+	succeed_if (ksGetRef (specMeta) == 1, "sharing changed the reference counter");
+	Key * e = keyDup (spec, KEY_CP_ALL);
+	succeed_if (elektraKeyGetMetaKeySet (e) != specMeta, "referenced metadata shared");
+	succeed_if (specMeta->shares == shares, "copy changed the number of Keys sharing the metadata");
+	ksDecRef (specMeta);
+	keyDel (e);
+
+	// removing unshares too, the last Key owns the metadata alone again
+	Key * c = keyNew ("/", KEY_END);
+	keyCopy (c, spec, KEY_CP_META);
+	succeed_if (elektraKeyGetMetaKeySet (c) == elektraKeyGetMetaKeySet (spec), "metadata KeySet not shared by keyCopy");
+	keyDel (spec);
+	succeed_if (keySetMeta (c, "default", NULL) == 0, "could not remove metadata");
+	succeed_if (keyGetMeta (c, "default") == NULL, "metadata not removed");
+	succeed_if_same_string (keyString (keyGetMeta (c, "type")), "long");
+
+	keyDel (a);
+	keyDel (b);
+	keyDel (c);
+}
+
 int main (int argc, char ** argv)
 {
 	printf ("KEY META     TESTS\n");
@@ -320,6 +434,8 @@ int main (int argc, char ** argv)
 	test_comment ();
 
 	test_metaArrayToKS ();
+	test_metaNames ();
+	test_sharedMeta ();
 	test_top ();
 	printf ("\ntest_meta RESULTS: %d test(s) done. %d error(s).\n", nbTest, nbError);
 
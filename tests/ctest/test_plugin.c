@@ -59,6 +59,48 @@ static void test_name (void)
 	ksDel (modules);
 }
 
+static void test_changeLog (void)
+{
+	printf ("Test change log\n");
+
+	Plugin plugin = { .global = ksNew (0, KS_END) };
+
+	KeySet * stored = ksNew (4, keyNew ("user:/a", KEY_END), keyNew ("user:/b", KEY_END), keyNew ("user:/c", KEY_END),
+				 keyNew ("user:/d", KEY_END), KS_END);
+	KeySet * returned = ksDeepDup (stored);
+	for (elektraCursor it = 0; it < ksGetSize (returned); ++it)
+	{
+		clear_bit (ksAtCursor (returned, it)->flags, KEY_FLAG_SYNC);
+	}
+	keySetString (ksLookupByName (returned, "user:/b", 0), "changed");
+	keyDel (ksLookupByName (returned, "user:/c", KDB_O_POP));
+	ksAppendKey (returned, keyNew ("user:/e", KEY_END));
+
+	KeySet * added = ksNew (0, KS_END);
+	KeySet * changed = ksNew (0, KS_END);
+	KeySet * removed = ksNew (0, KS_END);
+
+	succeed_if (elektraPluginGetChangeLog (&plugin, returned, added, changed, removed) == 0, "change log outside of kdbSet");
+
+	ElektraKdbPhase phase = ELEKTRA_KDB_SET_PHASE_STORAGE;
+	ksAppendKey (plugin.global, keyNew ("system:/elektra/kdb/backend/phase", KEY_BINARY, KEY_SIZE, sizeof (ElektraKdbPhase), KEY_VALUE,
+					    &phase, KEY_END));
+	ksAppendKey (plugin.global, keyNew ("system:/elektra/kdb/backend/storedkeys", KEY_BINARY, KEY_SIZE, sizeof (stored), KEY_VALUE,
+					    &stored, KEY_END));
+
+	succeed_if (elektraPluginGetChangeLog (&plugin, returned, added, changed, removed) == 1, "no change log");
+	succeed_if (ksGetSize (added) == 1 && ksLookupByName (added, "user:/e", 0) != NULL, "wrong added keys");
+	succeed_if (ksGetSize (changed) == 1 && ksLookupByName (changed, "user:/b", 0) != NULL, "wrong changed keys");
+	succeed_if (ksGetSize (removed) == 1 && ksLookupByName (removed, "user:/c", 0) != NULL, "wrong removed keys");
+
+	ksDel (added);
+	ksDel (changed);
+	ksDel (removed);
+	ksDel (returned);
+	ksDel (stored);
+	ksDel (plugin.global);
+}
+
 int main (int argc, char ** argv)
 {
 	printf (" PLUGINS  TESTS\n");
@@ -68,6 +110,7 @@ int main (int argc, char ** argv)
 
 	test_simple ();
 	test_name ();
+	test_changeLog ();
 
 	printf ("\ntest_plugin RESULTS: %d test(s) done. %d error(s).\n", nbTest, nbError);
 
@@ -54,7 +54,7 @@ public:
 /**
  * @brief Cascading + Spec mountpoint
  *
- * Hardcoded with resolver+dump
+ * Hardcoded with resolver+dump, further plugins can be added
  *
  * useful to quickly mount something in tests
  * and determine the config file paths (+unlink provided)
@@ -68,11 +68,11 @@ public:
 	std::string systemConfigFile;
 	std::string dirConfigFile; // currently unused, but may disturb tests if present
 
-	Mountpoint (std::string mountpoint_, std::string configFile_) : mountpoint (mountpoint_)
+	Mountpoint (std::string mountpoint_, std::string configFile_, std::vector<std::string> plugins_ = {}) : mountpoint (mountpoint_)
 	{
 		unlink ();
-		mount (mountpoint, configFile_);
-		mount ("spec:" + mountpoint, configFile_);
+		mount (mountpoint, configFile_, plugins_);
+		mount ("spec:" + mountpoint, configFile_, plugins_);
 
 		userConfigFile = getConfigFileName ("user", mountpoint);
 		specConfigFile = getConfigFileName ("spec", mountpoint);
@@ -113,7 +113,7 @@ public:
 		return parent.getString ();
 	}
 
-	static void mount (std::string mountpoint_, std::string configFile)
+	static void mount (std::string mountpoint_, std::string configFile, std::vector<std::string> plugins = {})
 	{
 		using namespace kdb;
 		using namespace kdb::tools;
@@ -124,6 +124,10 @@ public:
 		b.useConfigFile (configFile);
 		b.addPlugin (PluginSpec ("dump"));
 		b.addPlugin (PluginSpec ("error"));
+		for (const auto & plugin : plugins)
+		{
+			b.addPlugin (PluginSpec (plugin));
+		}
 		KeySet ks;
 		KDB kdb;
 		Key parentKey ("system:/elektra/mountpoints", KEY_END);
@@ -0,0 +1,144 @@
+/**
+ * @file
+ *
+ * @brief Tests for the cache of KDB
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ *
+ */
+
+#include <ftw.h>
+#include <stdlib.h>
+
+#include <keysetio.hpp>
+#include <sstream>
+
+#include <gtest/gtest-elektra.h>
+
+
+class Cache : public ::testing::Test
+{
+protected:
+	static const std::string testRoot;
+	static const std::string configFile;
+
+	testing::MountpointPtr mp;
+	char cacheDir[64];
+
+	virtual void SetUp () override
+	{
+		// keep the cache entries of the tests out of the cache of the user
+		strcpy (cacheDir, "/tmp/elektra-testkdb-cache-XXXXXX");
+		ASSERT_NE (mkdtemp (cacheDir), nullptr) << "could not create temporary cache directory";
+		setenv ("XDG_CACHE_HOME", cacheDir, 1);
+
+		// tracer prints a line for each call in the prestorage and poststorage phases
+		mp.reset (new testing::Mountpoint (testRoot, configFile, { "tracer" }));
+	}
+
+	virtual void TearDown () override
+	{
+		mp.reset ();
+
+		nftw (cacheDir, removeCacheFile, 16, FTW_DEPTH | FTW_PHYS);
+		unsetenv ("XDG_CACHE_HOME");
+	}
+
+	static int removeCacheFile (const char * fpath, const struct stat *, int, struct FTW *)
+	{
+		return remove (fpath);
+	}
+
+	static kdb::KeySet cacheContract ()
+	{
+		return kdb::KeySet (1, *kdb::Key ("system:/elektra/contract/mountglobal/cache", KEY_END), KS_END);
+	}
+
+	/**
+	 * @brief Fetches @p ks with a fresh KDB handle and counts the calls of tracer for the system:/ backend.
+	 *
+	 * proc:/ backends are never cached, so their calls are not counted.
+	 */
+	static size_t getCountingStorageCalls (kdb::KeySet contract, kdb::KeySet & ks)
+	{
+		using namespace kdb;
+		KDB kdb (contract);
+
+		testing::internal::CaptureStdout ();
+		kdb.get (ks, testRoot);
+		std::istringstream output (testing::internal::GetCapturedStdout ());
+
+		const std::string backend = ", system:" + testRoot.substr (0, testRoot.size () - 1) + ",";
+		size_t calls = 0;
+		for (std::string line; std::getline (output, line);)
+		{
+			if (line.find ("tracer: get(") == 0 && line.find (backend) != std::string::npos)
+			{
+				++calls;
+			}
+		}
+		return calls;
+	}
+};
+
+const std::string Cache::testRoot = "/tests/kdbcache/";
+const std::string Cache::configFile = "kdbFileCache.dump";
+
+
+TEST_F (Cache, HitSkipsStorage)
+{
+	using namespace kdb;
+	{
+		KDB kdb;
+		KeySet ks;
+		kdb.get (ks, testRoot);
+		ks.append (Key ("system:" + testRoot + "key", KEY_VALUE, "value", KEY_END));
+		ASSERT_EQ (kdb.set (ks, testRoot), 1);
+	}
+
+	KeySet first;
+	EXPECT_GT (getCountingStorageCalls (cacheContract (), first), 0) << "first kdbGet did not read from storage";
+	ASSERT_TRUE (first.lookup ("system:" + testRoot + "key")) << "key missing" << first;
+
+	KeySet cached;
+	EXPECT_EQ (getCountingStorageCalls (cacheContract (), cached), 0) << "cache hit ran prestorage or poststorage plugins";
+	Key k = cached.lookup ("system:" + testRoot + "key");
+	ASSERT_TRUE (k) << "key missing after cache hit" << cached;
+	EXPECT_EQ (k.getString (), "value");
+
+	KeySet uncached;
+	EXPECT_GT (getCountingStorageCalls (KeySet (), uncached), 0) << "kdbGet without cache did not read from storage";
+	ASSERT_TRUE (uncached.lookup ("system:" + testRoot + "key")) << "key missing" << uncached;
+}
+
+TEST_F (Cache, ChangedMountpointConfigMisses)
+{
+	using namespace kdb;
+	{
+		KDB kdb;
+		KeySet ks;
+		kdb.get (ks, testRoot);
+		ks.append (Key ("system:" + testRoot + "key", KEY_VALUE, "value", KEY_END));
+		ASSERT_EQ (kdb.set (ks, testRoot), 1);
+	}
+
+	KeySet first;
+	EXPECT_GT (getCountingStorageCalls (cacheContract (), first), 0) << "first kdbGet did not read from storage";
+
+	// changing the configuration of the mountpoint must invalidate its cache entry
+	{
+		KDB kdb;
+		KeySet ks;
+		Key parentKey ("system:/elektra/mountpoints", KEY_END);
+		kdb.get (ks, parentKey);
+		Key mountpoint ("system:/elektra/mountpoints", KEY_END);
+		mountpoint.addBaseName (testRoot.substr (0, testRoot.size () - 1));
+		mountpoint = ks.lookup (mountpoint);
+		ASSERT_TRUE (mountpoint) << "mountpoint config missing" << ks;
+		ks.append (Key (mountpoint.getName () + "/config/tests/kdbcache", KEY_VALUE, "changed", KEY_END));
+		ASSERT_EQ (kdb.set (ks, parentKey), 1);
+	}
+
+	KeySet changed;
+	EXPECT_GT (getCountingStorageCalls (cacheContract (), changed), 0) << "cache entry of changed mountpoint config was used";
+}
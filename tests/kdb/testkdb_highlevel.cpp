@@ -956,3 +956,39 @@ TEST_F (Highlevel, EnforceMetadata)
 
 	EXPECT_NE (elektraFindKey (elektra, "testkey", nullptr), nullptr);
 }
+
+TEST_F (Highlevel, KeyIndex)
+{
+	setValues ({
+		makeKey (KDB_TYPE_STRING, "stringkey", "A string"),
+		makeKey (KDB_TYPE_BOOLEAN, "booleankey", "1"),
+		makeKey (KDB_TYPE_LONG, "longkey", "1"),
+		makeKey (KDB_TYPE_DOUBLE, "doublekey", "1.1"),
+		makeKey (KDB_TYPE_STRING, "wrongtypekey", "A string"),
+	});
+
+	createElektra ();
+
+	const ElektraIndexedKey keys[] = {
+		{ "stringkey", KDB_TYPE_STRING }, { "booleankey", KDB_TYPE_BOOLEAN }, { "longkey", KDB_TYPE_LONG },
+		{ "doublekey", KDB_TYPE_DOUBLE }, { "wrongtypekey", KDB_TYPE_LONG },  { "missingkey", KDB_TYPE_LONG },
+	};
+	elektraBuildKeyIndex (elektra, keys, sizeof (keys) / sizeof (keys[0]));
+
+	EXPECT_STREQ (elektraGetStringById (elektra, 0), "A string") << "Wrong key value.";
+	EXPECT_TRUE (elektraGetBooleanById (elektra, 1)) << "Wrong key value.";
+	EXPECT_EQ (elektraGetLongById (elektra, 2), 1) << "Wrong key value.";
+	EXPECT_EQ (elektraGetDoubleById (elektra, 3), 1.1) << "Wrong key value.";
+
+	EXPECT_THROW (elektraGetLongById (elektra, 4), std::runtime_error);
+	EXPECT_THROW (elektraGetLongById (elektra, 5), std::runtime_error);
+	EXPECT_THROW (elektraGetLongById (elektra, 6), std::runtime_error);
+
+	ElektraError * error = nullptr;
+	elektraSetLong (elektra, "longkey", 2, &error);
+	elektraSetLong (elektra, "missingkey", 3, &error);
+	ASSERT_EQ (error, nullptr) << "elektraSetLong failed";
+
+	EXPECT_EQ (elektraGetLongById (elektra, 2), 2) << "Index not updated.";
+	EXPECT_EQ (elektraGetLongById (elektra, 5), 3) << "Index not updated.";
+}
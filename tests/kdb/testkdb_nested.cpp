@@ -7,6 +7,7 @@
  *
  */
 
+#include <kdbprivate.h>
 #include <keysetio.hpp>
 
 #include <gtest/gtest-elektra.h>
@@ -222,3 +223,106 @@ TEST_F (Nested, ErrorBelow)
 	ASSERT_EQ (stat (mpRoot->systemConfigFile.c_str (), &buf), -1) << "found wrong file";
 	ASSERT_EQ (stat (mpBelow->systemConfigFile.c_str (), &buf), -1) << "found wrong file";
 }
+
+
+TEST_F (Nested, GetParallel)
+{
+	using namespace kdb;
+	KeySet ks;
+
+	ks.append (Key ("system:" + testRoot + "key", KEY_VALUE, "root", KEY_END));
+	ks.append (Key ("system:" + testRoot + "key/subkey", KEY_END));
+	ks.append (Key ("system:" + testBelow + "key", KEY_VALUE, "below", KEY_END));
+	ks.append (Key ("system:" + testBelow + "key/subkey", KEY_END));
+
+	{
+		KDB kdb;
+		ASSERT_EQ (kdb.get (ks, testRoot), 2) << "should be nothing to update";
+		ASSERT_EQ (kdb.set (ks, testRoot), 1);
+	}
+
+	KeySet contract;
+	contract.append (Key ("system:/elektra/contract/parallel", KEY_VALUE, "4", KEY_END));
+	KDB kdb (contract);
+	KeySet ks2;
+	ASSERT_EQ (kdb.get (ks2, testRoot), 1);
+	ASSERT_EQ (ks2.size (), 4) << "did not get keys stored before" << ks2;
+	EXPECT_EQ (ks2.lookup ("system:" + testRoot + "key").getString (), "root");
+	EXPECT_EQ (ks2.lookup ("system:" + testBelow + "key").getString (), "below");
+	ASSERT_EQ (kdb.get (ks2, testRoot), 2) << "should be nothing to update";
+
+	ks2.clear ();
+	ASSERT_EQ (kdb.set (ks2, testRoot), 1); // remove files
+}
+
+
+TEST_F (Nested, Stream)
+{
+	using namespace kdb;
+	KeySet ks;
+
+	ks.append (Key ("system:" + testRoot + "a", KEY_VALUE, "root", KEY_END));
+	ks.append (Key ("system:" + testRoot + "z", KEY_END));
+	ks.append (Key ("system:" + testBelow + "key", KEY_VALUE, "below", KEY_END));
+	ks.append (Key ("system:" + testBelow + "key/subkey", KEY_END));
+
+	{
+		KDB kdb;
+		ASSERT_EQ (kdb.get (ks, testRoot), 2) << "should be nothing to update";
+		ASSERT_EQ (kdb.set (ks, testRoot), 1);
+	}
+
+	Key parent ("system:" + testRoot, KEY_END);
+	ckdb::KDB * handle = ckdb::kdbOpen (NULL, parent.getKey ());
+	ASSERT_NE (handle, nullptr);
+	ckdb::KDBGetStream * stream = ckdb::kdbGetStreamOpen (handle, parent.getKey ());
+	ASSERT_NE (stream, nullptr) << parent;
+
+	std::vector<std::string> names;
+	std::vector<std::string> files;
+	ckdb::KeySet * keys;
+	int ret;
+	while ((ret = ckdb::kdbGetStreamNext (stream, &keys)) == 1)
+	{
+		EXPECT_EQ (parent.getName (), "system:" + testRoot.substr (0, testRoot.size () - 1)) << "parentKey not restored";
+		files.push_back (parent.getString ());
+		for (ssize_t i = 0; i < ckdb::ksGetSize (keys); ++i)
+		{
+			names.push_back (ckdb::keyName (ckdb::ksAtCursor (keys, i)));
+		}
+	}
+	EXPECT_EQ (ret, 0) << parent;
+	EXPECT_EQ (keys, nullptr);
+	ckdb::kdbGetStreamClose (stream);
+
+	// the stream did not keep the keys, so the handle has to read them again
+	ckdb::KeySet * got = ckdb::ksNew (0, KS_END);
+	EXPECT_EQ (ckdb::kdbGet (handle, got, parent.getKey ()), 1) << parent;
+	EXPECT_EQ (ckdb::ksGetSize (got), 4) << "keys of the streamed backends got lost";
+	ckdb::ksDel (got);
+	ckdb::kdbClose (handle, parent.getKey ());
+
+	// one backend after the other, each sorted
+	std::vector<std::string> expected = { "system:" + testRoot + "a", "system:" + testRoot + "z", "system:" + testBelow + "key",
+					      "system:" + testBelow + "key/subkey" };
+	EXPECT_EQ (names, expected);
+	ASSERT_EQ (files.size (), 2);
+	EXPECT_EQ (files[0], mpRoot->systemConfigFile);
+	EXPECT_EQ (files[1], mpBelow->systemConfigFile);
+
+	KDB kdb;
+	KeySet ks2;
+	ASSERT_EQ (kdb.get (ks2, testRoot), 1);
+	ASSERT_EQ (ks2.size (), 4) << "did not get keys stored before" << ks2;
+	ks2.clear ();
+	ASSERT_EQ (kdb.set (ks2, testRoot), 1); // remove files
+}
+
+
+TEST_F (Nested, ParallelInvalid)
+{
+	using namespace kdb;
+	KeySet contract;
+	contract.append (Key ("system:/elektra/contract/parallel", KEY_VALUE, "many", KEY_END));
+	EXPECT_THROW (KDB kdb (contract), kdb::KDBException) << "invalid thread count accepted";
+}
@@ -76,6 +76,21 @@ static int isHelpMode (int argc, const char * const * argv)
 }
 
 
+// the position of a key in this array is used as its id in the getters
+static const ElektraIndexedKey indexedKeys[] = {
+	{ "get", "string" },
+	{ "get/keyname", "string" },
+	{ "get/maxlength", "long" },
+	{ "get/meta", "string" },
+	{ "get/meta/keyname", "string" },
+	{ "get/meta/metaname", "string" },
+	{ "get/meta/verbose", "boolean" },
+	{ "get/verbose", "boolean" },
+	{ "printversion", "boolean" },
+	{ "setter", "string" },
+	{ "setter/keyname", "string" },
+	{ "setter/value", "string" },
+};
 
 /**
  * Initializes an instance of Elektra for the application '/tests/script/gen/highlevel/commands'.
@@ -142,6 +157,8 @@ int loadConfiguration (Elektra ** elektra,
 		return -1;
 	}
 
+	elektraBuildKeyIndex (e, indexedKeys, 12);
+
 	*elektra = e;
 	return elektraHelpKey (e) != NULL && strcmp (keyString (elektraHelpKey (e)), "1") == 0 ? 1 : 0;
 }
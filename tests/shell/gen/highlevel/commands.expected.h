@@ -278,7 +278,7 @@ static inline kdb_long_long_t ELEKTRA_SIZE (ELEKTRA_TAG_DYNAMIC) (Elektra * elek
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_GET) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "get");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 0);
 }
 
 
@@ -314,7 +314,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_GET_KEYNAME) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "get/keyname");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 1);
 }
 
 
@@ -349,7 +349,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_KEYNAME) (Elektra * elektra,
 static inline kdb_long_t ELEKTRA_GET (ELEKTRA_TAG_GET_MAXLENGTH) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Long) (elektra, "get/maxlength");
+	return ELEKTRA_GET_BY_ID (Long) (elektra, 2);
 }
 
 
@@ -385,7 +385,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_MAXLENGTH) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_GET_META) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "get/meta");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 3);
 }
 
 
@@ -421,7 +421,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_META) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_GET_META_KEYNAME) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "get/meta/keyname");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 4);
 }
 
 
@@ -457,7 +457,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_META_KEYNAME) (Elektra * elektra
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_GET_META_METANAME) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "get/meta/metaname");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 5);
 }
 
 
@@ -492,7 +492,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_META_METANAME) (Elektra * elektr
 static inline kdb_boolean_t ELEKTRA_GET (ELEKTRA_TAG_GET_META_VERBOSE) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Boolean) (elektra, "get/meta/verbose");
+	return ELEKTRA_GET_BY_ID (Boolean) (elektra, 6);
 }
 
 
@@ -527,7 +527,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_META_VERBOSE) (Elektra * elektra
 static inline kdb_boolean_t ELEKTRA_GET (ELEKTRA_TAG_GET_VERBOSE) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Boolean) (elektra, "get/verbose");
+	return ELEKTRA_GET_BY_ID (Boolean) (elektra, 7);
 }
 
 
@@ -562,7 +562,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_GET_VERBOSE) (Elektra * elektra,
 static inline kdb_boolean_t ELEKTRA_GET (ELEKTRA_TAG_PRINTVERSION) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Boolean) (elektra, "printversion");
+	return ELEKTRA_GET_BY_ID (Boolean) (elektra, 8);
 }
 
 
@@ -598,7 +598,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_PRINTVERSION) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_SETTER) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "setter");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 9);
 }
 
 
@@ -634,7 +634,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_SETTER) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_SETTER_KEYNAME) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "setter/keyname");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 10);
 }
 
 
@@ -670,7 +670,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_SETTER_KEYNAME) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_SETTER_VALUE) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "setter/value");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 11);
 }
 
 
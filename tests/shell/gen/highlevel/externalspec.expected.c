@@ -57,6 +57,13 @@ static int isHelpMode (int argc, const char * const * argv)
 }
 
 
+// the position of a key in this array is used as its id in the getters
+static const ElektraIndexedKey indexedKeys[] = {
+	{ "mydouble", "double" },
+	{ "myint", "long" },
+	{ "mystring", "string" },
+	{ "print", "boolean" },
+};
 
 /**
  * Initializes an instance of Elektra for the application '/tests/script/gen/highlevel/externalspec'.
@@ -124,6 +131,8 @@ int loadConfiguration (Elektra ** elektra,
 		return -1;
 	}
 
+	elektraBuildKeyIndex (e, indexedKeys, 4);
+
 	*elektra = e;
 	return elektraHelpKey (e) != NULL && strcmp (keyString (elektraHelpKey (e)), "1") == 0 ? 1 : 0;
 }
@@ -174,7 +174,7 @@ extern "C" {
 static inline kdb_double_t ELEKTRA_GET (ELEKTRA_TAG_MYDOUBLE) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Double) (elektra, "mydouble");
+	return ELEKTRA_GET_BY_ID (Double) (elektra, 0);
 }
 
 
@@ -263,7 +263,7 @@ static inline kdb_long_long_t ELEKTRA_SIZE (ELEKTRA_TAG_MYFLOATARRAY) (Elektra *
 static inline kdb_long_t ELEKTRA_GET (ELEKTRA_TAG_MYINT) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Long) (elektra, "myint");
+	return ELEKTRA_GET_BY_ID (Long) (elektra, 1);
 }
 
 
@@ -299,7 +299,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_MYINT) (Elektra * elektra,
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_MYSTRING) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "mystring");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 2);
 }
 
 
@@ -334,7 +334,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_MYSTRING) (Elektra * elektra,
 static inline kdb_boolean_t ELEKTRA_GET (ELEKTRA_TAG_PRINT) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Boolean) (elektra, "print");
+	return ELEKTRA_GET_BY_ID (Boolean) (elektra, 3);
 }
 
 
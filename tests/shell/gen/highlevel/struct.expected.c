@@ -77,6 +77,13 @@ static int isHelpMode (int argc, const char * const * argv)
 }
 
 
+// the position of a key in this array is used as its id in the getters
+static const ElektraIndexedKey indexedKeys[] = {
+	{ "myotherstruct/x", "long" },
+	{ "myotherstruct/x/y", "long" },
+	{ "mystruct/a", "string" },
+	{ "mystruct/b", "long" },
+};
 
 /**
  * Initializes an instance of Elektra for the application '/tests/script/gen/highlevel/struct'.
@@ -143,6 +150,8 @@ int loadConfiguration (Elektra ** elektra,
 		return -1;
 	}
 
+	elektraBuildKeyIndex (e, indexedKeys, 4);
+
 	*elektra = e;
 	return elektraHelpKey (e) != NULL && strcmp (keyString (elektraHelpKey (e)), "1") == 0 ? 1 : 0;
 }
@@ -338,7 +338,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_MYOTHERSTRUCT) (Elektra * elektra, c
 static inline kdb_long_t ELEKTRA_GET (ELEKTRA_TAG_MYOTHERSTRUCT_X) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Long) (elektra, "myotherstruct/x");
+	return ELEKTRA_GET_BY_ID (Long) (elektra, 0);
 }
 
 
@@ -373,7 +373,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_MYOTHERSTRUCT_X) (Elektra * elektra,
 static inline kdb_long_t ELEKTRA_GET (ELEKTRA_TAG_MYOTHERSTRUCT_X_Y) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Long) (elektra, "myotherstruct/x/y");
+	return ELEKTRA_GET_BY_ID (Long) (elektra, 1);
 }
 
 
@@ -448,7 +448,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_MYSTRUCT) (Elektra * elektra, const
 static inline const char * ELEKTRA_GET (ELEKTRA_TAG_MYSTRUCT_A) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (String) (elektra, "mystruct/a");
+	return ELEKTRA_GET_BY_ID (String) (elektra, 2);
 }
 
 
@@ -483,7 +483,7 @@ static inline void ELEKTRA_SET (ELEKTRA_TAG_MYSTRUCT_A) (Elektra * elektra,
 static inline kdb_long_t ELEKTRA_GET (ELEKTRA_TAG_MYSTRUCT_B) (Elektra * elektra )
 {
 	
-	return ELEKTRA_GET (Long) (elektra, "mystruct/b");
+	return ELEKTRA_GET_BY_ID (Long) (elektra, 3);
 }
 
 